@@ -427,14 +427,14 @@ void BackupRelationTask::releaseBuffer(Item& item)
 	}
 }
 
-void BackupRelationTask::recordAdded(BurpGlobals* tdgbl)
+void BackupRelationTask::recordAdded(BurpGlobals* tdgbl, FB_SIZE_T count)
 {
 	Item* item = static_cast<Item*>(tdgbl->taskItem);
 	if (!item)
 		return;
 
 	IOBuffer* buf = item->m_buffer;
-	buf->recordAdded();
+	buf->recordAdded(count);
 	tdgbl->mvol_io_data = tdgbl->gbl_io_ptr;
 }
 
@@ -492,6 +492,7 @@ void BackupRelationTask::initItem(BurpGlobals* tdgbl, Item& item)
 	tdgbl->gbl_sw_version = m_masterGbl->gbl_sw_version;
 	tdgbl->gbl_sw_transportable = m_masterGbl->gbl_sw_transportable;
 	tdgbl->gbl_sw_blk_factor = m_masterGbl->gbl_sw_blk_factor;
+	tdgbl->gbl_sw_columnar = m_masterGbl->gbl_sw_columnar;
 	tdgbl->gbl_sw_sql_role = m_masterGbl->gbl_sw_sql_role;
 	tdgbl->gbl_sw_user = m_masterGbl->gbl_sw_user;
 	tdgbl->gbl_sw_password = m_masterGbl->gbl_sw_password;
@@ -365,7 +365,7 @@ public:
 		return static_cast<BackupRelationTask*>(task);
 	}
 
-	static void recordAdded(BurpGlobals* tdgbl);			// reader
+	static void recordAdded(BurpGlobals* tdgbl, FB_SIZE_T count = 1);	// reader
 	static IOBuffer* renewBuffer(BurpGlobals* tdgbl);		// reader
 
 	bool isStopped() const noexcept
@@ -568,9 +568,9 @@ public:
 		m_linked = false;
 	}
 
-	void recordAdded() noexcept
+	void recordAdded(FB_SIZE_T count = 1) noexcept
 	{
-		m_recs++;
+		m_recs += count;
 	}
 
 	void linkNext(IOBuffer* buf) noexcept
@@ -0,0 +1,963 @@
+/*
+ *	PROGRAM:	JRD Backup and Restore Program
+ *	MODULE:		ColumnChunk.cpp
+ *	DESCRIPTION:	Columnar layout of relation data
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../burp/ColumnChunk.h"
+#include "../jrd/align.h"
+#include "../common/classes/Hash.h"
+
+using namespace Firebird;
+
+// Chunk is
+//	<columns count>
+//	{ <dtype> <length> <null flags> { <component> }... }...
+// and every component is
+//	<encoding> <data length> <data>
+// Counts and lengths are stored as varints.
+
+namespace
+{
+	enum Encoding : UCHAR
+	{
+		ENC_RAW = 0,		// values as is
+		ENC_RLE = 1,		// <count> <value> for every run of equal values
+		ENC_DELTA = 2,		// difference with the previous value, integers only
+		ENC_DICT = 3,		// <count> <distinct values> followed by one byte index per value
+		ENC_COUNT
+	};
+
+	enum ComponentKind : UCHAR
+	{
+		CMP_INT,
+		CMP_TEXT,
+		CMP_VARYING
+	};
+
+	struct Component
+	{
+		UCHAR kind;
+		UCHAR width;		// of integer
+		USHORT offset;		// inside the value
+	};
+
+	constexpr unsigned MAX_COMPONENTS = 4;
+	constexpr unsigned MAX_DICT_ENTRIES = 256;
+	constexpr unsigned DICT_HASH_SIZE = 1024;		// power of 2
+	constexpr ULONG NO_ENCODING = MAX_ULONG;
+
+	// Split value of given type into components, return 0 for unsupported type
+
+	unsigned getComponents(USHORT dtype, Component* parts)
+	{
+		unsigned count = 0;
+
+		const auto add = [&](UCHAR kind, UCHAR width, USHORT offset)
+		{
+			if (parts)
+				parts[count] = {kind, width, offset};
+			count++;
+		};
+
+		switch (dtype)
+		{
+		case dtype_text:
+			add(CMP_TEXT, 0, 0);
+			break;
+
+		case dtype_varying:
+			add(CMP_VARYING, 0, 0);
+			break;
+
+		case dtype_boolean:
+			add(CMP_INT, 1, 0);
+			break;
+
+		case dtype_short:
+			add(CMP_INT, 2, 0);
+			break;
+
+		case dtype_long:
+		case dtype_sql_date:
+		case dtype_sql_time:
+		case dtype_real:
+			add(CMP_INT, 4, 0);
+			break;
+
+		case dtype_int64:
+		case dtype_double:
+		case dtype_dec64:
+			add(CMP_INT, 8, 0);
+			break;
+
+		case dtype_int128:
+		case dtype_dec128:
+			add(CMP_INT, 8, 0);
+			add(CMP_INT, 8, 8);
+			break;
+
+		case dtype_quad:
+		case dtype_timestamp:
+			add(CMP_INT, 4, 0);
+			add(CMP_INT, 4, 4);
+			break;
+
+		case dtype_timestamp_tz:
+			add(CMP_INT, 4, 0);
+			add(CMP_INT, 4, 4);
+			add(CMP_INT, 2, 8);
+			break;
+
+		case dtype_ex_timestamp_tz:
+			add(CMP_INT, 4, 0);
+			add(CMP_INT, 4, 4);
+			add(CMP_INT, 2, 8);
+			add(CMP_INT, 2, 10);
+			break;
+
+		case dtype_sql_time_tz:
+			add(CMP_INT, 4, 0);
+			add(CMP_INT, 2, 4);
+			break;
+
+		case dtype_ex_time_tz:
+			add(CMP_INT, 4, 0);
+			add(CMP_INT, 2, 4);
+			add(CMP_INT, 2, 6);
+			break;
+		}
+
+		fb_assert(count <= MAX_COMPONENTS);
+		return count;
+	}
+
+	inline FB_UINT64 zigzag(SINT64 value)
+	{
+		return (FB_UINT64(value) << 1) ^ FB_UINT64(value >> 63);
+	}
+
+	inline SINT64 unzigzag(FB_UINT64 value)
+	{
+		return SINT64(value >> 1) ^ -SINT64(value & 1);
+	}
+
+	// difference with wraparound, as deltas of 64-bit values may overflow
+	inline SINT64 delta(SINT64 value, SINT64 prev)
+	{
+		return SINT64(FB_UINT64(value) - FB_UINT64(prev));
+	}
+
+	inline ULONG varintLength(FB_UINT64 value)
+	{
+		ULONG length = 1;
+		for (; value >= 0x80; value >>= 7)
+			length++;
+		return length;
+	}
+
+	void putVarint(Array<UCHAR>& data, FB_UINT64 value)
+	{
+		for (; value >= 0x80; value >>= 7)
+			data.add(UCHAR(value | 0x80));
+		data.add(UCHAR(value));
+	}
+
+	void putFixed(Array<UCHAR>& data, SINT64 value, UCHAR width)
+	{
+		for (UCHAR i = 0; i < width; i++)
+			data.add(UCHAR(FB_UINT64(value) >> (i * 8)));
+	}
+
+	SINT64 getInt(const UCHAR* p, UCHAR width)
+	{
+		switch (width)
+		{
+		case 1:
+			return SCHAR(*p);
+
+		case 2:
+		{
+			SSHORT value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		case 4:
+		{
+			SLONG value;
+			memcpy(&value, p, sizeof(value));
+			return value;
+		}
+		}
+
+		SINT64 value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	void setInt(UCHAR* p, UCHAR width, SINT64 value)
+	{
+		switch (width)
+		{
+		case 1:
+			*p = UCHAR(value);
+			break;
+
+		case 2:
+		{
+			const SSHORT v = SSHORT(value);
+			memcpy(p, &v, sizeof(v));
+			break;
+		}
+
+		case 4:
+		{
+			const SLONG v = SLONG(value);
+			memcpy(p, &v, sizeof(v));
+			break;
+		}
+
+		default:
+			memcpy(p, &value, sizeof(value));
+		}
+	}
+
+	inline unsigned hashInt(SINT64 value)
+	{
+		return unsigned((FB_UINT64(value) * 0x9E3779B97F4A7C15ULL) >> 54) & (DICT_HASH_SIZE - 1);
+	}
+}
+
+
+namespace Burp {
+
+/// class ColumnChunk
+
+ColumnChunk::ColumnChunk(MemoryPool& pool, const burp_rel* relation, bool sqlLayout, ULONG recordLength) :
+	m_columns(pool),
+	m_records(pool),
+	m_recordLength(recordLength),
+	m_count(0),
+	m_supported(true)
+{
+	for (const burp_fld* field = relation->rel_fields; field && m_supported; field = field->fld_next)
+	{
+		if (field->fld_flags & FLD_computed)
+			continue;
+
+		if ((field->fld_flags & FLD_array) || field->fld_type > DTYPE_BLR_MAX)
+		{
+			m_supported = false;
+			break;
+		}
+
+		Column column;
+		column.dtype = gds_cvt_blr_dtype[field->fld_type];
+		column.length = (column.dtype == dtype_text || column.dtype == dtype_varying) ? field->fld_length : 0;
+		column.offset = sqlLayout ? field->fld_sql : field->fld_offset;
+		column.nullOffset = sqlLayout ? field->fld_null : field->fld_missing_offset;
+
+		Component parts[MAX_COMPONENTS];
+		const unsigned count = getComponents(column.dtype, parts);
+
+		// check the value fits into the message
+
+		ULONG length = 0;
+		for (unsigned i = 0; i < count; i++)
+		{
+			switch (parts[i].kind)
+			{
+			case CMP_INT:
+				length = MAX(length, ULONG(parts[i].offset + parts[i].width));
+				break;
+			case CMP_TEXT:
+				length = column.length;
+				break;
+			case CMP_VARYING:
+				length = sizeof(USHORT) + column.length;
+				break;
+			}
+		}
+
+		m_supported = count && column.offset + length <= recordLength &&
+			column.nullOffset + sizeof(SSHORT) <= recordLength;
+
+		m_columns.add(column);
+	}
+
+	m_supported = m_supported && m_columns.hasData();
+}
+
+
+/// class ColumnChunkWriter
+
+ColumnChunkWriter::ColumnChunkWriter(MemoryPool& pool, const burp_rel* relation, ULONG recordLength) :
+	ColumnChunk(pool, relation, false, recordLength),
+	m_data(pool),
+	m_ints(pool),
+	m_strings(pool),
+	m_dictInts(pool),
+	m_dictStrings(pool),
+	m_indexes(pool),
+	m_zeros(pool)
+{
+	// chunk should contain enough records to be worth the encoding
+	m_supported = m_supported && recordLength <= COLUMN_CHUNK_SIZE / 16;
+}
+
+void ColumnChunkWriter::add(const UCHAR* record)
+{
+	fb_assert(m_supported && !isFull());
+
+	m_records.add(record, m_recordLength);
+	m_count++;
+}
+
+const Array<UCHAR>& ColumnChunkWriter::encode()
+{
+	m_data.clear();
+	putVarint(m_data, m_columns.getCount());
+
+	m_ints.resize(m_count);
+	m_strings.resize(m_count);
+	m_indexes.resize(m_count);
+
+	for (const auto& column : m_columns)
+	{
+		m_data.add(UCHAR(column.dtype));
+		putVarint(m_data, column.length);
+
+		// Null flags. The value of null is zero, it doesn't break runs and deltas.
+
+		const UCHAR* record = m_records.begin();
+		for (ULONG i = 0; i < m_count; i++, record += m_recordLength)
+			m_ints[i] = getInt(record + column.nullOffset, sizeof(SSHORT)) ? 1 : 0;
+
+		putInts(1);
+
+		if (m_zeros.getCount() < column.length)
+			m_zeros.resize(column.length, 0);
+
+		Component parts[MAX_COMPONENTS];
+		const unsigned count = getComponents(column.dtype, parts);
+
+		for (unsigned n = 0; n < count; n++)
+		{
+			const Component& part = parts[n];
+
+			record = m_records.begin();
+			for (ULONG i = 0; i < m_count; i++, record += m_recordLength)
+			{
+				const bool null = getInt(record + column.nullOffset, sizeof(SSHORT)) != 0;
+				const UCHAR* const value = record + column.offset + part.offset;
+
+				switch (part.kind)
+				{
+				case CMP_INT:
+					m_ints[i] = null ? 0 : getInt(value, part.width);
+					break;
+
+				case CMP_TEXT:
+					m_strings[i].data = null ? m_zeros.begin() : value;
+					m_strings[i].length = column.length;
+					break;
+
+				case CMP_VARYING:
+					m_strings[i].data = value + sizeof(USHORT);
+					m_strings[i].length = null ? 0 :
+						MIN(ULONG(getInt(value, sizeof(USHORT)) & 0xFFFF), column.length);
+					break;
+				}
+			}
+
+			if (part.kind == CMP_INT)
+				putInts(part.width);
+			else
+				putStrings(part.kind == CMP_VARYING);
+		}
+	}
+
+	m_records.clear();
+	m_count = 0;
+
+	return m_data;
+}
+
+ULONG ColumnChunkWriter::intDictionary()
+{
+	SSHORT slots[DICT_HASH_SIZE];
+	memset(slots, -1, sizeof(slots));
+
+	m_dictInts.clear();
+	ULONG length = 0;
+
+	for (ULONG i = 0; i < m_count; i++)
+	{
+		const SINT64 value = m_ints[i];
+
+		for (unsigned slot = hashInt(value); ; slot = (slot + 1) & (DICT_HASH_SIZE - 1))
+		{
+			if (slots[slot] < 0)
+			{
+				if (m_dictInts.getCount() == MAX_DICT_ENTRIES)
+					return NO_ENCODING;
+
+				slots[slot] = SSHORT(m_dictInts.getCount());
+				m_dictInts.add(value);
+				length += varintLength(zigzag(value));
+			}
+			else if (m_dictInts[slots[slot]] != value)
+				continue;
+
+			m_indexes[i] = UCHAR(slots[slot]);
+			break;
+		}
+	}
+
+	return varintLength(m_dictInts.getCount()) + length + m_count;
+}
+
+ULONG ColumnChunkWriter::stringDictionary(bool varying)
+{
+	SSHORT slots[DICT_HASH_SIZE];
+	memset(slots, -1, sizeof(slots));
+
+	m_dictStrings.clear();
+	ULONG length = 0;
+
+	for (ULONG i = 0; i < m_count; i++)
+	{
+		const String& value = m_strings[i];
+
+		for (unsigned slot = InternalHash::hash(value.length, value.data, DICT_HASH_SIZE); ;
+			slot = (slot + 1) & (DICT_HASH_SIZE - 1))
+		{
+			if (slots[slot] < 0)
+			{
+				if (m_dictStrings.getCount() == MAX_DICT_ENTRIES)
+					return NO_ENCODING;
+
+				slots[slot] = SSHORT(m_dictStrings.getCount());
+				m_dictStrings.add(value);
+				length += (varying ? varintLength(value.length) : 0) + value.length;
+			}
+			else
+			{
+				const String& entry = m_dictStrings[slots[slot]];
+				if (entry.length != value.length || memcmp(entry.data, value.data, value.length))
+					continue;
+			}
+
+			m_indexes[i] = UCHAR(slots[slot]);
+			break;
+		}
+	}
+
+	return varintLength(m_dictStrings.getCount()) + length + m_count;
+}
+
+void ColumnChunkWriter::putInts(UCHAR width)
+{
+	const SINT64* const values = m_ints.begin();
+
+	// Calculate length of every encoding and write the shortest one
+
+	ULONG lengths[ENC_COUNT];
+	lengths[ENC_RAW] = m_count * width;
+	lengths[ENC_RLE] = 0;
+	lengths[ENC_DELTA] = 0;
+
+	for (ULONG i = 0; i < m_count; )
+	{
+		ULONG next = i + 1;
+		while (next < m_count && values[next] == values[i])
+			next++;
+
+		lengths[ENC_RLE] += varintLength(next - i) + varintLength(zigzag(values[i]));
+		i = next;
+	}
+
+	for (ULONG i = 0; i < m_count; i++)
+		lengths[ENC_DELTA] += varintLength(zigzag(delta(values[i], i ? values[i - 1] : 0)));
+
+	lengths[ENC_DICT] = intDictionary();
+
+	UCHAR encoding = ENC_RAW;
+	for (UCHAR e = ENC_RAW + 1; e < ENC_COUNT; e++)
+	{
+		if (lengths[e] < lengths[encoding])
+			encoding = e;
+	}
+
+	m_data.add(encoding);
+	putVarint(m_data, lengths[encoding]);
+
+	const FB_SIZE_T start = m_data.getCount();
+
+	switch (encoding)
+	{
+	case ENC_RAW:
+		for (ULONG i = 0; i < m_count; i++)
+			putFixed(m_data, values[i], width);
+		break;
+
+	case ENC_RLE:
+		for (ULONG i = 0; i < m_count; )
+		{
+			ULONG next = i + 1;
+			while (next < m_count && values[next] == values[i])
+				next++;
+
+			putVarint(m_data, next - i);
+			putVarint(m_data, zigzag(values[i]));
+			i = next;
+		}
+		break;
+
+	case ENC_DELTA:
+		for (ULONG i = 0; i < m_count; i++)
+			putVarint(m_data, zigzag(delta(values[i], i ? values[i - 1] : 0)));
+		break;
+
+	case ENC_DICT:
+		putVarint(m_data, m_dictInts.getCount());
+		for (const auto value : m_dictInts)
+			putVarint(m_data, zigzag(value));
+		m_data.add(m_indexes.begin(), m_count);
+		break;
+	}
+
+	fb_assert(m_data.getCount() - start == lengths[encoding]);
+}
+
+void ColumnChunkWriter::putStrings(bool varying)
+{
+	const String* const values = m_strings.begin();
+
+	const auto equal = [](const String& s1, const String& s2)
+	{
+		return s1.length == s2.length && !memcmp(s1.data, s2.data, s1.length);
+	};
+
+	const auto length = [varying](const String& value)
+	{
+		return (varying ? varintLength(value.length) : 0) + value.length;
+	};
+
+	const auto put = [this, varying](const String& value)
+	{
+		if (varying)
+			putVarint(m_data, value.length);
+		m_data.add(value.data, value.length);
+	};
+
+	ULONG lengths[ENC_COUNT];
+	lengths[ENC_RAW] = 0;
+	lengths[ENC_RLE] = 0;
+	lengths[ENC_DELTA] = NO_ENCODING;
+
+	for (ULONG i = 0; i < m_count; i++)
+		lengths[ENC_RAW] += length(values[i]);
+
+	for (ULONG i = 0; i < m_count; )
+	{
+		ULONG next = i + 1;
+		while (next < m_count && equal(values[next], values[i]))
+			next++;
+
+		lengths[ENC_RLE] += varintLength(next - i) + length(values[i]);
+		i = next;
+	}
+
+	lengths[ENC_DICT] = stringDictionary(varying);
+
+	UCHAR encoding = ENC_RAW;
+	for (UCHAR e = ENC_RAW + 1; e < ENC_COUNT; e++)
+	{
+		if (lengths[e] < lengths[encoding])
+			encoding = e;
+	}
+
+	m_data.add(encoding);
+	putVarint(m_data, lengths[encoding]);
+
+	const FB_SIZE_T start = m_data.getCount();
+
+	switch (encoding)
+	{
+	case ENC_RAW:
+		for (ULONG i = 0; i < m_count; i++)
+			put(values[i]);
+		break;
+
+	case ENC_RLE:
+		for (ULONG i = 0; i < m_count; )
+		{
+			ULONG next = i + 1;
+			while (next < m_count && equal(values[next], values[i]))
+				next++;
+
+			putVarint(m_data, next - i);
+			put(values[i]);
+			i = next;
+		}
+		break;
+
+	case ENC_DICT:
+		putVarint(m_data, m_dictStrings.getCount());
+		for (const auto& value : m_dictStrings)
+			put(value);
+		m_data.add(m_indexes.begin(), m_count);
+		break;
+	}
+
+	fb_assert(m_data.getCount() - start == lengths[encoding]);
+}
+
+
+/// class ColumnChunkReader
+
+class ColumnChunkReader::Input
+{
+public:
+	Input(const UCHAR* data, FB_UINT64 length) noexcept :
+		m_ptr(data), m_end(data + length)
+	{}
+
+	bool getByte(UCHAR& value) noexcept
+	{
+		if (m_ptr >= m_end)
+			return false;
+
+		value = *m_ptr++;
+		return true;
+	}
+
+	bool getVarint(FB_UINT64& value) noexcept
+	{
+		value = 0;
+
+		for (unsigned shift = 0; shift < 64 && m_ptr < m_end; shift += 7)
+		{
+			const UCHAR c = *m_ptr++;
+			value |= FB_UINT64(c & 0x7F) << shift;
+
+			if (!(c & 0x80))
+				return true;
+		}
+
+		return false;
+	}
+
+	bool getFixed(SINT64& value, UCHAR width) noexcept
+	{
+		if (m_end - m_ptr < width)
+			return false;
+
+		FB_UINT64 v = 0;
+		for (UCHAR i = 0; i < width; i++)
+			v |= FB_UINT64(*m_ptr++) << (i * 8);
+
+		// sign extension
+		const unsigned shift = 64 - width * 8;
+		value = shift ? SINT64(v << shift) >> shift : SINT64(v);
+		return true;
+	}
+
+	const UCHAR* getBytes(FB_UINT64 length) noexcept
+	{
+		if (FB_UINT64(m_end - m_ptr) < length)
+			return nullptr;
+
+		const UCHAR* const data = m_ptr;
+		m_ptr += length;
+		return data;
+	}
+
+	bool isEof() const noexcept
+	{
+		return m_ptr == m_end;
+	}
+
+private:
+	const UCHAR* m_ptr;
+	const UCHAR* const m_end;
+};
+
+ColumnChunkReader::ColumnChunkReader(MemoryPool& pool, const burp_rel* relation, bool sqlLayout,
+		ULONG recordLength) :
+	ColumnChunk(pool, relation, sqlLayout, recordLength),
+	m_input(pool)
+{
+}
+
+bool ColumnChunkReader::decode(ULONG length, ULONG count)
+{
+	if (!m_supported || !count || count > COLUMN_CHUNK_RECORDS || length > m_input.getCount())
+		return false;
+
+	m_count = count;
+	memset(m_records.getBuffer(count * m_recordLength, false), 0, count * m_recordLength);
+
+	Input input(m_input.begin(), length);
+
+	FB_UINT64 columns;
+	if (!input.getVarint(columns) || columns != m_columns.getCount())
+		return false;
+
+	for (const auto& column : m_columns)
+	{
+		UCHAR dtype;
+		FB_UINT64 columnLength;
+
+		if (!input.getByte(dtype) || dtype != column.dtype ||
+			!input.getVarint(columnLength) || columnLength != column.length)
+		{
+			return false;
+		}
+
+		if (!getInts(input, column.nullOffset, 1, true))
+			return false;
+
+		Component parts[MAX_COMPONENTS];
+		const unsigned count = getComponents(column.dtype, parts);
+
+		for (unsigned n = 0; n < count; n++)
+		{
+			const Component& part = parts[n];
+
+			if (part.kind == CMP_INT ?
+				!getInts(input, column.offset + part.offset, part.width, false) :
+				!getStrings(input, column, part.kind == CMP_VARYING))
+			{
+				return false;
+			}
+		}
+	}
+
+	return input.isEof();
+}
+
+bool ColumnChunkReader::getInts(Input& input, RCRD_OFFSET offset, UCHAR width, bool nullFlags)
+{
+	UCHAR encoding;
+	FB_UINT64 length;
+
+	if (!input.getByte(encoding) || !input.getVarint(length))
+		return false;
+
+	const UCHAR* const data = input.getBytes(length);
+	if (!data)
+		return false;
+
+	Input stream(data, length);
+
+	UCHAR* record = m_records.begin() + offset;
+	UCHAR* const end = record + m_count * m_recordLength;
+
+	const auto put = [&](SINT64 value)
+	{
+		if (nullFlags)
+			setInt(record, sizeof(SSHORT), value ? -1 : 0);
+		else
+			setInt(record, width, value);
+
+		record += m_recordLength;
+	};
+
+	switch (encoding)
+	{
+	case ENC_RAW:
+		while (record < end)
+		{
+			SINT64 value;
+			if (!stream.getFixed(value, width))
+				return false;
+
+			put(value);
+		}
+		break;
+
+	case ENC_RLE:
+		while (record < end)
+		{
+			FB_UINT64 run, value;
+			if (!stream.getVarint(run) || !stream.getVarint(value) ||
+				!run || run > FB_UINT64(end - record) / m_recordLength)
+			{
+				return false;
+			}
+
+			while (run--)
+				put(unzigzag(value));
+		}
+		break;
+
+	case ENC_DELTA:
+		for (SINT64 prev = 0; record < end; )
+		{
+			FB_UINT64 value;
+			if (!stream.getVarint(value))
+				return false;
+
+			prev = SINT64(FB_UINT64(prev) + FB_UINT64(unzigzag(value)));
+			put(prev);
+		}
+		break;
+
+	case ENC_DICT:
+	{
+		FB_UINT64 entries;
+		if (!stream.getVarint(entries) || !entries || entries > MAX_DICT_ENTRIES)
+			return false;
+
+		SINT64 dictionary[MAX_DICT_ENTRIES];
+		for (unsigned i = 0; i < entries; i++)
+		{
+			FB_UINT64 value;
+			if (!stream.getVarint(value))
+				return false;
+
+			dictionary[i] = unzigzag(value);
+		}
+
+		while (record < end)
+		{
+			UCHAR index;
+			if (!stream.getByte(index) || index >= entries)
+				return false;
+
+			put(dictionary[index]);
+		}
+		break;
+	}
+
+	default:
+		return false;
+	}
+
+	return stream.isEof();
+}
+
+bool ColumnChunkReader::getStrings(Input& input, const Column& column, bool varying)
+{
+	UCHAR encoding;
+	FB_UINT64 length;
+
+	if (!input.getByte(encoding) || !input.getVarint(length))
+		return false;
+
+	const UCHAR* const data = input.getBytes(length);
+	if (!data)
+		return false;
+
+	Input stream(data, length);
+
+	UCHAR* record = m_records.begin() + column.offset;
+	UCHAR* const end = record + m_count * m_recordLength;
+
+	const auto get = [&](const UCHAR*& value, ULONG& valueLength)
+	{
+		FB_UINT64 len = column.length;
+		if (varying && (!stream.getVarint(len) || len > column.length))
+			return false;
+
+		valueLength = ULONG(len);
+		value = stream.getBytes(len);
+		return value != nullptr;
+	};
+
+	const auto put = [&](const UCHAR* value, ULONG valueLength)
+	{
+		if (varying)
+		{
+			setInt(record, sizeof(USHORT), valueLength);
+			memcpy(record + sizeof(USHORT), value, valueLength);
+		}
+		else
+			memcpy(record, value, valueLength);
+
+		record += m_recordLength;
+	};
+
+	const UCHAR* value;
+	ULONG valueLength;
+
+	switch (encoding)
+	{
+	case ENC_RAW:
+		while (record < end)
+		{
+			if (!get(value, valueLength))
+				return false;
+
+			put(value, valueLength);
+		}
+		break;
+
+	case ENC_RLE:
+		while (record < end)
+		{
+			FB_UINT64 run;
+			if (!stream.getVarint(run) || !run || run > FB_UINT64(end - record) / m_recordLength ||
+				!get(value, valueLength))
+			{
+				return false;
+			}
+
+			while (run--)
+				put(value, valueLength);
+		}
+		break;
+
+	case ENC_DICT:
+	{
+		FB_UINT64 entries;
+		if (!stream.getVarint(entries) || !entries || entries > MAX_DICT_ENTRIES)
+			return false;
+
+		const UCHAR* values[MAX_DICT_ENTRIES];
+		ULONG lengths[MAX_DICT_ENTRIES];
+
+		for (unsigned i = 0; i < entries; i++)
+		{
+			if (!get(values[i], lengths[i]))
+				return false;
+		}
+
+		while (record < end)
+		{
+			UCHAR index;
+			if (!stream.getByte(index) || index >= entries)
+				return false;
+
+			put(values[index], lengths[index]);
+		}
+		break;
+	}
+
+	default:
+		return false;
+	}
+
+	return stream.isEof();
+}
+
+} // namespace Burp
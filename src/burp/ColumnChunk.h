@@ -0,0 +1,150 @@
+/*
+ *	PROGRAM:	JRD Backup and Restore Program
+ *	MODULE:		ColumnChunk.h
+ *	DESCRIPTION:	Columnar layout of relation data
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef BURP_COLUMN_CHUNK_H
+#define BURP_COLUMN_CHUNK_H
+
+#include "../burp/burp.h"
+#include "../common/classes/array.h"
+
+// When gbak -COLUMNAR is used, data of relations without blobs and arrays is
+// written as column chunks instead of row records. The chunk contains a batch
+// of records read by one worker:
+//
+//	<rec_column_data> <att_column_records> <att_column_length> <att_column_data>
+//
+// Every stored field is a column made of the null flags and the value, split
+// into components: integers of 1, 2, 4 or 8 bytes (numbers, dates and times,
+// also the parts of compound values) or strings (CHAR and VARCHAR). Every
+// component is encoded as raw values, runs of equal values, deltas or
+// dictionary indexes, whichever is shorter. Integers are stored low byte
+// first, thus chunks are transportable and don't depend on the message
+// layouts used by backup and restore.
+
+namespace Burp {
+
+inline constexpr ULONG COLUMN_CHUNK_SIZE = 64 * 1024;	// raw records collected per chunk
+inline constexpr ULONG COLUMN_CHUNK_RECORDS = 4096;		// max records per chunk
+
+class ColumnChunk
+{
+public:
+	ULONG getCount() const noexcept
+	{
+		return m_count;
+	}
+
+protected:
+	struct Column
+	{
+		USHORT dtype;
+		USHORT length;			// length of CHAR and VARCHAR values
+		RCRD_OFFSET offset;		// value offset in the message
+		RCRD_OFFSET nullOffset;	// null flag offset in the message
+	};
+
+	ColumnChunk(MemoryPool& pool, const burp_rel* relation, bool sqlLayout, ULONG recordLength);
+
+	Firebird::HalfStaticArray<Column, 16> m_columns;
+	Firebird::Array<UCHAR> m_records;	// records in message format
+	const ULONG m_recordLength;
+	ULONG m_count;
+	bool m_supported;
+};
+
+// Collects records received by the backup and encodes them into the chunk
+
+class ColumnChunkWriter : public ColumnChunk
+{
+public:
+	ColumnChunkWriter(MemoryPool& pool, const burp_rel* relation, ULONG recordLength);
+
+	// relation has no blobs and arrays, and its records are not too long
+	bool isSupported() const noexcept
+	{
+		return m_supported;
+	}
+
+	bool isFull() const noexcept
+	{
+		return m_count >= COLUMN_CHUNK_RECORDS || (m_count + 1) * m_recordLength > COLUMN_CHUNK_SIZE;
+	}
+
+	void add(const UCHAR* record);
+
+	// Encode collected records, the next record starts the new chunk
+	const Firebird::Array<UCHAR>& encode();
+
+private:
+	struct String
+	{
+		const UCHAR* data;
+		ULONG length;
+	};
+
+	void putInts(UCHAR width);
+	void putStrings(bool varying);
+	ULONG intDictionary();
+	ULONG stringDictionary(bool varying);
+
+	Firebird::Array<UCHAR> m_data;		// encoded chunk
+	Firebird::Array<SINT64> m_ints;		// values of the integer component
+	Firebird::Array<String> m_strings;	// values of the string component
+	Firebird::Array<SINT64> m_dictInts;
+	Firebird::Array<String> m_dictStrings;
+	Firebird::Array<UCHAR> m_indexes;	// dictionary index of every value
+	Firebird::Array<UCHAR> m_zeros;		// value of the nulls
+};
+
+// Decodes the chunk into records of the restore message
+
+class ColumnChunkReader : public ColumnChunk
+{
+public:
+	ColumnChunkReader(MemoryPool& pool, const burp_rel* relation, bool sqlLayout, ULONG recordLength);
+
+	// buffer to read the chunk into
+	UCHAR* getInput(ULONG length)
+	{
+		return m_input.getBuffer(length, false);
+	}
+
+	// false if the chunk is corrupted or doesn't match relation
+	bool decode(ULONG length, ULONG count);
+
+	const UCHAR* getRecord(ULONG n) const noexcept
+	{
+		fb_assert(n < m_count);
+		return m_records.begin() + n * m_recordLength;
+	}
+
+private:
+	class Input;
+
+	bool getInts(Input& input, RCRD_OFFSET offset, UCHAR width, bool nullFlags);
+	bool getStrings(Input& input, const Column& column, bool varying);
+
+	Firebird::Array<UCHAR> m_input;
+};
+
+} // namespace Burp
+
+#endif // BURP_COLUMN_CHUNK_H
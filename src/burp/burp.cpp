@@ -866,6 +866,11 @@ int gbak(Firebird::UtilSvc* uSvc)
 				BURP_error(334, true, SafeArg() << in_sw_tab->in_sw_name);
 			tdgbl->gbl_sw_zip = true;
 			break;
+		case IN_SW_BURP_COLUMNAR:
+			if (tdgbl->gbl_sw_columnar)
+				BURP_error(334, true, SafeArg() << in_sw_tab->in_sw_name);
+			tdgbl->gbl_sw_columnar = true;
+			break;
 		case IN_SW_BURP_FA:
 			if (tdgbl->gbl_sw_blk_factor)
 				BURP_error(333, true, SafeArg() << in_sw_tab->in_sw_name << tdgbl->gbl_sw_blk_factor);
@@ -1401,6 +1406,8 @@ int gbak(Firebird::UtilSvc* uSvc)
 			errNum = IN_SW_BURP_OL;
 		else if (tdgbl->gbl_sw_zip)
 			errNum = IN_SW_BURP_ZIP;
+		else if (tdgbl->gbl_sw_columnar)
+			errNum = IN_SW_BURP_COLUMNAR;
 
 		if (errNum != IN_SW_BURP_0)
 		{
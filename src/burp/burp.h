@@ -125,7 +125,8 @@ enum rec_type {
 	rec_publication,		// Publication
 	rec_pub_table,			// Publication table
 	rec_schema,				// Schema
-	rec_constants			// Constants
+	rec_constants,			// Constants
+	rec_column_data			// Data for relation in columnar layout
 };
 
 
@@ -148,6 +149,9 @@ where each relation data is:
 where data is:
 	<rec_data> <rec length> [<xdr_length>]  <data attr>  [ <blob>, <array>...]
 
+or, for relations without blobs and arrays backed up with -COLUMNAR, is:
+	<rec_column_data> <records count> <chunk length> <chunk attr>
+
 and <blob> is
 
 	<rec_blob> <blob_field_number> <max_sigment> <blob_type> <number_segments> <blob_data>
@@ -224,6 +228,8 @@ Version 12: FB6.0.
 			RDB$INDEX_SEGMENTS.RDB$PACKAGE_NAME.
 
 			Custom aggregate function.
+
+			Column chunks of relation data (rec_column_data).
 */
 
 inline constexpr int ATT_BACKUP_FORMAT = 12;
@@ -425,6 +431,12 @@ enum att_type {
 	att_class_description2,
 	att_view_relation_schema_name,
 
+	// Column chunk attributes, see ColumnChunk.h
+
+	att_column_records,		// number of records in the chunk
+	att_column_length,		// length of the encoded chunk
+	att_column_data,
+
 	// Trigger attributes
 
 	att_trig_type = SERIES,
@@ -1088,6 +1100,7 @@ public:
 	bool		gbl_sw_overwrite;
 	bool		gbl_sw_direct_io;
 	bool		gbl_sw_zip;
+	bool		gbl_sw_columnar;
 	const SCHAR*	gbl_sw_keyholder;
 	const SCHAR*	gbl_sw_crypt;
 	const SCHAR*	gbl_sw_keyname;
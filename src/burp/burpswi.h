@@ -105,6 +105,8 @@ inline constexpr int IN_SW_BURP_DIRECT_IO			= 55;	// direct IO for backup files
 inline constexpr int IN_SW_BURP_SKIP_SCHEMA_DATA	= 56;	// skip data from schema
 inline constexpr int IN_SW_BURP_INCLUDE_SCHEMA_DATA	= 57;	// backup data from schemas
 
+inline constexpr int IN_SW_BURP_COLUMNAR			= 58;	// columnar layout of table data
+
 /**************************************************************************/
 
 static inline constexpr const char* BURP_SW_MODE_NONE = "NONE";
@@ -123,6 +125,8 @@ static inline constexpr Switches::in_sw_tab_t reference_burp_in_sw_table[] =
 				// msg 257: @1BU(FFERS) override default page buffers
 	{IN_SW_BURP_C,	  isc_spb_res_create,		"CREATE_DATABASE",	0, 0, 0, false, true,	73, 	1, NULL, boMain},
 				// msg 73: @1CREATE_DATABASE create database from backup file
+	{IN_SW_BURP_COLUMNAR, isc_spb_bkp_columnar,	"COLUMNAR",			0, 0, 0, false, true,	427,	3, NULL, boBackup},
+				// msg 427: @1COL(UMNAR) store table data in compressed column chunks
 	{IN_SW_BURP_CO,   isc_spb_bkp_convert,		"CONVERT",			0, 0, 0, false, true,	254,	2, NULL, boBackup},
 				// msg 254: @1CO(NVERT)  backup external files as tables
 	{IN_SW_BURP_CRYPT,	isc_spb_bkp_crypt,		"CRYPT", 			0, 0, 0, false, false,	373,	3, NULL, boGeneral},
@@ -0,0 +1,448 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../burp/ColumnChunk.h"
+#include "../jrd/align.h"
+#include <string.h>
+#include <vector>
+
+using namespace Firebird;
+using namespace Burp;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(ColumnChunkSuite)
+
+
+namespace
+{
+	constexpr SSHORT STRING_LENGTH = 10;
+
+	// Every supported BLR type
+	constexpr SSHORT allTypes[] =
+	{
+		blr_text, blr_varying, blr_bool, blr_short, blr_long, blr_quad, blr_float,
+		blr_sql_date, blr_sql_time, blr_int64, blr_dec64, blr_dec128, blr_int128,
+		blr_double, blr_sql_time_tz, blr_timestamp_tz, blr_ex_time_tz,
+		blr_ex_timestamp_tz, blr_timestamp
+	};
+
+	// How the values of a column change from record to record
+	enum class Pattern
+	{
+		CONSTANT,		// the same value, also used for all nulls
+		RUNS,			// runs of 1 to 7 equal values
+		ASCENDING,		// small steps, fits deltas
+		FEW_DISTINCT,	// fits dictionary
+		RANDOM			// raw values
+	};
+
+	// Null every few records, the nulls may start or break runs of equal values
+	enum class Nulls
+	{
+		NONE,
+		SOME,
+		ALL
+	};
+
+	// Deterministic pseudo random numbers
+	class Random
+	{
+	public:
+		explicit Random(FB_UINT64 seed)
+			: m_state(seed * 0x9E3779B97F4A7C15ULL + 1)
+		{}
+
+		FB_UINT64 next()
+		{
+			m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+			return m_state ^ (m_state >> 29);
+		}
+
+	private:
+		FB_UINT64 m_state;
+	};
+
+	// Relation with its fields and the message layouts used by backup (fld_offset)
+	// and restore (fld_sql), the layouts are intentionally different
+
+	class TestRelation
+	{
+	public:
+		TestRelation(const SSHORT* types, unsigned count)
+			: m_fields(count), m_recordLength(0)
+		{
+			for (unsigned i = 0; i < count; i++)
+			{
+				burp_fld& field = m_fields[i];
+				field.fld_type = types[i];
+				field.fld_length = STRING_LENGTH;
+				field.fld_next = (i + 1 < count) ? &m_fields[i + 1] : nullptr;
+
+				// value followed by null flag, not aligned
+				field.fld_offset = m_recordLength;
+				m_recordLength += getValueLength(field);
+				field.fld_missing_offset = m_recordLength;
+				m_recordLength += sizeof(SSHORT);
+			}
+
+			// reverse order, null flag first
+			RCRD_OFFSET offset = 0;
+			for (unsigned i = count; i--;)
+			{
+				burp_fld& field = m_fields[i];
+				field.fld_null = offset;
+				field.fld_sql = offset + sizeof(SSHORT);
+				offset += sizeof(SSHORT) + getValueLength(field);
+			}
+
+			m_relation.rel_fields = count ? &m_fields[0] : nullptr;
+		}
+
+		const burp_rel* getRelation() const
+		{
+			return &m_relation;
+		}
+
+		ULONG getRecordLength() const
+		{
+			return m_recordLength;
+		}
+
+		const std::vector<burp_fld>& getFields() const
+		{
+			return m_fields;
+		}
+
+		// Fill the value of the field in the backup layout, null value is zeroed
+		void setValue(UCHAR* record, unsigned n, bool null, FB_UINT64 value) const
+		{
+			const burp_fld& field = m_fields[n];
+			UCHAR* const ptr = record + field.fld_offset;
+
+			const SSHORT nullFlag = null ? -1 : 0;
+			memcpy(record + field.fld_missing_offset, &nullFlag, sizeof(nullFlag));
+
+			if (null)
+				return;
+
+			switch (field.fld_type)
+			{
+			case blr_text:
+				for (SSHORT i = 0; i < STRING_LENGTH; i++)
+					ptr[i] = 'A' + (value >> (i * 2)) % 26;
+				break;
+
+			case blr_varying:
+			{
+				const USHORT length = value % (STRING_LENGTH + 1);
+				memcpy(ptr, &length, sizeof(length));
+
+				for (USHORT i = 0; i < length; i++)
+					ptr[sizeof(USHORT) + i] = 'a' + (value >> (i * 2)) % 26;
+				break;
+			}
+
+			default:
+			{
+				// fill the whole value with the bytes of the number
+				const USHORT length = getValueLength(field);
+				for (USHORT i = 0; i < length; i++)
+					ptr[i] = UCHAR(value >> ((i % 8) * 8)) ^ UCHAR(i / 8);
+			}
+			}
+		}
+
+		// Compare the value of the field in the backup and restore layouts
+		bool sameValue(const UCHAR* written, const UCHAR* read, unsigned n) const
+		{
+			const burp_fld& field = m_fields[n];
+
+			SSHORT writtenNull, readNull;
+			memcpy(&writtenNull, written + field.fld_missing_offset, sizeof(SSHORT));
+			memcpy(&readNull, read + field.fld_null, sizeof(SSHORT));
+
+			if ((writtenNull != 0) != (readNull != 0))
+				return false;
+
+			const UCHAR* const writtenValue = written + field.fld_offset;
+			const UCHAR* const readValue = read + field.fld_sql;
+
+			// null value is restored as zeroes
+			ULONG length = getDataLength(field);
+
+			if (field.fld_type == blr_varying && !writtenNull)
+			{
+				USHORT varLength;
+				memcpy(&varLength, writtenValue, sizeof(USHORT));
+				length = sizeof(USHORT) + varLength;
+			}
+
+			for (ULONG i = 0; i < length; i++)
+			{
+				if (readValue[i] != (writtenNull ? 0 : writtenValue[i]))
+					return false;
+			}
+
+			return true;
+		}
+
+	private:
+		static USHORT getValueLength(const burp_fld& field)
+		{
+			switch (field.fld_type)
+			{
+			case blr_text:
+				return field.fld_length;
+
+			case blr_varying:
+				return sizeof(USHORT) + field.fld_length;
+			}
+
+			return type_lengths[gds_cvt_blr_dtype[field.fld_type]];
+		}
+
+		// Padding at the end of the value is not stored
+		static USHORT getDataLength(const burp_fld& field)
+		{
+			switch (field.fld_type)
+			{
+			case blr_sql_time_tz:
+				return sizeof(ISC_TIME) + sizeof(ISC_USHORT);
+
+			case blr_timestamp_tz:
+				return sizeof(ISC_TIMESTAMP) + sizeof(ISC_USHORT);
+			}
+
+			return getValueLength(field);
+		}
+
+		std::vector<burp_fld> m_fields;
+		burp_rel m_relation{};
+		ULONG m_recordLength;
+	};
+
+	FB_UINT64 generate(Pattern pattern, Random& random, ULONG n, FB_UINT64& current, ULONG& runLeft)
+	{
+		switch (pattern)
+		{
+		case Pattern::CONSTANT:
+			return 12345;
+
+		case Pattern::RUNS:
+			if (!runLeft)
+			{
+				current = random.next();
+				runLeft = 1 + random.next() % 7;
+			}
+			runLeft--;
+			return current;
+
+		case Pattern::ASCENDING:
+			return 1000000 + n * 3 + random.next() % 3;
+
+		case Pattern::FEW_DISTINCT:
+			return (random.next() % 5) * 0x0101010101010101ULL;
+
+		case Pattern::RANDOM:
+			break;
+		}
+
+		return random.next();
+	}
+
+	bool isNull(Nulls nulls, Random& random, ULONG n)
+	{
+		switch (nulls)
+		{
+		case Nulls::NONE:
+			return false;
+
+		case Nulls::SOME:
+			return n % 7 == 0 || random.next() % 5 == 0;
+
+		case Nulls::ALL:
+			break;
+		}
+
+		return true;
+	}
+
+	// Fill the writer with records, encode them, decode the chunk and compare
+
+	void roundTrip(const TestRelation& test, Pattern pattern, Nulls nulls)
+	{
+		auto& pool = *getDefaultMemoryPool();
+		const ULONG recordLength = test.getRecordLength();
+		const unsigned fieldCount = test.getFields().size();
+
+		ColumnChunkWriter writer(pool, test.getRelation(), recordLength);
+		BOOST_REQUIRE(writer.isSupported());
+
+		std::vector<UCHAR> records;
+		Random random(unsigned(pattern) * 10 + unsigned(nulls));
+		std::vector<FB_UINT64> current(fieldCount);
+		std::vector<ULONG> runLeft(fieldCount);
+
+		for (ULONG n = 0; !writer.isFull(); n++)
+		{
+			std::vector<UCHAR> record(recordLength);
+
+			for (unsigned i = 0; i < fieldCount; i++)
+			{
+				const FB_UINT64 value = generate(pattern, random, n, current[i], runLeft[i]);
+				test.setValue(record.data(), i, isNull(nulls, random, n + i), value);
+			}
+
+			writer.add(record.data());
+			records.insert(records.end(), record.begin(), record.end());
+		}
+
+		const ULONG written = writer.getCount();
+		BOOST_REQUIRE(written > 0);
+
+		const Array<UCHAR>& data = writer.encode();
+		BOOST_TEST(writer.getCount() == 0u);
+
+		ColumnChunkReader reader(pool, test.getRelation(), true, recordLength);
+		memcpy(reader.getInput(data.getCount()), data.begin(), data.getCount());
+		BOOST_REQUIRE(reader.decode(data.getCount(), written));
+		BOOST_REQUIRE(reader.getCount() == written);
+
+		// report the first mismatch only
+		for (ULONG n = 0; n < written; n++)
+		{
+			for (unsigned i = 0; i < fieldCount; i++)
+			{
+				if (!test.sameValue(&records[n * recordLength], reader.getRecord(n), i))
+				{
+					BOOST_ERROR("mismatch in record " << n << ", field " << i <<
+						", type " << test.getFields()[i].fld_type);
+					return;
+				}
+			}
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(ColumnChunkTests)
+
+BOOST_AUTO_TEST_CASE(AllTypesTest)
+{
+	const TestRelation test(allTypes, FB_NELEM(allTypes));
+
+	for (const auto pattern : {Pattern::CONSTANT, Pattern::RUNS, Pattern::ASCENDING,
+		Pattern::FEW_DISTINCT, Pattern::RANDOM})
+	{
+		for (const auto nulls : {Nulls::NONE, Nulls::SOME, Nulls::ALL})
+		{
+			BOOST_TEST_CONTEXT("pattern " << unsigned(pattern) << ", nulls " << unsigned(nulls))
+			{
+				roundTrip(test, pattern, nulls);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(SingleTypeTest)
+{
+	// Narrow records fill the chunk up to COLUMN_CHUNK_RECORDS, the runs and
+	// dictionary indexes go over the single byte varint boundary
+
+	for (const auto type : allTypes)
+	{
+		const TestRelation test(&type, 1);
+
+		for (const auto pattern : {Pattern::CONSTANT, Pattern::RUNS, Pattern::ASCENDING,
+			Pattern::FEW_DISTINCT, Pattern::RANDOM})
+		{
+			BOOST_TEST_CONTEXT("type " << type << ", pattern " << unsigned(pattern))
+			{
+				roundTrip(test, pattern, Nulls::SOME);
+				roundTrip(test, pattern, Nulls::NONE);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(RunBoundariesTest)
+{
+	// The run is broken exactly after the first and before the last record of the full chunk
+
+	const SSHORT type = blr_long;
+	const TestRelation test(&type, 1);
+	const ULONG recordLength = test.getRecordLength();
+	auto& pool = *getDefaultMemoryPool();
+
+	ColumnChunkWriter writer(pool, test.getRelation(), recordLength);
+	BOOST_REQUIRE(writer.isSupported());
+
+	const ULONG count = COLUMN_CHUNK_RECORDS;
+	std::vector<UCHAR> records(count * recordLength);
+
+	for (ULONG n = 0; n < count; n++)
+	{
+		UCHAR* const record = &records[n * recordLength];
+		test.setValue(record, 0, n == count - 1, (n == 0) ? 1 : 2);
+
+		BOOST_REQUIRE(!writer.isFull());
+		writer.add(record);
+	}
+
+	BOOST_TEST(writer.isFull());
+
+	const Array<UCHAR>& data = writer.encode();
+
+	ColumnChunkReader reader(pool, test.getRelation(), true, recordLength);
+	memcpy(reader.getInput(data.getCount()), data.begin(), data.getCount());
+	BOOST_REQUIRE(reader.decode(data.getCount(), count));
+
+	for (ULONG n = 0; n < count; n++)
+		BOOST_TEST(test.sameValue(&records[n * recordLength], reader.getRecord(n), 0));
+}
+
+BOOST_AUTO_TEST_CASE(CorruptedChunkTest)
+{
+	const TestRelation test(allTypes, FB_NELEM(allTypes));
+	auto& pool = *getDefaultMemoryPool();
+
+	ColumnChunkWriter writer(pool, test.getRelation(), test.getRecordLength());
+
+	std::vector<UCHAR> record(test.getRecordLength());
+	Random random(1);
+
+	for (ULONG n = 0; n < 50; n++)
+	{
+		for (unsigned i = 0; i < test.getFields().size(); i++)
+			test.setValue(record.data(), i, isNull(Nulls::SOME, random, n + i), random.next());
+
+		writer.add(record.data());
+	}
+
+	const Array<UCHAR> data(writer.encode());
+
+	ColumnChunkReader reader(pool, test.getRelation(), true, test.getRecordLength());
+
+	// truncated chunk
+	for (ULONG length = 0; length < data.getCount(); length += 7)
+	{
+		memcpy(reader.getInput(data.getCount()), data.begin(), data.getCount());
+		BOOST_TEST(!reader.decode(length, 50));
+	}
+
+	// wrong number of records
+	memcpy(reader.getInput(data.getCount()), data.begin(), data.getCount());
+	BOOST_TEST(!reader.decode(data.getCount(), 49));
+
+	// different relation
+	const SSHORT type = blr_long;
+	const TestRelation other(&type, 1);
+	ColumnChunkReader otherReader(pool, other.getRelation(), true, other.getRecordLength());
+	memcpy(otherReader.getInput(data.getCount()), data.begin(), data.getCount());
+	BOOST_TEST(!otherReader.decode(data.getCount(), 50));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// ColumnChunkTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// ColumnChunkSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
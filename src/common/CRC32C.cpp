@@ -33,9 +33,9 @@
 
 #include <nmmintrin.h>
 
-unsigned int CRC32C(unsigned int length, const unsigned char* value) noexcept
+unsigned int CRC32C_update(unsigned int crc, unsigned int length, const unsigned char* value) noexcept
 {
-	unsigned int hash_value = 0;
+	unsigned int hash_value = crc;
 
 	if (length == 1)
 		return _mm_crc32_u8(hash_value, *value);
@@ -65,4 +65,9 @@ unsigned int CRC32C(unsigned int length, const unsigned char* value) noexcept
 	return hash_value;
 }
 
+unsigned int CRC32C(unsigned int length, const unsigned char* value) noexcept
+{
+	return CRC32C_update(0, length, value);
+}
+
 #endif // architecture check
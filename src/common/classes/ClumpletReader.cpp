@@ -448,6 +448,7 @@ ClumpletReader::ClumpletType ClumpletReader::getClumpletType(UCHAR tag) const
 			case isc_spb_options:
 			case isc_spb_nbk_keep_days:
 			case isc_spb_nbk_keep_rows:
+			case isc_spb_nbk_parallel_workers:
 				return IntSpb;
 			case isc_spb_nbk_clean_history:
 				return SingleTpb;
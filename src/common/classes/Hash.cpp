@@ -35,10 +35,41 @@
 using namespace Firebird;
 
 unsigned int CRC32C(unsigned int length, const unsigned char* value) noexcept;
+unsigned int CRC32C_update(unsigned int crc, unsigned int length, const unsigned char* value) noexcept;
 
 namespace
 {
 	typedef unsigned int (*hash_func_t)(unsigned int length, const UCHAR* value);
+	typedef unsigned int (*crc_func_t)(unsigned int crc, unsigned int length, const UCHAR* value);
+
+	class Crc32CTable
+	{
+	public:
+		Crc32CTable()
+		{
+			// Reflected Castagnoli polynomial, the same as used by SSE 4.2 crc32 instruction
+			for (unsigned int i = 0; i < 256; i++)
+			{
+				unsigned int crc = i;
+				for (int bit = 0; bit < 8; bit++)
+					crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78 : 0);
+
+				table[i] = crc;
+			}
+		}
+
+		unsigned int table[256];
+	};
+
+	const Crc32CTable crc32cTable;
+
+	unsigned int basicCrc32C(unsigned int crc, unsigned int length, const UCHAR* value) noexcept
+	{
+		for (const UCHAR* const end = value + length; value < end; ++value)
+			crc = crc32cTable.table[(crc ^ *value) & 0xFF] ^ (crc >> 8);
+
+		return crc;
+	}
 
 	unsigned int basicHash(unsigned int length, const UCHAR* value) noexcept
 	{
@@ -96,10 +127,12 @@ namespace
 	}
 
 	hash_func_t internalHash = SSE4_2Supported() ? CRC32C : basicHash;
+	crc_func_t crc32c = SSE4_2Supported() ? CRC32C_update : basicCrc32C;
 
 #else	// architecture check
 
 	hash_func_t internalHash = basicHash;
+	crc_func_t crc32c = basicCrc32C;
 
 #endif	// architecture check
 
@@ -110,6 +143,16 @@ unsigned int InternalHash::hash(unsigned int length, const UCHAR* value) noexcep
 	return internalHash(length, value);
 }
 
+unsigned int Crc32C::update(unsigned int crc, unsigned int length, const UCHAR* value) noexcept
+{
+	return crc32c(crc, length, value);
+}
+
+unsigned int Crc32C::updatePortable(unsigned int crc, unsigned int length, const UCHAR* value) noexcept
+{
+	return basicCrc32C(crc, length, value);
+}
+
 
 void WeakHashContext::update(const void* data, FB_SIZE_T length)
 {
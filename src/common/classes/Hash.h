@@ -330,6 +330,18 @@ namespace Firebird
 		}
 	};
 
+	// CRC-32C (Castagnoli) without pre- and post-conditioning. It's calculated using
+	// SSE 4.2 instruction when available, the result doesn't depend on that, thus
+	// it may be stored persistently. Pass the previous result to continue.
+	class Crc32C
+	{
+	public:
+		static unsigned int update(unsigned int crc, unsigned int length, const UCHAR* value) noexcept;
+
+		// Table-driven implementation available on any CPU
+		static unsigned int updatePortable(unsigned int crc, unsigned int length, const UCHAR* value) noexcept;
+	};
+
 	class HashContext
 	{
 	public:
@@ -44,6 +44,10 @@
 #include <unistd.h>
 #endif
 
+#if !defined(WIN_NT) && defined(HAVE_MMAP)
+#include <sys/mman.h>
+#endif
+
 #include "../common/gdsassert.h"
 #include "../common/os/os_utils.h"
 #include "../common/os/path_utils.h"
@@ -326,6 +330,39 @@ void TempFile::extend(offset_t delta)
 	}
 }
 
+//
+// TempFile::map
+//
+// Maps the given part of the file into memory. The range must be already
+// allocated in the file and the offset must be aligned at the allocation
+// granularity of the platform. NULL is returned if mapping is not possible.
+//
+
+void* TempFile::map(offset_t offset, FB_SIZE_T length) noexcept
+{
+	fb_assert(offset + length <= size);
+
+#if !defined(WIN_NT) && defined(HAVE_MMAP)
+	void* const address = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, handle, (off_t) offset);
+	return (address == MAP_FAILED) ? NULL : address;
+#else
+	return NULL;
+#endif
+}
+
+//
+// TempFile::unmap
+//
+// Releases memory mapping created by map()
+//
+
+void TempFile::unmap(void* address, FB_SIZE_T length) noexcept
+{
+#if !defined(WIN_NT) && defined(HAVE_MMAP)
+	munmap(address, length);
+#endif
+}
+
 //
 // TempFile::read
 //
@@ -60,6 +60,10 @@ public:
 
 	void extend(offset_t);
 
+	// Map part of the file into memory, return NULL if not possible
+	void* map(offset_t offset, FB_SIZE_T length) noexcept;
+	static void unmap(void* address, FB_SIZE_T length) noexcept;
+
 	const PathName& getName() const noexcept
 	{
 		return filename;
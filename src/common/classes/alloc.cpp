@@ -1625,6 +1625,7 @@ private:
 	MemPool* parent;	// Parent pool if present
 	ExtentsCache* extentsCache;
 	AtomicCounter used_memory, mapped_memory;	// Memory used
+	AtomicCounter external_mapped;				// Memory mapped by the pool owner
 
 private:
 
@@ -1723,6 +1724,9 @@ public:
 	// previously set group and added to new
 	void setStatsGroup(MemoryStats& stats) noexcept;
 
+	void chargeMapping(size_t size) noexcept;
+	void releaseMapping(size_t size) noexcept;
+
 	// Initialize and finalize global memory pool
 	static MemPool* initDefaultPool()
 	{
@@ -2018,6 +2022,9 @@ MemPool::~MemPool(void)
 	decrement_usage(used_memory.value());
 	decrement_mapping(mapped_memory.value());
 
+	fb_assert(!external_mapped.value());
+	stats->decrement_mapping(external_mapped.value());
+
 #ifdef USE_VALGRIND
 	VALGRIND_DESTROY_MEMPOOL(this);
 
@@ -2147,7 +2154,7 @@ void MemPool::setStatsGroup(MemoryStats& newStats) noexcept
 	MutexLockGuard guard(mutex, "MemPool::setStatsGroup");
 
 	const size_t sav_used_memory = used_memory.value();
-	const size_t sav_mapped_memory = mapped_memory.value();
+	const size_t sav_mapped_memory = mapped_memory.value() + external_mapped.value();
 
 	stats->decrement_mapping(sav_mapped_memory);
 	stats->decrement_usage(sav_used_memory);
@@ -2158,6 +2165,23 @@ void MemPool::setStatsGroup(MemoryStats& newStats) noexcept
 	stats->increment_usage(sav_used_memory);
 }
 
+void MemPool::chargeMapping(size_t size) noexcept
+{
+	MutexLockGuard guard(mutex, "MemPool::chargeMapping");
+
+	stats->increment_mapping(size);
+	external_mapped += size;
+}
+
+void MemPool::releaseMapping(size_t size) noexcept
+{
+	MutexLockGuard guard(mutex, "MemPool::releaseMapping");
+
+	fb_assert(static_cast<size_t>(external_mapped.value()) >= size);
+	stats->decrement_mapping(size);
+	external_mapped -= size;
+}
+
 MemoryStats& MemoryPool::getStatsGroup() noexcept
 {
 	return pool->getStatsGroup();
@@ -2168,6 +2192,16 @@ void MemoryPool::setStatsGroup(MemoryStats& newStats) noexcept
 	pool->setStatsGroup(newStats);
 }
 
+void MemoryPool::chargeMapping(size_t size) noexcept
+{
+	pool->chargeMapping(size);
+}
+
+void MemoryPool::releaseMapping(size_t size) noexcept
+{
+	pool->releaseMapping(size);
+}
+
 MemBlock* MemPool::allocateInternal2(size_t from, size_t& length, bool flagRedirect)
 {
 	MutexEnsureUnlock guard(mutex, "MemPool::allocateInternal2");
@@ -226,6 +226,11 @@ public:
 	// previously set group and added to new
 	void setStatsGroup(MemoryStats& stats) noexcept;
 
+	// Account memory mapped directly from OS by the pool owner (bypassing
+	// the pool itself) in the mapping counters of the statistics group
+	void chargeMapping(size_t size) noexcept;
+	void releaseMapping(size_t size) noexcept;
+
 	// Initialize and finalize global memory pool
 	static void initDefaultPool();
 	static void cleanupDefaultPool();
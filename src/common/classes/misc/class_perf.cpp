@@ -28,6 +28,7 @@
 
 #include "tree.h"
 #include "alloc.h"
+#include "sparse_bitmap.h"
 #include <stdio.h>
 #include <time.h>
 #include <set>
@@ -141,6 +142,59 @@ static void testTree()
 }
 
 
+const int BITMAP_ITEMS	= 10000000;
+
+static void testBitmap(const char* name, int density)
+{
+	// Every density-th value of the range is set, like record numbers of
+	// dense and sparse predicates used in the bitmap index scans
+	printf("Bitmaps of %d values, %s:\n", BITMAP_ITEMS, name);
+
+	SparseBitmap<FB_UINT64>* bitmap1 = FB_NEW SparseBitmap<FB_UINT64>(*getDefaultMemoryPool());
+	SparseBitmap<FB_UINT64>* bitmap2 = FB_NEW SparseBitmap<FB_UINT64>(*getDefaultMemoryPool());
+	SparseBitmap<FB_UINT64>* bitmap3 = FB_NEW SparseBitmap<FB_UINT64>(*getDefaultMemoryPool());
+	int n = 0;
+
+	start();
+	for (int i = 0; i < BITMAP_ITEMS; i++)
+	{
+		n = n * 45578 - 17651;
+		const FB_UINT64 value = (FB_UINT64) i * density;
+		bitmap1->set(value + (n & 1));
+		bitmap2->set(value + ((n >> 1) & 1));
+		bitmap3->set(value + ((n >> 2) & 1));
+	}
+	clock_t d = clock();
+	printf("Set took %d milliseconds, bitmap takes %d KB\n",
+		(int)(d-t)*1000/CLOCKS_PER_SEC, (int) (bitmap1->approxSize() / 1024));
+
+	start();
+	SparseBitmap<FB_UINT64>** result = SparseBitmap<FB_UINT64>::bit_and(&bitmap1, &bitmap2);
+	d = clock();
+	printf("AND took %d milliseconds\n", (int)(d-t)*1000/CLOCKS_PER_SEC);
+
+	start();
+	result = SparseBitmap<FB_UINT64>::bit_or(result, &bitmap3);
+	d = clock();
+	printf("OR took %d milliseconds\n", (int)(d-t)*1000/CLOCKS_PER_SEC);
+
+	start();
+	int count = 0;
+	if ((*result)->getFirst())
+	{
+		do {
+			count++;
+		} while ((*result)->getNext());
+	}
+	d = clock();
+	printf("Iteration over %d values took %d milliseconds\n", count, (int)(d-t)*1000/CLOCKS_PER_SEC);
+
+	delete bitmap1;
+	delete bitmap2;
+	delete bitmap3;
+}
+
+
 void report()
 {
 	clock_t d = clock();
@@ -319,6 +373,8 @@ static void testAllocatorMalloc()
 int main()
 {
 	testTree();
+	testBitmap("dense", 1);
+	testBitmap("sparse", 1000);
 	testAllocatorOverhead();
 	testAllocatorMemoryPool();
 	testAllocatorMalloc();
@@ -32,6 +32,8 @@
 
 #include "../common/classes/alloc.h"
 #include "../common/classes/tree.h"
+#include <bit>
+#include <string.h>
 
 namespace Firebird {
 
@@ -55,20 +57,32 @@ struct BitmapTypes_64
 
 #define BUNCH_ONE  ((BUNCH_T) 1)
 
+// Values are split into chunks of 64K values. Every chunk present in the
+// bitmap is stored in B+ tree as a container, which is either the sorted
+// array of 16-bit low parts of the values (while the chunk is sparse) or the
+// bitset of the whole chunk. Thus dense bitmaps don't make large trees of
+// tiny buckets and union/intersection of the dense chunks is done by plain
+// loops over machine words which are vectorized by the compiler.
+
 template <typename T, typename InternalTypes = BitmapTypes_64>
 class SparseBitmap : public AutoStorage
 {
 public:
 	// Default constructor, stack placement
 	SparseBitmap() :
-		singular(false), singular_value(0), tree(getPool()), defaultAccessor(this)
+		singular(false), singular_value(0), memory(0), tree(getPool()), defaultAccessor(this)
 	{ }
 
 	// Pooled constructor
 	explicit SparseBitmap(MemoryPool& p) :
-		AutoStorage(p), singular(false), singular_value(0), tree(getPool()), defaultAccessor(this)
+		AutoStorage(p), singular(false), singular_value(0), memory(0), tree(getPool()), defaultAccessor(this)
 	{ }
 
+	~SparseBitmap()
+	{
+		clear();
+	}
+
 	// Default accessor methods
 	bool locate(T key) { return defaultAccessor.locate(locEqual, key); }
 
@@ -97,11 +111,7 @@ public:
 			fb_assert(tree.isEmpty());
 
 			singular = false;
-
-			Bucket bucket;
-			bucket.start_value = singular_value & ~(T) (BUNCH_BITS - 1);
-			bucket.bits = BUNCH_ONE << (singular_value - bucket.start_value);
-			tree.add(bucket);
+			setBit(singular_value);
 		}
 		else
 		{
@@ -113,17 +123,7 @@ public:
 			}
 		}
 
-		const T val_aligned = value & ~(T) (BUNCH_BITS - 1);
-		const BUNCH_T bit_mask = BUNCH_ONE << (value - val_aligned);
-
-		Bucket bucket;
-		bucket.start_value = val_aligned;
-		bucket.bits = bit_mask;
-		if (tree.isPositioned(val_aligned) || !tree.add(bucket))
-		{
-			fb_assert(tree.isPositioned(val_aligned));
-			tree.current().bits |= bit_mask;
-		}
+		setBit(value);
 	}
 
 	bool clear(T value)
@@ -140,16 +140,17 @@ public:
 			return false;
 		}
 
-		const T val_aligned = value & ~(T)(BUNCH_BITS - 1);
-		if (tree.isPositioned(val_aligned) || tree.locate(val_aligned))
+		const T start = value & ~(T) (CHUNK_BITS - 1);
+		if (tree.isPositioned(start) || tree.locate(start))
 		{
-			const BUNCH_T bit_mask = BUNCH_ONE << (value - val_aligned);
-			Bucket *current_bucket = &tree.current();
-			if (current_bucket->bits & bit_mask)
+			Container* const container = tree.current().container;
+			if (removeValue(container, (ULONG) (value - start)))
 			{
-				current_bucket->bits &= ~bit_mask;
-				if (!current_bucket->bits)
+				if (!container->count)
+				{
+					freeContainer(container);
 					tree.fastRemove();
+				}
 				return true;
 			}
 		}
@@ -164,11 +165,11 @@ public:
 			return (value == singular_value);
 		}
 
-		const T val_aligned = value & ~(T) (BUNCH_BITS - 1);
-		if (tree.isPositioned(val_aligned) || tree.locate(val_aligned))
+		const T start = value & ~(T) (CHUNK_BITS - 1);
+		if (tree.isPositioned(start) || tree.locate(start))
 		{
-			const BUNCH_T bit_mask = BUNCH_ONE << (value - val_aligned);
-			return tree.current().bits & bit_mask;
+			ULONG pos;
+			return findValue(tree.current().container, (ULONG) (value - start), pos);
 		}
 		return false;
 	}
@@ -189,13 +190,22 @@ public:
 
 	size_t approxSize() const
 	{
-		return sizeof(*this) + tree.approxSize();
+		return sizeof(*this) + tree.approxSize() + memory;
 	}
 
 	// Make bitmap empty
 	void clear()
 	{
 		singular = false;
+
+		if (tree.getFirst())
+		{
+			do {
+				freeContainer(tree.current().container);
+			} while (tree.getNext());
+		}
+
+		fb_assert(!memory);
 		tree.clear();
 	}
 
@@ -211,15 +221,57 @@ protected:
 	// Internal types and constants
 	typedef typename InternalTypes::BUNCH_T BUNCH_T;
 	enum {
-		LOG2_BUNCH_BITS = InternalTypes::LOG2_BUNCH_BITS,
-		BUNCH_BITS = InternalTypes::BUNCH_BITS
+		BUNCH_BITS = InternalTypes::BUNCH_BITS,
+		CHUNK_BITS = 65536,							// values per container
+		WORD_COUNT = CHUNK_BITS / BUNCH_BITS,		// words of the bitset container
+		MAX_ARRAY = 4096,							// array container doesn't grow beyond the bitset size
+		MIN_ARRAY = 4
+	};
+
+	// Values of one chunk, followed by the array of the sorted low parts
+	// of the values or by the bitset
+	struct Container
+	{
+		ULONG count;		// number of values
+		ULONG capacity;		// size of the array, zero for the bitset
+
+		bool isArray() const
+		{
+			return capacity != 0;
+		}
+
+		USHORT* values()
+		{
+			return reinterpret_cast<USHORT*>(this + 1);
+		}
+
+		const USHORT* values() const
+		{
+			return reinterpret_cast<const USHORT*>(this + 1);
+		}
+
+		BUNCH_T* words()
+		{
+			return reinterpret_cast<BUNCH_T*>(this + 1);
+		}
+
+		const BUNCH_T* words() const
+		{
+			return reinterpret_cast<const BUNCH_T*>(this + 1);
+		}
+
+		size_t getSize() const
+		{
+			return sizeof(Container) +
+				(isArray() ? capacity * sizeof(USHORT) : WORD_COUNT * sizeof(BUNCH_T));
+		}
 	};
 
-	// Bucket with bits
+	// Chunk of values
 	struct Bucket
 	{
-		T start_value; // starting value, BUNCH_BITS-aligned
-		BUNCH_T bits;  // bits data
+		T start_value; // starting value, CHUNK_BITS-aligned
+		Container* container;
 		inline static const T& generate(const void* /*sender*/, const Bucket& i)
 		{
 			return i.start_value;
@@ -233,8 +285,382 @@ protected:
 	bool singular;
 	T singular_value;
 
+	size_t memory;		// allocated by containers
+
 	BitmapTree tree;
 
+	Container* allocArray(ULONG capacity)
+	{
+		Container* const container = static_cast<Container*>(
+			getPool().allocate(sizeof(Container) + capacity * sizeof(USHORT)));
+		container->count = 0;
+		container->capacity = capacity;
+		memory += container->getSize();
+		return container;
+	}
+
+	Container* allocBitset()
+	{
+		Container* const container = static_cast<Container*>(
+			getPool().allocate(sizeof(Container) + WORD_COUNT * sizeof(BUNCH_T)));
+		container->count = 0;
+		container->capacity = 0;
+		memset(container->words(), 0, WORD_COUNT * sizeof(BUNCH_T));
+		memory += container->getSize();
+		return container;
+	}
+
+	Container* copyContainer(const Container* from)
+	{
+		Container* const container = from->isArray() ? allocArray(from->count) : allocBitset();
+		container->count = from->count;
+
+		if (from->isArray())
+			memcpy(container->values(), from->values(), from->count * sizeof(USHORT));
+		else
+			memcpy(container->words(), from->words(), WORD_COUNT * sizeof(BUNCH_T));
+
+		return container;
+	}
+
+	void freeContainer(Container* container)
+	{
+		memory -= container->getSize();
+		getPool().deallocate(container);
+	}
+
+	// Add the new chunk to the tree, default accessor position is not defined after that
+	void addBucket(T start, Container* container)
+	{
+		Bucket bucket;
+		bucket.start_value = start;
+		bucket.container = container;
+
+		try
+		{
+			const bool added = tree.add(bucket);
+			fb_assert(added);
+		}
+		catch (const Exception&)
+		{
+			freeContainer(container);
+			throw;
+		}
+	}
+
+	void setBit(T value)
+	{
+		const T start = value & ~(T) (CHUNK_BITS - 1);
+
+		if (!tree.isPositioned(start) && !tree.locate(start))
+		{
+			addBucket(start, allocArray(MIN_ARRAY));
+			tree.locate(start);
+		}
+
+		Bucket& bucket = tree.current();
+		insertValue(bucket.container, (ULONG) (value - start));
+	}
+
+	// Position of the value: index of the array or the value itself.
+	// If the array doesn't contain the value, the position of the next one
+	static bool findValue(const Container* container, ULONG low, ULONG& pos)
+	{
+		if (!container->isArray())
+		{
+			pos = low;
+			return container->words()[low / BUNCH_BITS] & (BUNCH_ONE << (low % BUNCH_BITS));
+		}
+
+		const USHORT* const values = container->values();
+		ULONG lo = 0, hi = container->count;
+		while (lo < hi)
+		{
+			const ULONG mid = (lo + hi) / 2;
+			if (values[mid] < low)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		pos = lo;
+		return lo < container->count && values[lo] == low;
+	}
+
+	void insertValue(Container*& container, ULONG low)
+	{
+		if (!container->isArray())
+		{
+			BUNCH_T& word = container->words()[low / BUNCH_BITS];
+			const BUNCH_T mask = BUNCH_ONE << (low % BUNCH_BITS);
+			if (!(word & mask))
+			{
+				word |= mask;
+				container->count++;
+			}
+			return;
+		}
+
+		ULONG pos;
+		if (findValue(container, low, pos))
+			return;
+
+		if (container->count == container->capacity)
+		{
+			if (container->capacity >= MAX_ARRAY)
+			{
+				toBitset(container);
+				insertValue(container, low);
+				return;
+			}
+
+			Container* const grown = allocArray(MIN(container->capacity * 2, (ULONG) MAX_ARRAY));
+			grown->count = container->count;
+			memcpy(grown->values(), container->values(), container->count * sizeof(USHORT));
+			freeContainer(container);
+			container = grown;
+		}
+
+		USHORT* const values = container->values();
+		memmove(values + pos + 1, values + pos, (container->count - pos) * sizeof(USHORT));
+		values[pos] = (USHORT) low;
+		container->count++;
+	}
+
+	static bool removeValue(Container* container, ULONG low)
+	{
+		ULONG pos;
+		if (!findValue(container, low, pos))
+			return false;
+
+		if (container->isArray())
+		{
+			USHORT* const values = container->values();
+			memmove(values + pos, values + pos + 1, (container->count - pos - 1) * sizeof(USHORT));
+		}
+		else
+			container->words()[low / BUNCH_BITS] &= ~(BUNCH_ONE << (low % BUNCH_BITS));
+
+		container->count--;
+		return true;
+	}
+
+	void toBitset(Container*& container)
+	{
+		fb_assert(container->isArray());
+
+		Container* const bitset = allocBitset();
+		BUNCH_T* const words = bitset->words();
+		const USHORT* const values = container->values();
+
+		for (ULONG i = 0; i < container->count; i++)
+			words[values[i] / BUNCH_BITS] |= BUNCH_ONE << (values[i] % BUNCH_BITS);
+
+		bitset->count = container->count;
+		freeContainer(container);
+		container = bitset;
+	}
+
+	void toArray(Container*& container)
+	{
+		fb_assert(!container->isArray() && container->count <= MAX_ARRAY);
+
+		Container* const array = allocArray(MAX(container->count, (ULONG) MIN_ARRAY));
+		USHORT* values = array->values();
+		const BUNCH_T* const words = container->words();
+
+		for (ULONG n = 0; n < WORD_COUNT; n++)
+		{
+			for (BUNCH_T word = words[n]; word; word &= word - 1)
+				*values++ = (USHORT) (n * BUNCH_BITS + std::countr_zero(word));
+		}
+
+		array->count = container->count;
+		freeContainer(container);
+		container = array;
+	}
+
+	static ULONG countBits(const BUNCH_T* words)
+	{
+		ULONG count = 0;
+		for (ULONG n = 0; n < WORD_COUNT; n++)
+			count += std::popcount(words[n]);
+		return count;
+	}
+
+	// Find the first value at or after the given one in the bitset
+	static bool bitForward(const BUNCH_T* words, ULONG low, ULONG& found)
+	{
+		if (low >= CHUNK_BITS)
+			return false;
+
+		ULONG n = low / BUNCH_BITS;
+		BUNCH_T word = words[n] & (~(BUNCH_T) 0 << (low % BUNCH_BITS));
+		while (!word)
+		{
+			if (++n == WORD_COUNT)
+				return false;
+			word = words[n];
+		}
+
+		found = n * BUNCH_BITS + std::countr_zero(word);
+		return true;
+	}
+
+	// Find the last value at or before the given one in the bitset
+	static bool bitBackward(const BUNCH_T* words, ULONG low, ULONG& found)
+	{
+		ULONG n = low / BUNCH_BITS;
+		BUNCH_T word = words[n] & (~(BUNCH_T) 0 >> (BUNCH_BITS - 1 - low % BUNCH_BITS));
+		while (!word)
+		{
+			if (n-- == 0)
+				return false;
+			word = words[n];
+		}
+
+		found = n * BUNCH_BITS + BUNCH_BITS - 1 - std::countl_zero(word);
+		return true;
+	}
+
+	// Union of the chunks, the destination container could be replaced
+	void unite(Container*& dest, const Container* source)
+	{
+		if (!source->isArray())
+		{
+			if (dest->isArray())
+				toBitset(dest);
+
+			BUNCH_T* const words = dest->words();
+			const BUNCH_T* const sourceWords = source->words();
+			for (ULONG n = 0; n < WORD_COUNT; n++)
+				words[n] |= sourceWords[n];
+
+			dest->count = countBits(words);
+			return;
+		}
+
+		const USHORT* const sourceValues = source->values();
+
+		if (!dest->isArray())
+		{
+			BUNCH_T* const words = dest->words();
+			for (ULONG i = 0; i < source->count; i++)
+				words[sourceValues[i] / BUNCH_BITS] |= BUNCH_ONE << (sourceValues[i] % BUNCH_BITS);
+
+			dest->count = countBits(words);
+			return;
+		}
+
+		// Merge the arrays
+		const ULONG total = dest->count + source->count;
+		Container* const merged = allocArray(total);
+		const USHORT* const values = dest->values();
+		USHORT* const result = merged->values();
+		ULONG i = 0, j = 0, k = 0;
+
+		while (i < dest->count && j < source->count)
+		{
+			if (values[i] < sourceValues[j])
+				result[k++] = values[i++];
+			else if (values[i] > sourceValues[j])
+				result[k++] = sourceValues[j++];
+			else
+			{
+				result[k++] = values[i++];
+				j++;
+			}
+		}
+
+		while (i < dest->count)
+			result[k++] = values[i++];
+
+		while (j < source->count)
+			result[k++] = sourceValues[j++];
+
+		merged->count = k;
+		freeContainer(dest);
+		dest = merged;
+
+		if (k > MAX_ARRAY)
+			toBitset(dest);
+	}
+
+	// Intersection of the chunks, the destination container could be replaced
+	void intersect(Container*& dest, const Container* source)
+	{
+		if (!dest->isArray() && !source->isArray())
+		{
+			BUNCH_T* const words = dest->words();
+			const BUNCH_T* const sourceWords = source->words();
+			for (ULONG n = 0; n < WORD_COUNT; n++)
+				words[n] &= sourceWords[n];
+
+			dest->count = countBits(words);
+
+			if (dest->count && dest->count <= MAX_ARRAY)
+				toArray(dest);
+
+			return;
+		}
+
+		if (!dest->isArray())
+		{
+			// Keep the values of the source array present in the destination bitset
+			Container* const array = allocArray(MAX(source->count, (ULONG) MIN_ARRAY));
+			const BUNCH_T* const words = dest->words();
+			const USHORT* const sourceValues = source->values();
+			USHORT* const values = array->values();
+			ULONG k = 0;
+
+			for (ULONG i = 0; i < source->count; i++)
+			{
+				const ULONG low = sourceValues[i];
+				if (words[low / BUNCH_BITS] & (BUNCH_ONE << (low % BUNCH_BITS)))
+					values[k++] = (USHORT) low;
+			}
+
+			array->count = k;
+			freeContainer(dest);
+			dest = array;
+			return;
+		}
+
+		USHORT* const values = dest->values();
+		ULONG k = 0;
+
+		if (!source->isArray())
+		{
+			const BUNCH_T* const sourceWords = source->words();
+			for (ULONG i = 0; i < dest->count; i++)
+			{
+				const ULONG low = values[i];
+				if (sourceWords[low / BUNCH_BITS] & (BUNCH_ONE << (low % BUNCH_BITS)))
+					values[k++] = (USHORT) low;
+			}
+		}
+		else
+		{
+			const USHORT* const sourceValues = source->values();
+			ULONG i = 0, j = 0;
+
+			while (i < dest->count && j < source->count)
+			{
+				if (values[i] < sourceValues[j])
+					i++;
+				else if (values[i] > sourceValues[j])
+					j++;
+				else
+				{
+					values[k++] = values[i++];
+					j++;
+				}
+			}
+		}
+
+		dest->count = k;
+	}
+
 private:
 	SparseBitmap(const SparseBitmap& from); // Copy constructor. Not implemented for now.
 	SparseBitmap& operator =(const SparseBitmap& from); // Assignment operator. Not implemented for now.
@@ -244,7 +670,7 @@ public:
 	{
 	public:
 		Accessor(SparseBitmap* _bitmap) :
-			bitmap(_bitmap), treeAccessor(_bitmap ? &_bitmap->tree : NULL), bit_mask(BUNCH_ONE),
+			bitmap(_bitmap), treeAccessor(_bitmap ? &_bitmap->tree : NULL), pos(0),
 			current_value(0)
 		{}
 
@@ -261,10 +687,6 @@ public:
 			if (!bitmap)
 				return false;
 
-			// This routine is not perfectly optimized, but is simple and functional
-			// If need arises to use it in performance-critical places separation
-			// of handling for different LocType cases may make sense.
-
 			if (bitmap->singular)
 			{
 				// Trivial handling for singular bitmap
@@ -305,100 +727,49 @@ public:
 					break;
 			}
 
-			// Look up a bucket for our key
-			T key_aligned = key & ~(T) (BUNCH_BITS - 1);
-			if (!treeAccessor.locate(lt, key_aligned))
+			// Look up a chunk for our key
+			const T start = key & ~(T) (CHUNK_BITS - 1);
+			const ULONG low = (ULONG) (key - start);
+			if (!treeAccessor.locate(lt, start))
 			{
-				// If we didn't find the desired bucket no way we can find desired value
+				// If we didn't find the desired chunk no way we can find desired value
 				return false;
 			}
 
+			const Bucket& bucket = treeAccessor.current();
+			ULONG found;
+
 			switch (lt)
 			{
 				case locEqual:
 					current_value = key;
-					bit_mask = BUNCH_ONE << (key - key_aligned);
-					return treeAccessor.current().bits & bit_mask;
+					return findValue(bucket.container, low, pos);
+
 				case locGreatEqual:
-				{
-					// Initialize bit_mask
-					if (treeAccessor.current().start_value == key_aligned) {
-						current_value = key;
-						bit_mask = BUNCH_ONE << (key - key_aligned);
-					}
-					else {
-						current_value = treeAccessor.current().start_value;
-						bit_mask = BUNCH_ONE;
+					if (bucket.start_value != start)
+						return setFirst();
+
+					if (ceilValue(bucket.container, low, found))
+					{
+						current_value = start + found;
+						return true;
 					}
 
-					// Scan bucket forwards looking for a match
-					BUNCH_T tree_bits = treeAccessor.current().bits;
-					do {
-						if (tree_bits & bit_mask)
-							return true;
-						bit_mask <<= 1;
-						current_value++;
-					} while (bit_mask);
-
-					// We scanned bucket, but found no match.
-					// No problem, scan the next bucket (there should be at least one bit set for a bucket)
-					if (!treeAccessor.getNext())
-						return false;
+					// No match in the chunk, take the next one
+					// (there should be at least one value in every chunk)
+					return treeAccessor.getNext() && setFirst();
 
-					tree_bits = treeAccessor.current().bits;
-					bit_mask = BUNCH_ONE;
-					current_value = treeAccessor.current().start_value;
-					do {
-						if (tree_bits & bit_mask)
-							return true;
-						bit_mask <<= 1;
-						current_value++;
-					} while (bit_mask);
-
-					// Bucket must contain one bit at least
-					fb_assert(false);
-				}
 				case locLessEqual:
-				{
-					// Initialize bit_mask
-					if (treeAccessor.current().start_value == key_aligned)
-					{
-						current_value = key;
-						bit_mask = BUNCH_ONE << (key - key_aligned);
-					}
-					else
+					if (bucket.start_value != start)
+						return setLast();
+
+					if (floorValue(bucket.container, low, found))
 					{
-						current_value = treeAccessor.current().start_value;
-						bit_mask = BUNCH_ONE << (BUNCH_BITS - 1);
+						current_value = start + found;
+						return true;
 					}
 
-					// Scan bucket backwards looking for a match
-					BUNCH_T tree_bits = treeAccessor.current().bits;
-					do {
-						if (tree_bits & bit_mask)
-							return true;
-						bit_mask >>= 1;
-						current_value--;
-					} while (bit_mask);
-
-					// We scanned bucket, but found no match.
-					// No problem, scan the next bucket (there should be at least one bit set for a bucket)
-					if (!treeAccessor.getPrev())
-						return false;
-
-					tree_bits = treeAccessor.current().bits;
-					bit_mask = BUNCH_ONE << (BUNCH_BITS - 1);
-					current_value = treeAccessor.current().start_value + BUNCH_BITS - 1;
-					do {
-						if (tree_bits & bit_mask)
-							return true;
-						bit_mask >>= 1;
-						current_value--;
-					} while (bit_mask);
-
-					// Bucket must contain one bit at least
-					fb_assert(false);
-				}
+					return treeAccessor.getPrev() && setLast();
 
 				default:
 					break;
@@ -421,22 +792,7 @@ public:
 				return true;
 			}
 
-			if (!treeAccessor.getFirst())
-				return false;
-
-			const BUNCH_T tree_bits = treeAccessor.current().bits;
-			bit_mask = BUNCH_ONE;
-			current_value = treeAccessor.current().start_value;
-			do {
-				if (tree_bits & bit_mask)
-					return true;
-				bit_mask <<= 1;
-				current_value++;
-			} while (bit_mask);
-
-			// Bucket must contain one bit at least
-			fb_assert(false);
-			return false;
+			return treeAccessor.getFirst() && setFirst();
 		}
 
 		// If method returns false it means list is empty and
@@ -453,21 +809,7 @@ public:
 				return true;
 			}
 
-			if (!treeAccessor.getLast())
-				return false;
-
-			const BUNCH_T tree_bits = treeAccessor.current().bits;
-			bit_mask = BUNCH_ONE << (BUNCH_BITS - 1);
-			current_value = treeAccessor.current().start_value + BUNCH_BITS - 1;
-			do {
-				if (tree_bits & bit_mask)
-					return true;
-				bit_mask >>= 1;
-				current_value--;
-			} while (bit_mask);
-
-			// Bucket must contain one bit at least
-			fb_assert(false);
+			return treeAccessor.getLast() && setLast();
 		}
 
 		// Accessor position must be establised via successful call to getFirst(),
@@ -477,49 +819,48 @@ public:
 			if (bitmap->singular)
 				return false;
 
-			// Use temporaries to avoid corrupting position if there is no next item in bitmap
-			BUNCH_T try_mask = bit_mask;
-			T try_value = current_value;
-
-			// Proceed to next value
-			try_mask <<= 1;
-			try_value++;
+			const Bucket& bucket = treeAccessor.current();
+			const Container* const container = bucket.container;
+			const ULONG low = (ULONG) (current_value - bucket.start_value);
+			ULONG found;
 
-			// Scan bucket forwards looking for a match
-			BUNCH_T tree_bits = treeAccessor.current().bits;
-			while (try_mask)
+			if (container->isArray())
 			{
-				if (tree_bits & try_mask)
+				// The array could be changed since the position was taken
+				ULONG next = pos;
+				if (next < container->count && container->values()[next] == low)
+					next++;
+				else if (findValue(container, low, next))
+					next++;
+
+				if (next < container->count)
 				{
-					bit_mask = try_mask;
-					current_value = try_value;
+					pos = next;
+					current_value = bucket.start_value + container->values()[next];
 					return true;
 				}
-				try_mask <<= 1;
-				try_value++;
 			}
+			else
+			{
+				// Look at the rest of the current word first
+				const BUNCH_T* const words = container->words();
+				const ULONG shift = (low % BUNCH_BITS) + 1;
+				const BUNCH_T rest = (shift < BUNCH_BITS) ? words[low / BUNCH_BITS] >> shift : 0;
 
-			// We scanned bucket, but found no match.
-			// No problem, scan the next bucket (there should be at least one bit set for a bucket)
-			if (!treeAccessor.getNext())
-				return false;
+				if (rest || bitForward(words, low + 1, found))
+				{
+					if (rest)
+						found = low + 1 + std::countr_zero(rest);
 
-			tree_bits = treeAccessor.current().bits;
-			try_mask = BUNCH_ONE;
-			try_value = treeAccessor.current().start_value;
-			do {
-				if (tree_bits & try_mask) {
-					bit_mask = try_mask;
-					current_value = try_value;
+					pos = found;
+					current_value = bucket.start_value + found;
 					return true;
 				}
-				try_mask <<= 1;
-				try_value++;
-			} while (try_mask);
+			}
 
-			// Bucket must contain one bit at least
-			fb_assert(false);
-			return false; // Absence of this statement makes GCC 3.4 generate wrong code here
+			// We scanned the chunk, but found no match. No problem, take the next one
+			// (there should be at least one value in every chunk)
+			return treeAccessor.getNext() && setFirst();
 		}
 
 		// Accessor position must be establised via successful call to getFirst(),
@@ -529,56 +870,135 @@ public:
 			if (bitmap->singular)
 				return false;
 
-			// Use temporaries to avoid corrupting position if there is no next item in bitmap
-			BUNCH_T try_mask = bit_mask;
-			T try_value = current_value;
-
-			// Proceed to next value
-			try_mask >>= 1;
-			try_value--;
+			const Bucket& bucket = treeAccessor.current();
+			const Container* const container = bucket.container;
+			const ULONG low = (ULONG) (current_value - bucket.start_value);
+			ULONG found;
 
-			// Scan bucket backwards looking for a match
-			BUNCH_T tree_bits = treeAccessor.current().bits;
-			while (try_mask)
+			if (container->isArray())
 			{
-				if (tree_bits & try_mask)
+				ULONG prev = pos;
+				if (!(prev < container->count && container->values()[prev] == low))
+					findValue(container, low, prev);
+
+				if (prev > 0)
 				{
-					bit_mask = try_mask;
-					current_value = try_value;
+					pos = --prev;
+					current_value = bucket.start_value + container->values()[prev];
 					return true;
 				}
-				try_mask >>= 1;
-				try_value--;
 			}
+			else if (low && bitBackward(container->words(), low - 1, found))
+			{
+				pos = found;
+				current_value = bucket.start_value + found;
+				return true;
+			}
+
+			return treeAccessor.getPrev() && setLast();
+		}
+
+	    T current() const { return current_value; }
 
-			// We scanned bucket, but found no match.
-			// No problem, scan the next bucket (there should be at least one bit set for a bucket)
-			if (!treeAccessor.getPrev())
+	private:
+		// Position on the first value of the current chunk
+		bool setFirst()
+		{
+			const Bucket& bucket = treeAccessor.current();
+			const Container* const container = bucket.container;
+			ULONG found;
+
+			if (container->isArray())
+			{
+				fb_assert(container->count);
+				pos = 0;
+				found = container->values()[0];
+			}
+			else if (bitForward(container->words(), 0, found))
+				pos = found;
+			else
+			{
+				// Chunk must contain one value at least
+				fb_assert(false);
 				return false;
+			}
 
-			tree_bits = treeAccessor.current().bits;
-			try_mask = BUNCH_ONE << (BUNCH_BITS - 1);
-			try_value = treeAccessor.current().start_value + BUNCH_BITS - 1;
-			do {
-				if (tree_bits & try_mask)
-				{
-					bit_mask = try_mask;
-					current_value = try_value;
-					return true;
-				}
-				try_mask >>= 1;
-				try_value--;
-			} while (bit_mask);
+			current_value = bucket.start_value + found;
+			return true;
+		}
+
+		// Position on the last value of the current chunk
+		bool setLast()
+		{
+			const Bucket& bucket = treeAccessor.current();
+			const Container* const container = bucket.container;
+			ULONG found;
+
+			if (container->isArray())
+			{
+				fb_assert(container->count);
+				pos = container->count - 1;
+				found = container->values()[pos];
+			}
+			else if (bitBackward(container->words(), CHUNK_BITS - 1, found))
+				pos = found;
+			else
+			{
+				// Chunk must contain one value at least
+				fb_assert(false);
+				return false;
+			}
 
-			// Bucket must contain one bit at least
-			fb_assert(false);
+			current_value = bucket.start_value + found;
+			return true;
+		}
+
+		// Find the first value at or after the given one
+		bool ceilValue(const Container* container, ULONG low, ULONG& found)
+		{
+			if (!container->isArray())
+			{
+				if (!bitForward(container->words(), low, found))
+					return false;
+
+				pos = found;
+				return true;
+			}
+
+			findValue(container, low, pos);
+			if (pos >= container->count)
+				return false;
+
+			found = container->values()[pos];
+			return true;
+		}
+
+		// Find the last value at or before the given one
+		bool floorValue(const Container* container, ULONG low, ULONG& found)
+		{
+			if (!container->isArray())
+			{
+				if (!bitBackward(container->words(), low, found))
+					return false;
+
+				pos = found;
+				return true;
+			}
+
+			if (!findValue(container, low, pos))
+			{
+				if (!pos)
+					return false;
+				pos--;
+			}
+
+			found = container->values()[pos];
+			return true;
 		}
 
-	    T current() const { return current_value; }
-	private:
 		SparseBitmap* bitmap;
 		BitmapTreeAccessor treeAccessor;
-		BUNCH_T bit_mask;
+		ULONG pos;			// index of the array or the value of the bitset in the chunk
 		T current_value;
 	};
 private:
@@ -644,64 +1064,51 @@ SparseBitmap<T, InternalTypes>::bit_or(SparseBitmap<T, InternalTypes>** bitmap1,
 		return result;
 	}
 
-	// Both source and destination are empty. Return destination FWIW.
 	bool destFound = dest->tree.getFirst();
-	if (!destFound) {
-		return result;
-	}
-
-	T destValue = dest->tree.current().start_value;
-	T sourceValue = source->tree.current().start_value;
 
 	while (sourceFound)
 	{
+		const Bucket& sourceBucket = source->tree.current();
+
 		if (destFound)
 		{
-			// See if we need to skip value in destination tree
-			if (destValue < sourceValue)
+			Bucket& destBucket = dest->tree.current();
+
+			// See if we need to skip chunk in destination tree
+			if (destBucket.start_value < sourceBucket.start_value)
 			{
-				if ((destFound = dest->tree.getNext()))
-					destValue = dest->tree.current().start_value;
+				destFound = dest->tree.getNext();
 				continue;
 			}
 
 			// Positions of our trees match
-			if (destValue == sourceValue)
+			if (destBucket.start_value == sourceBucket.start_value)
 			{
-				dest->tree.current().bits |= source->tree.current().bits;
+				dest->unite(destBucket.container, sourceBucket.container);
 
-				if ((destFound = dest->tree.getNext()))
-					destValue = dest->tree.current().start_value;
-
-				if ((sourceFound = source->tree.getNext()))
-					sourceValue = source->tree.current().start_value;
+				destFound = dest->tree.getNext();
+				sourceFound = source->tree.getNext();
 				continue;
 			}
 
-			// Need to add some buckets to destination tree.
-			// Try to add them in a row to avoid accessor resync after addition
-			while (true)
-			{
-				dest->tree.add(source->tree.current());
+			// Need to add some chunks to destination tree.
+			// Add them in a row and resync accessor position after that
+			const T destValue = destBucket.start_value;
 
-				if (!(sourceFound = source->tree.getNext()))
-					break;
-
-				sourceValue = source->tree.current().start_value;
+			do {
+				const Bucket& bucket = source->tree.current();
+				dest->addBucket(bucket.start_value, dest->copyContainer(bucket.container));
+			} while ((sourceFound = source->tree.getNext()) &&
+				source->tree.current().start_value < destValue);
 
-				// Resync accessor position if necessary
-				if (destValue <= sourceValue)
-				{
-					dest->tree.locate(destValue);
-					break;
-				}
-			}
+			dest->tree.locate(destValue);
 		}
 		else
 		{
-			// Add remaining buckets to destination tree and get out
+			// Add remaining chunks to destination tree and get out
 			do {
-				dest->tree.add(source->tree.current());
+				const Bucket& bucket = source->tree.current();
+				dest->addBucket(bucket.start_value, dest->copyContainer(bucket.container));
 			} while (source->tree.getNext());
 
 			break;
@@ -769,55 +1176,51 @@ SparseBitmap<T, InternalTypes>::bit_and(SparseBitmap<T, InternalTypes>** bitmap1
 
 	bool sourceFound = source->tree.getFirst();
 
-	// Both source and destination are empty. Return destination FWIW.
-	if (!sourceFound)
-		return result;
-
-	T destValue = dest->tree.current().start_value;
-	T sourceValue = source->tree.current().start_value;
-
 	while (destFound)
 	{
+		Bucket& destBucket = dest->tree.current();
+
 		if (sourceFound)
 		{
-			// See if we need to skip value in destination tree
-			if (sourceValue < destValue)
+			const Bucket& sourceBucket = source->tree.current();
+
+			// See if we need to skip chunk in source tree
+			if (sourceBucket.start_value < destBucket.start_value)
 			{
-				if ((sourceFound = source->tree.getNext()))
-					sourceValue = source->tree.current().start_value;
+				sourceFound = source->tree.getNext();
 				continue;
 			}
 
 			// Positions of our trees match
-			if (sourceValue == destValue)
+			if (sourceBucket.start_value == destBucket.start_value)
 			{
-				const BUNCH_T bits = dest->tree.current().bits &= source->tree.current().bits;
+				dest->intersect(destBucket.container, sourceBucket.container);
 
 				// Move to the next item of destination tree
-				if (bits)
+				if (destBucket.container->count)
 					destFound = dest->tree.getNext();
 				else
+				{
+					dest->freeContainer(destBucket.container);
 					destFound = dest->tree.fastRemove();
-
-				if (destFound)
-					destValue = dest->tree.current().start_value;
+				}
 
 				// Move to the next item of source tree
-				if ((sourceFound = source->tree.getNext()))
-					sourceValue = source->tree.current().start_value;
+				sourceFound = source->tree.getNext();
 				continue;
 			}
 
-			// Need to remove some buckets from destination tree.
+			// Need to remove some chunks from destination tree.
 			// if (sourceValue > destValue)
-			if ((destFound = dest->tree.fastRemove()))
-				destValue = dest->tree.current().start_value;
+			dest->freeContainer(destBucket.container);
+			destFound = dest->tree.fastRemove();
 		}
 		else
 		{
-			// Trim out remaining values from destination list and get out
-			while (dest->tree.fastRemove())
-			{ }
+			// Trim out remaining chunks from destination list and get out
+			do {
+				dest->freeContainer(dest->tree.current().container);
+			} while (dest->tree.fastRemove());
 			break;
 		}
 	}
@@ -0,0 +1,100 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/Hash.h"
+#include <string.h>
+
+using namespace Firebird;
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(Crc32CSuite)
+
+
+namespace
+{
+	// Standard CRC-32C, i.e. with pre- and post-conditioning
+	unsigned int standardCrc(unsigned int length, const UCHAR* value, bool portable)
+	{
+		const unsigned int crc = portable ?
+			Crc32C::updatePortable(~0u, length, value) :
+			Crc32C::update(~0u, length, value);
+
+		return ~crc;
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(KnownVectorsTest)
+{
+	// Check values from RFC 3720, B.4
+	UCHAR buffer[32];
+
+	for (const bool portable : {false, true})
+	{
+		memset(buffer, 0, sizeof(buffer));
+		BOOST_TEST(standardCrc(sizeof(buffer), buffer, portable) == 0x8A9136AAu);
+
+		memset(buffer, 0xFF, sizeof(buffer));
+		BOOST_TEST(standardCrc(sizeof(buffer), buffer, portable) == 0x62A8AB43u);
+
+		for (unsigned i = 0; i < sizeof(buffer); ++i)
+			buffer[i] = i;
+		BOOST_TEST(standardCrc(sizeof(buffer), buffer, portable) == 0x46DD794Eu);
+
+		for (unsigned i = 0; i < sizeof(buffer); ++i)
+			buffer[i] = sizeof(buffer) - 1 - i;
+		BOOST_TEST(standardCrc(sizeof(buffer), buffer, portable) == 0x113FDB5Cu);
+
+		const char* const check = "123456789";
+		BOOST_TEST(standardCrc(strlen(check), (const UCHAR*) check, portable) == 0xE3069283u);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(UnalignedTest)
+{
+	// With SSE 4.2 available update() uses the crc32 instruction reading the data
+	// by 4, 2 and 1 bytes, compare it with the table on any offset and length
+
+	UCHAR buffer[256 + 8];
+	for (unsigned i = 0; i < sizeof(buffer); ++i)
+		buffer[i] = (UCHAR) (i * 131 + 7);
+
+	for (unsigned offset = 0; offset < 8; ++offset)
+	{
+		for (unsigned length = 0; length <= 256; ++length)
+		{
+			const UCHAR* const data = buffer + offset;
+
+			BOOST_TEST(Crc32C::update(0, length, data) == Crc32C::updatePortable(0, length, data));
+			BOOST_TEST(Crc32C::update(0x12345678, length, data) ==
+				Crc32C::updatePortable(0x12345678, length, data));
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(ContinuationTest)
+{
+	// The checksum calculated by parts must be the same as calculated at once
+
+	UCHAR buffer[101];
+	for (unsigned i = 0; i < sizeof(buffer); ++i)
+		buffer[i] = (UCHAR) (i * 37 + 11);
+
+	const unsigned int whole = Crc32C::update(0, sizeof(buffer), buffer);
+
+	for (unsigned split = 0; split <= sizeof(buffer); ++split)
+	{
+		unsigned int crc = Crc32C::update(0, split, buffer);
+		crc = Crc32C::update(crc, sizeof(buffer) - split, buffer + split);
+		BOOST_TEST(crc == whole);
+
+		crc = Crc32C::updatePortable(0, split, buffer);
+		crc = Crc32C::updatePortable(crc, sizeof(buffer) - split, buffer + split);
+		BOOST_TEST(crc == whole);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// Crc32CSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
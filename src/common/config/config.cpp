@@ -424,6 +424,9 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_PARALLEL_WORKERS, 1, true);
 	checkIntForHiBound(KEY_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
+
+	checkIntForLoBound(KEY_PROFILER_SAMPLING_INTERVAL, 1, true);
+	checkIntForHiBound(KEY_PROFILER_SAMPLING_INTERVAL, 1000, false);
 }
 
 
@@ -187,6 +187,9 @@ enum ConfigKey
 	KEY_MAX_PARALLEL_WORKERS,
 	KEY_OPTIMIZE_FOR_FIRST_ROWS,
 	KEY_ALLOW_UPDATE_OVERWRITE,
+	KEY_TEMP_FILE_MAPPING,
+	KEY_SORT_COMPRESSION,
+	KEY_PROFILER_SAMPLING_INTERVAL,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -300,7 +303,10 @@ inline constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,	"ParallelWorkers",			true,	1},
 	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1},
 	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false},
-	{TYPE_BOOLEAN,	"AllowUpdateOverwrite",		false,	true}
+	{TYPE_BOOLEAN,	"AllowUpdateOverwrite",		false,	true},
+	{TYPE_BOOLEAN,	"TempFileMapping",			true,	true},
+	{TYPE_BOOLEAN,	"SortCompression",			false,	false},
+	{TYPE_INTEGER,	"ProfilerSamplingInterval",	true,	10}		// milliseconds
 };
 
 
@@ -623,6 +629,15 @@ public:
 	CONFIG_GET_PER_DB_BOOL(getOptimizeForFirstRows, KEY_OPTIMIZE_FOR_FIRST_ROWS);
 
 	CONFIG_GET_PER_DB_BOOL(getAllowUpdateOverwrite, KEY_ALLOW_UPDATE_OVERWRITE);
+
+	// Access the temporary files through memory mapping
+	CONFIG_GET_GLOBAL_BOOL(getTempFileMapping, KEY_TEMP_FILE_MAPPING);
+
+	// Compress sort runs written to the temporary files
+	CONFIG_GET_PER_DB_BOOL(getSortCompression, KEY_SORT_COMPRESSION);
+
+	// Interval between samples taken by the profiler sessions in sampling mode
+	CONFIG_GET_GLOBAL_INT(getProfilerSamplingInterval, KEY_PROFILER_SAMPLING_INTERVAL);
 };
 
 // Implementation of interface to access master configuration file
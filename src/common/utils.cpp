@@ -830,6 +830,16 @@ SINT64 query_performance_frequency()
 }
 
 
+// Converts interval in performance counter ticks into microseconds
+SINT64 ticks_to_microseconds(SINT64 ticks)
+{
+	// Split the conversion to avoid overflow of ticks * 1000000 for
+	// nanosecond counters (it happens after ~2.5 hours)
+	const SINT64 frequency = query_performance_frequency();
+	return ticks / frequency * 1000000 + (ticks % frequency) * 1000000 / frequency;
+}
+
+
 // returns system and user time in milliseconds that process runs
 void get_process_times(SINT64 &userTime, SINT64 &sysTime)
 {
@@ -213,6 +213,9 @@ namespace fb_utils
 	// Returns frequency of performance counter in Hz
 	SINT64 query_performance_frequency();
 
+	// Converts interval in performance counter ticks into microseconds
+	SINT64 ticks_to_microseconds(SINT64 ticks);
+
 	void get_process_times(SINT64 &userTime, SINT64 &sysTime);
 
 	void exactNumericToStr(SINT64 value, int scale, Firebird::string& target, bool append = false);
@@ -1909,6 +1909,48 @@ typedef RecreateNode<CreateRelationNode, DropRelationNode, isc_dsql_recreate_tab
 	RecreateTableNode;
 
 
+class TruncateTableNode final : public DdlNode
+{
+public:
+	TruncateTableNode(MemoryPool& p, const QualifiedName& aName)
+		: DdlNode(p),
+		  name(p, aName)
+	{
+	}
+
+public:
+	Firebird::string internalPrint(NodePrinter& printer) const override;
+	void checkPermission(thread_db* tdbb, jrd_tra* transaction) override;
+	void execute(thread_db* tdbb, DsqlCompilerScratch* dsqlScratch, jrd_tra* transaction) override;
+
+	DdlNode* dsqlPass(DsqlCompilerScratch* dsqlScratch) override
+	{
+		dsqlScratch->qualifyExistingName(name, obj_relation);
+		protectSystemSchema(name.schema, obj_relation);
+		dsqlScratch->ddlSchema = name.schema;
+
+		return DdlNode::dsqlPass(dsqlScratch);
+	}
+
+	bool mustBeReplicated() const override
+	{
+		return false;	// tables published for replication can't be truncated
+	}
+
+private:
+	void checkReferences(thread_db* tdbb, jrd_tra* transaction);
+
+protected:
+	void putErrorPrefix(Firebird::Arg::StatusVector& statusVector) override
+	{
+		statusVector << Firebird::Arg::Gds(isc_dsql_truncate_table_failed) << name.toQuotedString();
+	}
+
+public:
+	QualifiedName name;
+};
+
+
 class CreateAlterViewNode final : public RelationNode
 {
 public:
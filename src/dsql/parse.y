@@ -960,6 +960,7 @@ ddl_statement
 	| recreate									{ $$ = $1; }
 	| revoke									{ $$ = $1; }
 	| set_statistics							{ $$ = $1; }
+	| truncate_table							{ $$ = $1; }
 	;
 
 %type <traNode> tra_statement
@@ -6542,6 +6543,12 @@ set_statistics
 		{ $$ = newNode<SetStatisticsNode>(*$4); }
 	;
 
+%type <ddlNode>	truncate_table
+truncate_table
+	: TRUNCATE TABLE symbol_table_name
+		{ $$ = newNode<TruncateTableNode>(*$3); }
+	;
+
 %type <ddlNode> comment
 comment
 	: COMMENT ON ddl_type0 IS ddl_desc
@@ -7653,6 +7653,7 @@ namespace Firebird
 
 		static CLOOP_CONSTEXPR unsigned FLAG_BEFORE_EVENTS = 0x1;
 		static CLOOP_CONSTEXPR unsigned FLAG_AFTER_EVENTS = 0x2;
+		static CLOOP_CONSTEXPR unsigned FLAG_SAMPLING = 0x4;
 
 		ISC_INT64 getId()
 		{
@@ -7830,6 +7831,12 @@ namespace Firebird
 		static CLOOP_CONSTEXPR unsigned RECORD_FRAGMENT_READS = 12;
 		static CLOOP_CONSTEXPR unsigned RECORD_RPT_READS = 13;
 		static CLOOP_CONSTEXPR unsigned RECORD_IMGC = 14;
+		static CLOOP_CONSTEXPR unsigned WAIT_LOCK_WAITS = 0;
+		static CLOOP_CONSTEXPR unsigned WAIT_LOCK_TIME = 1;
+		static CLOOP_CONSTEXPR unsigned WAIT_LATCH_WAITS = 2;
+		static CLOOP_CONSTEXPR unsigned WAIT_LATCH_TIME = 3;
+		static CLOOP_CONSTEXPR unsigned WAIT_READ_TIME = 4;
+		static CLOOP_CONSTEXPR unsigned WAIT_WRITE_TIME = 5;
 
 		unsigned getObjectCount()
 		{
@@ -7889,6 +7896,7 @@ namespace Firebird
 
 		static CLOOP_CONSTEXPR unsigned COUNTER_GROUP_PAGES = 0;
 		static CLOOP_CONSTEXPR unsigned COUNTER_GROUP_TABLES = 1;
+		static CLOOP_CONSTEXPR unsigned COUNTER_GROUP_WAITS = 2;
 
 		ISC_UINT64 getElapsedTime()
 		{
@@ -445,6 +445,7 @@
 #define isc_spb_bkp_no_triggers			 0x8000
 #define isc_spb_bkp_zip					 0x010000
 #define isc_spb_bkp_direct_io			 0x020000
+#define isc_spb_bkp_columnar			 0x040000
 
 /********************************************
  * Parameters for isc_action_svc_properties *
@@ -646,9 +647,11 @@
 #define isc_spb_nbk_clean_history	9
 #define isc_spb_nbk_keep_days		10
 #define isc_spb_nbk_keep_rows		11
+#define isc_spb_nbk_parallel_workers	12
 #define isc_spb_nbk_no_triggers		0x01
 #define isc_spb_nbk_inplace			0x02
 #define isc_spb_nbk_sequence		0x04
+#define isc_spb_nbk_compress		0x08
 
 /***************************************
  * Parameters for isc_action_svc_trace *
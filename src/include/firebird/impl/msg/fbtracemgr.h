@@ -40,3 +40,7 @@ FB_IMPL_MSG(FBTRACEMGR, 39, trace_param_act_notcompat, -901, "00", "000", "param
 FB_IMPL_MSG(FBTRACEMGR, 40, trace_mandatory_switch_miss, -901, "00", "000", "mandatory switch \"@1\" is missing")
 FB_IMPL_MSG_NO_SYMBOL(FBTRACEMGR, 41, "  -P[LUGINS]  <string list>             Plugins list for use with trace session; valid list separators: <tab>, <comma>, <semicolon>")
 FB_IMPL_MSG_NO_SYMBOL(FBTRACEMGR, 42, "  fbtracemgr -SE service_mgr -START -NAME my_trace -CONFIG my_cfg.txt -PLUGINS fbtrace,custom_plugin")
+FB_IMPL_MSG_NO_SYMBOL(FBTRACEMGR, 43, "  -D[ECODE]                             Decode binary trace log")
+FB_IMPL_MSG_NO_SYMBOL(FBTRACEMGR, 44, "  -INP[UT]   <string>                   Binary trace log file name")
+FB_IMPL_MSG_NO_SYMBOL(FBTRACEMGR, 45, "  -J[SON]                               Decode binary trace log into JSON")
+FB_IMPL_MSG_NO_SYMBOL(FBTRACEMGR, 46, "  fbtracemgr -DECODE -INPUT trace.log -JSON")
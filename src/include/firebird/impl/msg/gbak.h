@@ -422,3 +422,5 @@ FB_IMPL_MSG(GBAK, 423, gbak_writing_constants, -901, "00", "000", "writing const
 FB_IMPL_MSG(GBAK, 424, gbak_writing_constant, -901, "00", "000", "writing constant %s")
 FB_IMPL_MSG(GBAK, 425, gbak_constant, -901, "00", "000", "constant (in RDB$CONSTANTS)")
 FB_IMPL_MSG(GBAK, 426, gbak_restoring_constant, -901, "00", "000", "restoring constant %s")
+FB_IMPL_MSG_NO_SYMBOL(GBAK, 427, "    @1COL(UMNAR)           store table data in compressed column chunks")
+FB_IMPL_MSG(GBAK, 428, gbak_column_chunk_err, -901, "00", "000", "corrupted column chunk in data of table @1")
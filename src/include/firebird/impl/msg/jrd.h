@@ -1020,3 +1020,7 @@ FB_IMPL_MSG(JRD, 1017, dsql_agg_non_agg_context, -104, "42", "000", "Aggregate f
 FB_IMPL_MSG(JRD, 1018, dsql_agg_param_not_accum, -204, "42", "000", "Aggregate function input parameters may be referenced only in ON ACCUMULATE DO")
 FB_IMPL_MSG(JRD, 1019, dsql_agg_exit_group, -204, "42", "000", "EXIT is not allowed in ON GROUP DO section of aggregate function")
 FB_IMPL_MSG(JRD, 1020, dsql_agg_return, -204, "42", "000", "RETURN is not allowed in ON START DO, ON ACCUMULATE DO or ON FINISH DO sections of aggregate function; use EXIT instead")
+FB_IMPL_MSG(JRD, 1021, truncate_not_supported, -607, "42", "000", "TRUNCATE TABLE requires a persistent table not published for replication and the shared page cache")
+FB_IMPL_MSG(JRD, 1022, truncate_referenced, -607, "23", "000", "Table @1 is referenced by FOREIGN KEY constraint @2 of table @3")
+FB_IMPL_MSG(JRD, 1023, truncate_snapshots, -901, "40", "001", "Records of table @1 may still be visible to other transactions")
+FB_IMPL_MSG(JRD, 1024, truncate_modified, -607, "42", "000", "Table @1 has been modified or reserved by the current transaction")
@@ -86,3 +86,11 @@ FB_IMPL_MSG(NBACKUP, 85, nbackup_clean_hist_misuse, -901, "00", "000", "Switch -
 FB_IMPL_MSG(NBACKUP, 86, nbackup_clean_hist_missed, -901, "00", "000", "-KEEP can be used only with -CLEAN_HISTORY")
 FB_IMPL_MSG(NBACKUP, 87, nbackup_keep_hist_missed, -901, "00", "000", "-KEEP is required with -CLEAN_HISTORY")
 FB_IMPL_MSG(NBACKUP, 88, nbackup_second_keep_switch, -901, "00", "000", "-KEEP can be used one time only")
+FB_IMPL_MSG_NO_SYMBOL(NBACKUP, 89, "  -PAR(ALLEL) <n>                        Number of parallel workers for backup and restore")
+FB_IMPL_MSG_NO_SYMBOL(NBACKUP, 90, "  -COMP(RESS)                            Write compressed backup")
+FB_IMPL_MSG(NBACKUP, 91, nbackup_err_chunk, -901, "00", "000", "Invalid data chunk in backup file: @1")
+FB_IMPL_MSG(NBACKUP, 92, nbackup_nozlib, -901, "00", "000", "Backup file @1 is compressed but compression library is not available")
+FB_IMPL_MSG_NO_SYMBOL(NBACKUP, 93, "  -VER(IFY) <file0> [<file1>...]         Verify backup files without restore")
+FB_IMPL_MSG_NO_SYMBOL(NBACKUP, 94, "  \"stdin\" may be used as a value of <file> for -R and -VER options.")
+FB_IMPL_MSG(NBACKUP, 95, nbackup_err_checksum, -901, "00", "000", "Checksum mismatch in chunk @1 of backup file: @2")
+FB_IMPL_MSG(NBACKUP, 96, nbackup_page_corrupt, -901, "00", "000", "Invalid page @1 in backup file: @2")
@@ -4091,6 +4091,7 @@ type
 		const VERSION = 4;
 		const FLAG_BEFORE_EVENTS = Cardinal($1);
 		const FLAG_AFTER_EVENTS = Cardinal($2);
+		const FLAG_SAMPLING = Cardinal($4);
 
 		function getId(): Int64;
 		function getFlags(): Cardinal;
@@ -4177,6 +4178,12 @@ type
 		const RECORD_FRAGMENT_READS = Cardinal(12);
 		const RECORD_RPT_READS = Cardinal(13);
 		const RECORD_IMGC = Cardinal(14);
+		const WAIT_LOCK_WAITS = Cardinal(0);
+		const WAIT_LOCK_TIME = Cardinal(1);
+		const WAIT_LATCH_WAITS = Cardinal(2);
+		const WAIT_LATCH_TIME = Cardinal(3);
+		const WAIT_READ_TIME = Cardinal(4);
+		const WAIT_WRITE_TIME = Cardinal(5);
 
 		function getObjectCount(): Cardinal;
 		function getMaxCounterIndex(): Cardinal;
@@ -4205,6 +4212,7 @@ type
 		const VERSION = 2;
 		const COUNTER_GROUP_PAGES = Cardinal(0);
 		const COUNTER_GROUP_TABLES = Cardinal(1);
+		const COUNTER_GROUP_WAITS = Cardinal(2);
 
 		function getElapsedTime(): QWord;
 		function getFetchedRecords(): QWord;
@@ -4504,6 +4512,7 @@ const
 	isc_spb_bkp_no_triggers = $8000;
 	isc_spb_bkp_zip = $010000;
 	isc_spb_bkp_direct_io = $020000;
+	isc_spb_bkp_columnar = $040000;
 	isc_spb_prp_page_buffers = byte(5);
 	isc_spb_prp_sweep_interval = byte(6);
 	isc_spb_prp_shutdown_db = byte(7);
@@ -4610,9 +4619,11 @@ const
 	isc_spb_nbk_clean_history = byte(9);
 	isc_spb_nbk_keep_days = byte(10);
 	isc_spb_nbk_keep_rows = byte(11);
+	isc_spb_nbk_parallel_workers = byte(12);
 	isc_spb_nbk_no_triggers = $01;
 	isc_spb_nbk_inplace = $02;
 	isc_spb_nbk_sequence = $04;
+	isc_spb_nbk_compress = $08;
 	isc_spb_trc_id = byte(1);
 	isc_spb_trc_name = byte(2);
 	isc_spb_trc_cfg = byte(3);
@@ -6062,6 +6073,10 @@ const
 	 isc_dsql_agg_param_not_accum = 335545338;
 	 isc_dsql_agg_exit_group = 335545339;
 	 isc_dsql_agg_return = 335545340;
+	 isc_truncate_not_supported = 335545341;
+	 isc_truncate_referenced = 335545342;
+	 isc_truncate_snapshots = 335545343;
+	 isc_truncate_modified = 335545344;
 	 isc_gfix_db_name = 335740929;
 	 isc_gfix_invalid_sw = 335740930;
 	 isc_gfix_incmp_sw = 335740932;
@@ -6331,6 +6346,7 @@ const
 	 isc_gbak_writing_constant = 336331176;
 	 isc_gbak_constant = 336331177;
 	 isc_gbak_restoring_constant = 336331178;
+	 isc_gbak_column_chunk_err = 336331180;
 	 isc_dsql_too_old_ods = 336397205;
 	 isc_dsql_table_not_found = 336397206;
 	 isc_dsql_view_not_found = 336397207;
@@ -6470,6 +6486,7 @@ const
 	 isc_dsql_create_const_failed = 336397341;
 	 isc_dsql_alter_const_failed = 336397342;
 	 isc_dsql_create_alter_const_failed = 336397343;
+	 isc_dsql_truncate_table_failed = 336397344;
 	 isc_gsec_cant_open_db = 336723983;
 	 isc_gsec_switches_error = 336723984;
 	 isc_gsec_no_op_spec = 336723985;
@@ -6572,6 +6589,10 @@ const
 	 isc_nbackup_clean_hist_missed = 337117270;
 	 isc_nbackup_keep_hist_missed = 337117271;
 	 isc_nbackup_second_keep_switch = 337117272;
+	 isc_nbackup_err_chunk = 337117275;
+	 isc_nbackup_nozlib = 337117276;
+	 isc_nbackup_err_checksum = 337117279;
+	 isc_nbackup_page_corrupt = 337117280;
 	 isc_trace_conflict_acts = 337182750;
 	 isc_trace_act_notfound = 337182751;
 	 isc_trace_switch_once = 337182752;
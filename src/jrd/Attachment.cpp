@@ -231,7 +231,10 @@ Jrd::Attachment::Attachment(MemoryPool* pool, Database* dbb, JProvider* provider
 	  att_unqualified_charset_resolved_cache_search_path(att_schema_search_path),
 	  att_unqualified_charset_resolved_cache(*pool),
 	  att_parallel_workers(0),
+	  att_back_version_cache(nullptr),
+	  att_tip_state_cache(nullptr),
 	  att_local_temporary_tables(*pool),
+	  att_scan_locks(*pool),
 	  att_repl_appliers(*pool),
 	  att_utility(UTIL_NONE),
 	  att_dec_status(DecimalStatus::DEFAULT),
@@ -259,6 +262,9 @@ Jrd::Attachment::~Attachment()
 	// once more here because it nulls att_long_locks.
 	//		AP 2007
 	detachLocks();
+
+	for (auto& scanLock : att_scan_locks)
+		delete scanLock.second;
 }
 
 
@@ -639,6 +645,9 @@ void Jrd::Attachment::releaseLocks(thread_db* tdbb)
 
 	if (att_profiler_listener_lock)
 		LCK_release(tdbb, att_profiler_listener_lock);
+
+	for (auto& scanLock : att_scan_locks)
+		scanLock.second->release(tdbb);
 }
 
 void Jrd::Attachment::detachLocks()
@@ -734,6 +743,10 @@ int Jrd::Attachment::blockingAstMonitor(void* ast_object)
 
 		LCK_downgrade(tdbb, attachment->att_monitor_lock);
 		attachment->att_flags |= ATT_monitor_disabled;
+
+		// Our dump stays actual until the lock is converted back
+		if (attachment->att_monitor_lock->lck_logical == LCK_SR)
+			Monitoring::setDowngraded(tdbb, attachment, true);
 	}
 	catch (const Exception&)
 	{} // no-op
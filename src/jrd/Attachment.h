@@ -77,6 +77,8 @@ namespace Jrd
 	class Format;
 	class BufferControl;
 	class PageToBufferMap;
+	class BackVersionCache;
+	class TipStateCache;
 	class SparseBitmap;
 	class jrd_rel;
 	class ExternalFile;
@@ -99,6 +101,7 @@ namespace Jrd
 	class ProfilerManager;
 	class Validation;
 	class Applier;
+	class ScanLock;
 	enum InternalRequest : USHORT;
 
 
@@ -605,8 +608,11 @@ public:
 	Firebird::TriState att_opt_first_rows;
 
 	PageToBufferMap* att_bdb_cache;			// managed in CCH, created in att_pool, freed with it
+	BackVersionCache* att_back_version_cache;	// managed in VIO, created in att_pool, freed with it
+	TipStateCache* att_tip_state_cache;		// managed in TPC, created in att_pool, freed with it
 
 	Firebird::LeftPooledMap<QualifiedName, LocalTemporaryTable*> att_local_temporary_tables;
+	Firebird::NonPooledMap<MetaId, ScanLock*> att_scan_locks;	// tables read by record streams
 	std::optional<USHORT> att_next_ltt_id;		// Next available LTT relation ID
 
 	Firebird::RefPtr<Firebird::IReplicatedSession> att_replicator;
@@ -0,0 +1,115 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		BackVersionCache.h
+ *	DESCRIPTION:	Cache of reconstructed delta back versions
+ *
+ * The contents of this file are subject to the Initial
+ * Developer's Public License Version 1.0 (the "License");
+ * you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ * Software distributed under the License is distributed AS IS,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the License for the specific language governing rights
+ * and limitations under the License.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_BACK_VERSION_CACHE_H
+#define JRD_BACK_VERSION_CACHE_H
+
+#include "../common/classes/array.h"
+#include "../jrd/Record.h"
+#include "../jrd/req.h"
+
+namespace Jrd {
+
+// BackVersionCache keeps the data of back versions which were rebuilt by applying
+// differences records. Readers with old snapshots walk the same delta chains again
+// and again, so the attachment remembers the results and reuses them on re-fetch.
+// Only versions of committed transactions are put here: their data never changes,
+// while the version slot is identified by its page, line and transaction number.
+
+class BackVersionCache
+{
+	static const FB_SIZE_T CACHE_SIZE = 256;			// direct mapped slots
+	static const ULONG MAX_RECORD_LENGTH = 64 * 1024;	// don't waste memory for huge records
+
+public:
+	explicit BackVersionCache(MemoryPool& pool)
+	{
+		m_items = FB_NEW_POOL(pool) Item[CACHE_SIZE];
+
+		for (FB_SIZE_T i = 0; i < CACHE_SIZE; i++)
+			m_items[i].m_data = FB_NEW_POOL(pool) Firebird::Array<UCHAR>(pool);
+	}
+
+	bool get(const record_param* rpb, USHORT relId, Record* record)
+	{
+		const Item& item = m_items[hash(rpb)];
+
+		if (!item.m_valid || !item.matches(rpb, relId) ||
+			item.m_data->getCount() != record->getLength())
+		{
+			return false;
+		}
+
+		record->copyDataFrom(item.m_data->begin());
+		return true;
+	}
+
+	void put(const record_param* rpb, ULONG page, USHORT line, USHORT relId, const Record* record)
+	{
+		const ULONG length = record->getLength();
+
+		if (length > MAX_RECORD_LENGTH)
+			return;
+
+		Item& item = m_items[hash(rpb)];
+
+		item.m_valid = true;
+		item.m_relId = relId;
+		item.m_number = rpb->rpb_number.getValue();
+		item.m_transaction = rpb->rpb_transaction_nr;
+		item.m_page = page;
+		item.m_line = line;
+		item.m_format = rpb->rpb_format_number;
+		item.m_data->assign(record->getData(), length);
+	}
+
+private:
+	struct Item
+	{
+		SINT64 m_number = 0;
+		TraNumber m_transaction = 0;
+		ULONG m_page = 0;
+		USHORT m_line = 0;
+		USHORT m_relId = 0;
+		USHORT m_format = 0;
+		bool m_valid = false;
+		Firebird::Array<UCHAR>* m_data = nullptr;
+
+		bool matches(const record_param* rpb, USHORT relId) const
+		{
+			return m_number == rpb->rpb_number.getValue() &&
+				m_transaction == rpb->rpb_transaction_nr &&
+				m_page == rpb->rpb_page && m_line == rpb->rpb_line &&
+				m_relId == relId && m_format == rpb->rpb_format_number;
+		}
+	};
+
+	static FB_SIZE_T hash(const record_param* rpb)
+	{
+		const FB_UINT64 value = (FB_UINT64) rpb->rpb_number.getValue() * 31 + rpb->rpb_transaction_nr;
+		return (FB_SIZE_T) ((value ^ (value >> 17)) % CACHE_SIZE);
+	}
+
+	Item* m_items = nullptr;
+};
+
+} // namespace Jrd
+
+#endif // JRD_BACK_VERSION_CACHE_H
@@ -28,8 +28,10 @@
 #include "../jrd/BulkInsert.h"
 #include "../jrd/sqz.h"
 #include "../jrd/tra.h"
+#include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
 #include "../jrd/dpm_proto.h"
+#include "../jrd/idx_proto.h"
 #include "../jrd/ods_proto.h"
 
 
@@ -49,19 +51,43 @@ namespace Jrd
 // How many bytes per record should be reserved, see SPACE_FUDGE in dpm.epp
 constexpr unsigned RESERVE_SIZE = (ROUNDUP(RHDF_SIZE, ODS_ALIGNMENT) + sizeof(data_page::dpg_repeat));
 
-BulkInsert::BulkInsert(MemoryPool& pool, thread_db* tdbb, jrd_rel* relation) :
+BulkInsert::BulkInsert(MemoryPool& pool, thread_db* tdbb, jrd_tra* transaction, jrd_rel* relation) :
 	PermanentStorage(pool),
-	m_request(tdbb->getRequest())
+	m_request(tdbb->getRequest()),
+	m_transaction(transaction)
 {
 	Database* dbb = tdbb->getDatabase();
 
 	m_primary = FB_NEW_POOL(getPool())
 		Buffer(getPool(), dbb->dbb_page_size, (dbb->dbb_flags & DBB_no_reserve) ? 0 : RESERVE_SIZE, true, relation);
+
+	// Index keys can't be added until records are in the page cache. Thus numbers
+	// of the stored records are collected and indices are updated at flush.
+
+	RelationPages* relPages = relation->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, -1);
+
+	index_desc idx;
+	idx.idx_id = idx_invalid;
+
+	if (BTR_next_index(tdbb, getPermanent(relation), transaction, &idx, &window))
+	{
+		CCH_RELEASE(tdbb, &window);
+		m_indexed = true;
+	}
+}
+
+BulkInsert::~BulkInsert()
+{
+	delete m_records;
 }
 
 void BulkInsert::putRecord(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 {
 	m_primary->putRecord(tdbb, rpb, transaction);
+
+	if (m_indexed)
+		RBM_SET(&getPool(), &m_records, rpb->rpb_number.getValue());
 }
 
 RecordNumber BulkInsert::putBlob(thread_db* tdbb, blb* blob, Record* record)
@@ -72,11 +98,22 @@ RecordNumber BulkInsert::putBlob(thread_db* tdbb, blb* blob, Record* record)
 	return m_other->putBlob(tdbb, blob, record);
 }
 
-void BulkInsert::flush(thread_db* tdbb)
+void BulkInsert::flush(thread_db* tdbb, bool commit)
 {
 	if (m_other)
 		m_other->flush(tdbb);
 	m_primary->flush(tdbb);
+
+	if (m_records)
+	{
+		// Take the records away to not index them twice if flush is repeated after error
+		AutoPtr<RecordBitmap> records(m_records);
+		m_records = nullptr;
+
+		// Records of the failed insert are never seen, no need to index them
+		if (commit)
+			IDX_store_bulk(tdbb, getRelation(), m_transaction, records);
+	}
 }
 
 
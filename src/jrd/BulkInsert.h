@@ -35,6 +35,7 @@
 #include "../jrd/ods.h"
 #include "../jrd/pag.h"
 #include "../jrd/RecordNumber.h"
+#include "../jrd/sbm.h"
 
 
 namespace Jrd
@@ -50,11 +51,18 @@ class Request;
 class BulkInsert : public Firebird::PermanentStorage
 {
 public:
-	BulkInsert(Firebird::MemoryPool& pool, thread_db* tdbb, jrd_rel* relation);
+	BulkInsert(Firebird::MemoryPool& pool, thread_db* tdbb, jrd_tra* transaction, jrd_rel* relation);
+	~BulkInsert();
 
 	void putRecord(thread_db* tdbb, record_param* rpb, jrd_tra* transaction);
 	RecordNumber putBlob(thread_db* tdbb, blb* blob, Record* record);
-	void flush(thread_db* tdbb);
+	void flush(thread_db* tdbb, bool commit);
+
+	// Records were stored into the buffers and can't be undone
+	bool hasRecords() const
+	{
+		return m_primary->m_current || m_other;
+	}
 
 	Request* getRequest() const
 	{
@@ -97,6 +105,9 @@ private:
 	};
 
 	Request* const m_request;		// "owner" request that will destroy this object on unwind
+	jrd_tra* const m_transaction;
+	RecordBitmap* m_records = nullptr;	// stored records, to be indexed at flush
+	bool m_indexed = false;				// relation has indices
 
 	Firebird::AutoPtr<Buffer> m_primary;
 	Firebird::AutoPtr<Buffer> m_other;
@@ -120,8 +120,8 @@ const Format* MonitoringTableScan::getFormat(thread_db* tdbb, RelationPermanent*
 bool MonitoringTableScan::retrieveRecord(thread_db* tdbb, jrd_rel* relation,
 										 FB_UINT64 position, Record* record) const
 {
-	const auto* const snapshot = MonitoringSnapshot::create(tdbb);
-	if (!snapshot->getData(getPermanent(relation))->fetch(position, record))
+	const auto snapshot = MonitoringSnapshot::create(tdbb);
+	if (!snapshot->loadData(tdbb, getPermanent(relation))->fetch(position, record))
 		return false;
 
 	if (relation->getId() == rel_mon_attachments || relation->getId() == rel_mon_statements)
@@ -271,8 +271,16 @@ void MonitoringData::enumerate(const char* userName, ULONG generation, SessionLi
 		{
 			if (init)
 			{
-				if (element->generation < generation)
+				// Sessions with the downgraded lock are not pinged, their dumps are actual.
+				// Unless their process is dead, then the session should be garbage collected.
+
+				if (element->generation < generation &&
+					(!(element->flags & ELEMENT_DOWNGRADED) ||
+						(element->processId != getpid() &&
+							!ISC_check_process_existence(element->processId))))
+				{
 					sessions.add(element->attId);
+				}
 			}
 			else if (element->generation >= generation)
 				sessions.findAndRemove(element->attId);
@@ -321,6 +329,8 @@ ULONG MonitoringData::setup(AttNumber att_id, const char* userName, ULONG genera
 	snprintf(element->userName, sizeof(element->userName), "%s", userName);
 	element->generation = generation;
 	element->length = 0;
+	element->processId = getpid();
+	element->flags = 0;
 	m_sharedMemory->getHeader()->used += delta;
 	return offset;
 }
@@ -340,6 +350,28 @@ void MonitoringData::write(ULONG offset, ULONG length, const void* buffer)
 }
 
 
+void MonitoringData::setDowngraded(AttNumber att_id, bool downgraded)
+{
+	for (ULONG offset = HEADER_SIZE; offset < m_sharedMemory->getHeader()->used;)
+	{
+		const auto ptr = (UCHAR*) m_sharedMemory->getHeader() + offset;
+		const auto element = (Element*) ptr;
+
+		if (element->attId == att_id)
+		{
+			if (downgraded)
+				element->flags |= ELEMENT_DOWNGRADED;
+			else
+				element->flags &= ~ELEMENT_DOWNGRADED;
+
+			break;
+		}
+
+		offset += element->getBlockLength();
+	}
+}
+
+
 void MonitoringData::cleanup(AttNumber att_id)
 {
 	// Remove information about the given session
@@ -446,7 +478,10 @@ MonitoringSnapshot* MonitoringSnapshot::create(thread_db* tdbb)
 
 
 MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
-	: SnapshotData(pool)
+	: SnapshotData(pool),
+	  m_dump(pool, SCRATCH),
+	  m_loaded(pool),
+	  m_blobsMap(pool)
 {
 	PAG_header(tdbb, true);
 
@@ -456,21 +491,20 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 	const auto selfAttId = attachment->att_attachment_id;
 
 	// Initialize record buffers
-	const auto dbb_buffer = allocBuffer(tdbb, pool, rel_mon_database);
-	const auto att_buffer = allocBuffer(tdbb, pool, rel_mon_attachments);
-	const auto tra_buffer = allocBuffer(tdbb, pool, rel_mon_transactions);
-	const auto cmp_stmt_buffer = dbb->getEncodedOdsVersion() >= ODS_13_1 ?
-		allocBuffer(tdbb, pool, rel_mon_compiled_statements) :
-		nullptr;
-	const auto stmt_buffer = allocBuffer(tdbb, pool, rel_mon_statements);
-	const auto call_buffer = allocBuffer(tdbb, pool, rel_mon_calls);
-	const auto io_stat_buffer = allocBuffer(tdbb, pool, rel_mon_io_stats);
-	const auto rec_stat_buffer = allocBuffer(tdbb, pool, rel_mon_rec_stats);
-	const auto ctx_var_buffer = allocBuffer(tdbb, pool, rel_mon_ctx_vars);
-	const auto mem_usage_buffer = allocBuffer(tdbb, pool, rel_mon_mem_usage);
-	const auto tab_stat_buffer = allocBuffer(tdbb, pool, rel_mon_tab_stats);
-	const auto local_temp_tables_buffer = allocBuffer(tdbb, pool, rel_mon_local_temp_tables);
-	const auto local_temp_table_columns_buffer = allocBuffer(tdbb, pool, rel_mon_local_temp_table_columns);
+	allocBuffer(tdbb, pool, rel_mon_database);
+	allocBuffer(tdbb, pool, rel_mon_attachments);
+	allocBuffer(tdbb, pool, rel_mon_transactions);
+	if (dbb->getEncodedOdsVersion() >= ODS_13_1)
+		allocBuffer(tdbb, pool, rel_mon_compiled_statements);
+	allocBuffer(tdbb, pool, rel_mon_statements);
+	allocBuffer(tdbb, pool, rel_mon_calls);
+	allocBuffer(tdbb, pool, rel_mon_io_stats);
+	allocBuffer(tdbb, pool, rel_mon_rec_stats);
+	allocBuffer(tdbb, pool, rel_mon_ctx_vars);
+	allocBuffer(tdbb, pool, rel_mon_mem_usage);
+	allocBuffer(tdbb, pool, rel_mon_tab_stats);
+	allocBuffer(tdbb, pool, rel_mon_local_temp_tables);
+	allocBuffer(tdbb, pool, rel_mon_local_temp_table_columns);
 
 	// Increment the global monitor generation
 
@@ -482,6 +516,8 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 
 	// Enumerate active sessions and ensure they have dumped their state.
 	// Check that by comparing the session generation with the current one.
+	// Sessions that have their monitoring lock downgraded are not enumerated,
+	// they didn't change their state since they dumped it for the last time.
 
 	const auto locksmith = attachment->locksmith(tdbb, MONITOR_ANY_ATTACHMENT);
 	const auto userName = attachment->getEffectiveUserName();
@@ -535,112 +571,87 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 	// Collect monitoring data. Start by gathering database-level info,
 	// it goes directly to the temporary space (as it's not stored in the shared dump).
 
-	TempSpace temp_space(pool, SCRATCH);
-
 	{ // scope for putDatabase and its utilities
 
-		TempWriter writer(temp_space);
+		TempWriter writer(m_dump);
 		SnapshotData::DumpRecord tempRecord(pool, writer);
 
 		Monitoring::putDatabase(tdbb, tempRecord);
 	}
 
-	// Read the dump into a temporary space
+	// Read the dump into a temporary space. It's parsed later,
+	// see loadData().
 
 	{ // scope for the guard
 
 		MonitoringData::Guard guard(dbb->dbb_monitoring_data);
-		dbb->dbb_monitoring_data->read(userNamePtr, temp_space);
+		dbb->dbb_monitoring_data->read(userNamePtr, m_dump);
 	}
+}
+
+
+RecordBuffer* MonitoringSnapshot::loadData(thread_db* tdbb, const RelationPermanent* relation)
+{
+	fb_assert(relation);
+
+	const int relId = relation->getId();
 
-	// Parse the dump
+	if (!m_loaded.exist(relId))
+	{
+		// The code below requires that rel_mon_compiled_statements is loaded
+		// before rel_mon_statements, see also dumpAttachment()
 
-	// BlobID's of statement text and plan
-	struct StmtBlobs { bid text; bid plan; };
+		if (relId == rel_mon_statements && getData(rel_mon_compiled_statements) &&
+			!m_loaded.exist(rel_mon_compiled_statements))
+		{
+			load(tdbb, rel_mon_compiled_statements);
+			m_loaded.add(rel_mon_compiled_statements);
+		}
 
-	// Map compiled statement id to blobs ids
-	NonPooledMap<FB_UINT64, StmtBlobs> blobsMap(pool);
+		load(tdbb, relId);
+		m_loaded.add(relId);
+	}
 
-	MonitoringData::Reader reader(pool, temp_space);
+	return getData(relId);
+}
+
+
+void MonitoringSnapshot::load(thread_db* tdbb, int relId)
+{
+	const auto dbb = tdbb->getDatabase();
+	auto& pool = *tdbb->getTransaction()->tra_pool;
+
+	const auto buffer = getData(relId);
+	fb_assert(buffer);
+
+	// Parse the dump, picking up the records of the given relation only
+
+	MonitoringData::Reader reader(pool, m_dump);
 
 	SnapshotData::DumpRecord dumpRecord(pool);
 	while (reader.getRecord(dumpRecord))
 	{
 		const int rid = dumpRecord.getRelationId();
 
-		RecordBuffer* buffer = nullptr;
-		Record* record = nullptr;
-
-		switch (rid)
-		{
-		case rel_mon_database:
-			buffer = dbb_buffer;
-			break;
-		case rel_mon_attachments:
-			buffer = att_buffer;
-			break;
-		case rel_mon_transactions:
-			buffer = tra_buffer;
-			break;
-		case rel_mon_compiled_statements:
-			buffer = cmp_stmt_buffer;
-			break;
-		case rel_mon_statements:
-			buffer = stmt_buffer;
-			break;
-		case rel_mon_calls:
-			buffer = call_buffer;
-			break;
-		case rel_mon_io_stats:
-			buffer = io_stat_buffer;
-			break;
-		case rel_mon_rec_stats:
-			buffer = rec_stat_buffer;
-			break;
-		case rel_mon_ctx_vars:
-			buffer = ctx_var_buffer;
-			break;
-		case rel_mon_mem_usage:
-			buffer = mem_usage_buffer;
-			break;
-		case rel_mon_tab_stats:
-			buffer = tab_stat_buffer;
-			break;
-		case rel_mon_local_temp_tables:
-			buffer = local_temp_tables_buffer;
-			break;
-		case rel_mon_local_temp_table_columns:
-			buffer = local_temp_table_columns_buffer;
-			break;
-		default:
-			fb_assert(false);
-		}
+		if (rid != relId)
+			continue;
 
-		if (buffer)
-		{
-			record = buffer->getTempRecord();
-			record->nullify();
-		}
+		Record* const record = buffer->getTempRecord();
+		record->nullify();
 
 		bool store_record = false;
 
 		SnapshotData::DumpField dumpField;
 		while (dumpRecord.getField(dumpField))
 		{
-			if (record)
-			{
-				putField(tdbb, record, dumpField);
-				store_record = true;
-			}
+			putField(tdbb, record, dumpField);
+			store_record = true;
 		}
 
 		if (store_record)
 		{
 			if (dbb->getEncodedOdsVersion() >= ODS_13_1)
 			{
-				// The code below requires that rel_mon_compiled_statements put
-				// into dump before	rel_mon_statements, see also dumpAttachment()
-
 				FB_UINT64 stmtId;
 				StmtBlobs stmtBlobs;
 				dsc desc;
@@ -667,14 +678,14 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 						stmtBlobs.plan.clear();
 
 					if (!stmtBlobs.text.isEmpty() || !stmtBlobs.plan.isEmpty())
-						blobsMap.put(stmtId, stmtBlobs);
+						m_blobsMap.put(stmtId, stmtBlobs);
 				}
 				else if ((rid == rel_mon_statements) && EVL_field(nullptr, record, f_mon_stmt_cmp_stmt_id, &desc))
 				{
 					fb_assert(desc.dsc_dtype == dtype_int64);
 					stmtId = *(FB_UINT64*) desc.dsc_address;
 
-					if (blobsMap.get(stmtId, stmtBlobs))
+					if (m_blobsMap.get(stmtId, stmtBlobs))
 					{
 						if (!stmtBlobs.text.isEmpty())
 						{
@@ -1668,13 +1679,26 @@ void Monitoring::checkState(thread_db* tdbb)
 
 	if (attachment->att_flags & ATT_monitor_disabled)
 	{
-		// Enable signal handler for the monitoring stuff
+		// Enable signal handler for the monitoring stuff.
+		// From now on our dump may become outdated, so let others ping us.
 		attachment->att_flags &= ~ATT_monitor_disabled;
+		setDowngraded(tdbb, attachment, false);
 		LCK_convert(tdbb, attachment->att_monitor_lock, LCK_EX, LCK_WAIT);
 	}
 }
 
 
+void Monitoring::setDowngraded(thread_db* tdbb, Attachment* attachment, bool downgraded)
+{
+	const auto dbb = tdbb->getDatabase();
+
+	fb_assert(dbb->dbb_monitoring_data);
+
+	MonitoringData::Guard guard(dbb->dbb_monitoring_data);
+	dbb->dbb_monitoring_data->setDowngraded(attachment->att_attachment_id, downgraded);
+}
+
+
 void Monitoring::dumpAttachment(thread_db* tdbb, Attachment* attachment, ULONG generation)
 {
 	if (!attachment->att_user)
@@ -267,17 +267,23 @@ struct MonitoringHeader : public Firebird::MemoryHeader
 
 class MonitoringData final : public Firebird::PermanentStorage, public Firebird::IpcObject
 {
-	static constexpr USHORT MONITOR_VERSION = 6;
+	static constexpr USHORT MONITOR_VERSION = 7;
 	static constexpr ULONG DEFAULT_SIZE = 1048576;
 
 	typedef MonitoringHeader Header;
 
+	// The session's monitoring lock is downgraded, so its dump stays actual
+	// until the session gets the lock back and there's no need to ping it
+	static constexpr ULONG ELEMENT_DOWNGRADED = 1;
+
 	struct Element
 	{
 		AttNumber attId;
 		TEXT userName[USERNAME_LENGTH + 1];
 		ULONG generation;
 		ULONG length;
+		SLONG processId;
+		ULONG flags;
 
 		inline ULONG getBlockLength() const
 		{
@@ -364,6 +370,7 @@ public:
 	void read(const char*, TempSpace&);
 	ULONG setup(AttNumber, const char*, ULONG);
 	void write(ULONG, ULONG, const void*);
+	void setDowngraded(AttNumber, bool);
 
 	void cleanup(AttNumber);
 
@@ -393,11 +400,26 @@ protected:
 
 class MonitoringSnapshot final : public SnapshotData
 {
+	// BlobID's of statement text and plan
+	struct StmtBlobs { bid text; bid plan; };
+
 public:
 	static MonitoringSnapshot* create(thread_db* tdbb);
 
+	RecordBuffer* loadData(thread_db* tdbb, const RelationPermanent* relation);
+
 protected:
 	MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool);
+
+private:
+	void load(thread_db* tdbb, int relId);
+
+	// The dump is kept as is and parsed into the record buffer
+	// only when the corresponding table is actually accessed
+	TempSpace m_dump;
+	Firebird::SortedArray<int> m_loaded;
+	// Map compiled statement id to blobs ids
+	Firebird::NonPooledMap<FB_UINT64, StmtBlobs> m_blobsMap;
 };
 
 
@@ -420,6 +442,8 @@ public:
 
 	static void dumpAttachment(thread_db* tdbb, Attachment* attachment, ULONG generation);
 
+	static void setDowngraded(thread_db* tdbb, Attachment* attachment, bool downgraded);
+
 	static void publishAttachment(thread_db* tdbb);
 	static void cleanupAttachment(thread_db* tdbb);
 
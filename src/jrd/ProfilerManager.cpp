@@ -36,6 +36,8 @@
 #include "../jrd/pag_proto.h"
 #include "../jrd/tra_proto.h"
 #include "../jrd/Statement.h"
+#include "../common/classes/semaphore.h"
+#include "../common/config/config.h"
 #include <variant>
 
 using namespace Jrd;
@@ -174,6 +176,82 @@ namespace
 
 		return checkResponseIsNotException(chatClient.sendAndReceive(in, udleFunc));
 	}
+
+	// Advances ProfilerManager::sampleClock while there are sampling sessions in the process
+
+	class SampleTicker
+	{
+	public:
+		explicit SampleTicker(MemoryPool&)
+			: sessions(0), started(false), shutdown(false)
+		{}
+
+		~SampleTicker()
+		{
+			if (started)
+			{
+				shutdown = true;
+				wakeup.release();
+				thread.waitForCompletion();
+			}
+		}
+
+		void addSession()
+		{
+			MutexLockGuard guard(mutex, FB_FUNCTION);
+
+			if (sessions++)
+				return;
+
+			if (!started)
+			{
+				Thread::start(tickerThread, this, THREAD_high, &thread);
+				started = true;
+			}
+			else
+				wakeup.release();
+		}
+
+		void removeSession()
+		{
+			MutexLockGuard guard(mutex, FB_FUNCTION);
+
+			fb_assert(sessions);
+			--sessions;
+		}
+
+	private:
+		static THREAD_ENTRY_DECLARE tickerThread(THREAD_ENTRY_PARAM arg)
+		{
+			static_cast<SampleTicker*>(arg)->run();
+			return 0;
+		}
+
+		void run()
+		{
+			const int interval = Config::getProfilerSamplingInterval();
+
+			while (!shutdown)
+			{
+				if (sessions)
+				{
+					wakeup.tryEnter(0, interval);
+					++ProfilerManager::sampleClock;
+				}
+				else
+					wakeup.enter();
+			}
+		}
+
+		Mutex mutex;
+		Semaphore wakeup;
+		Thread thread;
+		std::atomic<unsigned> sessions;
+		bool started;
+		volatile bool shutdown;
+	};
+
+	GlobalPtr<SampleTicker, InstanceControl::PRIORITY_DELETE_FIRST> sampleTicker;
 }
 
 
@@ -381,7 +459,8 @@ void ProfilerPackage::startSessionFunction(ThrowStatusExceptionWrapper* /*status
 
 
 ProfilerManager::ProfilerManager(thread_db* tdbb)
-	: activePlugins(*tdbb->getAttachment()->att_pool)
+	: activePlugins(*tdbb->getAttachment()->att_pool),
+	  sampleStack(*tdbb->getAttachment()->att_pool)
 {
 	const auto attachment = tdbb->getAttachment();
 
@@ -399,6 +478,9 @@ ProfilerManager::ProfilerManager(thread_db* tdbb)
 ProfilerManager::~ProfilerManager()
 {
 	flushTimer->stop();
+
+	if (samplingStarted)
+		sampleTicker->removeSession();
 }
 
 ProfilerManager* ProfilerManager::create(thread_db* tdbb)
@@ -448,6 +530,7 @@ SINT64 ProfilerManager::startSession(thread_db* tdbb, std::optional<SLONG> flush
 	{
 		currentSession->pluginSession->finish(&status, timestamp);
 		currentSession = nullptr;
+		updateSampling();
 	}
 
 	auto pluginPtr = activePlugins.get(pluginName);
@@ -491,6 +574,8 @@ SINT64 ProfilerManager::startSession(thread_db* tdbb, std::optional<SLONG> flush
 	currentSession->plugin = std::move(plugin);
 	currentSession->flags = currentSession->pluginSession->getFlags();
 
+	updateSampling();
+
 	paused = false;
 
 	if (flushInterval.has_value())
@@ -584,6 +669,7 @@ void ProfilerManager::cancelSession()
 
 		currentSession->pluginSession->cancel(&status);
 		currentSession = nullptr;
+		updateSampling();
 	}
 }
 
@@ -597,6 +683,7 @@ void ProfilerManager::finishSession(thread_db* tdbb, bool flushData)
 
 		currentSession->pluginSession->finish(&status, timestamp);
 		currentSession = nullptr;
+		updateSampling();
 	}
 
 	if (flushData)
@@ -634,6 +721,7 @@ void ProfilerManager::discard()
 {
 	currentSession = nullptr;
 	activePlugins.clear();
+	updateSampling();
 }
 
 void ProfilerManager::flush(bool updateTimer)
@@ -669,6 +757,48 @@ void ProfilerManager::updateFlushTimer(bool canStopTimer)
 		flushTimer->stop();
 }
 
+void ProfilerManager::updateSampling()
+{
+	const bool sampling = currentSession && isSampling();
+
+	if (sampling == samplingStarted)
+		return;
+
+	if (sampling)
+	{
+		sampleTicks = fb_utils::query_performance_frequency() * Config::getProfilerSamplingInterval() / 1000;
+		syncSampleClock();
+		sampleTicker->addSession();
+	}
+	else
+		sampleTicker->removeSession();
+
+	samplingStarted = sampling;
+}
+
+void ProfilerManager::takeSample(Request* request)
+{
+	syncSampleClock();
+
+	Stats stats(sampleTicks);
+
+	// The request is executed on behalf of its callers, count their current lines too
+
+	for (auto caller = request; caller; caller = caller->req_caller)
+	{
+		if (caller->req_src_line && !caller->hasInternalStatement())
+			afterPsqlLineColumn(caller, caller->req_src_line, caller->req_src_column, stats);
+	}
+
+	for (const auto& frame : sampleStack)
+	{
+		if (frame.open)
+			afterRecordSourceOpen(frame.request, frame.recordSource, stats);
+		else
+			afterRecordSourceGetRecord(frame.request, frame.recordSource, stats);
+	}
+}
+
 ProfilerManager::Statement* ProfilerManager::getStatement(Request* request)
 {
 	if (!isActive())
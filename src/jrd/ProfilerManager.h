@@ -25,6 +25,7 @@
 
 #include "firebird.h"
 #include "firebird/Message.h"
+#include <atomic>
 #include <optional>
 #include "../common/PerformanceStopWatch.h"
 #include "../common/classes/auto.h"
@@ -93,7 +94,12 @@ public:
 			  recordSource(recordSource),
 			  event(aEvent)
 		{
-			if (profilerManager)
+			if (profilerManager && profilerManager->isSampling())
+			{
+				sampling = true;
+				profilerManager->enterRecordSource(request, recordSource, event == Event::OPEN);
+			}
+			else if (profilerManager)
 			{
 				lastTicks = profilerManager->queryTicks();
 
@@ -111,7 +117,9 @@ public:
 
 		~RecordSourceStopWatcher()
 		{
-			if (profilerManager)
+			if (sampling)
+				profilerManager->leaveRecordSource();
+			else if (profilerManager)
 			{
 				const SINT64 currentTicks = profilerManager->queryTicks();
 				const SINT64 elapsedTicks = profilerManager->getElapsedTicksAndAdjustOverhead(
@@ -132,6 +140,7 @@ public:
 		SINT64 lastTicks = 0;
 		SINT64 lastAccumulatedOverhead = 0;
 		Event event;
+		bool sampling = false;
 	};
 
 private:
@@ -173,6 +182,14 @@ private:
 		unsigned flags = 0;
 	};
 
+	// Record source being opened or fetched, for the sampling mode
+	struct SampleFrame
+	{
+		Request* request;
+		const AccessPath* recordSource;
+		bool open;
+	};
+
 private:
 	ProfilerManager(thread_db* tdbb);
 
@@ -194,6 +211,45 @@ public:
 	void prepareCursor(thread_db* tdbb, Request* request, const Select* select);
 	void onRequestFinish(Request* request, Stats& stats);
 
+	// In the sampling mode, execution is not measured. Instead, the clock below is
+	// advanced periodically and the executing request checks it at the same points
+	// where the events are sent. If the clock is changed, the current PSQL lines of
+	// the request with its callers and the record sources being executed are counted
+	// as if they spent the sampling interval.
+
+	static inline std::atomic<ULONG> sampleClock{0};
+
+	bool isSampling() const
+	{
+		return currentSession->flags & Firebird::IProfilerSession::FLAG_SAMPLING;
+	}
+
+	bool isSamplePending() const
+	{
+		return sampleClock.load(std::memory_order_relaxed) != lastSampleClock;
+	}
+
+	void syncSampleClock()
+	{
+		lastSampleClock = sampleClock.load(std::memory_order_relaxed);
+	}
+
+	void takeSample(Request* request);
+
+	void enterRecordSource(Request* request, const AccessPath* recordSource, bool open)
+	{
+		sampleStack.push({request, recordSource, open});
+
+		if (isSamplePending())
+			takeSample(request);
+	}
+
+	void leaveRecordSource()
+	{
+		if (sampleStack.hasData())
+			sampleStack.pop();
+	}
+
 	void beforePsqlLineColumn(Request* request, ULONG line, ULONG column)
 	{
 		if (const auto profileRequestId = getRequest(request, Firebird::IProfilerSession::FLAG_BEFORE_EVENTS))
@@ -302,6 +358,7 @@ private:
 	void flush(bool updateTimer = true);
 
 	void updateFlushTimer(bool canStopTimer = true);
+	void updateSampling();
 
 	Statement* getStatement(Request* request);
 
@@ -347,6 +404,10 @@ private:
 	Firebird::RefPtr<Firebird::TimerImpl> flushTimer;
 	unsigned currentFlushInterval = 0;
 	bool paused = false;
+	Firebird::HalfStaticArray<SampleFrame, 16> sampleStack;
+	ULONG lastSampleClock = 0;
+	SINT64 sampleTicks = 0;
+	bool samplingStarted = false;
 };
 
 
@@ -752,7 +752,7 @@ Lock* RelationPermanent::createLock(thread_db* tdbb, MemoryPool& pool, lck_t lck
 	const USHORT relLockLen = getRelLockKeyLength();
 
 	Lock* lock = FB_NEW_RPT(pool, relLockLen)
-		Lock(tdbb, relLockLen, lckType, lckType == LCK_relation ? (void*)this : (void*)&rel_gc_lock);
+		Lock(tdbb, relLockLen, lckType, lckType == LCK_rel_gc ? (void*)&rel_gc_lock : (void*)this);
 	getRelLockKey(tdbb, lock->getKeyPtr());
 
 	lock->lck_type = lckType;
@@ -765,6 +765,10 @@ Lock* RelationPermanent::createLock(thread_db* tdbb, MemoryPool& pool, lck_t lck
 		lock->lck_ast = noAst ? nullptr : GCLock::ast;
 		break;
 
+	case LCK_rel_scan:
+		// ScanLock sets the AST itself
+		break;
+
 	default:
 		fb_assert(false);
 	}
@@ -1038,6 +1042,133 @@ void GCLock::enable(thread_db* tdbb, Lock* tempLock)
 }
 
 
+/// ScanLock
+
+ScanLock::ScanLock(thread_db* tdbb, RelationPermanent* relation)
+	: scanLck(nullptr), scanCount(0), scanBlocking(false)
+{
+	scanLck = relation->createLock(tdbb, *tdbb->getAttachment()->att_pool, LCK_rel_scan, true);
+	scanLck->lck_object = this;
+	scanLck->lck_ast = ast;
+}
+
+ScanLock::~ScanLock()
+{
+	delete scanLck;
+}
+
+bool ScanLock::needLock(const RelationPermanent* relation)
+{
+	// Tables that can't be truncated
+	return !(relation->isSystem() || relation->isTemporary() || relation->isLTT() ||
+		relation->isVirtual());
+}
+
+void ScanLock::enter(thread_db* tdbb, RelationPermanent* relation)
+{
+	if (!needLock(relation))
+		return;
+
+	Attachment* const attachment = tdbb->getAttachment();
+
+	ScanLock* scanLock = nullptr;
+	if (!attachment->att_scan_locks.get(relation->getId(), scanLock))
+	{
+		scanLock = FB_NEW_POOL(*attachment->att_pool) ScanLock(tdbb, relation);
+		attachment->att_scan_locks.put(relation->getId(), scanLock);
+	}
+
+	MutexLockGuard guard(scanLock->scanMutex, FB_FUNCTION);
+
+	// The lock is not granted, therefore its AST can't wait for the mutex meanwhile
+	if (!scanLock->scanLck->lck_id)
+	{
+		const jrd_tra* const transaction = tdbb->getTransaction();
+		const SSHORT wait = transaction ? transaction->getLockWait() : LCK_WAIT;
+
+		if (!LCK_lock(tdbb, scanLock->scanLck, LCK_PR, wait))
+			ERR_punt();
+	}
+
+	scanLock->scanCount++;
+}
+
+void ScanLock::leave(thread_db* tdbb, RelationPermanent* relation)
+{
+	if (!needLock(relation))
+		return;
+
+	ScanLock* scanLock = nullptr;
+	if (!tdbb->getAttachment()->att_scan_locks.get(relation->getId(), scanLock))
+	{
+		fb_assert(false);
+		return;
+	}
+
+	MutexLockGuard guard(scanLock->scanMutex, FB_FUNCTION);
+
+	fb_assert(scanLock->scanCount);
+	if (!--scanLock->scanCount && scanLock->scanBlocking)
+	{
+		scanLock->scanBlocking = false;
+		LCK_release(tdbb, scanLock->scanLck);
+	}
+}
+
+void ScanLock::release(thread_db* tdbb)
+{
+	MutexLockGuard guard(scanMutex, FB_FUNCTION);
+
+	scanBlocking = false;
+	LCK_release(tdbb, scanLck);
+}
+
+void ScanLock::blockingAst()
+{
+	AsyncContextHolder tdbb(scanLck->lck_dbb, FB_FUNCTION, scanLck);
+
+	MutexLockGuard guard(scanMutex, FB_FUNCTION);
+
+	// Truncation waits till the last stream of the table is closed
+
+	if (scanCount)
+		scanBlocking = true;
+	else
+		LCK_release(tdbb, scanLck);
+}
+
+bool ScanLock::Exclusive::acquire(int wait)
+{
+	fb_assert(!m_lock);
+
+	if (!needLock(m_rl))
+		return true;
+
+	// Lock cached by our own attachment would conflict with the exclusive one
+
+	ScanLock* ownLock = nullptr;
+	if (m_tdbb->getAttachment()->att_scan_locks.get(m_rl->getId(), ownLock))
+	{
+		if (ownLock->scanCount)
+			return false;
+
+		ownLock->release(m_tdbb);
+	}
+
+	m_lock = m_rl->createLock(m_tdbb, LCK_rel_scan, true);
+
+	ThreadStatusGuard temp_status(m_tdbb);
+
+	return LCK_lock(m_tdbb, m_lock, LCK_EX, wait);
+}
+
+void ScanLock::Exclusive::release()
+{
+	if (m_lock && m_lock->lck_id)
+		LCK_release(m_tdbb, m_lock);
+}
+
+
 /// RelationPages
 
 void RelationPages::free(RelationPages*& nextFree)
@@ -1055,6 +1186,7 @@ void RelationPages::free(RelationPages*& nextFree)
 
 	dpMap.clear();
 	dpMapMark = 0;
+	rightLeafMap.clear();
 }
 
 
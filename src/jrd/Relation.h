@@ -334,7 +334,8 @@ public:
 		  rel_last_free_pri_dp(0), rel_last_free_blb_dp(0),
 		  rel_pg_space_id(DB_PAGE_SPACE), rel_next_free(NULL),
 		  dpMap(pool),
-		  dpMapMark(0)
+		  dpMapMark(0),
+		  rightLeafMap(pool)
 	{}
 
 	inline SLONG addRef() noexcept
@@ -388,6 +389,14 @@ public:
 		}
 	}
 
+	void clearDPNumbers()
+	{
+		Firebird::MutexLockGuard g(dpMutex, FB_FUNCTION);
+
+		dpMap.clear();
+		dpMapMark = 0;
+	}
+
 	void freeOldestMapItems() noexcept
 	{
 		Firebird::MutexLockGuard g(dpMutex, FB_FUNCTION);
@@ -415,6 +424,48 @@ public:
 		dpMapMark -= minMark;
 	}
 
+	// The rightmost leaf page of the index known by the previous insertion.
+	// It's still the rightmost one while its parent page keeps the incarnation.
+	struct RightLeaf
+	{
+		ULONG root;					// index root page the hint belongs to
+		ULONG leaf;
+		ULONG parent;
+		ULONG parentIncarnation;
+	};
+
+	bool getRightLeaf(USHORT indexId, RightLeaf& hint)
+	{
+		Firebird::MutexLockGuard g(rightLeafMutex, FB_FUNCTION);
+
+		FB_SIZE_T pos;
+		if (!rightLeafMap.find(indexId, pos))
+			return false;
+
+		hint = rightLeafMap[pos].hint;
+		return true;
+	}
+
+	void setRightLeaf(USHORT indexId, const RightLeaf& hint)
+	{
+		Firebird::MutexLockGuard g(rightLeafMutex, FB_FUNCTION);
+
+		FB_SIZE_T pos;
+		if (rightLeafMap.find(indexId, pos))
+			rightLeafMap[pos].hint = hint;
+		else
+			rightLeafMap.insert(pos, {indexId, hint});
+	}
+
+	void resetRightLeaf(USHORT indexId)
+	{
+		Firebird::MutexLockGuard g(rightLeafMutex, FB_FUNCTION);
+
+		FB_SIZE_T pos;
+		if (rightLeafMap.find(indexId, pos))
+			rightLeafMap.remove(pos);
+	}
+
 private:
 	RelationPages*		rel_next_free;
 	std::atomic<SLONG>	useCount = 0;
@@ -437,6 +488,20 @@ private:
 	ULONG				dpMapMark;
 	Firebird::Mutex		dpMutex;
 
+	struct RightLeafItem
+	{
+		USHORT indexId;
+		RightLeaf hint;
+
+		static USHORT generate(const RightLeafItem& item) noexcept
+		{
+			return item.indexId;
+		}
+	};
+
+	Firebird::SortedArray<RightLeafItem, Firebird::InlineStorage<RightLeafItem, 8>, USHORT, RightLeafItem> rightLeafMap;
+	Firebird::Mutex		rightLeafMutex;
+
 friend class RelationPermanent;
 };
 
@@ -826,6 +891,66 @@ private:
 };
 
 
+// Lock that record streams of an attachment hold on a table from open till close.
+// TRUNCATE TABLE takes it exclusively while pages of the table are released. Waits
+// are done by the lock manager, thus deadlocks with other locks are detected.
+// The lock is kept when the last stream is closed and released on demand.
+
+class ScanLock
+{
+public:
+	ScanLock(thread_db* tdbb, RelationPermanent* relation);
+	~ScanLock();
+
+	static void enter(thread_db* tdbb, RelationPermanent* relation);
+	static void leave(thread_db* tdbb, RelationPermanent* relation);
+
+	void release(thread_db* tdbb);
+
+	static int ast(void* self)
+	{
+		try
+		{
+			reinterpret_cast<ScanLock*>(self)->blockingAst();
+		}
+		catch(const Firebird::Exception&) { }
+
+		return 0;
+	}
+
+	class Exclusive
+	{
+	public:
+		Exclusive(thread_db* tdbb, RelationPermanent* rl)
+			: m_tdbb(tdbb), m_rl(rl), m_lock(nullptr)
+		{ }
+
+		~Exclusive()
+		{
+			release();
+			delete m_lock;
+		}
+
+		bool acquire(int wait);
+		void release();
+
+	private:
+		thread_db*		m_tdbb;
+		RelationPermanent*		m_rl;
+		Lock*			m_lock;
+	};
+
+private:
+	static bool needLock(const RelationPermanent* relation);
+	void blockingAst();
+
+	Firebird::Mutex scanMutex;
+	Lock* scanLck;
+	unsigned scanCount;
+	bool scanBlocking;
+};
+
+
 // Non-versioned part of relation in cache
 
 class RelationPermanent : public Firebird::PermanentStorage
@@ -27,6 +27,7 @@
 #include "../jrd/RuntimeStatistics.h"
 #include "../jrd/ntrace.h"
 #include "../jrd/met.h"
+#include "../common/utils_proto.h"
 
 using namespace Firebird;
 
@@ -143,4 +144,24 @@ RuntimeStatistics::Accumulator::~Accumulator()
 		m_tdbb->bumpStats(m_type, m_id, m_counter);
 }
 
+RuntimeStatistics::WaitTimer::WaitTimer(thread_db* tdbb, const WaitStatType timeType,
+										const WaitStatType countType)
+	: m_tdbb(tdbb), m_timeType(timeType), m_countType(countType),
+	  m_start(fb_utils::query_performance_counter())
+{}
+
+void RuntimeStatistics::WaitTimer::stop()
+{
+	if (!m_start)
+		return;
+
+	const SINT64 ticks = fb_utils::query_performance_counter() - m_start;
+	m_start = 0;
+
+	m_tdbb->bumpStats(m_timeType, fb_utils::ticks_to_microseconds(ticks));
+
+	if (m_countType != WaitStatType::TOTAL_ITEMS)
+		m_tdbb->bumpStats(m_countType);
+}
+
 } // namespace
@@ -73,10 +73,24 @@ enum class RecordStatType
 	TOTAL_ITEMS
 };
 
+// Time is measured in microseconds
+
+enum class WaitStatType
+{
+	LOCK_WAITS = 0,
+	LOCK_TIME,
+	LATCH_WAITS,
+	LATCH_TIME,
+	READ_TIME,
+	WRITE_TIME,
+	TOTAL_ITEMS
+};
+
 class RuntimeStatistics : protected Firebird::AutoStorage
 {
 	static constexpr size_t PAGE_TOTAL_ITEMS = static_cast<size_t>(PageStatType::TOTAL_ITEMS);
 	static constexpr size_t RECORD_TOTAL_ITEMS = static_cast<size_t>(RecordStatType::TOTAL_ITEMS);
+	static constexpr size_t WAIT_TOTAL_ITEMS = static_cast<size_t>(WaitStatType::TOTAL_ITEMS);
 
 public:
 	// Number of globally counted items.
@@ -90,7 +104,9 @@ public:
 	//			So far I leave everything as is but it can be reconsidered in the future.
 	//			sumValue() method is already in place for that purpose.
 	//
-	static constexpr size_t GLOBAL_ITEMS = PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS;
+	// Wait counters are global only, they're not grouped per page space or table.
+	//
+	static constexpr size_t GLOBAL_ITEMS = PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS + WAIT_TOTAL_ITEMS;
 
 private:
 	template <typename T> class CountsVector
@@ -396,6 +412,19 @@ public:
 		}
 	}
 
+	const SINT64& operator[](const WaitStatType type) const
+	{
+		const auto index = static_cast<size_t>(type);
+		return values[PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS + index];
+	}
+
+	void bumpValue(const WaitStatType type, SINT64 delta = 1)
+	{
+		++allChgNumber;
+		const auto index = static_cast<size_t>(type);
+		values[PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS + index] += delta;
+	}
+
 	// Calculate difference between counts stored in this object and current
 	// counts of given request. Counts stored in object are destroyed.
 	void setToDiff(const RuntimeStatistics& newStats);
@@ -459,6 +488,29 @@ public:
 		SINT64 m_counter = 0;
 	};
 
+	// Measures the wait between construction and stop() (or destruction)
+	// and accounts its time and, optionally, the number of waits
+
+	class WaitTimer
+	{
+	public:
+		WaitTimer(thread_db* tdbb, const WaitStatType timeType,
+				  const WaitStatType countType = WaitStatType::TOTAL_ITEMS);
+
+		~WaitTimer()
+		{
+			stop();
+		}
+
+		void stop();
+
+	private:
+		thread_db* const m_tdbb;
+		const WaitStatType m_timeType;
+		const WaitStatType m_countType;
+		SINT64 m_start;
+	};
+
 	const PageCounters& getPageCounters() const
 	{
 		return pageCounters;
@@ -413,6 +413,8 @@ constexpr char
 	PARALLEL_WORKERS[] = "PARALLEL_WORKERS",
 	DECFLOAT_ROUND[] = "DECFLOAT_ROUND",
 	DECFLOAT_TRAPS[] = "DECFLOAT_TRAPS",
+	TIP_CACHE_HITS[] = "TIP_CACHE_HITS",
+	TIP_CACHE_MISSES[] = "TIP_CACHE_MISSES",
 	// SYSTEM namespace: transaction wise items
 	TRANSACTION_ID_NAME[] = "TRANSACTION_ID",
 	ISOLATION_LEVEL_NAME[] = "ISOLATION_LEVEL",
@@ -4758,6 +4760,16 @@ dsc* evlGetContext(thread_db* tdbb, const SysFunction*, const NestValueArray& ar
 			resultStr.printf("%" ULONGFORMAT, attachment->getIdleTimeout());
 		else if (nameStr == STATEMENT_TIMEOUT)
 			resultStr.printf("%" ULONGFORMAT, attachment->getStatementTimeout());
+		else if (nameStr == TIP_CACHE_HITS)
+		{
+			const TipStateCache* const stateCache = attachment->att_tip_state_cache;
+			resultStr.printf("%" UQUADFORMAT, stateCache ? stateCache->getHits() : 0);
+		}
+		else if (nameStr == TIP_CACHE_MISSES)
+		{
+			const TipStateCache* const stateCache = attachment->att_tip_state_cache;
+			resultStr.printf("%" UQUADFORMAT, stateCache ? stateCache->getMisses() : 0);
+		}
 		else if (nameStr == TRANSACTION_ID_NAME)
 			resultStr.printf("%" SQUADFORMAT, transaction->tra_number);
 		else if (nameStr == ISOLATION_LEVEL_NAME)
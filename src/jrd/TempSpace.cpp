@@ -33,6 +33,10 @@
 
 #include "../jrd/TempSpace.h"
 
+#if !defined(WIN_NT) && defined(HAVE_MMAP)
+#include <sys/mman.h>
+#endif
+
 using namespace Firebird;
 using namespace Jrd;
 
@@ -41,10 +45,13 @@ using namespace Jrd;
 GlobalPtr<Mutex> TempSpace::initMutex;
 TempDirectoryList* TempSpace::tempDirs = NULL;
 FB_SIZE_T TempSpace::minBlockSize = 0;
+bool TempSpace::fileMapping = false;
 
 namespace
 {
 	constexpr size_t MIN_TEMP_BLOCK_SIZE = 64 * 1024;
+	constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+	constexpr size_t MAX_MAPPED_CHUNK_SIZE = 128 * 1024 * 1024;
 
 	class TempCacheLimitGuard
 	{
@@ -105,6 +112,51 @@ FB_SIZE_T TempSpace::MemoryBlock::write(offset_t offset, const void* buffer, FB_
 	return length;
 }
 
+//
+// Huge pages memory block class
+//
+
+TempSpace::HugeMemoryBlock::~HugeMemoryBlock()
+{
+#if !defined(WIN_NT) && defined(HAVE_MMAP)
+	munmap(ptr, size);
+#endif
+	ptr = NULL;
+}
+
+UCHAR* TempSpace::HugeMemoryBlock::allocate(size_t length) noexcept
+{
+#if !defined(WIN_NT) && defined(HAVE_MMAP)
+	if (length % HUGE_PAGE_SIZE)
+		return NULL;
+
+	void* memory = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+	// Explicit huge pages, works only if they are reserved by administrator
+	memory = mmap(NULL, length, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+
+	if (memory == MAP_FAILED)
+	{
+		memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (memory == MAP_FAILED)
+			return NULL;
+
+#ifdef MADV_HUGEPAGE
+		// Ask for transparent huge pages, failure is not critical
+		madvise(memory, length, MADV_HUGEPAGE);
+#endif
+	}
+
+	return static_cast<UCHAR*>(memory);
+#else
+	return NULL;
+#endif
+}
+
 //
 // On-disk block class
 //
@@ -200,7 +252,7 @@ TempSpace::Segment* TempSpace::FreeSegmentBySize::getSegment(FB_SIZE_T size)
 
 TempSpace::TempSpace(MemoryPool& p, const PathName& prefix, bool dynamic)
 		: pool(p), filePrefix(p, prefix),
-		  logicalSize(0), physicalSize(0), localCacheUsage(0),
+		  logicalSize(0), physicalSize(0), localCacheUsage(0), mappedSize(0),
 		  head(NULL), tail(NULL), tempFiles(p),
 		  initialBuffer(p), initiallyDynamic(dynamic),
 		  freeSegments(p), freeSegmentsBySize(p)
@@ -218,6 +270,9 @@ TempSpace::TempSpace(MemoryPool& p, const PathName& prefix, bool dynamic)
 				minBlockSize = MIN_TEMP_BLOCK_SIZE;
 			else
 				minBlockSize = FB_ALIGN(minBlockSize, MIN_TEMP_BLOCK_SIZE);
+
+			// Don't waste address space of 32-bit processes
+			fileMapping = Config::getTempFileMapping() && sizeof(void*) >= sizeof(FB_UINT64);
 		}
 	}
 }
@@ -243,6 +298,9 @@ TempSpace::~TempSpace()
 		dbb->decTempCacheUsage(localCacheUsage);
 	}
 
+	if (mappedSize)
+		pool.releaseMapping(static_cast<size_t>(mappedSize));
+
 	for (bool found = freeSegments.getFirst(); found; found = freeSegments.getNext())
 		delete freeSegments.current();
 
@@ -395,6 +453,7 @@ void TempSpace::extend(FB_SIZE_T size)
 		}
 
 		Block* block = NULL;
+		bool mapped = false;
 
 		{	// scope
 			TempCacheLimitGuard guard(GET_DBB());
@@ -403,8 +462,15 @@ void TempSpace::extend(FB_SIZE_T size)
 			{
 				try
 				{
-					// allocate block in virtual memory
-					block = FB_NEW_POOL(pool) MemoryBlock(FB_NEW_POOL(pool) UCHAR[size], tail, size);
+					// allocate block in virtual memory, prefer huge pages for big blocks
+					if (UCHAR* const memory = HugeMemoryBlock::allocate(size))
+					{
+						block = FB_NEW_POOL(pool) HugeMemoryBlock(memory, tail, size);
+						mapped = true;
+					}
+					else
+						block = FB_NEW_POOL(pool) MemoryBlock(FB_NEW_POOL(pool) UCHAR[size], tail, size);
+
 					localCacheUsage += size;
 					guard.commit();
 				}
@@ -417,17 +483,40 @@ void TempSpace::extend(FB_SIZE_T size)
 
 		if (!block)
 		{
+			if (fileMapping)
+			{
+				// Map the file in chunks growing along with the file itself,
+				// this keeps the number of mappings and blocks in the chain low
+				const offset_t fileSize = originalPhysicalSize - localCacheUsage;
+				const FB_SIZE_T chunk = static_cast<FB_SIZE_T>(
+					FB_ALIGN(MIN(fileSize, MAX_MAPPED_CHUNK_SIZE), minBlockSize));
+
+				if (chunk > size)
+				{
+					physicalSize += chunk - size;
+					size = chunk;
+				}
+			}
+
 			// allocate block in the temp file
 			// Possible error thrown when not enough physical memory
 			TempFile* const file = setupFile(size);
 			fb_assert(file);
-			if (tail && tail->sameFile(file))
+
+			// access the file via memory mapping, if possible
+			block = mapFile(file, size);
+			mapped = (block != NULL);
+
+			if (!block)
 			{
-				fb_assert(!initialSize);
-				tail->size += size;
-				return;
+				if (tail && tail->sameFile(file))
+				{
+					fb_assert(!initialSize);
+					tail->size += size;
+					return;
+				}
+				block = FB_NEW_POOL(pool) FileBlock(file, tail, size);
 			}
-			block = FB_NEW_POOL(pool) FileBlock(file, tail, size);
 		}
 
 		// preserve the initial contents, if any
@@ -443,6 +532,13 @@ void TempSpace::extend(FB_SIZE_T size)
 			head = block;
 		}
 		tail = block;
+
+		// memory mapped directly from OS is not accounted by the pool itself
+		if (mapped)
+		{
+			pool.chargeMapping(size);
+			mappedSize += size;
+		}
 	}
 	catch (...)
 	{
@@ -552,6 +648,34 @@ TempFile* TempSpace::setupFile(FB_SIZE_T size)
 	return NULL; // compiler silencer
 }
 
+//
+// TempSpace::mapFile
+//
+// Creates the block for the just allocated tail of the temporary file
+// mapped into memory. Returns NULL if the mapping is disabled or failed.
+//
+
+TempSpace::Block* TempSpace::mapFile(TempFile* file, FB_SIZE_T size)
+{
+	if (!fileMapping)
+		return NULL;
+
+	UCHAR* const memory = static_cast<UCHAR*>(file->map(file->getSize() - size, size));
+
+	if (!memory)
+		return NULL;
+
+	try
+	{
+		return FB_NEW_POOL(pool) MappedBlock(memory, tail, size);
+	}
+	catch (...)
+	{
+		TempFile::unmap(memory, size);
+		throw;
+	}
+}
+
 //
 // TempSpace::allocateSpace
 //
@@ -665,6 +789,32 @@ UCHAR* TempSpace::inMemory(offset_t begin, size_t size) const
 	return block ? block->inMemory(begin, size) : NULL;
 }
 
+//
+// TempSpace::inFile
+//
+// Return true if any part of the given range is backed by the temporary file,
+// either directly or via memory mapping
+//
+
+bool TempSpace::inFile(offset_t begin, size_t size) const
+{
+	const offset_t end = begin + size;
+	offset_t local_offset = begin;
+	const Block* block = findBlock(local_offset);
+
+	while (block && begin < end)
+	{
+		if (block->inFile())
+			return true;
+
+		begin += block->size - local_offset;
+		local_offset = 0;
+		block = block->next;
+	}
+
+	return false;
+}
+
 //
 // TempSpace::findMemory
 //
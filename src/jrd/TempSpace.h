@@ -53,6 +53,7 @@ public:
 	void releaseSpace(offset_t offset, FB_SIZE_T size);
 
 	UCHAR* inMemory(offset_t offset, size_t size) const;
+	bool inFile(offset_t offset, size_t size) const;
 
 	struct SegmentInMemory
 	{
@@ -89,6 +90,7 @@ private:
 
 		virtual UCHAR* inMemory(offset_t offset, size_t size) const noexcept = 0;
 		virtual bool sameFile(const Firebird::TempFile* file) const noexcept = 0;
+		virtual bool inFile() const noexcept = 0;
 
 		Block *prev;
 		Block *next;
@@ -123,6 +125,11 @@ private:
 			return false;
 		}
 
+		bool inFile() const noexcept override
+		{
+			return false;
+		}
+
 	protected:
 		UCHAR* ptr;
 	};
@@ -140,6 +147,39 @@ private:
 		}
 	};
 
+	// Memory block allocated directly from OS, trying to use huge pages
+	class HugeMemoryBlock : public MemoryBlock
+	{
+	public:
+		HugeMemoryBlock(UCHAR* memory, Block* tail, size_t length) noexcept
+			: MemoryBlock(memory, tail, length)
+		{}
+
+		~HugeMemoryBlock();
+
+		static UCHAR* allocate(size_t length) noexcept;
+	};
+
+	// Part of the temporary file mapped into memory
+	class MappedBlock : public MemoryBlock
+	{
+	public:
+		MappedBlock(UCHAR* memory, Block* tail, size_t length) noexcept
+			: MemoryBlock(memory, tail, length)
+		{}
+
+		~MappedBlock()
+		{
+			Firebird::TempFile::unmap(ptr, size);
+			ptr = NULL;
+		}
+
+		bool inFile() const noexcept override
+		{
+			return true;
+		}
+	};
+
 	class FileBlock : public Block
 	{
 	public:
@@ -168,6 +208,11 @@ private:
 			return (aFile == this->file);
 		}
 
+		bool inFile() const noexcept override
+		{
+			return true;
+		}
+
 	private:
 		Firebird::TempFile* file;
 		offset_t seek;
@@ -175,6 +220,7 @@ private:
 
 	Block* findBlock(offset_t& offset) const;
 	Firebird::TempFile* setupFile(FB_SIZE_T size);
+	Block* mapFile(Firebird::TempFile* file, FB_SIZE_T size);
 
 	UCHAR* findMemory(offset_t& begin, offset_t end, size_t size) const;
 
@@ -221,6 +267,7 @@ private:
 	offset_t logicalSize;
 	offset_t physicalSize;
 	offset_t localCacheUsage;
+	offset_t mappedSize;
 	Block* head;
 	Block* tail;
 	Firebird::Array<Firebird::TempFile*> tempFiles;
@@ -253,6 +300,7 @@ private:
 	static Firebird::GlobalPtr<Firebird::Mutex> initMutex;
 	static Firebird::TempDirectoryList* tempDirs;
 	static FB_SIZE_T minBlockSize;
+	static bool fileMapping;
 };
 
 #endif // JRD_TEMP_SPACE_H
@@ -33,6 +33,16 @@
 using namespace Jrd;
 using namespace Ods;
 
+namespace
+{
+	// Gather four key bytes into integer compared the same way as the bytes
+
+	inline ULONG getHead(const UCHAR* p)
+	{
+		return ((ULONG) p[0] << 24) | ((ULONG) p[1] << 16) | ((ULONG) p[2] << 8) | p[3];
+	}
+}
+
 USHORT IndexNode::computePrefix(const UCHAR* prevString, USHORT prevLength,
 								const UCHAR* string, USHORT length)
 {
@@ -629,3 +639,150 @@ UCHAR* IndexNode::writeNode(UCHAR* pagePointer, bool leafNode, bool withData)
 
 	return pagePointer;
 }
+
+bool BtrSearchIndex::findStartPoint(const btree_page* page, ULONG incarnation,
+									const UCHAR* key, USHORT keyLength, USHORT* offset, USHORT* prefix)
+{
+/**************************************
+ *
+ *	f i n d S t a r t P o i n t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Find the last indexed node less than the key
+ *  and return its offset and the prefix common to
+ *  the key and the node preceding it. Ascending
+ *  keys only.
+ *
+ **************************************/
+	if (!incarnation)
+		return false;
+
+	if (m_incarnation.load(std::memory_order_acquire) != incarnation)
+	{
+		// Page is latched for read by all threads getting here, so
+		// the only concurrent change possible is the build itself
+
+		if (m_building.exchange(true, std::memory_order_acquire))
+			return false;
+
+		if (m_incarnation.load(std::memory_order_relaxed) != incarnation)
+		{
+			build(page);
+			m_incarnation.store(incarnation, std::memory_order_release);
+		}
+
+		m_building.store(false, std::memory_order_release);
+	}
+
+	UCHAR head[HEAD_SIZE];
+	memset(head, 0, sizeof(head));
+	memcpy(head, key, MIN(keyLength, HEAD_SIZE));
+
+	const ULONG keyHigh = getHead(head);
+	const ULONG keyLow = getHead(head + HEAD_SIZE / 2);
+
+	// Count nodes less than the key. Heads are sorted, so
+	// nodes with equal high part follow the lesser ones.
+
+	const ULONG* const high = m_high.begin();
+	const ULONG count = m_high.getCount();
+	ULONG less = 0, equal = 0;
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		less += (high[i] < keyHigh);
+		equal += (high[i] == keyHigh);
+	}
+
+	const ULONG* const low = m_low.begin();
+	ULONG n = less;
+
+	for (ULONG i = less; i < less + equal; i++)
+		n += (low[i] < keyLow);
+
+	if (!n)
+	{
+		*offset = BTR_SIZE + page->btr_jump_size;
+		*prefix = 0;
+		return true;
+	}
+
+	// Node head is less than the key head, so they differ in the first bytes
+
+	const ULONG i = n - 1;
+	const FB_UINT64 diff = ((FB_UINT64) (high[i] ^ keyHigh) << 32) | (low[i] ^ keyLow);
+	fb_assert(diff);
+
+	USHORT common = 0;
+	for (FB_UINT64 mask = FB_CONST64(0xFF00000000000000); !(diff & mask); mask >>= 8)
+		common++;
+
+	common = MIN(common, m_lengths[i]);
+	common = MIN(common, keyLength);
+
+	*offset = m_offsets[i];
+	*prefix = MIN(m_prefixes[i], common);
+
+	return true;
+}
+
+void BtrSearchIndex::build(const btree_page* page)
+{
+/**************************************
+ *
+ *	b u i l d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Index the nodes of the page.
+ *
+ **************************************/
+	m_high.clear();
+	m_low.clear();
+	m_offsets.clear();
+	m_prefixes.clear();
+	m_lengths.clear();
+
+	const bool leafPage = (page->btr_level == 0);
+	UCHAR* const base = (UCHAR*) page;
+	const UCHAR* const endPointer = base + page->btr_length;
+	UCHAR* pointer = base + BTR_SIZE + page->btr_jump_size;
+
+	UCHAR head[HEAD_SIZE];
+	memset(head, 0, sizeof(head));
+
+	IndexNode node;
+	ULONG next = 0;
+
+	while (pointer < endPointer)
+	{
+		pointer = node.readNode(pointer, leafPage);
+
+		if (node.isEndBucket || node.isEndLevel || pointer > endPointer)
+			break;
+
+		// Restore first bytes of the key, the rest of them is kept from the previous node
+
+		if (node.prefix < HEAD_SIZE)
+			memcpy(head + node.prefix, node.data, MIN(node.length, HEAD_SIZE - node.prefix));
+
+		const ULONG keyLength = node.prefix + node.length;
+		if (keyLength < HEAD_SIZE)
+			memset(head + keyLength, 0, HEAD_SIZE - keyLength);
+
+		const ULONG offset = node.nodePointer - base;
+		if (offset < next)
+			continue;
+
+		m_high.add(getHead(head));
+		m_low.add(getHead(head + HEAD_SIZE / 2));
+		m_offsets.add(offset);
+		m_prefixes.add(node.prefix);
+		m_lengths.add(MIN(keyLength, HEAD_SIZE));
+
+		next = offset + INTERVAL;
+	}
+}
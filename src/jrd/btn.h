@@ -30,6 +30,8 @@
 #include "firebird.h"			// needed for get_long
 #include "memory_routines.h"	// needed for get_long
 
+#include <atomic>
+
 #include "../jrd/ods.h"
 #include "../common/classes/array.h"
 
@@ -276,6 +278,44 @@ struct IndexJumpNode
 	UCHAR* writeJumpNode(UCHAR* pagePointer);
 };
 
+// Search index of the cached B-tree page. Every few nodes of the page are kept
+// in the fixed-stride arrays: first bytes of the full node key (as big-endian
+// integers, thus they are compared the same way as keys), node offset and
+// prefix. Arrays are scanned with the plain loops the compiler vectorizes, and
+// the search continues from the last node less than the key instead of walking
+// the whole area after the jump node.
+//
+// Index is built by the reader of the page and it's valid while the page
+// incarnation is not changed, i.e. the page is not marked or re-read.
+
+class BtrSearchIndex
+{
+public:
+	explicit BtrSearchIndex(MemoryPool& pool)
+		: m_incarnation(0), m_building(false),
+		  m_high(pool), m_low(pool), m_offsets(pool), m_prefixes(pool), m_lengths(pool)
+	{}
+
+	// Find the node to start the search of the ascending key from.
+	// Return false if index is being built by another reader.
+	bool findStartPoint(const Ods::btree_page* page, ULONG incarnation,
+						const UCHAR* key, USHORT keyLength, USHORT* offset, USHORT* prefix);
+
+private:
+	static constexpr USHORT HEAD_SIZE = 8;		// key bytes kept in index
+	static constexpr USHORT INTERVAL = 64;		// min distance between indexed nodes
+
+	void build(const Ods::btree_page* page);
+
+	std::atomic<ULONG> m_incarnation;	// page incarnation the index is built for
+	std::atomic<bool> m_building;
+	Firebird::Array<ULONG> m_high;		// key bytes 0 - 3
+	Firebird::Array<ULONG> m_low;		// key bytes 4 - 7
+	Firebird::Array<USHORT> m_offsets;
+	Firebird::Array<USHORT> m_prefixes;
+	Firebird::Array<UCHAR> m_lengths;	// key length up to HEAD_SIZE
+};
+
 } // namespace Jrd
 
 #endif // JRD_BTN_H
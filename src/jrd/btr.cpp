@@ -51,6 +51,7 @@
 #include "../common/gdsassert.h"
 #include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
+#include "../jrd/dfw_proto.h"
 #include "../jrd/dpm_proto.h"
 #include "../jrd/err_proto.h"
 #include "../jrd/evl_proto.h"
@@ -194,6 +195,35 @@ namespace
 		temporary_mini_key jumpKey;
 	};
 
+	// Leaf page of the key range to be propagated to the upper levels: page number,
+	// record number and key of the first node on the page
+
+	void putRangePage(Array<UCHAR>& pages, ULONG page, RecordNumber number, const temporary_mini_key& key)
+	{
+		const SINT64 value = number.getValue();
+
+		pages.add(reinterpret_cast<const UCHAR*>(&page), sizeof(page));
+		pages.add(reinterpret_cast<const UCHAR*>(&value), sizeof(value));
+		pages.add(reinterpret_cast<const UCHAR*>(&key.key_length), sizeof(key.key_length));
+		pages.add(key.key_data, key.key_length);
+	}
+
+	const UCHAR* getRangePage(const UCHAR* p, ULONG& page, RecordNumber& number, temporary_mini_key& key)
+	{
+		SINT64 value;
+
+		memcpy(&page, p, sizeof(page));
+		p += sizeof(page);
+		memcpy(&value, p, sizeof(value));
+		p += sizeof(value);
+		memcpy(&key.key_length, p, sizeof(key.key_length));
+		p += sizeof(key.key_length);
+		memcpy(key.key_data, p, key.key_length);
+
+		number.setValue(value);
+		return p + key.key_length;
+	}
+
 	inline int indexCacheState(thread_db* tdbb, TraNumber descTrans, Cached::Relation* rel, MetaId idxId, bool creating)
 	{
 		auto checkPresence = [tdbb, rel, idxId]()->bool
@@ -230,24 +260,30 @@ static USHORT compress_root(thread_db*, index_root_page*);
 static void copy_key(const temporary_mini_key*, temporary_mini_key*);
 static contents delete_node(thread_db*, WIN*, UCHAR*);
 static void delete_tree(thread_db*, MetaId, MetaId, PageNumber, PageNumber);
-static ULONG fast_load(thread_db*, IndexCreation&, SelectivityList&);
+static ULONG fast_load(thread_db*, IndexCreation&, IndexRange*, SelectivityList&);
 
 static const index_root_page* fetch_root(thread_db*, WIN*, const RelationPermanent*, const RelationPages*);
-static UCHAR* find_node_start_point(btree_page*, temporary_key*, UCHAR*, USHORT*,
+static UCHAR* find_node_start_point(WIN*, btree_page*, temporary_key*, UCHAR*, USHORT*,
 									bool, int, bool = false, RecordNumber = NO_VALUE);
 
-static UCHAR* find_area_start_point(btree_page*, const temporary_key*, UCHAR*,
+static UCHAR* find_area_start_point(WIN*, btree_page*, const temporary_key*, UCHAR*,
 									USHORT*, bool, int, RecordNumber = NO_VALUE);
 
-static ULONG find_page(btree_page*, const temporary_key*, const index_desc*, RecordNumber = NO_VALUE,
+static UCHAR* find_indexed_start_point(WIN*, btree_page*, const temporary_key*, USHORT*);
+
+static ULONG find_page(WIN*, btree_page*, const temporary_key*, const index_desc*, RecordNumber = NO_VALUE,
 					   int = 0);
+static ULONG find_leaf_optimistic(thread_db*, const WIN*, const index_desc*, const temporary_key*, int,
+								  ULONG*, ULONG*);
 
 static contents garbage_collect(thread_db*, WIN*, ULONG);
 static void generate_jump_nodes(thread_db*, btree_page*, JumpNodeList*, USHORT,
 								USHORT*, USHORT*, USHORT*, USHORT);
 
+static void insert_from_top(thread_db*, WIN*, index_insertion*, RecordNumber);
 static ULONG insert_node(thread_db*, WIN*, index_insertion*, temporary_key*,
 						 RecordNumber*, ULONG*, ULONG*);
+static ULONG insert_rightmost(thread_db*, index_insertion*, temporary_key*, RecordNumber*);
 
 static INT64_KEY make_int64_key(SINT64, SSHORT);
 #ifdef DEBUG_INDEXKEY
@@ -259,6 +295,7 @@ static contents remove_leaf_node(thread_db*, index_insertion*, WIN*);
 static bool scan(thread_db*, UCHAR*, RecordBitmap**, RecordBitmap*, index_desc*,
 				 const IndexRetrieval*, USHORT, temporary_key*,
 				 bool&, const temporary_key&, USHORT);
+static USHORT separator_length(btree_page*, const UCHAR*, const temporary_key*);
 static void update_selectivity(index_root_page*, MetaId, const SelectivityList&);
 static void checkForLowerKeySkip(bool&, const bool, const IndexNode&, const temporary_key&,
 								 const index_desc&, const IndexRetrieval*);
@@ -1073,7 +1110,10 @@ void BTR_create(thread_db* tdbb,
 	index_desc* const idx = creation.index;
 
 	// Now that the index id has been checked out, create the index.
-	idx->idx_root = fast_load(tdbb, creation, selectivity);
+	idx->idx_root = fast_load(tdbb, creation, NULL, selectivity);
+
+	// Forget the rightmost leaf of the index dropped before, see insert_rightmost
+	relation->getPages(tdbb)->resetRightLeaf(idx->idx_id);
 
 	// Index is created.  Go back to the index root page and update it to
 	// point to the index.
@@ -1149,6 +1189,101 @@ bool BTR_delete_index(thread_db* tdbb, WIN* window, MetaId id, bool withCleanup)
 }
 
 
+void BTR_truncate(thread_db* tdbb, Cached::Relation* relation, RelationPages* relPages)
+{
+/**************************************
+ *
+ *	B T R _ t r u n c a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Replace trees of all indices of a relation by empty
+ *	leaf pages and release old trees back to free list.
+ *	Index slots keep their ids, so metadata doesn't change.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	const Database* dbb = tdbb->getDatabase();
+	CHECK_DBB(dbb);
+
+	WIN window(relPages->rel_pg_space_id, relPages->rel_index_root);
+	index_root_page* root = BTR_fetch_root_for_update(FB_FUNCTION, tdbb, &window);
+
+	// Indices being created or dropped have trees bound to the transactions
+	// which did it, leave them alone.
+
+	for (MetaId id = 0; id < root->irt_count; id++)
+	{
+		const UCHAR state = root->irt_rpt[id].getState();
+
+		if (state != irt_unused && state != irt_normal)
+		{
+			CCH_RELEASE(tdbb, &window);
+			DFW_raiseRelationInUseError(relation);
+		}
+	}
+
+	HalfStaticArray<ULONG, 16> oldRoots;
+
+	for (MetaId id = 0; id < root->irt_count; id++)
+	{
+		index_root_page::irt_repeat* irt_desc = root->irt_rpt + id;
+		const ULONG rootPage = irt_desc->getRoot();
+
+		if (irt_desc->getState() != irt_normal || !rootPage)
+		{
+			oldRoots.add(0);
+			continue;
+		}
+
+		WIN old_window(relPages->rel_pg_space_id, rootPage);
+		const btree_page* old_bucket = (btree_page*) CCH_FETCH(tdbb, &old_window, LCK_read, pag_index);
+		const USHORT btr_jump_interval = old_bucket->btr_jump_interval;
+		CCH_RELEASE(tdbb, &old_window);
+
+		// Allocate and format an empty leaf page, it's the whole tree now
+		WIN new_window(relPages->rel_pg_space_id, -1);
+		btree_page* new_bucket = (btree_page*) DPM_allocate(tdbb, &new_window);
+
+		new_bucket->btr_header.pag_type = pag_index;
+		new_bucket->btr_relation = relation->getId();
+		new_bucket->btr_id = (UCHAR)(id % 256);
+		new_bucket->btr_level = 0;
+
+		new_bucket->btr_jump_interval = btr_jump_interval;
+		new_bucket->btr_jump_size = 0;
+		new_bucket->btr_jump_count = 0;
+
+		IndexNode node;
+		node.setEndLevel();
+		const UCHAR* pointer = node.writeNode(new_bucket->btr_nodes, true);
+		new_bucket->btr_length = pointer - (UCHAR*) new_bucket;
+
+		CCH_RELEASE(tdbb, &new_window);
+
+		// The new page must be written before the root page points to it
+		CCH_precedence(tdbb, &window, new_window.win_page);
+		CCH_MARK(tdbb, &window);
+		irt_desc->setRoot(new_window.win_page.getPageNum());
+
+		relPages->resetRightLeaf(id);
+		oldRoots.add(rootPage);
+	}
+
+	CCH_RELEASE(tdbb, &window);
+
+	for (MetaId id = 0; id < oldRoots.getCount(); id++)
+	{
+		if (oldRoots[id])
+		{
+			delete_tree(tdbb, relation->getId(), id,
+				PageNumber(relPages->rel_pg_space_id, oldRoots[id]), window.win_page);
+		}
+	}
+}
+
+
 static void checkTransactionNumber(const index_root_page::irt_repeat* irt_desc, TraNumber tran, const char* msg)
 {
 	if (irt_desc->getTransaction() != tran)
@@ -1599,7 +1734,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 		UCHAR* pointer;
 		if (retrieval->irb_lower_count)
 		{
-			while (!(pointer = find_node_start_point(page, lower, 0, &prefix,
+			while (!(pointer = find_node_start_point(&window, page, lower, 0, &prefix,
 				descending, (retrieval->irb_generic & (irb_starting | irb_partial)))))
 			{
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
@@ -1716,7 +1851,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 }
 
 
-UCHAR* BTR_find_leaf(btree_page* bucket, temporary_key* key, UCHAR* value,
+UCHAR* BTR_find_leaf(WIN* window, btree_page* bucket, temporary_key* key, UCHAR* value,
 					 USHORT* return_value, bool descending, int retrieval)
 {
 /**************************************
@@ -1731,7 +1866,7 @@ UCHAR* BTR_find_leaf(btree_page* bucket, temporary_key* key, UCHAR* value,
  *	A flag indicates the index is descending.
  *
  **************************************/
-	return find_node_start_point(bucket, key, value, return_value, descending, retrieval);
+	return find_node_start_point(window, bucket, key, value, return_value, descending, retrieval);
 }
 
 
@@ -1767,8 +1902,6 @@ btree_page* BTR_find_page(thread_db* tdbb,
 		IBERROR(260);	// msg 260 index unexpectedly deleted
 	}
 
-	btree_page* page = (btree_page*) CCH_HANDOFF(tdbb, window, idx->idx_root, LCK_read, pag_index);
-
 	// If there is a starting descriptor, search down index to starting position.
 	// This may involve sibling buckets if splits are in progress.  If there
 	// isn't a starting descriptor, walk down the left side of the index (right
@@ -1779,23 +1912,57 @@ btree_page* BTR_find_page(thread_db* tdbb,
 		(retrieval->irb_generic & irb_ignore_null_value_key) && !(retrieval->irb_lower_count));
 
 	const bool firstData = (retrieval->irb_lower_count || ignoreNulls);
+	const int searchFlags = (retrieval->irb_generic & (irb_starting | irb_partial));
 
-	if (firstData)
+	// Make a temporary key with length 1 and zero byte, this will return
+	// the first data value after the NULLs for an ASC index.
+	temporary_key firstNotNullKey;
+	firstNotNullKey.key_flags = 0;
+	firstNotNullKey.key_data[0] = 0;
+	firstNotNullKey.key_length = 1;
+	firstNotNullKey.key_nulls = 0;
+
+	const temporary_key* const tkey = firstData ? (ignoreNulls ? &firstNotNullKey : lower) : nullptr;
+
+	// Try to get the leaf page latching nothing but the leaf itself
+
+	ULONG parentNumber, parentIncarnation;
+	const ULONG leafNumber =
+		find_leaf_optimistic(tdbb, window, idx, tkey, searchFlags, &parentNumber, &parentIncarnation);
+
+	if (leafNumber)
 	{
-		// Make a temporary key with length 1 and zero byte, this will return
-		// the first data value after the NULLs for an ASC index.
-		temporary_key firstNotNullKey;
-		firstNotNullKey.key_flags = 0;
-		firstNotNullKey.key_data[0] = 0;
-		firstNotNullKey.key_length = 1;
+		btree_page* page = (btree_page*) CCH_HANDOFF(tdbb, window, leafNumber, LCK_read, pag_undefined);
+
+		// The leaf is valid if it's still pointed by the parent
+		if (page->btr_header.pag_type == pag_index && page->btr_level == 0 &&
+			!(page->btr_header.pag_flags & btr_released) &&
+			CCH_validate_copy(tdbb, PageNumber(relPages->rel_pg_space_id, parentNumber), parentIncarnation))
+		{
+			return page;
+		}
+
+		CCH_RELEASE(tdbb, window);
+
+		window->win_page = relPages->rel_index_root;
+		rpage = BTR_fetch_root(FB_FUNCTION, tdbb, window);
+
+		if (!BTR_description(tdbb, retrieval->getPermRelation(), rpage, idx, retrieval->irb_index))
+		{
+			CCH_RELEASE(tdbb, window);
+			IBERROR(260);	// msg 260 index unexpectedly deleted
+		}
+	}
+
+	btree_page* page = (btree_page*) CCH_HANDOFF(tdbb, window, idx->idx_root, LCK_read, pag_index);
 
+	if (firstData)
+	{
 		while (page->btr_level > 0)
 		{
 			while (true)
 			{
-				const temporary_key* tkey = ignoreNulls ? &firstNotNullKey : lower;
-				const ULONG number = find_page(page, tkey, idx,
-					NO_VALUE, (retrieval->irb_generic & (irb_starting | irb_partial)));
+				const ULONG number = find_page(window, page, tkey, idx, NO_VALUE, searchFlags);
 				if (number != END_BUCKET)
 				{
 					page = (btree_page*) CCH_HANDOFF(tdbb, window, number, LCK_read, pag_index);
@@ -1842,6 +2009,63 @@ void BTR_insert(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
  **************************************/
 	SET_TDBB(tdbb);
 
+	// Monotonically increasing keys are appended to the rightmost leaf,
+	// try it first to skip the descent from the top of the index
+	if (insertion->iib_btr_level == 0)
+	{
+		temporary_key key;
+		key.key_flags = 0;
+		key.key_length = 0;
+
+		RecordNumber recordNumber(0);
+		BtrPageGCLock lock(tdbb);
+		insertion->iib_dont_gc_lock = &lock;
+
+		const ULONG split_page = insert_rightmost(tdbb, insertion, &key, &recordNumber);
+
+		if (split_page == NO_SPLIT)
+		{
+			CCH_RELEASE(tdbb, root_window);
+			return;
+		}
+
+		if (split_page != NO_VALUE_PAGE)
+		{
+			// The leaf has split, insert the pointer to the new page
+			// into the upper level the usual way
+			index_insertion propagate = *insertion;
+			propagate.iib_number.setValue(split_page);
+			propagate.iib_key = &key;
+			propagate.iib_duplicates = NULL;
+			propagate.iib_btr_level = 1;
+
+			insert_from_top(tdbb, root_window, &propagate, recordNumber);
+
+			lock.enablePageGC(tdbb);
+			return;
+		}
+	}
+
+	insert_from_top(tdbb, root_window, insertion, RecordNumber(0));
+}
+
+
+static void insert_from_top(thread_db* tdbb, WIN* root_window, index_insertion* insertion,
+							RecordNumber recordNumber)
+{
+/**************************************
+ *
+ *	i n s e r t _ f r o m _ t o p
+ *
+ **************************************
+ *
+ * Functional description
+ *	Insert a node into an index level walking down from
+ *	the top page. The record number is the one of the
+ *	split node when the pointer to the split page is
+ *	propagated to the upper level.
+ *
+ **************************************/
 	index_desc* idx = insertion->iib_descriptor;
 	RelationPages* relPages = insertion->iib_relation->getPages(tdbb);
 	WIN window(relPages->rel_pg_space_id, idx->idx_root);
@@ -1860,7 +2084,6 @@ void BTR_insert(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
 	key.key_flags = 0;
 	key.key_length = 0;
 
-	RecordNumber recordNumber(0);
 	BtrPageGCLock lock(tdbb);
 	insertion->iib_dont_gc_lock = &lock;
 	ULONG split_page = add_node(tdbb, &window, insertion, &key, &recordNumber, NULL, NULL);
@@ -2151,6 +2374,27 @@ USHORT BTR_key_length(thread_db* tdbb, jrd_rel* relation, index_desc* idx)
 }
 
 
+void BTR_load_range(thread_db* tdbb, IndexCreation& creation, IndexRange& range)
+{
+/**************************************
+ *
+ *	B T R _ l o a d _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Load the leaf level of the key range of a new index.
+ *	Ranges are loaded by parallel workers, then BTR_create
+ *	links them and builds the upper levels of the index.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	SelectivityList selectivity(*tdbb->getDefaultPool());
+	fast_load(tdbb, creation, &range, selectivity);
+}
+
+
 bool BTR_lookup(thread_db* tdbb, Cached::Relation* relation, MetaId id, index_desc* buffer,
 				  RelationPages* relPages)
 {
@@ -2812,6 +3056,33 @@ bool BTR_cleanup_index(thread_db* tdbb, const QualifiedName& relName, jrd_tra* t
 }
 
 
+void BTR_release_range(thread_db* tdbb, const IndexCreation& creation, IndexRange& range)
+{
+/**************************************
+ *
+ *	B T R _ r e l e a s e _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release the leaf pages of the loaded key range
+ *	if index creation failed before it was linked.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	if (!range.lastPage)
+		return;
+
+	const USHORT pageSpaceID = creation.relation->getPages(tdbb)->rel_pg_space_id;
+
+	delete_tree(tdbb, creation.relation->getId(), creation.index->idx_id,
+				PageNumber(pageSpaceID, range.firstPage), PageNumber(pageSpaceID, 0));
+
+	range.firstPage = range.lastPage = 0;
+}
+
+
 void BTR_remove(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
 {
 /**************************************
@@ -3353,7 +3624,7 @@ static ULONG add_node(thread_db* tdbb,
 	ULONG page;
 	while (true)
 	{
-		page = find_page(bucket, insertion->iib_key, insertion->iib_descriptor,
+		page = find_page(window, bucket, insertion->iib_key, insertion->iib_descriptor,
 						 insertion->iib_number);
 
 		if (page != END_BUCKET)
@@ -3368,10 +3639,20 @@ static ULONG add_node(thread_db* tdbb,
 	// Fetch the page at the next level down.  If the next level is leaf level,
 	// fetch for write since we know we are going to write to the page (most likely).
 	const PageNumber index = window->win_page;
-	CCH_HANDOFF(tdbb, window, page,
+	const bool leafParent = (bucket->btr_level == 1 && insertion->iib_btr_level == 0);
+	const ULONG indexIncarnation = CCH_get_incarnation(window);
+	const btree_page* const lower = (btree_page*) CCH_HANDOFF(tdbb, window, page,
 				(SSHORT) ((bucket->btr_level == 1 + insertion->iib_btr_level) ? LCK_write : LCK_read),
 				pag_index);
 
+	// Remember the rightmost leaf for the next insertion, see insert_rightmost
+	if (leafParent && !lower->btr_sibling && (tdbb->getDatabase()->dbb_bcb->bcb_flags & BCB_exclusive))
+	{
+		const RelationPages::RightLeaf hint =
+			{insertion->iib_descriptor->idx_root, page, index.getPageNum(), indexIncarnation};
+		insertion->iib_relation->getPages(tdbb)->setRightLeaf(insertion->iib_descriptor->idx_id, hint);
+	}
+
 	// now recursively try to insert the node at the next level down
 	index_insertion propagate;
 	BtrPageGCLock lockLower(tdbb);
@@ -4412,6 +4693,7 @@ static void delete_tree(thread_db* tdbb,
 
 static ULONG fast_load(thread_db* tdbb,
 					   IndexCreation& creation,
+					   IndexRange* range,
 					   SelectivityList& selectivity)
 {
 /**************************************
@@ -4425,6 +4707,12 @@ static ULONG fast_load(thread_db* tdbb,
  *	are ripe for the plucking.  This beast is complicated, but, I hope,
  *	comprehendable.
  *
+ *	When index is created by parallel workers, every worker loads
+ *	the leaf level of its own key range (range is given). The last
+ *	page of the range ends with END_BUCKET node made of the first
+ *	key of the next range. Leaf pages of the ranges are linked and
+ *	the upper levels are built over them at once (creation.ranges).
+ *
  **************************************/
 #ifdef DEBUG_BTR_PAGES
 	TEXT debugtext[1024];
@@ -4482,6 +4770,9 @@ static ULONG fast_load(thread_db* tdbb,
 	HalfStaticArray<FB_UINT64, 4> duplicatesList(pool);
 	HalfStaticArray<FastLoadLevel, 4> levels(pool);
 
+	const bool stitch = !range && creation.ranges;
+	bool endBucket = false;
+
 	try
 	{
 		levels.resize(1);
@@ -4490,32 +4781,68 @@ static ULONG fast_load(thread_db* tdbb,
 		// Initialize level
 		leafLevel->window.win_page.setPageSpaceID(pageSpaceID);
 
-		// Allocate and format the first leaf level bucket.  Awkwardly,
-		// the bucket header has room for only a byte of index id and that's
-		// part of the ODS.  So, for now, we'll just record the first byte
-		// of the id and hope for the best.  Index buckets are (almost) always
-		// located through the index structure (dmp being an exception used
-		// only for debug) so the id is actually redundant.
-		btree_page* bucket = (btree_page*) DPM_allocate(tdbb, &leafLevel->window);
-		bucket->btr_header.pag_type = pag_index;
-		bucket->btr_relation = relation->getId();
-		bucket->btr_id = (UCHAR)(idx->idx_id % 256);
-		bucket->btr_level = 0;
-		bucket->btr_length = BTR_SIZE;
-		bucket->btr_jump_interval = jumpAreaSize;
-		bucket->btr_jump_size = 0;
-		bucket->btr_jump_count = 0;
+		btree_page* bucket = NULL;
+		UCHAR* pointer = NULL;
+
+		if (stitch)
+		{
+			const ObjectsArray<IndexRange>& ranges = *creation.ranges;
+
+			leafLevel->window.win_page = PageNumber(pageSpaceID, ranges[0].firstPage);
+			window = &leafLevel->window;
+
+			// Link the leaf pages of the adjacent key ranges
+			for (FB_SIZE_T i = 1; i < ranges.getCount(); i++)
+			{
+				const IndexRange& left = ranges[i - 1];
+				const IndexRange& right = ranges[i];
+
+				WIN leftWindow(pageSpaceID, left.lastPage);
+				btree_page* page = (btree_page*) CCH_FETCH(tdbb, &leftWindow, LCK_write, pag_index);
+				CCH_precedence(tdbb, &leftWindow, right.firstPage);
+				CCH_MARK(tdbb, &leftWindow);
+				page->btr_sibling = right.firstPage;
+				CCH_RELEASE(tdbb, &leftWindow);
+
+				WIN rightWindow(pageSpaceID, right.firstPage);
+				page = (btree_page*) CCH_FETCH(tdbb, &rightWindow, LCK_write, pag_index);
+				CCH_MARK(tdbb, &rightWindow);
+				page->btr_left_sibling = left.lastPage;
+				CCH_RELEASE(tdbb, &rightWindow);
+			}
+		}
+		else
+		{
+			// Allocate and format the first leaf level bucket.  Awkwardly,
+			// the bucket header has room for only a byte of index id and that's
+			// part of the ODS.  So, for now, we'll just record the first byte
+			// of the id and hope for the best.  Index buckets are (almost) always
+			// located through the index structure (dmp being an exception used
+			// only for debug) so the id is actually redundant.
+			bucket = (btree_page*) DPM_allocate(tdbb, &leafLevel->window);
+			bucket->btr_header.pag_type = pag_index;
+			bucket->btr_relation = relation->getId();
+			bucket->btr_id = (UCHAR)(idx->idx_id % 256);
+			bucket->btr_level = 0;
+			bucket->btr_length = BTR_SIZE;
+			bucket->btr_jump_interval = jumpAreaSize;
+			bucket->btr_jump_size = 0;
+			bucket->btr_jump_count = 0;
 
 #ifdef DEBUG_BTR_PAGES
-		snprintf(debugtext, sizeof(debugtext), "\t new page (%d)", windows[0].win_page);
-		gds__log(debugtext);
+			snprintf(debugtext, sizeof(debugtext), "\t new page (%d)", windows[0].win_page);
+			gds__log(debugtext);
 #endif
 
-		UCHAR* pointer = bucket->btr_nodes;
+			pointer = bucket->btr_nodes;
+
+			leafLevel->levelNode.setNode();
+			leafLevel->jumpNodes = FB_NEW_POOL(pool) JumpNodeList(pool);
+			leafLevel->newAreaPointer = pointer + jumpAreaSize;
 
-		leafLevel->levelNode.setNode();
-		leafLevel->jumpNodes = FB_NEW_POOL(pool) JumpNodeList(pool);
-		leafLevel->newAreaPointer = pointer + jumpAreaSize;
+			if (range)
+				range->firstPage = leafLevel->window.win_page.getPageNum();
+		}
 
 		tdbb->tdbb_flags |= TDBB_no_cache_unwind;
 
@@ -4551,63 +4878,370 @@ static ULONG fast_load(thread_db* tdbb,
 		// duplicate keys.
 		bool primarySeen = false;
 
-		while (!error)
+		// Propagate the split of the leaf page up to the upper levels
+		auto propagate = [&]()
 		{
-			// Get the next record in sorted order.
+			for (unsigned level = 1; levels[level - 1].splitPage; level++)
+			{
+				if (level == MAX_LEVELS)
+				{
+					// Maximum level depth reached
+					status_exception::raise(Arg::Gds(isc_imp_exc) <<
+						Arg::Gds(isc_max_idx_depth) << Arg::Num(MAX_LEVELS));
+				}
 
-			UCHAR* record;
-			creation.sort->get(tdbb, reinterpret_cast<ULONG**>(&record));
+				if (level == levels.getCount())
+					levels.resize(level + 1);
 
-			if (!record || creation.duplicates.value())
-				break;
+				FastLoadLevel* const currLevel = &levels[level];
+				FastLoadLevel* const priorLevel = &levels[level - 1];
 
-			index_sort_record* isr = (index_sort_record*) (record + key_length);
-			count++;
-			record += nullIndLen;
+				// Initialize the current pointers for this level
+				window = &currLevel->window;
+				currLevel->splitPage = 0;
+				UCHAR* levelPointer = currLevel->pointer;
 
-			leafLevel = &levels[0]; // reset after possible array reallocation
+				// If there isn't already a bucket at this level, make one.  Remember to
+				// shorten the index id to a byte
+				if (!(bucket = currLevel->bucket))
+				{
+					// Initialize new level
+					currLevel->window.win_page.setPageSpaceID(pageSpaceID);
 
-			// restore previous values
-			bucket = leafLevel->bucket;
-			leafLevel->splitPage = 0;
+					currLevel->bucket = bucket = (btree_page*) DPM_allocate(tdbb, window);
+					bucket->btr_header.pag_type = pag_index;
+					bucket->btr_relation = relation->getId();
+					bucket->btr_id = (UCHAR)(idx->idx_id % 256);
+					fb_assert(level <= MAX_UCHAR);
+					bucket->btr_level = (UCHAR) level;
+					bucket->btr_jump_interval = jumpAreaSize;
+					bucket->btr_jump_size = 0;
+					bucket->btr_jump_count = 0;
 
-			temporary_mini_key* const leafKey = &leafLevel->key;
-			JumpNodeList* const leafJumpNodes = leafLevel->jumpNodes;
-			temporary_mini_key* const leafJumpKey = &leafLevel->jumpKey;
+#ifdef DEBUG_BTR_PAGES
+					snprintf(debugtext, sizeof(debugtext), "\t new page (%d)", window->win_page);
+					gds__log(debugtext);
+#endif
 
-			// Compute the prefix as the length in common with the previous record's key.
-			USHORT prefix =
-				IndexNode::computePrefix(leafKey->key_data, leafKey->key_length, record, isr->isr_key_length);
+					// since this is the beginning of the level, we propagate the lower-level
+					// page with a "degenerate" zero-length node indicating that this page holds
+					// any key value less than the next node
 
-			// set node values
-			newNode.setNode(prefix, isr->isr_key_length - prefix,
-						    RecordNumber(isr->isr_record_number));
-			newNode.data = record + prefix;
+					levelPointer = bucket->btr_nodes;
 
-			// If the length of the new node will cause us to overflow the bucket,
-			// form a new bucket.
-			if (bucket->btr_length + leafLevel->totalJumpSize +
-				newNode.getNodeSize(true) > lp_fill_limit)
-			{
-				// mark the end of the previous page
-				const RecordNumber lastRecordNumber = previousNode.recordNumber;
-				previousNode.readNode(previousNode.nodePointer, true);
-				previousNode.setEndBucket();
-				pointer = previousNode.writeNode(previousNode.nodePointer, true, false);
-				bucket->btr_length = pointer - (UCHAR*) bucket;
+					// First record-number of level must be zero
+					currLevel->levelNode.setNode(0, 0, RecordNumber(0), priorLevel->splitPage);
+					levelPointer = currLevel->levelNode.writeNode(levelPointer, false);
+					bucket->btr_length = levelPointer - (UCHAR*) bucket;
 
-				if (leafLevel->totalJumpSize)
-				{
-					// Slide down current nodes;
-					// CVC: Warning, this may overlap. It seems better to use
-					// memmove or to ensure manually that leafLevel->totalJumpSize > l
-					// Also, "sliding down" here is moving contents higher in memory.
-					const USHORT l = bucket->btr_length - BTR_SIZE;
-					memmove(bucket->btr_nodes + leafLevel->totalJumpSize, bucket->btr_nodes, l);
+					currLevel->jumpNodes = FB_NEW_POOL(pool) JumpNodeList(pool);
+					currLevel->newAreaPointer = levelPointer + jumpAreaSize;
+				}
 
-					// Update JumpInfo
-					if (leafJumpNodes->getCount() > MAX_UCHAR)
-						BUGCHECK(205);	// msg 205 index bucket overfilled
+				temporary_mini_key* const pageKey = &currLevel->key;
+				temporary_mini_key* const pageJumpKey = &currLevel->jumpKey;
+				JumpNodeList* const pageJumpNodes = currLevel->jumpNodes;
+
+				// Compute the prefix in preparation of insertion
+				const USHORT prefix = IndexNode::computePrefix(pageKey->key_data, pageKey->key_length,
+					split_key.key_data, split_key.key_length);
+
+				// Remember the last key inserted to compress the next one.
+				copy_key(&split_key, &temp_key);
+
+				// Save current node if we need to split.
+				tempNode = currLevel->levelNode;
+				// Set new node values.
+				currLevel->levelNode.setNode(prefix, temp_key.key_length - prefix,
+					priorLevel->splitRecordNumber, priorLevel->window.win_page.getPageNum());
+				currLevel->levelNode.data = temp_key.key_data + prefix;
+
+				// See if the new node fits in the current bucket.
+				// If not, split the bucket.
+				if (bucket->btr_length + currLevel->totalJumpSize +
+					currLevel->levelNode.getNodeSize(false) > pp_fill_limit)
+				{
+					// mark the end of the page; note that the end_bucket marker must
+					// contain info about the first node on the next page
+					const ULONG lastPageNumber = tempNode.pageNumber;
+					tempNode.readNode(tempNode.nodePointer, false);
+					tempNode.setEndBucket();
+					levelPointer = tempNode.writeNode(tempNode.nodePointer, false, false);
+					bucket->btr_length = levelPointer - (UCHAR*) bucket;
+
+					if (currLevel->totalJumpSize)
+					{
+						// Slide down current nodes;
+						// CVC: Warning, this may overlap. It seems better to use
+						// memmove or to ensure manually that leafLevel->totalJumpSize > l
+						// Also, "sliding down" here is moving contents higher in memory.
+						const USHORT l = bucket->btr_length - BTR_SIZE;
+						memmove(bucket->btr_nodes + currLevel->totalJumpSize, bucket->btr_nodes, l);
+
+						// Update JumpInfo
+						if (pageJumpNodes->getCount() > MAX_UCHAR)
+							BUGCHECK(205);	// msg 205 index bucket overfilled
+
+						bucket->btr_jump_interval = jumpAreaSize;
+						bucket->btr_jump_size = currLevel->totalJumpSize;
+						bucket->btr_jump_count = (UCHAR) pageJumpNodes->getCount();
+
+						// Write jumpnodes on page.
+						levelPointer = bucket->btr_nodes;
+						IndexJumpNode* walkJumpNode = pageJumpNodes->begin();
+						for (size_t i = 0; i < pageJumpNodes->getCount(); i++)
+						{
+							// Update offset position first.
+							walkJumpNode[i].offset += currLevel->totalJumpSize;
+							levelPointer = walkJumpNode[i].writeJumpNode(levelPointer);
+						}
+
+						bucket->btr_length += currLevel->totalJumpSize;
+					}
+
+					if (bucket->btr_length > dbb->dbb_page_size)
+						BUGCHECK(205);	// msg 205 index bucket overfilled
+
+					btree_page* split = (btree_page*) DPM_allocate(tdbb, &split_window);
+					bucket->btr_sibling = split_window.win_page.getPageNum();
+					split->btr_left_sibling = window->win_page.getPageNum();
+					split->btr_header.pag_type = pag_index;
+					split->btr_relation = bucket->btr_relation;
+					split->btr_level = bucket->btr_level;
+					split->btr_id = bucket->btr_id;
+					split->btr_jump_interval = bucket->btr_jump_interval;
+					split->btr_jump_size = 0;
+					split->btr_jump_count = 0;
+
+#ifdef DEBUG_BTR_PAGES
+					snprintf(debugtext, sizeof(debugtext), "\t new page (%d), left page (%d)",
+						split_window.win_page, split->btr_left_sibling);
+					gds__log(debugtext);
+#endif
+
+					levelPointer = split->btr_nodes;
+					// Reset position and size for generating jumpnode
+					currLevel->newAreaPointer = levelPointer + jumpAreaSize;
+					currLevel->totalJumpSize = 0;
+					pageJumpKey->key_length = 0;
+
+					// insert the new node in the new bucket
+					IndexNode splitNode;
+					splitNode.setNode(0, pageKey->key_length, tempNode.recordNumber, lastPageNumber);
+					splitNode.data = pageKey->key_data;
+					levelPointer = splitNode.writeNode(levelPointer, false);
+					tempNode = splitNode;
+
+					// indicate to propagate the page we just split from
+					currLevel->splitPage = window->win_page.getPageNum();
+					currLevel->splitRecordNumber = splitNode.recordNumber;
+					CCH_RELEASE(tdbb, window);
+
+#ifdef DEBUG_BTR_PAGES
+					snprintf(debugtext, sizeof(debugtext),
+						"\t release page (%d), left page (%d), right page (%d)",
+						window->win_page,
+						((btr*)window->win_buffer)->btr_left_sibling,
+						((btr*)window->win_buffer)->btr_sibling);
+					gds__log(debugtext);
+#endif
+
+					// and make the new page the current page
+					*window = split_window;
+					currLevel->bucket = bucket = split;
+					copy_key(pageKey, &split_key);
+
+					// Clear jumplist.
+					IndexJumpNode* walkJumpNode = pageJumpNodes->begin();
+					for (size_t i = 0; i < pageJumpNodes->getCount(); i++)
+						delete[] walkJumpNode[i].data;
+
+					pageJumpNodes->clear();
+				}
+
+				// Now propagate up the lower-level bucket by storing a "pointer" to it.
+				bucket->btr_prefix_total += prefix;
+				levelPointer = currLevel->levelNode.writeNode(levelPointer, false);
+
+				// Update the length of the page.
+				bucket->btr_length = levelPointer - (UCHAR*) bucket;
+				if (bucket->btr_length > dbb->dbb_page_size)
+					BUGCHECK(205);	// msg 205 index bucket overfilled
+
+				if (currLevel->newAreaPointer < levelPointer)
+				{
+					// Create a jumpnode
+					IndexJumpNode jumpNode;
+					jumpNode.prefix = IndexNode::computePrefix(pageJumpKey->key_data,
+															   pageJumpKey->key_length,
+															   temp_key.key_data,
+															   currLevel->levelNode.prefix);
+					jumpNode.length = currLevel->levelNode.prefix - jumpNode.prefix;
+
+					const USHORT jumpNodeSize = jumpNode.getJumpNodeSize();
+					// Ensure the new jumpnode fits in the bucket
+					if (bucket->btr_length + currLevel->totalJumpSize + jumpNodeSize < pp_fill_limit)
+					{
+						// Initialize the rest of the jumpnode
+						jumpNode.offset = (currLevel->levelNode.nodePointer - (UCHAR*) bucket);
+						jumpNode.data = FB_NEW_POOL(pool) UCHAR[jumpNode.length];
+						memcpy(jumpNode.data, temp_key.key_data + jumpNode.prefix, jumpNode.length);
+						// Push node on end in list
+						pageJumpNodes->add(jumpNode);
+						// Store new data in jumpKey, so a new jump node can calculate prefix
+						memcpy(pageJumpKey->key_data + jumpNode.prefix, jumpNode.data, jumpNode.length);
+						pageJumpKey->key_length = jumpNode.length + jumpNode.prefix;
+						// Set new position for generating jumpnode
+						currLevel->newAreaPointer += jumpAreaSize;
+						currLevel->totalJumpSize += jumpNodeSize;
+					}
+				}
+
+				// Now restore the current key value and save this node as the
+				// current node on this level; also calculate the new page length.
+				copy_key(&temp_key, pageKey);
+				currLevel->pointer = levelPointer;
+			}
+		};
+
+		// Propagate the leaf page of the key range as if it has been just split
+		// from the page on its left
+		auto propagateRangePage = [&](ULONG page, RecordNumber number)
+		{
+			FastLoadLevel* const leaf = &levels[0];
+
+			leaf->splitPage = leaf->window.win_page.getPageNum();
+			leaf->splitRecordNumber = number;
+			leaf->window.win_page = PageNumber(pageSpaceID, page);
+
+			propagate();
+		};
+
+		if (stitch)
+		{
+			// Build the upper levels over the linked leaf pages of the key ranges,
+			// the first page of the range is followed by its split pages
+			const ObjectsArray<IndexRange>& ranges = *creation.ranges;
+
+			for (FB_SIZE_T i = 0; i < ranges.getCount(); i++)
+			{
+				const IndexRange& part = ranges[i];
+
+				count += part.count;
+				duplicates += part.duplicates;
+
+				for (ULONG j = 0; j < segments && j < part.duplicatesList.getCount(); j++)
+					duplicatesList[j] += part.duplicatesList[j];
+
+				if (i > 0)
+				{
+					const UCHAR* const record = part.first.begin();
+					const index_sort_record* const isr = (const index_sort_record*) (record + key_length);
+
+					split_key.key_length = isr->isr_key_length;
+					memcpy(split_key.key_data, record + nullIndLen, split_key.key_length);
+					propagateRangePage(part.firstPage, RecordNumber(isr->isr_record_number));
+				}
+
+				for (const UCHAR* p = part.pages.begin(); p < part.pages.end();)
+				{
+					ULONG page;
+					RecordNumber number;
+
+					p = getRangePage(p, page, number, split_key);
+					propagateRangePage(page, number);
+				}
+			}
+		}
+
+		while (!error && !stitch)
+		{
+			// Get the next record in sorted order. The key range starts with
+			// the record read ahead and is followed by the first record of the
+			// next range, which makes only the END_BUCKET node of the last page.
+
+			UCHAR* record;
+			bool boundary = false;
+
+			if (!range)
+				creation.sort->get(tdbb, reinterpret_cast<ULONG**>(&record));
+			else if (!count)
+				record = range->first.hasData() ? range->first.begin() : NULL;
+			else
+			{
+				range->sort->get(tdbb, reinterpret_cast<ULONG**>(&record));
+
+				if (!record && range->next.hasData())
+				{
+					record = range->next.begin();
+					boundary = true;
+				}
+			}
+
+			if (!record || creation.duplicates.value())
+				break;
+
+			index_sort_record* isr = (index_sort_record*) (record + key_length);
+			if (!boundary)
+				count++;
+			record += nullIndLen;
+
+			leafLevel = &levels[0]; // reset after possible array reallocation
+
+			// restore previous values
+			bucket = leafLevel->bucket;
+			leafLevel->splitPage = 0;
+
+			temporary_mini_key* const leafKey = &leafLevel->key;
+			JumpNodeList* const leafJumpNodes = leafLevel->jumpNodes;
+			temporary_mini_key* const leafJumpKey = &leafLevel->jumpKey;
+
+			// Compute the prefix as the length in common with the previous record's key.
+			USHORT prefix =
+				IndexNode::computePrefix(leafKey->key_data, leafKey->key_length, record, isr->isr_key_length);
+
+			// set node values
+			newNode.setNode(prefix, isr->isr_key_length - prefix,
+						    RecordNumber(isr->isr_record_number));
+			newNode.data = record + prefix;
+
+			// If the length of the new node will cause us to overflow the bucket,
+			// form a new bucket.
+			if (bucket->btr_length + leafLevel->totalJumpSize +
+				newNode.getNodeSize(true) > lp_fill_limit)
+			{
+				// mark the end of the previous page
+				const RecordNumber lastRecordNumber = previousNode.recordNumber;
+				previousNode.readNode(previousNode.nodePointer, true);
+
+				// The last node moves to the new page, its prefix is the length in common
+				// with the key left on this page. Only the shortest key which separates
+				// them is propagated, as in insert_node(), and the end of bucket marker
+				// gets the same key.
+				USHORT separatorLength = leafKey->key_length;
+				if (!descending && previousNode.nodePointer > bucket->btr_nodes &&
+					previousNode.prefix < separatorLength)
+				{
+					separatorLength = previousNode.prefix + 1;
+					previousNode.length = separatorLength - previousNode.prefix;
+				}
+
+				previousNode.setEndBucket();
+				pointer = previousNode.writeNode(previousNode.nodePointer, true, false);
+				bucket->btr_length = pointer - (UCHAR*) bucket;
+
+				if (leafLevel->totalJumpSize)
+				{
+					// Slide down current nodes;
+					// CVC: Warning, this may overlap. It seems better to use
+					// memmove or to ensure manually that leafLevel->totalJumpSize > l
+					// Also, "sliding down" here is moving contents higher in memory.
+					const USHORT l = bucket->btr_length - BTR_SIZE;
+					memmove(bucket->btr_nodes + leafLevel->totalJumpSize, bucket->btr_nodes, l);
+
+					// Update JumpInfo
+					if (leafJumpNodes->getCount() > MAX_UCHAR)
+						BUGCHECK(205);	// msg 205 index bucket overfilled
 
 					bucket->btr_jump_interval = jumpAreaSize;
 					bucket->btr_jump_size = leafLevel->totalJumpSize;
@@ -4680,6 +5314,13 @@ static ULONG fast_load(thread_db* tdbb,
 
 				// save the first key on page as the page to be propagated
 				copy_key(leafKey, &split_key);
+				split_key.key_length = separatorLength;
+
+				if (range)
+				{
+					putRangePage(range->pages, leafLevel->window.win_page.getPageNum(),
+						leafLevel->splitRecordNumber, split_key);
+				}
 
 				// Clear jumplist.
 				IndexJumpNode* walkJumpNode = leafJumpNodes->begin();
@@ -4695,7 +5336,7 @@ static ULONG fast_load(thread_db* tdbb,
 			previousNode = newNode;
 
 			// if we have a compound-index calculate duplicates per segment.
-			if (segments > 1 && count > 1)
+			if (segments > 1 && (count > 1 || boundary))
 			{
 				// Initialize variables for segment duplicate check.
 				// count holds the current checking segment (starting by
@@ -4769,6 +5410,20 @@ static ULONG fast_load(thread_db* tdbb,
 					duplicatesList[segments - i]++;
 			}
 
+			if (boundary)
+			{
+				// The first key of the next range marks the end of the page.
+				// Duplicates are not counted as both keys can't be equal.
+				newNode.setEndBucket();
+				pointer = newNode.writeNode(newNode.nodePointer, true);
+				bucket->btr_length = pointer - (UCHAR*) bucket;
+				if (bucket->btr_length > dbb->dbb_page_size)
+					BUGCHECK(205);	// msg 205 index bucket overfilled
+
+				endBucket = true;
+				break;
+			}
+
 			// check if this is a duplicate node
 			duplicate = (!newNode.length && prefix == leafKey->key_length);
 			const bool isPrimary = !(isr->isr_flags & ISR_secondary);
@@ -4777,276 +5432,58 @@ static ULONG fast_load(thread_db* tdbb,
 				++duplicates;
 				if (unique && primarySeen && isPrimary && !(isr->isr_flags & ISR_null))
 				{
-					++creation.duplicates;
-					creation.dup_recno = isr->isr_record_number;
-				}
-
-				if (isPrimary)
-					primarySeen = true;
-			}
-			else
-				primarySeen = isPrimary;
-
-			// Update the length of the page.
-			bucket->btr_length = pointer - (UCHAR*) bucket;
-			if (bucket->btr_length > dbb->dbb_page_size)
-				BUGCHECK(205);	// msg 205 index bucket overfilled
-
-			// Remember the last key inserted to compress the next one.
-			leafKey->key_length = isr->isr_key_length;
-			memcpy(leafKey->key_data, record, leafKey->key_length);
-
-			if (leafLevel->newAreaPointer < pointer)
-			{
-				// Create a jumpnode
-				IndexJumpNode jumpNode;
-				jumpNode.prefix = IndexNode::computePrefix(leafJumpKey->key_data,
-					leafJumpKey->key_length, leafKey->key_data, newNode.prefix);
-				jumpNode.length = newNode.prefix - jumpNode.prefix;
-
-				const USHORT jumpNodeSize = jumpNode.getJumpNodeSize();
-				// Ensure the new jumpnode fits in the bucket
-				if (bucket->btr_length + leafLevel->totalJumpSize + jumpNodeSize < lp_fill_limit)
-				{
-					// Initialize the rest of the jumpnode
-					jumpNode.offset = (newNode.nodePointer - (UCHAR*) bucket);
-					jumpNode.data = FB_NEW_POOL(pool) UCHAR[jumpNode.length];
-					memcpy(jumpNode.data, leafKey->key_data + jumpNode.prefix, jumpNode.length);
-					// Push node on end in list
-					leafJumpNodes->add(jumpNode);
-					// Store new data in leafJumpKey, so a new jump node can calculate prefix
-					memcpy(leafJumpKey->key_data + jumpNode.prefix, jumpNode.data, jumpNode.length);
-					leafJumpKey->key_length = jumpNode.length + jumpNode.prefix;
-					// Set new position for generating jumpnode
-					leafLevel->newAreaPointer += jumpAreaSize;
-					leafLevel->totalJumpSize += jumpNodeSize;
-				}
-			}
-
-			// If there wasn't a split, we're done.  If there was, propagate the
-			// split upward
-			for (unsigned level = 1; levels[level - 1].splitPage; level++)
-			{
-				if (level == MAX_LEVELS)
-				{
-					// Maximum level depth reached
-					status_exception::raise(Arg::Gds(isc_imp_exc) <<
-						Arg::Gds(isc_max_idx_depth) << Arg::Num(MAX_LEVELS));
-				}
-
-				if (level == levels.getCount())
-					levels.resize(level + 1);
-
-				FastLoadLevel* const currLevel = &levels[level];
-				FastLoadLevel* const priorLevel = &levels[level - 1];
-
-				// Initialize the current pointers for this level
-				window = &currLevel->window;
-				currLevel->splitPage = 0;
-				UCHAR* levelPointer = currLevel->pointer;
-
-				// If there isn't already a bucket at this level, make one.  Remember to
-				// shorten the index id to a byte
-				if (!(bucket = currLevel->bucket))
-				{
-					// Initialize new level
-					currLevel->window.win_page.setPageSpaceID(pageSpaceID);
-
-					currLevel->bucket = bucket = (btree_page*) DPM_allocate(tdbb, window);
-					bucket->btr_header.pag_type = pag_index;
-					bucket->btr_relation = relation->getId();
-					bucket->btr_id = (UCHAR)(idx->idx_id % 256);
-					fb_assert(level <= MAX_UCHAR);
-					bucket->btr_level = (UCHAR) level;
-					bucket->btr_jump_interval = jumpAreaSize;
-					bucket->btr_jump_size = 0;
-					bucket->btr_jump_count = 0;
-
-#ifdef DEBUG_BTR_PAGES
-					snprintf(debugtext, sizeof(debugtext), "\t new page (%d)", window->win_page);
-					gds__log(debugtext);
-#endif
-
-					// since this is the beginning of the level, we propagate the lower-level
-					// page with a "degenerate" zero-length node indicating that this page holds
-					// any key value less than the next node
-
-					levelPointer = bucket->btr_nodes;
-
-					// First record-number of level must be zero
-					currLevel->levelNode.setNode(0, 0, RecordNumber(0), priorLevel->splitPage);
-					levelPointer = currLevel->levelNode.writeNode(levelPointer, false);
-					bucket->btr_length = levelPointer - (UCHAR*) bucket;
-
-					currLevel->jumpNodes = FB_NEW_POOL(pool) JumpNodeList(pool);
-					currLevel->newAreaPointer = levelPointer + jumpAreaSize;
-				}
-
-				temporary_mini_key* const pageKey = &currLevel->key;
-				temporary_mini_key* const pageJumpKey = &currLevel->jumpKey;
-				JumpNodeList* const pageJumpNodes = currLevel->jumpNodes;
-
-				// Compute the prefix in preparation of insertion
-				prefix = IndexNode::computePrefix(pageKey->key_data, pageKey->key_length,
-					split_key.key_data, split_key.key_length);
-
-				// Remember the last key inserted to compress the next one.
-				copy_key(&split_key, &temp_key);
-
-				// Save current node if we need to split.
-				tempNode = currLevel->levelNode;
-				// Set new node values.
-				currLevel->levelNode.setNode(prefix, temp_key.key_length - prefix,
-					priorLevel->splitRecordNumber, priorLevel->window.win_page.getPageNum());
-				currLevel->levelNode.data = temp_key.key_data + prefix;
-
-				// See if the new node fits in the current bucket.
-				// If not, split the bucket.
-				if (bucket->btr_length + currLevel->totalJumpSize +
-					currLevel->levelNode.getNodeSize(false) > pp_fill_limit)
-				{
-					// mark the end of the page; note that the end_bucket marker must
-					// contain info about the first node on the next page
-					const ULONG lastPageNumber = tempNode.pageNumber;
-					tempNode.readNode(tempNode.nodePointer, false);
-					tempNode.setEndBucket();
-					levelPointer = tempNode.writeNode(tempNode.nodePointer, false, false);
-					bucket->btr_length = levelPointer - (UCHAR*) bucket;
-
-					if (currLevel->totalJumpSize)
-					{
-						// Slide down current nodes;
-						// CVC: Warning, this may overlap. It seems better to use
-						// memmove or to ensure manually that leafLevel->totalJumpSize > l
-						// Also, "sliding down" here is moving contents higher in memory.
-						const USHORT l = bucket->btr_length - BTR_SIZE;
-						memmove(bucket->btr_nodes + currLevel->totalJumpSize, bucket->btr_nodes, l);
-
-						// Update JumpInfo
-						if (pageJumpNodes->getCount() > MAX_UCHAR)
-							BUGCHECK(205);	// msg 205 index bucket overfilled
-
-						bucket->btr_jump_interval = jumpAreaSize;
-						bucket->btr_jump_size = currLevel->totalJumpSize;
-						bucket->btr_jump_count = (UCHAR) pageJumpNodes->getCount();
-
-						// Write jumpnodes on page.
-						levelPointer = bucket->btr_nodes;
-						IndexJumpNode* walkJumpNode = pageJumpNodes->begin();
-						for (size_t i = 0; i < pageJumpNodes->getCount(); i++)
-						{
-							// Update offset position first.
-							walkJumpNode[i].offset += currLevel->totalJumpSize;
-							levelPointer = walkJumpNode[i].writeJumpNode(levelPointer);
-						}
-
-						bucket->btr_length += currLevel->totalJumpSize;
-					}
-
-					if (bucket->btr_length > dbb->dbb_page_size)
-						BUGCHECK(205);	// msg 205 index bucket overfilled
-
-					btree_page* split = (btree_page*) DPM_allocate(tdbb, &split_window);
-					bucket->btr_sibling = split_window.win_page.getPageNum();
-					split->btr_left_sibling = window->win_page.getPageNum();
-					split->btr_header.pag_type = pag_index;
-					split->btr_relation = bucket->btr_relation;
-					split->btr_level = bucket->btr_level;
-					split->btr_id = bucket->btr_id;
-					split->btr_jump_interval = bucket->btr_jump_interval;
-					split->btr_jump_size = 0;
-					split->btr_jump_count = 0;
-
-#ifdef DEBUG_BTR_PAGES
-					snprintf(debugtext, sizeof(debugtext), "\t new page (%d), left page (%d)",
-						split_window.win_page, split->btr_left_sibling);
-					gds__log(debugtext);
-#endif
-
-					levelPointer = split->btr_nodes;
-					// Reset position and size for generating jumpnode
-					currLevel->newAreaPointer = levelPointer + jumpAreaSize;
-					currLevel->totalJumpSize = 0;
-					pageJumpKey->key_length = 0;
-
-					// insert the new node in the new bucket
-					IndexNode splitNode;
-					splitNode.setNode(0, pageKey->key_length, tempNode.recordNumber, lastPageNumber);
-					splitNode.data = pageKey->key_data;
-					levelPointer = splitNode.writeNode(levelPointer, false);
-					tempNode = splitNode;
-
-					// indicate to propagate the page we just split from
-					currLevel->splitPage = window->win_page.getPageNum();
-					currLevel->splitRecordNumber = splitNode.recordNumber;
-					CCH_RELEASE(tdbb, window);
-
-#ifdef DEBUG_BTR_PAGES
-					snprintf(debugtext, sizeof(debugtext),
-						"\t release page (%d), left page (%d), right page (%d)",
-						window->win_page,
-						((btr*)window->win_buffer)->btr_left_sibling,
-						((btr*)window->win_buffer)->btr_sibling);
-					gds__log(debugtext);
-#endif
-
-					// and make the new page the current page
-					*window = split_window;
-					currLevel->bucket = bucket = split;
-					copy_key(pageKey, &split_key);
+					++creation.duplicates;
+					creation.dup_recno = isr->isr_record_number;
+				}
 
-					// Clear jumplist.
-					IndexJumpNode* walkJumpNode = pageJumpNodes->begin();
-					for (size_t i = 0; i < pageJumpNodes->getCount(); i++)
-						delete[] walkJumpNode[i].data;
+				if (isPrimary)
+					primarySeen = true;
+			}
+			else
+				primarySeen = isPrimary;
 
-					pageJumpNodes->clear();
-				}
+			// Update the length of the page.
+			bucket->btr_length = pointer - (UCHAR*) bucket;
+			if (bucket->btr_length > dbb->dbb_page_size)
+				BUGCHECK(205);	// msg 205 index bucket overfilled
 
-				// Now propagate up the lower-level bucket by storing a "pointer" to it.
-				bucket->btr_prefix_total += prefix;
-				levelPointer = currLevel->levelNode.writeNode(levelPointer, false);
+			// Remember the last key inserted to compress the next one.
+			leafKey->key_length = isr->isr_key_length;
+			memcpy(leafKey->key_data, record, leafKey->key_length);
 
-				// Update the length of the page.
-				bucket->btr_length = levelPointer - (UCHAR*) bucket;
-				if (bucket->btr_length > dbb->dbb_page_size)
-					BUGCHECK(205);	// msg 205 index bucket overfilled
+			if (leafLevel->newAreaPointer < pointer)
+			{
+				// Create a jumpnode
+				IndexJumpNode jumpNode;
+				jumpNode.prefix = IndexNode::computePrefix(leafJumpKey->key_data,
+					leafJumpKey->key_length, leafKey->key_data, newNode.prefix);
+				jumpNode.length = newNode.prefix - jumpNode.prefix;
 
-				if (currLevel->newAreaPointer < levelPointer)
+				const USHORT jumpNodeSize = jumpNode.getJumpNodeSize();
+				// Ensure the new jumpnode fits in the bucket
+				if (bucket->btr_length + leafLevel->totalJumpSize + jumpNodeSize < lp_fill_limit)
 				{
-					// Create a jumpnode
-					IndexJumpNode jumpNode;
-					jumpNode.prefix = IndexNode::computePrefix(pageJumpKey->key_data,
-															   pageJumpKey->key_length,
-															   temp_key.key_data,
-															   currLevel->levelNode.prefix);
-					jumpNode.length = currLevel->levelNode.prefix - jumpNode.prefix;
-
-					const USHORT jumpNodeSize = jumpNode.getJumpNodeSize();
-					// Ensure the new jumpnode fits in the bucket
-					if (bucket->btr_length + currLevel->totalJumpSize + jumpNodeSize < pp_fill_limit)
-					{
-						// Initialize the rest of the jumpnode
-						jumpNode.offset = (currLevel->levelNode.nodePointer - (UCHAR*) bucket);
-						jumpNode.data = FB_NEW_POOL(pool) UCHAR[jumpNode.length];
-						memcpy(jumpNode.data, temp_key.key_data + jumpNode.prefix, jumpNode.length);
-						// Push node on end in list
-						pageJumpNodes->add(jumpNode);
-						// Store new data in jumpKey, so a new jump node can calculate prefix
-						memcpy(pageJumpKey->key_data + jumpNode.prefix, jumpNode.data, jumpNode.length);
-						pageJumpKey->key_length = jumpNode.length + jumpNode.prefix;
-						// Set new position for generating jumpnode
-						currLevel->newAreaPointer += jumpAreaSize;
-						currLevel->totalJumpSize += jumpNodeSize;
-					}
+					// Initialize the rest of the jumpnode
+					jumpNode.offset = (newNode.nodePointer - (UCHAR*) bucket);
+					jumpNode.data = FB_NEW_POOL(pool) UCHAR[jumpNode.length];
+					memcpy(jumpNode.data, leafKey->key_data + jumpNode.prefix, jumpNode.length);
+					// Push node on end in list
+					leafJumpNodes->add(jumpNode);
+					// Store new data in leafJumpKey, so a new jump node can calculate prefix
+					memcpy(leafJumpKey->key_data + jumpNode.prefix, jumpNode.data, jumpNode.length);
+					leafJumpKey->key_length = jumpNode.length + jumpNode.prefix;
+					// Set new position for generating jumpnode
+					leafLevel->newAreaPointer += jumpAreaSize;
+					leafLevel->totalJumpSize += jumpNodeSize;
 				}
-
-				// Now restore the current key value and save this node as the
-				// current node on this level; also calculate the new page length.
-				copy_key(&temp_key, pageKey);
-				currLevel->pointer = levelPointer;
 			}
 
+			// If there wasn't a split, we're done.  If there was, propagate the
+			// split upward. Pages of the key range are propagated when the ranges
+			// are linked together.
+			if (!range)
+				propagate();
+
 			try
 			{
 				JRD_reschedule(tdbb);
@@ -5058,8 +5495,9 @@ static ULONG fast_load(thread_db* tdbb,
 		}
 
 		// To finish up, put an end of level marker on the last bucket
-		// of each level.
-		for (unsigned i = 0; i < levels.getCount(); i++)
+		// of each level. Leaf pages are already finished when the key
+		// ranges are linked together.
+		for (unsigned i = stitch ? 1 : 0; i < levels.getCount(); i++)
 		{
 			FastLoadLevel* const currLevel = &levels[i];
 
@@ -5071,15 +5509,19 @@ static ULONG fast_load(thread_db* tdbb,
 			const bool leafPage = (bucket->btr_level == 0);
 			window = &currLevel->window;
 
-			// store the end of level marker
-			pointer = (UCHAR*) bucket + bucket->btr_length;
-			currLevel->levelNode.setEndLevel();
-			pointer = currLevel->levelNode.writeNode(pointer, leafPage);
+			// store the end of level marker, unless the key range is followed
+			// by the next one
+			if (!endBucket)
+			{
+				pointer = (UCHAR*) bucket + bucket->btr_length;
+				currLevel->levelNode.setEndLevel();
+				pointer = currLevel->levelNode.writeNode(pointer, leafPage);
 
-			// and update the final page length
-			bucket->btr_length = pointer - (UCHAR*) bucket;
-			if (bucket->btr_length > dbb->dbb_page_size)
-				BUGCHECK(205);	// msg 205 index bucket overfilled
+				// and update the final page length
+				bucket->btr_length = pointer - (UCHAR*) bucket;
+				if (bucket->btr_length > dbb->dbb_page_size)
+					BUGCHECK(205);	// msg 205 index bucket overfilled
+			}
 
 			// Store jump nodes on page if needed.
 			JumpNodeList* const pageJumpNodes = currLevel->jumpNodes;
@@ -5158,6 +5600,17 @@ static ULONG fast_load(thread_db* tdbb,
 		if (error)
 			ERR_punt();
 
+		if (range)
+		{
+			// Statistics of the key range are summarized when ranges are linked
+			range->lastPage = levels[0].window.win_page.getPageNum();
+			range->count = count;
+			range->duplicates = duplicates;
+			range->duplicatesList.assign(duplicatesList);
+
+			return range->lastPage;
+		}
+
 		if (!relation->isTemporary())
 			CCH_flush(tdbb, FLUSH_ALL, 0);
 
@@ -5183,7 +5636,17 @@ static ULONG fast_load(thread_db* tdbb,
 				CCH_RELEASE(tdbb, &levels[i].window);
 		}
 
-		if (window)
+		if (range)
+		{
+			if (range->firstPage)
+			{
+				delete_tree(tdbb, relation->getId(), idx->idx_id,
+							PageNumber(pageSpaceID, range->firstPage), PageNumber(pageSpaceID, 0));
+			}
+
+			range->firstPage = 0;
+		}
+		else if (window)
 		{
 			delete_tree(tdbb, relation->getId(), idx->idx_id,
 						window->win_page, PageNumber(window->win_page.getPageSpaceID(), 0));
@@ -5230,7 +5693,7 @@ static const index_root_page* fetch_root(thread_db* tdbb, WIN* window, const Rel
 }
 
 
-static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key,
+static UCHAR* find_node_start_point(WIN* window, btree_page* bucket, temporary_key* key,
 									UCHAR* value,
 									USHORT* return_value, bool descending,
 									int retrieval, bool pointer_by_marker,
@@ -5256,7 +5719,7 @@ static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key,
 	const UCHAR* const endPointer = (UCHAR*) bucket + bucket->btr_length;
 
 	// Find point where we can start search.
-	UCHAR* pointer = find_area_start_point(bucket, key, value, &prefix, descending, retrieval,
+	UCHAR* pointer = find_area_start_point(window, bucket, key, value, &prefix, descending, retrieval,
 										   find_record_number);
 	const UCHAR* p = key->key_data + prefix;
 
@@ -5380,7 +5843,7 @@ done:
 }
 
 
-static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key,
+static UCHAR* find_area_start_point(WIN* window, btree_page* bucket, const temporary_key* key,
 									UCHAR* value,
 									USHORT* return_prefix, bool descending,
 									int retrieval, RecordNumber find_record_number)
@@ -5400,6 +5863,15 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
  *
  **************************************/
 	const bool useFindRecordNumber = (find_record_number != NO_VALUE);
+
+	// Page search index knows nothing about duplicates and descending keys
+	// and doesn't restore the key value
+	if (!useFindRecordNumber && !descending && !value)
+	{
+		if (UCHAR* const pointer = find_indexed_start_point(window, bucket, key, return_prefix))
+			return pointer;
+	}
+
 	const bool leafPage = (bucket->btr_level == 0);
 	const UCHAR* keyPointer = key->key_data;
 	const UCHAR* const keyEnd = keyPointer + key->key_length;
@@ -5604,7 +6076,56 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 }
 
 
-static ULONG find_page(btree_page* bucket, const temporary_key* key,
+static UCHAR* find_indexed_start_point(WIN* window, btree_page* bucket, const temporary_key* key,
+									   USHORT* return_prefix)
+{
+/**************************************
+ *
+ *	f i n d _ i n d e x e d _ s t a r t _ p o i n t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Locate the start point of the search using
+ *  the search index of the cached page. Return
+ *  NULL if the index can't be used.
+ *
+ **************************************/
+	BufferDesc* const bdb = window ? window->win_bdb : NULL;
+
+	// Page being modified can change without the change of incarnation
+	if (!bdb || (bdb->bdb_flags & BDB_writer))
+		return NULL;
+
+	fb_assert(bdb->bdb_buffer == (pag*) bucket);
+
+	BtrSearchIndex* index = bdb->bdb_search_index.load(std::memory_order_acquire);
+	if (!index)
+	{
+		BtrSearchIndex* const newIndex =
+			FB_NEW_POOL(*bdb->bdb_bcb->bcb_bufferpool) BtrSearchIndex(*bdb->bdb_bcb->bcb_bufferpool);
+
+		if (bdb->bdb_search_index.compare_exchange_strong(index, newIndex))
+			index = newIndex;
+		else
+			delete newIndex;
+	}
+
+	USHORT offset, prefix;
+	if (!index->findStartPoint(bucket, bdb->bdb_incarnation, key->key_data, key->key_length,
+			&offset, &prefix))
+	{
+		return NULL;
+	}
+
+	if (return_prefix)
+		*return_prefix = prefix;
+
+	return (UCHAR*) bucket + offset;
+}
+
+
+static ULONG find_page(WIN* window, btree_page* bucket, const temporary_key* key,
 					   const index_desc* idx, RecordNumber find_record_number,
 					   int retrieval)
 {
@@ -5639,7 +6160,7 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 	USHORT prefix = 0;	// last computed prefix against processed node
 
 	// pointer where to start reading next node
-	UCHAR* pointer = find_area_start_point(bucket, key, 0, &prefix,
+	UCHAR* pointer = find_area_start_point(window, bucket, key, 0, &prefix,
 										   descending, retrieval, find_record_number);
 
 	IndexNode node;
@@ -5774,6 +6295,96 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 }
 
 
+static ULONG find_leaf_optimistic(thread_db* tdbb, const WIN* window, const index_desc* idx,
+								  const temporary_key* key, int retrieval,
+								  ULONG* parent_number, ULONG* parent_incarnation)
+{
+/**************************************
+ *
+ *	f i n d _ l e a f _ o p t i m i s t i c
+ *
+ **************************************
+ *
+ * Functional description
+ *	Walk down the non-leaf levels of the index using page
+ *	copies taken without latches (see CCH_copy_page), thus
+ *	concurrent descents don't contend on the upper levels.
+ *	Return the number of the leaf page, or zero if some page
+ *	was not cached or was changed while read. The caller must
+ *	latch the leaf and then validate the parent page, the leaf
+ *	may be released if the parent was changed since it was read.
+ *	If there is no key, walk down the left side of the index.
+ *
+ **************************************/
+	Database* dbb = tdbb->getDatabase();
+	const USHORT pageSpaceID = window->win_page.getPageSpaceID();
+
+	// don't chase siblings forever while the index is changed heavily
+	const int MAX_STEPS = 2 * MAX_LEVELS;
+
+	HalfStaticArray<UCHAR, MAX_PAGE_SIZE + ODS_ALIGNMENT> buffer;
+	btree_page* page = (btree_page*) buffer.getAlignedBuffer(dbb->dbb_page_size, ODS_ALIGNMENT);
+
+	// the copy has no buffer, so the search index of the cached page is not used
+	WIN copyWindow(pageSpaceID, idx->idx_root);
+
+	ULONG number = idx->idx_root;
+	UCHAR level = MAX_LEVELS;
+
+	for (int step = 0; step < MAX_STEPS; step++)
+	{
+		ULONG incarnation;
+		if (!CCH_copy_page(tdbb, PageNumber(pageSpaceID, number), &page->btr_header, &incarnation))
+			return 0;
+
+		if (page->btr_header.pag_type != pag_index ||
+			(page->btr_header.pag_flags & btr_released) ||
+			page->btr_id != (UCHAR)(idx->idx_id % 256) ||
+			page->btr_level == 0 || page->btr_level > level)
+		{
+			return 0;
+		}
+
+		level = page->btr_level;
+		ULONG next;
+
+		if (key)
+		{
+			copyWindow.win_page = PageNumber(pageSpaceID, number);
+			next = find_page(&copyWindow, page, key, idx, NO_VALUE, retrieval);
+
+			if (next == END_BUCKET)
+			{
+				number = page->btr_sibling;
+				continue;
+			}
+		}
+		else
+		{
+			IndexNode node;
+			const UCHAR* const endPointer = (UCHAR*) page + page->btr_length;
+			const UCHAR* pointer = node.readNode(page->btr_nodes + page->btr_jump_size, false);
+
+			if (pointer > endPointer)
+				BUGCHECK(204);	// msg 204 index inconsistent
+
+			next = node.pageNumber;
+		}
+
+		if (level == 1)
+		{
+			*parent_number = number;
+			*parent_incarnation = incarnation;
+			return next;
+		}
+
+		number = next;
+	}
+
+	return 0;
+}
+
+
 static contents garbage_collect(thread_db* tdbb, WIN* window, ULONG parent_number)
 {
 /**************************************
@@ -6474,7 +7085,7 @@ static ULONG insert_node(thread_db* tdbb,
 		insertion->iib_number : *new_record_number;
 
 	// For checking on duplicate nodes we should find the first matching key.
-	UCHAR* pointer = find_node_start_point(bucket, key, 0, &prefix,
+	UCHAR* pointer = find_node_start_point(window, bucket, key, 0, &prefix,
 						idx->idx_flags & idx_descending,
 						false, true, validateDuplicates ? NO_VALUE : newRecordNumber);
 	if (!pointer)
@@ -6898,6 +7509,13 @@ static ULONG insert_node(thread_db* tdbb,
 	split->btr_sibling = right_sibling;
 	split->btr_left_sibling = window->win_page.getPageNum();
 
+	// Suffix truncation: only the shortest key separating the pages goes to the
+	// parent. The upper levels compare bytes in the ascending order only, and
+	// their own separators can't be shortened as keys equal to them may be
+	// stored in the left subtree.
+	const USHORT separatorLength = (leafPage && !(idx->idx_flags & idx_descending)) ?
+		separator_length(newBucket, node.nodePointer, new_key) : new_key->key_length;
+
 	// Format the first node on the overflow page
 	newNode.setNode(0, new_key->key_length, node.recordNumber, node.pageNumber);
 	// Return first record number on split page to caller.
@@ -6963,7 +7581,15 @@ static ULONG insert_node(thread_db* tdbb,
 
 	// mark the end of the page; note that the end_bucket marker must
 	// contain info about the first node on the next page. So we don't
-	// overwrite the existing data.
+	// overwrite the existing data. The key is truncated as the separator
+	// propagated to the parent page, so the page never gets keys which
+	// the parent page routes to the split page.
+	if (separatorLength < new_key->key_length)
+	{
+		fb_assert(node.prefix < separatorLength);
+		node.length = separatorLength - node.prefix;
+	}
+
 	node.setEndBucket();
 	pointer = node.writeNode(node.nodePointer, leafPage, false);
 	newBucket->btr_length = pointer - (UCHAR*) newBucket;
@@ -7033,6 +7659,7 @@ static ULONG insert_node(thread_db* tdbb,
 
 	jumpNodes->clear();
 
+	new_key->key_length = separatorLength;
 	new_key->key_nulls = 0;
 	if (unique)
 	{
@@ -7055,6 +7682,107 @@ static ULONG insert_node(thread_db* tdbb,
 }
 
 
+static ULONG insert_rightmost(thread_db* tdbb,
+							  index_insertion* insertion,
+							  temporary_key* new_key,
+							  RecordNumber* new_record_number)
+{
+/**************************************
+ *
+ *	i n s e r t _ r i g h t m o s t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Insert a node into the rightmost leaf page remembered
+ *	by the previous insertion (see add_node) without walking
+ *	down from the top of the index. Return NO_VALUE_PAGE if
+ *	the page is not known or was changed, or the key doesn't
+ *	belong to it. Otherwise return the result of insert_node.
+ *	The caller holds the index root page, thus the index
+ *	can't be dropped meanwhile.
+ *
+ **************************************/
+	index_desc* const idx = insertion->iib_descriptor;
+	jrd_rel* const relation = insertion->iib_relation;
+	RelationPages* const relPages = relation->getPages(tdbb);
+
+	// keys are compared bytewise below, this is not the order of descending index
+	if (idx->idx_flags & idx_descending)
+		return NO_VALUE_PAGE;
+
+	RelationPages::RightLeaf hint;
+	if (!relPages->getRightLeaf(idx->idx_id, hint) || hint.root != idx->idx_root)
+		return NO_VALUE_PAGE;
+
+	// The leaf is still the rightmost one if its parent was not changed since
+	// the hint was taken. Check it before any page is latched: the leaf could
+	// be released and reused meanwhile, so it's not fetched unless the parent
+	// still points to it.
+
+	const PageNumber parentNumber(relPages->rel_pg_space_id, hint.parent);
+
+	if (!CCH_validate_copy(tdbb, parentNumber, hint.parentIncarnation))
+	{
+		relPages->resetRightLeaf(idx->idx_id);
+		return NO_VALUE_PAGE;
+	}
+
+	// Go down from the parent as the usual insertion does, so the parent
+	// can't be changed until the leaf is latched
+
+	WIN window(parentNumber);
+	CCH_FETCH(tdbb, &window, LCK_read, pag_undefined);
+
+	if ((ULONG) CCH_get_incarnation(&window) != hint.parentIncarnation)
+	{
+		CCH_RELEASE(tdbb, &window);
+		relPages->resetRightLeaf(idx->idx_id);
+		return NO_VALUE_PAGE;
+	}
+
+	btree_page* const page = (btree_page*) CCH_HANDOFF(tdbb, &window, hint.leaf, LCK_write, pag_undefined);
+
+	bool valid = page->btr_header.pag_type == pag_index &&
+		!(page->btr_header.pag_flags & btr_released) &&
+		page->btr_relation == relation->getId() &&
+		page->btr_id == (UCHAR)(idx->idx_id % 256) &&
+		page->btr_level == 0 && !page->btr_sibling;
+
+	// The key must be greater than the first one on the page, otherwise it
+	// could belong to the left sibling. The first node has no prefix.
+	if (valid)
+	{
+		const temporary_key* const key = insertion->iib_key;
+
+		IndexNode node;
+		node.readNode(page->btr_nodes + page->btr_jump_size, true);
+		valid = !node.isEndLevel;
+
+		if (valid)
+		{
+			const int result = memcmp(key->key_data, node.data, MIN(key->key_length, node.length));
+			valid = (result > 0 || (result == 0 && key->key_length > node.length));
+		}
+	}
+
+	if (!valid)
+	{
+		// Don't try it again until the rightmost leaf is met by the usual insertion
+		CCH_RELEASE(tdbb, &window);
+		relPages->resetRightLeaf(idx->idx_id);
+		return NO_VALUE_PAGE;
+	}
+
+	const ULONG split = insert_node(tdbb, &window, insertion, new_key, new_record_number, NULL, NULL);
+
+	if (split == NO_VALUE_PAGE)
+		CCH_RELEASE(tdbb, &window);
+
+	return split;
+}
+
+
 static INT64_KEY make_int64_key(SINT64 q, SSHORT scale)
 {
 /**************************************
@@ -7212,7 +7940,7 @@ static contents remove_node(thread_db* tdbb, index_insertion* insertion, WIN* wi
 
 	while (true)
 	{
-		const ULONG number = find_page(page, insertion->iib_key, idx, insertion->iib_number);
+		const ULONG number = find_page(window, page, insertion->iib_key, idx, insertion->iib_number);
 
 		// we should always find the node, but let's make sure
 		if (number == END_LEVEL)
@@ -7282,7 +8010,7 @@ static contents remove_leaf_node(thread_db* tdbb, index_insertion* insertion, WI
 	// Look for the first node with the value to be removed.
 	UCHAR* pointer;
 	USHORT prefix;
-	while (!(pointer = find_node_start_point(page, key, 0, &prefix,
+	while (!(pointer = find_node_start_point(window, page, key, 0, &prefix,
 			(idx->idx_flags & idx_descending),
 			false, false,
 			(validateDuplicates ? NO_VALUE : insertion->iib_number))))
@@ -7619,6 +8347,51 @@ static bool scan(thread_db* tdbb, UCHAR* pointer, RecordBitmap** bitmap, RecordB
 }
 
 
+static USHORT separator_length(btree_page* page, const UCHAR* splitPointer, const temporary_key* key)
+{
+/**************************************
+ *
+ *	s e p a r a t o r _ l e n g t h
+ *
+ **************************************
+ *
+ * Functional description
+ *	A leaf page has been split at splitPointer and key is the first
+ *	key of the split page. Return the length of the shortest prefix
+ *	of key which is still greater than the last key left on the page.
+ *	Only this prefix is propagated to the parent page and stored in
+ *	the END_BUCKET marker of the page, so the high key of the page
+ *	is always equal to its separator in the parent page. Keys between
+ *	the separator and the first key of the split page are routed to
+ *	the split page by both of them.
+ *
+ **************************************/
+	temporary_mini_key lastKey;
+	lastKey.key_length = 0;
+
+	UCHAR* pointer = page->btr_nodes + page->btr_jump_size;
+	if (pointer >= splitPointer)
+		return key->key_length;
+
+	IndexNode node;
+	while (pointer < splitPointer)
+	{
+		pointer = node.readNode(pointer, true);
+		memcpy(lastKey.key_data + node.prefix, node.data, node.length);
+		lastKey.key_length = node.prefix + node.length;
+	}
+
+	if (pointer != splitPointer)
+		return key->key_length;
+
+	// duplicates can't be separated by a shorter key
+	const USHORT prefix = IndexNode::computePrefix(lastKey.key_data, lastKey.key_length,
+		key->key_data, key->key_length);
+
+	return (prefix < key->key_length) ? prefix + 1 : key->key_length;
+}
+
+
 void update_selectivity(index_root_page* root, MetaId id, const SelectivityList& selectivity)
 {
 /**************************************
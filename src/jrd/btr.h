@@ -29,6 +29,7 @@
 
 #include "../jrd/constants.h"
 #include "../common/classes/array.h"
+#include "../common/classes/objects_array.h"
 #include "../include/fb_blk.h"
 
 #include "../jrd/err_proto.h"    // Index error types
@@ -330,6 +331,26 @@ private:
 #endif
 };
 
+// Key range of the index loaded by the parallel worker, see BTR_load_range
+
+struct IndexRange
+{
+	explicit IndexRange(MemoryPool& p)
+		: sort(NULL), first(p), next(p), firstPage(0), lastPage(0), pages(p),
+		  count(0), duplicates(0), duplicatesList(p)
+	{}
+
+	PartitionedSort* sort;
+	Firebird::Array<UCHAR> first;		// first sort record of the range
+	Firebird::Array<UCHAR> next;		// first sort record of the next range
+	ULONG firstPage;					// leaf pages chain
+	ULONG lastPage;
+	Firebird::Array<UCHAR> pages;		// leaf pages to be propagated to the upper levels
+	FB_UINT64 count;
+	FB_UINT64 duplicates;
+	Firebird::HalfStaticArray<FB_UINT64, 4> duplicatesList;
+};
+
 // Struct used for index creation
 
 struct IndexCreation
@@ -339,6 +360,7 @@ struct IndexCreation
 	QualifiedName index_name;
 	jrd_tra* transaction;
 	PartitionedSort* sort;
+	Firebird::ObjectsArray<IndexRange>* ranges;	// loaded key ranges, if any
 	sort_key_def* key_desc;
 	USHORT key_length;
 	USHORT nullIndLen;
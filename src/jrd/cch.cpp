@@ -195,6 +195,7 @@ static void flushAll(thread_db* tdbb, USHORT flush_flag);
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count);
 
 static void recentlyUsed(BufferDesc* bdb);
+static bool isCopyable(const BufferDesc* bdb, const PageNumber& page);
 static void requeueRecentlyUsed(BufferControl* bcb);
 
 
@@ -366,6 +367,66 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 }
 
 
+bool CCH_copy_page(thread_db* tdbb, PageNumber page, Ods::pag* copy, ULONG* incarnation)
+{
+/**************************************
+ *
+ *	C C H _ c o p y _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Copy the cached page without latching its buffer.
+ *	The copy is validated by the page incarnation, which
+ *	is changed every time the page is read or marked.
+ *	Return false if the page is not in the cache or is
+ *	being changed, the caller should fetch it as usual then.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* dbb = tdbb->getDatabase();
+	BufferControl* bcb = dbb->dbb_bcb;
+
+	// Without the page lock the buffer could be stale if the page
+	// is also cached by another process
+
+	if (!(bcb->bcb_flags & BCB_exclusive))
+		return false;
+
+	BufferDesc* bdb;
+	{
+#ifndef HASH_USE_CDS_LIST
+		SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
+#endif
+		bdb = bcb->bcb_hashTable->find(page);
+	}
+
+	if (!bdb)
+		return false;
+
+	const ULONG current = bdb->bdb_incarnation.load(std::memory_order_acquire);
+
+	if (!isCopyable(bdb, page))
+		return false;
+
+	memcpy(copy, bdb->bdb_buffer, dbb->dbb_page_size);
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	if (bdb->bdb_incarnation.load(std::memory_order_relaxed) != current || !isCopyable(bdb, page))
+		return false;
+
+	// Don't touch the shared flags of the hot buffer if it's already in LRU chain
+	if (!(bdb->bdb_flags & BDB_lru_chained))
+		recentlyUsed(bdb);
+
+	tdbb->bumpStats(PageStatType::FETCHES, page.getPageSpaceID());
+
+	*incarnation = current;
+	return true;
+}
+
+
 int CCH_down_grade_dbb(void* ast_object)
 {
 /**************************************
@@ -973,6 +1034,8 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 			Database *dbb = tdbb->getDatabase();
 			int retryCount = 0;
 
+			RuntimeStatistics::WaitTimer timer(tdbb, WaitStatType::READ_TIME);
+
 			while (!PIO_read(tdbb, file, bdb, page, status))
 	 		{
 				if (isTempPage || !read_shadow)
@@ -1737,6 +1800,9 @@ void CCH_mark(thread_db* tdbb, WIN* window, bool mark_system, bool must_write)
 
 	bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
 
+	// Page changes must not be seen before the new incarnation, see CCH_copy_page
+	std::atomic_thread_fence(std::memory_order_release);
+
 	// mark the dirty bit vector for this specific transaction,
 	// if it exists; otherwise mark that the system transaction
 	// has updated this page
@@ -2432,6 +2498,39 @@ bool CCH_validate(WIN* window)
 }
 
 
+bool CCH_validate_copy(thread_db* tdbb, PageNumber page, ULONG incarnation)
+{
+/**************************************
+ *
+ *	C C H _ v a l i d a t e _ c o p y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check that the page copied by CCH_copy_page (or which
+ *	incarnation was got from its latched buffer) was not
+ *	changed since then.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	BufferControl* bcb = tdbb->getDatabase()->dbb_bcb;
+
+	if (!(bcb->bcb_flags & BCB_exclusive))
+		return false;
+
+	BufferDesc* bdb;
+	{
+#ifndef HASH_USE_CDS_LIST
+		SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
+#endif
+		bdb = bcb->bcb_hashTable->find(page);
+	}
+
+	return bdb && bdb->bdb_incarnation.load(std::memory_order_acquire) == incarnation &&
+		isCopyable(bdb, page);
+}
+
+
 bool CCH_write_all_shadows(thread_db* tdbb, Shadow* shadow, BufferDesc* bdb, Ods::pag* page,
 	FbStatusVector* status, const bool inAst)
 {
@@ -4996,6 +5095,7 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 					bool callback(thread_db* tdbb, FbStatusVector* status, Ods::pag* page)
 					{
 						Database* dbb = tdbb->getDatabase();
+						RuntimeStatistics::WaitTimer timer(tdbb, WaitStatType::WRITE_TIME);
 
 						while (!PIO_write(tdbb, file, bdb, page, status))
 						{
@@ -5009,6 +5109,8 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 							file = pageSpace->file;
 						}
 
+						timer.stop();
+
 						if (bdb->bdb_page == HEADER_PAGE_NUMBER)
 						{
 							const auto header = (const header_page*) page;
@@ -5100,6 +5202,14 @@ static void clear_dirty_flag_and_nbak_state(thread_db* tdbb, BufferDesc* bdb)
 		fb_assert(PageSpace::isTemporary(bdb->bdb_page.getPageSpaceID()));
 }
 
+bool isCopyable(const BufferDesc* bdb, const PageNumber& page)
+{
+	// Buffer contains the page and nobody is changing it
+
+	return bdb->bdb_page == page && bdb->bdb_syncPage.getState() != SYNC_EXCLUSIVE &&
+		!(bdb->bdb_flags & (BDB_read_pending | BDB_free_pending | BDB_not_valid | BDB_io_error));
+}
+
 void recentlyUsed(BufferDesc* bdb)
 {
 	const AtomicCounter::counter_type oldFlags = bdb->bdb_flags.exchangeBitOr(BDB_lru_chained);
@@ -5189,10 +5299,20 @@ void BufferControl::destroy(BufferControl* bcb)
 
 bool BufferDesc::addRef(thread_db* tdbb, SyncType syncType, int wait)
 {
-	if (wait == 1)
-		bdb_syncPage.lock(NULL, syncType, FB_FUNCTION);
-	else if (!bdb_syncPage.lock(NULL, syncType, FB_FUNCTION, -wait * 1000))
-		return false;
+	// Only the contended latch we're going to block on is accounted as a wait
+
+	if (!bdb_syncPage.lockConditional(syncType, FB_FUNCTION))
+	{
+		if (!wait)
+			return false;
+
+		RuntimeStatistics::WaitTimer timer(tdbb, WaitStatType::LATCH_TIME, WaitStatType::LATCH_WAITS);
+
+		if (wait == 1)
+			bdb_syncPage.lock(NULL, syncType, FB_FUNCTION);
+		else if (!bdb_syncPage.lock(NULL, syncType, FB_FUNCTION, -wait * 1000))
+			return false;
+	}
 
 	++bdb_use_count;
 
@@ -61,6 +61,7 @@ class Precedence;
 class thread_db;
 struct que;
 class BufferDesc;
+class BtrSearchIndex;
 class Database;
 class BCBHashTable;
 
@@ -213,6 +214,7 @@ public:
 		bdb_scan_count = 0;
 		bdb_difference_page = 0;
 		bdb_prec_walk_mark = 0;
+		bdb_search_index = nullptr;
 	}
 
 	bool addRef(thread_db* tdbb, Firebird::SyncType syncType, int wait = 1);
@@ -247,7 +249,7 @@ public:
 	BufferDesc*	bdb_lru_chain;			// pending LRU chain
 	Ods::pag*	bdb_buffer;				// Actual buffer
 	PageNumber	bdb_page;				// Database page number in buffer
-	ULONG		bdb_incarnation;
+	std::atomic<ULONG>	bdb_incarnation;	// changed when page is read or marked, see CCH_copy_page
 	ULONG		bdb_transactions;		// vector of dirty flags to reduce commit overhead
 	TraNumber	bdb_mark_transaction;	// hi-water mark transaction to defer header page I/O
 	que			bdb_lower;				// lower precedence que
@@ -267,6 +269,7 @@ public:
 	Firebird::AtomicCounter	bdb_scan_count;		// concurrent sequential scans
 	ULONG       bdb_difference_page;			// Number of page in difference file, NBAK
 	ULONG		bdb_prec_walk_mark;				// mark value used in precedence graph walk
+	std::atomic<BtrSearchIndex*>	bdb_search_index;	// search index of B-tree page, see btn.h
 };
 
 // bdb_flags
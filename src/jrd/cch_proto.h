@@ -41,6 +41,7 @@ enum LockState {
 };
 
 void		CCH_clean_page(Jrd::thread_db*, Jrd::PageNumber);
+bool		CCH_copy_page(Jrd::thread_db*, Jrd::PageNumber, Ods::pag*, ULONG*);
 int			CCH_down_grade_dbb(void*);
 bool		CCH_exclusive(Jrd::thread_db*, USHORT, SSHORT, Firebird::Sync*);
 bool		CCH_exclusive_attachment(Jrd::thread_db*, USHORT, SSHORT, Firebird::Sync*);
@@ -73,6 +74,7 @@ bool		CCH_rollover_to_shadow(Jrd::thread_db* tdbb, Jrd::Database* dbb, Jrd::jrd_
 void		CCH_shutdown(Jrd::thread_db*);
 void		CCH_unwind(Jrd::thread_db*, const bool);
 bool		CCH_validate(Jrd::win*);
+bool		CCH_validate_copy(Jrd::thread_db*, Jrd::PageNumber, ULONG);
 void		CCH_flush_ast(Jrd::thread_db*);
 bool		CCH_write_all_shadows(Jrd::thread_db*, Jrd::Shadow*, Jrd::BufferDesc*, Ods::pag*,
 					 Jrd::FbStatusVector*, const bool);
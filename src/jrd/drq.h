@@ -243,6 +243,7 @@ enum drq_type_t
 	drq_l_rel_con,			// lookup relation constraint
 	drq_l_rel_fld_name,		// lookup relation field name
 	drq_g_nxt_package_id,	// lookup next package ID
+	drq_l_truncate_fk,		// lookup foreign keys referencing truncated relation
 
 	drq_MAX
 };
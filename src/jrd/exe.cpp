@@ -1717,6 +1717,10 @@ const StmtNode* EXE_looper(thread_db* tdbb, Request* request, const StmtNode* no
 		profilerInitialTicks = profilerLastTicks = profilerManager->queryTicks();
 		profilerInitialAccumulatedOverhead = profilerLastAccumulatedOverhead =
 			profilerManager->getAccumulatedOverhead();
+
+		// Don't count the time spent outside the engine as the top level request execution
+		if (!exeState.oldRequest && profilerManager->isSampling())
+			profilerManager->syncSampleClock();
 	}
 	else
 	{
@@ -1767,7 +1771,12 @@ const StmtNode* EXE_looper(thread_db* tdbb, Request* request, const StmtNode* no
 							profilerManager->getAccumulatedOverhead();
 					}
 
-					if (node->hasLineColumn &&
+					if (profilerManager->isSampling())
+					{
+						if (profilerManager->isSamplePending())
+							profilerManager->takeSample(request);
+					}
+					else if (node->hasLineColumn &&
 						node->isProfileAware() &&
 						(exeState.forceProfileNextEvaluate ||
 						 !profileNode ||
@@ -214,6 +214,9 @@ public:
 	const ULONG IS_GBAK			= 0x01;		// main attachment is gbak attachment
 	const ULONG IS_LARGE_SCAN	= 0x02;		// relation not fits into page cache
 
+	const ULONG SAMPLE_PAGES	= 16;		// data pages sampled per key range
+	const ULONG SAMPLE_RECORDS	= 8;		// records sampled per data page
+
 	IndexCreateTask(thread_db* tdbb, MemoryPool* pool, IndexCreation* creation) : Task(),
 		m_pool(pool),
 		m_dbb(tdbb->getDatabase()),
@@ -221,9 +224,13 @@ public:
 		m_flags(0),
 		m_creation(creation),
 		m_items(*m_pool),
+		m_ranges(*m_pool),
+		m_splitters(*m_pool),
 		m_stop(false),
+		m_building(false),
 		m_countPP(0),
-		m_nextPP(0)
+		m_nextPP(0),
+		m_nextRange(0)
 	{
 		Attachment* att = tdbb->getAttachment();
 
@@ -269,6 +276,9 @@ public:
 	{
 		for (Item** p = m_items.begin(); p < m_items.end(); p++)
 			delete *p;
+
+		for (FB_SIZE_T i = 0; i < m_ranges.getCount(); i++)
+			delete m_ranges[i].sort;
 	}
 
 	bool handler(WorkItem& _item);
@@ -281,6 +291,10 @@ public:
 		return (m_flags & IS_GBAK);
 	}
 
+	void sampleKeys(thread_db* tdbb);
+	bool prepareRanges(thread_db* tdbb);
+	void releaseRanges(thread_db* tdbb);
+
 	class Item : public Task::WorkItem
 	{
 	public:
@@ -288,17 +302,17 @@ public:
 			m_inuse(false),
 			m_ownAttach(true),
 			m_tra(NULL),
-			m_sort(NULL),
-			m_ppSequence(0)
+			m_sorts(*task->m_pool),
+			m_ppSequence(0),
+			m_range(0)
 		{}
 
 		virtual ~Item()
 		{
-			if (m_sort)
-			{
-				delete m_sort;
-				m_sort = NULL;
-			}
+			for (Sort** p = m_sorts.begin(); p < m_sorts.end(); p++)
+				delete *p;
+
+			m_sorts.clear();
 
 			if (!m_ownAttach || !m_attStable)
 				return;
@@ -365,7 +379,7 @@ public:
 
 			tdbb->setTransaction(m_tra);
 
-			if (!m_sort)
+			if (m_sorts.isEmpty() && !getTask()->m_building)
 			{
 				m_idx = *creation->index;	// copy
 				if (m_ownAttach)
@@ -388,17 +402,30 @@ public:
 
 				MutexLockGuard guard(getTask()->m_mutex, FB_FUNCTION);
 
-				m_sort = FB_NEW_POOL(m_tra->tra_sorts.getPool())
-							Sort(att->att_database, &m_tra->tra_sorts,
-								 creation->key_length + sizeof(index_sort_record),
-								 2, 1, creation->key_desc, callback, callback_arg);
+				// One sort per key range, if any
+				ObjectsArray<IndexRange>& ranges = getTask()->m_ranges;
+				const FB_SIZE_T count = ranges.hasData() ? ranges.getCount() : 1;
+
+				for (FB_SIZE_T i = 0; i < count; i++)
+				{
+					Sort* const sort = FB_NEW_POOL(m_tra->tra_sorts.getPool())
+						Sort(att->att_database, &m_tra->tra_sorts,
+							 creation->key_length + sizeof(index_sort_record),
+							 2, 1, creation->key_desc, callback, callback_arg);
 
-				creation->sort->addPartition(m_sort);
+					m_sorts.add(sort);
+					(ranges.hasData() ? ranges[i].sort : creation->sort)->addPartition(sort);
+				}
 			}
 
 			return true;
 		}
 
+		bool isSorted() const
+		{
+			return m_sorts.hasData() && m_sorts.back()->isSorted();
+		}
+
 		IndexCreateTask* getTask() const
 		{
 			return reinterpret_cast<IndexCreateTask*> (m_task);
@@ -409,8 +436,9 @@ public:
 		RefPtr<StableAttachmentPart> m_attStable;
 		jrd_tra* m_tra;
 		index_desc m_idx;
-		Sort* m_sort;
+		HalfStaticArray<Sort*, 8> m_sorts;
 		ULONG m_ppSequence;
+		FB_SIZE_T m_range;
 	};
 
 private:
@@ -427,6 +455,52 @@ private:
 			m_stop = true;
 	}
 
+	// Store the key as the sort record does: NULL indicator and the key padded
+	// up to the maximum key length
+	UCHAR* putSortKey(const temporary_key* key, UCHAR* p) const
+	{
+		const UCHAR pad = (m_creation->index->idx_flags & idx_descending) ? -1 : 0;
+
+		if (m_creation->nullIndLen)
+			*p++ = (key->key_length == 0) ? 0 : 1;
+
+		if (key->key_length > 0)
+		{
+			memcpy(p, key->key_data, key->key_length);
+			p += key->key_length;
+		}
+
+		const int l = int(m_creation->key_length) - m_creation->nullIndLen - key->key_length;	// must be signed
+
+		if (l > 0)
+		{
+			memset(p, pad, l);
+			p += l;
+		}
+
+		return p;
+	}
+
+	// Key range of the sort key: the number of splitters not greater than the key.
+	// Thus equal keys always belong to the same range.
+	FB_SIZE_T getRange(const UCHAR* sortKey) const
+	{
+		const ULONG length = m_creation->key_length;
+		FB_SIZE_T lo = 0, hi = m_ranges.getCount() - 1;
+
+		while (lo < hi)
+		{
+			const FB_SIZE_T mid = (lo + hi) / 2;
+
+			if (memcmp(sortKey, m_splitters.begin() + mid * length, length) < 0)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+
+		return lo;
+	}
+
 	MemoryPool* m_pool;
 	Database* m_dbb;
 	const ULONG m_tdbb_flags;
@@ -437,11 +511,15 @@ private:
 
 	Mutex m_mutex;
 	HalfStaticArray<Item*, 8> m_items;
+	ObjectsArray<IndexRange> m_ranges;		// key ranges loaded by workers, if any
+	Array<UCHAR> m_splitters;				// first sort keys of the key ranges except the first one
 	StatusHolder m_status;
 
 	volatile bool m_stop;
+	bool m_building;						// workers load the key ranges
 	ULONG m_countPP;
 	ULONG m_nextPP;
+	FB_SIZE_T m_nextRange;
 };
 
 bool IndexCreateTask::handler(WorkItem& _item)
@@ -461,13 +539,18 @@ bool IndexCreateTask::handler(WorkItem& _item)
 
 	WorkerContextHolder holder(tdbb, FB_FUNCTION);
 
+	if (m_building)
+	{
+		BTR_load_range(tdbb, *m_creation, m_ranges[item->m_range]);
+		return true;
+	}
+
 	Database* dbb = tdbb->getDatabase();
 	Attachment* attachment = tdbb->getAttachment();
 	jrd_rel* relation = MetadataCache::getVersioned<Cached::Relation>(tdbb, m_creation->relation->getId(), CacheFlag::AUTOCREATE);
 
 	index_desc* idx = &item->m_idx;
 	jrd_tra* transaction = item->m_tra ? item->m_tra : m_creation->transaction;
-	Sort* scb = item->m_sort;
 
 	RecordStack stack;
 	record_param primary, secondary;
@@ -495,8 +578,11 @@ bool IndexCreateTask::handler(WorkItem& _item)
 			idx->idx_condition_statement = NULL;
 		}
 
-		if (!m_stop && m_creation->duplicates.value() == 0)
-			scb->sort(tdbb);
+		for (Sort** scb = item->m_sorts.begin(); scb < item->m_sorts.end(); scb++)
+		{
+			if (!m_stop && m_creation->duplicates.value() == 0)
+				(*scb)->sort(tdbb);
+		}
 
 		if (!m_stop && m_creation->duplicates.value() > 0)
 		{
@@ -567,10 +653,8 @@ bool IndexCreateTask::handler(WorkItem& _item)
 		primary.rpb_org_scans = secondary.rpb_org_scans = getPermanent(relation)->rel_scan_count++;
 	}
 
-	const bool isDescending = (idx->idx_flags & idx_descending);
 	const bool isPrimary = (idx->idx_flags & idx_primary);
 	const bool isForeign = (idx->idx_flags & idx_foreign);
-	const UCHAR pad = isDescending ? -1 : 0;
 
 	primary.rpb_number.compose(dbb->dbb_max_records, dbb->dbb_dp_per_pp, 0, 0, item->m_ppSequence);
 	primary.rpb_number.decrement();
@@ -581,6 +665,7 @@ bool IndexCreateTask::handler(WorkItem& _item)
 
 	IndexKey key(tdbb, relation, idx);
 	IndexCondition condition(tdbb, idx);
+	HalfStaticArray<UCHAR, 256> sortKey;
 
 	// Loop thru the relation computing index keys.  If there are old versions, find them, too.
 	while (DPM_next(tdbb, &primary, LCK_read, DPM_next_pointer_page))
@@ -694,8 +779,15 @@ bool IndexCreateTask::handler(WorkItem& _item)
 				context.raise(tdbb, idx_e_keytoobig, record);
 			}
 
+			FB_SIZE_T range = 0;
+			if (m_ranges.hasData())
+			{
+				putSortKey(key, sortKey.getBuffer(m_creation->key_length));
+				range = getRange(sortKey.begin());
+			}
+
 			UCHAR* p;
-			scb->put(tdbb, reinterpret_cast<ULONG**>(&p));
+			item->m_sorts[range]->put(tdbb, reinterpret_cast<ULONG**>(&p));
 
 			// try to catch duplicates early
 
@@ -709,22 +801,7 @@ bool IndexCreateTask::handler(WorkItem& _item)
 				break;
 			}
 
-			if (m_creation->nullIndLen)
-				*p++ = (key->key_length == 0) ? 0 : 1;
-
-			if (key->key_length > 0)
-			{
-				memcpy(p, key->key_data, key->key_length);
-				p += key->key_length;
-			}
-
-			int l = int(m_creation->key_length) - m_creation->nullIndLen - key->key_length;	// must be signed
-
-			if (l > 0)
-			{
-				memset(p, pad, l);
-				p += l;
-			}
+			p = putSortKey(key, p);
 
 			const bool key_is_null = (key->key_nulls == (1 << idx->idx_count) - 1);
 
@@ -783,8 +860,16 @@ bool IndexCreateTask::getWorkItem(WorkItem** pItem)
 	if (!item)
 		return false;
 
-	item->m_inuse = (m_nextPP < m_countPP) ||
-		(item->m_sort && item->m_sort->isSorted()) == 0;
+	if (m_building)
+	{
+		item->m_inuse = (m_nextRange < m_ranges.getCount());
+		if (item->m_inuse)
+			item->m_range = m_nextRange++;
+
+		return item->m_inuse;
+	}
+
+	item->m_inuse = (m_nextPP < m_countPP) || !item->isSorted();
 
 	if (item->m_inuse)
 	{
@@ -818,9 +903,167 @@ int IndexCreateTask::getMaxWorkers()
 	if (!m_creation || m_creation->relation->isTemporary())
 		return 1;
 
+	if (m_building)
+		return MIN(parWorkers, m_ranges.getCount());
+
 	return MIN(parWorkers, m_countPP);
 }
 
+void IndexCreateTask::sampleKeys(thread_db* tdbb)
+{
+	// With shared page cache workers can also load the leaf pages of the index,
+	// every worker its own key range. Ranges are chosen by the keys of sampled
+	// records and every range is sorted separately. Sampling is done by the
+	// main attachment before the workers are started as their sorts depend
+	// on the ranges.
+	//
+	// Read the keys of some records spread evenly over the relation and choose
+	// the splitters of the key ranges of about the same size. Keys of empty
+	// strings and NULLs are not used as splitters: they have the same key value
+	// and differ by the NULL indicator of sort record only.
+
+	// Unlike the scan, loading is not limited by the number of pointer pages
+	const ULONG ranges = m_items.getCount();
+	if (ranges <= 1 || !m_countPP || m_creation->relation->isTemporary() ||
+		!(m_dbb->dbb_flags & DBB_shared))
+	{
+		return;
+	}
+
+	fb_assert(m_ranges.isEmpty());
+
+	jrd_rel* const relation = m_creation->relation;
+	index_desc* const idx = m_creation->index;
+	const ULONG length = m_creation->key_length;
+
+	Array<ULONG> pages(*tdbb->getDefaultPool());
+	DPM_sample_pages(tdbb, relation, ranges * SAMPLE_PAGES, pages);
+
+	SortedObjectsArray<string> samples(*tdbb->getDefaultPool());
+	HalfStaticArray<UCHAR, 256> sortKey;
+	UCHAR* const buffer = sortKey.getBuffer(length);
+
+	record_param rpb;
+	rpb.rpb_relation = relation;
+
+	AutoTempRecord record(relation->getGCRecord(tdbb));
+	IndexKey key(tdbb, relation, idx);
+	IndexCondition condition(tdbb, idx);
+
+	for (const ULONG sequence : pages)
+	{
+		rpb.rpb_number.compose(m_dbb->dbb_max_records, m_dbb->dbb_dp_per_pp, 0,
+			sequence % m_dbb->dbb_dp_per_pp, sequence / m_dbb->dbb_dp_per_pp);
+		rpb.rpb_number.decrement();
+
+		for (ULONG n = 0; n < SAMPLE_RECORDS && DPM_next(tdbb, &rpb, LCK_read, DPM_next_data_page); n++)
+		{
+			if (rpb.rpb_number.getValue() / m_dbb->dbb_max_records != sequence)
+			{
+				CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+				break;
+			}
+
+			if (rpb.rpb_flags & rpb_deleted)
+			{
+				CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+				continue;
+			}
+
+			rpb.rpb_record = record;
+			VIO_data(tdbb, &rpb, relation->rel_pool);
+
+			idx_e result = idx_e_ok;
+			const auto checkResult = condition.check(rpb.rpb_record, &result);
+
+			if (result != idx_e_ok || !checkResult.asBool())
+				continue;
+
+			if (key.compose(rpb.rpb_record) != idx_e_ok || !key->key_length ||
+				key->key_length > length - m_creation->nullIndLen)
+			{
+				continue;
+			}
+
+			putSortKey(key, buffer);
+			samples.add(string(reinterpret_cast<const char*>(buffer), length));
+		}
+	}
+
+	// Too small relation, nothing to gain
+	if (samples.getCount() < ranges * SAMPLE_RECORDS / 2)
+		return;
+
+	for (ULONG i = 1; i < ranges; i++)
+	{
+		const string& splitter = samples[(FB_SIZE_T) ((FB_UINT64) samples.getCount() * i / ranges)];
+
+		const FB_SIZE_T count = m_splitters.getCount() / length;
+		if (count && memcmp(m_splitters.begin() + (count - 1) * length, splitter.c_str(), length) >= 0)
+			continue;
+
+		m_splitters.add(reinterpret_cast<const UCHAR*>(splitter.c_str()), length);
+	}
+
+	if (m_splitters.isEmpty())
+		return;
+
+	const FB_SIZE_T count = m_splitters.getCount() / length + 1;
+	for (FB_SIZE_T i = 0; i < count; i++)
+		m_ranges.add().sort = FB_NEW_POOL(*m_pool) PartitionedSort(m_dbb, &m_creation->transaction->tra_sorts);
+}
+
+bool IndexCreateTask::prepareRanges(thread_db* tdbb)
+{
+	// Records are sorted: merge the partitions of every key range and read its first
+	// record to be the end of the previous range. Empty ranges are dropped unless
+	// the index is empty.
+
+	if (m_ranges.isEmpty())
+		return false;
+
+	const ULONG length = m_creation->key_length + sizeof(index_sort_record);
+
+	for (FB_SIZE_T i = 0; i < m_ranges.getCount();)
+	{
+		IndexRange& range = m_ranges[i];
+		range.sort->buildMergeTree();
+
+		UCHAR* record;
+		range.sort->get(tdbb, reinterpret_cast<ULONG**>(&record));
+
+		if (record || m_ranges.getCount() == 1)
+		{
+			if (record)
+				range.first.assign(record, length);
+
+			i++;
+			continue;
+		}
+
+		delete range.sort;
+		m_ranges.remove(i);
+	}
+
+	for (FB_SIZE_T i = 1; i < m_ranges.getCount(); i++)
+		m_ranges[i - 1].next.assign(m_ranges[i].first);
+
+	m_building = true;
+	m_creation->ranges = &m_ranges;
+
+	return true;
+}
+
+void IndexCreateTask::releaseRanges(thread_db* tdbb)
+{
+	// Index creation failed, release leaf pages already loaded
+
+	for (FB_SIZE_T i = 0; i < m_ranges.getCount(); i++)
+		BTR_release_range(tdbb, *m_creation, m_ranges[i]);
+
+	m_creation->ranges = NULL;
+}
+
 }; // namespace Jrd
 
 
@@ -895,6 +1138,7 @@ void IDX_create_index(thread_db* tdbb,
 	creation.relation = relation;
 	creation.transaction = transaction;
 	creation.sort = NULL;
+	creation.ranges = NULL;
 	creation.key_length = key_length;
 	creation.nullIndLen = nullIndLen;
 	creation.dup_recno = -1;
@@ -928,6 +1172,9 @@ void IDX_create_index(thread_db* tdbb,
 	Coordinator coord(dbb->dbb_permanent);
 	IndexCreateTask task(tdbb, dbb->dbb_permanent, &creation);
 
+	// Choose the key ranges to be loaded by workers, if any
+	task.sampleKeys(tdbb);
+
 	{
 		EngineCheckout cout(tdbb, FB_FUNCTION);
 
@@ -942,6 +1189,26 @@ void IDX_create_index(thread_db* tdbb,
 
 	sort.buildMergeTree();
 
+	// Load the key ranges in parallel, then link them in BTR_create
+	if (creation.duplicates.value() == 0 && task.prepareRanges(tdbb))
+	{
+		FbLocalStatus local_status;
+		fb_utils::init_status(&local_status);
+
+		{
+			EngineCheckout cout(tdbb, FB_FUNCTION);
+			coord.runSync(&task);
+		}
+
+		const bool success = task.getResult(&local_status);
+
+		if (!success || creation.duplicates.value() > 0)
+			task.releaseRanges(tdbb);
+
+		if (!success)
+			local_status.raise();
+	}
+
 	if (creation.duplicates.value() == 0)
 		BTR_create(tdbb, creation, selectivity);
 
@@ -1593,6 +1860,242 @@ void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 	}
 }
 
+
+void IDX_store_bulk(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction, RecordBitmap* records)
+{
+/**************************************
+ *
+ *	I D X _ s t o r e _ b u l k
+ *
+ **************************************
+ *
+ * Functional description
+ *	Update the various indices after records were stored
+ *	by the bulk insert. Keys of every index are sorted and
+ *	inserted in the key order, thus consecutive insertions
+ *	go to the same (cached) leaf pages rather than random ones.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* dbb = tdbb->getDatabase();
+
+	// Keys of the index are sorted the same way as for index creation,
+	// see comments in IDX_create_index
+
+	struct IndexSort
+	{
+		explicit IndexSort(MemoryPool&)
+		{}
+
+		index_desc idx;
+		AutoPtr<Sort> sort;
+		USHORT keyLength = 0;
+		USHORT nullIndLen = 0;
+	};
+
+	ObjectsArray<IndexSort> indices(*tdbb->getDefaultPool());
+
+	RelationPages* relPages = relation->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, -1);
+
+	index_desc idx;
+	idx.idx_id = idx_invalid;
+
+	while (BTR_next_index(tdbb, getPermanent(relation), transaction, &idx, &window))
+		indices.add().idx = idx;
+
+	if (indices.isEmpty() || !records)
+		return;
+
+	for (auto& item : indices)
+	{
+		const bool isDescending = (item.idx.idx_flags & idx_descending);
+
+		item.nullIndLen = !isDescending && (item.idx.idx_count == 1) ? 1 : 0;
+		item.keyLength = ROUNDUP(BTR_key_length(tdbb, relation, &item.idx) + item.nullIndLen, sizeof(SINT64));
+
+		sort_key_def key_desc[2];
+		// Key sort description
+		key_desc[0].setSkdLength(SKD_bytes, item.keyLength);
+		key_desc[0].skd_flags = SKD_ascending;
+		key_desc[0].setSkdOffset();
+		key_desc[0].skd_vary_offset = 0;
+		// RecordNumber sort description
+		key_desc[1].setSkdLength(SKD_int64, sizeof(RecordNumber));
+		key_desc[1].skd_flags = SKD_ascending;
+		key_desc[1].setSkdOffset(key_desc);
+		key_desc[1].skd_vary_offset = 0;
+
+		item.sort = FB_NEW_POOL(transaction->tra_sorts.getPool())
+			Sort(dbb, &transaction->tra_sorts, item.keyLength + sizeof(index_sort_record),
+				 2, 2, key_desc, NULL, NULL);
+	}
+
+	record_param rpb;
+	rpb.rpb_relation = relation;
+
+	AutoTempRecord gc_record(relation->getGCRecord(tdbb));
+
+	const auto fetchRecord = [&](SINT64 number)
+	{
+		rpb.rpb_number.setValue(number);
+		rpb.rpb_record = gc_record;
+
+		if (!DPM_get(tdbb, &rpb, LCK_read))
+			BUGCHECK(186);	// msg 186 record disappeared
+
+		VIO_data(tdbb, &rpb, tdbb->getDefaultPool());
+		return rpb.rpb_record;
+	};
+
+	// Compute keys of the stored records, every record is fetched once for all indices
+
+	RecordBitmap::Accessor accessor(records);
+
+	if (accessor.getFirst())
+	do {
+		Record* const record = fetchRecord(accessor.current());
+
+		for (auto& item : indices)
+		{
+			IndexErrorContext context(relation, &item.idx);
+			idx_e error_code = idx_e_ok;
+
+			{
+				IndexCondition condition(tdbb, &item.idx);
+				const auto checkResult = condition.check(record, &error_code);
+
+				if (error_code)
+					context.raise(tdbb, error_code, record);
+
+				fb_assert(checkResult.isAssigned());
+				if (!checkResult.asBool())
+					continue;
+			}
+
+			AutoIndexExpression expression;
+			IndexKey key(tdbb, relation, &item.idx, expression);
+
+			if ( (error_code = key.compose(record, true)) )
+			{
+				if (error_code == idx_e_skip)
+					continue;
+
+				context.raise(tdbb, error_code, record);
+			}
+
+			if (key->key_length + item.nullIndLen > item.keyLength)
+				context.raise(tdbb, idx_e_keytoobig, record);
+
+			UCHAR* p;
+			item.sort->put(tdbb, reinterpret_cast<ULONG**>(&p));
+
+			if (item.nullIndLen)
+				*p++ = (key->key_length == 0) ? 0 : 1;
+
+			if (key->key_length > 0)
+			{
+				memcpy(p, key->key_data, key->key_length);
+				p += key->key_length;
+			}
+
+			const int l = int(item.keyLength) - item.nullIndLen - key->key_length;	// must be signed
+
+			if (l > 0)
+			{
+				memset(p, (item.idx.idx_flags & idx_descending) ? -1 : 0, l);
+				p += l;
+			}
+
+			index_sort_record* isr = (index_sort_record*) p;
+			isr->isr_record_number = accessor.current();
+			isr->isr_key_length = key->key_length;
+			isr->isr_flags = (key->key_nulls == (1 << item.idx.idx_count) - 1) ? ISR_null : 0;
+		}
+
+		JRD_reschedule(tdbb);
+	} while (accessor.getNext());
+
+	// Insert the sorted keys
+
+	index_insertion insertion;
+	insertion.iib_relation = relation;
+	insertion.iib_transaction = transaction;
+	insertion.iib_btr_level = 0;
+
+	temporary_key sortKey;
+	sortKey.key_flags = 0;
+
+	for (auto& item : indices)
+	{
+		index_desc* const idx = &item.idx;
+		IndexErrorContext context(relation, idx);
+		insertion.iib_descriptor = idx;
+
+		// Unique and foreign key checks need the record itself
+		const bool checkRecord = (idx->idx_flags & (idx_unique | idx_primary | idx_foreign));
+
+		item.sort->sort(tdbb);
+
+		while (true)
+		{
+			UCHAR* p;
+			item.sort->get(tdbb, reinterpret_cast<ULONG**>(&p));
+
+			if (!p)
+				break;
+
+			const index_sort_record* isr = (index_sort_record*) (p + item.keyLength);
+			insertion.iib_number.setValue(isr->isr_record_number);
+
+			AutoIndexExpression expression;
+			IndexKey key(tdbb, relation, idx, expression);
+			Record* record = nullptr;
+
+			if (checkRecord)
+			{
+				record = fetchRecord(isr->isr_record_number);
+
+				const idx_e error_code = key.compose(record, true);
+				fb_assert(error_code == idx_e_ok);
+
+				if (error_code)
+					context.raise(tdbb, error_code, record);
+
+				expression.reset();
+				insertion.iib_key = key;
+			}
+			else
+			{
+				sortKey.key_length = isr->isr_key_length;
+				memcpy(sortKey.key_data, p + item.nullIndLen, sortKey.key_length);
+				sortKey.key_nulls = (isr->isr_flags & ISR_null) ? (1 << idx->idx_count) - 1 : 0;
+				insertion.iib_key = &sortKey;
+			}
+
+			// Index root could be changed by the split of the previous insertion
+			WIN rootWindow(relPages->rel_pg_space_id, relPages->rel_index_root);
+			const index_root_page* root = BTR_fetch_root(FB_FUNCTION, tdbb, &rootWindow);
+			idx->idx_root = root->irt_rpt[idx->idx_id].getRoot();
+
+			if (checkRecord)
+			{
+				const idx_e error_code =
+					insert_key(tdbb, relation, record, transaction, &rootWindow, &insertion, context);
+
+				if (error_code)
+					context.raise(tdbb, error_code, record);
+			}
+			else
+				BTR_insert(tdbb, &rootWindow, &insertion);
+
+			JRD_reschedule(tdbb);
+		}
+
+		item.sort.reset();
+	}
+}
+
 static bool cmpRecordKeys(thread_db* tdbb,
 						  Record* rec1, jrd_rel* rel1, index_desc* idx1,
 						  Record* rec2, jrd_rel* rel2, index_desc* idx2)
@@ -113,6 +113,12 @@ void LockManagerEngineCallbacks::checkoutRun(std::function<void()> func) const
 	func();
 }
 
+void LockManagerEngineCallbacks::accountWait(SINT64 time) const
+{
+	tdbb->bumpStats(WaitStatType::LOCK_WAITS);
+	tdbb->bumpStats(WaitStatType::LOCK_TIME, time);
+}
+
 
 // globals and macros
 
@@ -606,6 +612,7 @@ static lck_owner_t get_owner_type(enum lck_t lock_type)
 	case LCK_dsql_statement_cache:
 	case LCK_profiler_listener:
 	case LCK_idx_create:
+	case LCK_rel_scan:
 		owner_type = LCK_OWNER_attachment;
 		break;
 
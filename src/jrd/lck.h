@@ -78,7 +78,8 @@ enum lck_t : UCHAR {
 	LCK_dsql_statement_cache,	// DSQL statement cache lock
 	LCK_profiler_listener,		// Remote profiler listener
 	LCK_dbwide_triggers,		// Database wide triggers rescan lock
-	LCK_idx_create				// Taken during index build process
+	LCK_idx_create,				// Taken during index build process
+	LCK_rel_scan				// Relation is read by attachment, not truncated
 };
 
 // Lock owner types
@@ -99,6 +100,7 @@ public:
 	ISC_STATUS getCancelState() const override;
 	ULONG adjustWait(ULONG wait) const override;
 	void checkoutRun(std::function<void()> func) const override;
+	void accountWait(SINT64 time) const override;
 
 private:
 	thread_db* const tdbb;
@@ -578,6 +578,17 @@ namespace
 		}
 	}
 
+	// Check whether the FIRST/SKIP value is known before the stream is opened
+	// and can be safely evaluated more than once
+
+	bool isStableLimit(const ValueExprNode* node)
+	{
+		return !node ||
+			nodeIs<LiteralNode>(node) ||
+			nodeIs<ParameterNode>(node) ||
+			nodeIs<VariableNode>(node);
+	}
+
 } // namespace
 
 
@@ -743,6 +754,7 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 		conjunctCount = decomposeBoolean(rse->rse_boolean, conjunctStack);
 
 	conjunctCount += distributeEqualities(conjunctStack, conjunctCount);
+	conjunctCount += inferBoundConditions(conjunctStack, conjunctCount);
 
 	// AB: If we have limit our retrieval with FIRST / SKIP syntax then
 	// we may not deliver above conditions (from higher rse's) to this
@@ -795,6 +807,7 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 
 		// We've now merged parent, try again to make more conjunctions.
 		distributedCount = distributeEqualities(conjunctStack, conjunctCount);
+		distributedCount += inferBoundConditions(conjunctStack, conjunctCount + distributedCount);
 		conjunctCount += distributedCount;
 	}
 
@@ -1137,6 +1150,8 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 
 	checkIndices();
 
+	SortedStream* sortRsb = nullptr;
+
 	if (project || sort)
 	{
 		// Eliminate any duplicate dbkey streams
@@ -1153,7 +1168,7 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 
 		// Handle sort clause if present
 		if (sort)
-			rsb = generateSort(bedStreams, &keyStreams, rsb, sort, favorFirstRows(), false);
+			rsb = sortRsb = generateSort(bedStreams, &keyStreams, rsb, sort, favorFirstRows(), false);
 	}
 
 	// Add invariant booleans, if any. They should be evaluated before
@@ -1171,7 +1186,14 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 		rsb = FB_NEW_POOL(getPool()) SkipRowsStream(csb, rsb, rse->rse_skip);
 
 	if (rse->rse_first)
+	{
+		// If the sorted records are limited, the sort needs to keep only the top ones
+
+		if (sortRsb && isStableLimit(rse->rse_first) && isStableLimit(rse->rse_skip))
+			sortRsb->setLimit(rse->rse_first, rse->rse_skip);
+
 		rsb = FB_NEW_POOL(getPool()) FirstRowsStream(csb, rsb, rse->rse_first);
+	}
 
 	if (rse->isSingular())
 		rsb = FB_NEW_POOL(getPool()) SingularStream(csb, rsb);
@@ -2508,6 +2530,144 @@ unsigned Optimizer::distributeEqualities(BoolExprNodeStack& orgStack, unsigned b
 }
 
 
+//
+// Infer conditions from the lower and upper bounds of the same field, e.g.
+// infer A < B from F >= A and F < B. When the bounds are literals, parameters
+// or variables, such conditions are invariant and they're checked before
+// the data retrieval, so the stream is not read at all if the bounds conflict.
+// This prunes UNION ALL branches (e.g. of a view over per-period tables)
+// whose own bounds don't intersect the ones delivered from the parent.
+//
+
+unsigned Optimizer::inferBoundConditions(BoolExprNodeStack& orgStack, unsigned baseCount)
+{
+	constexpr unsigned MAX_CONJUNCTS_TO_PROCESS = 1024;
+	const unsigned MAX_CONJUNCTS_TO_INJECT = MAX(baseCount, 256);
+
+	if (baseCount > MAX_CONJUNCTS_TO_PROCESS)
+		return 0;
+
+	struct Bound
+	{
+		ValueExprNode* field;
+		ValueExprNode* value;
+		bool lower;
+		bool upper;
+		bool strict;
+	};
+
+	HalfStaticArray<Bound, OPT_STATIC_ITEMS> bounds;
+
+	for (BoolExprNodeStack::iterator iter(orgStack); iter.hasData(); ++iter)
+	{
+		const auto boolean = iter.object();
+
+		if (boolean->nodFlags & ExprNode::FLAG_DEOPTIMIZE)
+			continue;
+
+		const auto cmpNode = nodeAs<ComparativeBoolNode>(boolean);
+
+		if (!cmpNode)
+			continue;
+
+		Bound bound;
+		bound.field = cmpNode->arg1;
+		bound.value = cmpNode->arg2;
+		bool reverse = false;
+
+		if (!nodeIs<FieldNode>(bound.field))
+		{
+			std::swap(bound.field, bound.value);
+			reverse = true;
+		}
+
+		if (!nodeIs<FieldNode>(bound.field))
+			continue;
+
+		if (!nodeIs<LiteralNode>(bound.value) &&
+			!nodeIs<ParameterNode>(bound.value) &&
+			!nodeIs<VariableNode>(bound.value))
+		{
+			continue;
+		}
+
+		switch (cmpNode->blrOp)
+		{
+			case blr_eql:
+				bound.lower = bound.upper = true;
+				bound.strict = false;
+				break;
+
+			case blr_gtr:
+			case blr_geq:
+				bound.lower = !reverse;
+				bound.upper = reverse;
+				bound.strict = (cmpNode->blrOp == blr_gtr);
+				break;
+
+			case blr_lss:
+			case blr_leq:
+				bound.lower = reverse;
+				bound.upper = !reverse;
+				bound.strict = (cmpNode->blrOp == blr_lss);
+				break;
+
+			default:
+				continue;
+		}
+
+		// The inferred condition compares the bounds directly, so they must
+		// have the type of the field to be compared the same way as the field.
+		// Strings are not handled as their comparison depends on the collation.
+
+		dsc fieldDesc, valueDesc;
+		bound.field->getDesc(tdbb, csb, &fieldDesc);
+		bound.value->getDesc(tdbb, csb, &valueDesc);
+
+		if (!(fieldDesc.isNumeric() || fieldDesc.isDateTime()) ||
+			fieldDesc.dsc_dtype != valueDesc.dsc_dtype ||
+			fieldDesc.dsc_scale != valueDesc.dsc_scale)
+		{
+			continue;
+		}
+
+		bounds.add(bound);
+	}
+
+	unsigned count = 0;
+
+	for (const auto& lower : bounds)
+	{
+		if (!lower.lower)
+			continue;
+
+		for (const auto& upper : bounds)
+		{
+			if (!upper.upper || &lower == &upper || !fieldEqual(lower.field, upper.field))
+				continue;
+
+			if (count >= MAX_CONJUNCTS_TO_INJECT)
+				return count;
+
+			const UCHAR blrOp = (lower.strict || upper.strict) ? blr_lss : blr_leq;
+
+			AutoPtr<ComparativeBoolNode> cmpNode(FB_NEW_POOL(getPool())
+				ComparativeBoolNode(getPool(), blrOp));
+			cmpNode->arg1 = lower.value;
+			cmpNode->arg2 = upper.value;
+
+			if (augmentStack(cmpNode, orgStack))
+			{
+				count++;
+				cmpNode.release();
+			}
+		}
+	}
+
+	return count;
+}
+
+
 //
 // Find the streams that can use an index with the currently active streams
 //
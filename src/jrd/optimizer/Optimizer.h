@@ -597,6 +597,7 @@ private:
 	void checkIndices();
 	void checkSorts();
 	unsigned distributeEqualities(BoolExprNodeStack& orgStack, unsigned baseCount);
+	unsigned inferBoundConditions(BoolExprNodeStack& orgStack, unsigned baseCount);
 	void findDependentStreams(const RiverList& rivers,
 							  const StreamList& streams,
 							  StreamList& dependentStreams,
@@ -52,6 +52,9 @@ void BitmapTableScan::internalOpen(thread_db* tdbb) const
 	Request* const request = tdbb->getRequest();
 	Impure* const impure = request->getImpure<Impure>(m_impure);
 
+	if (!(impure->irsb_flags & irsb_open))
+		ScanLock::enter(tdbb, m_relation());
+
 	impure->irsb_flags = irsb_open;
 	impure->irsb_bitmap = EVL_bitmap(tdbb, m_inversion, NULL);
 
@@ -78,6 +81,8 @@ void BitmapTableScan::close(thread_db* tdbb) const
 			delete *impure->irsb_bitmap;
 			*impure->irsb_bitmap = NULL;
 		}
+
+		ScanLock::leave(tdbb, m_relation());
 	}
 }
 
@@ -113,7 +118,9 @@ bool BitmapTableScan::internalGetRecord(thread_db* tdbb) const
 			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
 			{
 				rpb->rpb_number.setValid(true);
-				return true;
+
+				if (checkRuntimeFilter(tdbb))
+					return true;
 			}
 		} while (bitmap->getNext());
 	}
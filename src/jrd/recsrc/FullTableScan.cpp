@@ -55,6 +55,9 @@ void FullTableScan::internalOpen(thread_db* tdbb) const
 	Request* const request = tdbb->getRequest();
 	Impure* const impure = request->getImpure<Impure>(m_impure);
 
+	if (!(impure->irsb_flags & irsb_open))
+		ScanLock::enter(tdbb, m_relation());
+
 	impure->irsb_flags = irsb_open;
 
 	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation(), false);
@@ -129,6 +132,8 @@ void FullTableScan::close(thread_db* tdbb) const
 		{
 			m_relation()->rel_scan_count--;
 		}
+
+		ScanLock::leave(tdbb, m_relation());
 	}
 }
 
@@ -148,10 +153,12 @@ bool FullTableScan::internalGetRecord(thread_db* tdbb) const
 
 	const RecordNumber* upper = impure->irsb_upper.isValid() ? &impure->irsb_upper : nullptr;
 
-	if (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
+	while (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
 	{
 		rpb->rpb_number.setValid(true);
-		return true;
+
+		if (checkRuntimeFilter(tdbb))
+			return true;
 	}
 
 	rpb->rpb_number.setValid(false);
@@ -47,6 +47,23 @@ using namespace Jrd;
 static constexpr ULONG HASH_SIZE = 1009;
 static constexpr ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per bucket
 
+// Bloom filter pushed into the leading stream: 8 bits per key and 3 probes
+// give about 3% of false positives
+static constexpr ULONG BLOOM_BITS_PER_KEY = 8;
+static constexpr ULONG BLOOM_PROBES = 3;
+static constexpr ULONG BLOOM_MIN_BITS = 512;
+
+static inline ULONG bloomStep(ULONG hash) noexcept
+{
+	// Derive the second hash for double hashing, it must be odd
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6b;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35;
+	hash ^= hash >> 16;
+	return hash | 1;
+}
+
 unsigned HashJoin::maxCapacity() noexcept
 {
 	// Binary search across 1000 collisions is computationally similar to
@@ -352,6 +369,35 @@ void HashJoin::init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 		m_args.add(sub.buffer);
 	}
 
+	// Inner and semi joins never return the leading records without matches,
+	// so they may be rejected by the table scan that fetches them. This is
+	// possible when the leading keys are the fields of the single stream:
+	// the scan checks the record before the booleans pushed down to it, so
+	// evaluating a key must not depend on them (or raise an error).
+
+	if (m_joinType == JoinType::INNER || m_joinType == JoinType::SEMI)
+	{
+		SortedStreamList streams;
+		bool plainFields = true;
+
+		for (const auto key : *m_leader.keys)
+		{
+			const auto field = nodeAs<FieldNode>(key);
+
+			if (!field)
+			{
+				plainFields = false;
+				break;
+			}
+
+			if (!streams.exist(field->fieldStream))
+				streams.add(field->fieldStream);
+		}
+
+		if (plainFields && streams.getCount() == 1)
+			m_runtimeFilter = m_leader.source->pushRuntimeFilter(streams[0], this);
+	}
+
 	if (!selectivity)
 	{
 		selectivity = (m_joinType == JoinType::INNER || m_joinType == JoinType::OUTER) ?
@@ -374,6 +420,10 @@ void HashJoin::internalOpen(thread_db* tdbb) const
 	delete[] impure->irsb_leader_buffer;
 	impure->irsb_leader_buffer = nullptr;
 
+	delete[] impure->irsb_bloom_filter;
+	impure->irsb_bloom_filter = nullptr;
+	impure->irsb_leader_hashed = false;
+
 	m_leader.source->open(tdbb);
 }
 
@@ -395,6 +445,9 @@ void HashJoin::close(thread_db* tdbb) const
 
 		delete[] impure->irsb_leader_buffer;
 		impure->irsb_leader_buffer = nullptr;
+
+		delete[] impure->irsb_bloom_filter;
+		impure->irsb_bloom_filter = nullptr;
 	}
 }
 
@@ -414,7 +467,8 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 	{
 		if (impure->irsb_flags & irsb_mustread)
 		{
-			// Fetch the record from the leading stream
+			// Fetch the record from the leading stream. If the runtime filter
+			// is pushed into its scan, the hash table is built by checkRecord().
 
 			if (!m_leader.source->getRecord(tdbb))
 				return false;
@@ -429,41 +483,20 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 
 			// We have something to join with, so ensure the hash table is initialized
 
-			if (!impure->irsb_hash_table && !impure->irsb_leader_buffer)
-			{
-				auto& pool = *tdbb->getDefaultPool();
-				const auto argCount = m_subs.getCount();
-
-				impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
-				impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
+			if (!impure->irsb_hash_table)
+				buildHashTable(tdbb, request, impure);
 
-				UCharBuffer buffer(pool);
-
-				for (FB_SIZE_T i = 0; i < argCount; i++)
-				{
-					// Read and cache the inner streams. While doing that,
-					// hash the join condition values and populate hash tables.
+			// Compute and hash the comparison keys, unless it's already done
+			// by the runtime filter
 
-					m_subs[i].buffer->open(tdbb);
-
-					ULONG counter = 0;
-					const auto keyBuffer = buffer.getBuffer(m_subs[i].totalKeyLength, false);
-
-					while (m_subs[i].buffer->getRecord(tdbb))
-					{
-						const auto hash = computeHash(tdbb, request, m_subs[i], keyBuffer);
-						impure->irsb_hash_table->put(i, hash, counter++);
-					}
-				}
-
-				impure->irsb_hash_table->sort();
+			if (impure->irsb_leader_hashed)
+				impure->irsb_leader_hashed = false;
+			else
+			{
+				impure->irsb_leader_hash =
+					computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
 			}
 
-			// Compute and hash the comparison keys
-
-			impure->irsb_leader_hash =
-				computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
-
 			// Ensure the every inner stream having matches for this hash slot.
 			// Setup the hash table for the iteration through collisions.
 
@@ -533,6 +566,51 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 	return true;
 }
 
+bool HashJoin::checkRecord(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	// Called by the table scan of the leading stream for every fetched record.
+	// The hash table and the filter are built for the first record, so nothing
+	// is read from the inner streams if the leading one is empty.
+
+	if (!impure->irsb_hash_table)
+		buildHashTable(tdbb, request, impure);
+
+	const auto filter = impure->irsb_bloom_filter;
+
+	if (!filter)
+		return true;
+
+	// The hash is remembered, it's used for the hash table lookup if the record
+	// passes the filter.
+
+	const auto hash = computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+	impure->irsb_leader_hash = hash;
+	impure->irsb_leader_hashed = true;
+
+	const auto mask = impure->irsb_bloom_mask;
+	const auto step = bloomStep(hash);
+	const auto words = (mask + 1) / 64;
+
+	for (FB_SIZE_T i = 0; i < m_subs.getCount(); i++)
+	{
+		const FB_UINT64* const bits = filter + i * words;
+		ULONG bit = hash;
+
+		for (ULONG j = 0; j < BLOOM_PROBES; j++, bit += step)
+		{
+			const ULONG n = bit & mask;
+
+			if (!(bits[n / 64] & (FB_CONST64(1) << (n % 64))))
+				return false;
+		}
+	}
+
+	return true;
+}
+
 void HashJoin::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
 {
 	level++;
@@ -558,6 +636,91 @@ void HashJoin::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned l
 	Join::internalGetPlan(tdbb, planEntry, level, recurse);
 }
 
+void HashJoin::buildHashTable(thread_db* tdbb, Request* request, Impure* impure) const
+{
+	auto& pool = *tdbb->getDefaultPool();
+	const auto argCount = m_subs.getCount();
+
+	impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
+	impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
+
+	UCharBuffer buffer(pool);
+
+	// Hashes are collected for the runtime filter, it's built when
+	// the inner streams sizes are known
+
+	Array<ULONG> hashes(pool);
+	HalfStaticArray<ULONG, 4> counts(pool);
+
+	for (FB_SIZE_T i = 0; i < argCount; i++)
+	{
+		// Read and cache the inner streams. While doing that,
+		// hash the join condition values and populate hash tables.
+
+		m_subs[i].buffer->open(tdbb);
+
+		ULONG counter = 0;
+		const auto keyBuffer = buffer.getBuffer(m_subs[i].totalKeyLength, false);
+
+		while (m_subs[i].buffer->getRecord(tdbb))
+		{
+			const auto hash = computeHash(tdbb, request, m_subs[i], keyBuffer);
+			impure->irsb_hash_table->put(i, hash, counter++);
+
+			if (m_runtimeFilter)
+				hashes.add(hash);
+		}
+
+		counts.add(counter);
+	}
+
+	impure->irsb_hash_table->sort();
+
+	if (!m_runtimeFilter)
+		return;
+
+	// Too big filter could hardly reject anything, so don't bother
+
+	ULONG maxCount = 0;
+	for (const auto count : counts)
+		maxCount = MAX(maxCount, count);
+
+	if (maxCount > maxCapacity())
+		return;
+
+	ULONG bitCount = BLOOM_MIN_BITS;
+	while (bitCount < maxCount * BLOOM_BITS_PER_KEY)
+		bitCount *= 2;
+
+	const ULONG words = bitCount / 64;
+	const ULONG mask = bitCount - 1;
+
+	const auto filter = FB_NEW_POOL(pool) FB_UINT64[words * argCount];
+	memset(filter, 0, words * argCount * sizeof(FB_UINT64));
+
+	const ULONG* hash = hashes.begin();
+
+	for (FB_SIZE_T i = 0; i < argCount; i++)
+	{
+		FB_UINT64* const bits = filter + i * words;
+
+		for (const ULONG* const end = hash + counts[i]; hash < end; hash++)
+		{
+			const auto step = bloomStep(*hash);
+			ULONG bit = *hash;
+
+			for (ULONG j = 0; j < BLOOM_PROBES; j++, bit += step)
+			{
+				const ULONG n = bit & mask;
+				bits[n / 64] |= FB_CONST64(1) << (n % 64);
+			}
+		}
+	}
+
+	impure->irsb_bloom_filter = filter;
+	impure->irsb_bloom_mask = mask;
+}
+
 ULONG HashJoin::computeHash(thread_db* tdbb,
 							Request* request,
 						    const SubStream& sub,
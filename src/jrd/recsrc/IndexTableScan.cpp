@@ -66,6 +66,9 @@ void IndexTableScan::internalOpen(thread_db* tdbb) const
 	Request* const request = tdbb->getRequest();
 	Impure* const impure = request->getImpure<Impure>(m_impure);
 
+	if (!(impure->irsb_flags & irsb_open))
+		ScanLock::enter(tdbb, m_relation());
+
 	impure->irsb_flags = irsb_first | irsb_open;
 
 	record_param* const rpb = &request->req_rpb[m_stream];
@@ -136,6 +139,8 @@ void IndexTableScan::close(thread_db* tdbb) const
 			delete impure->irsb_iterator;
 			impure->irsb_iterator = NULL;
 		}
+
+		ScanLock::leave(tdbb, m_relation());
 	}
 #ifdef DEBUG_LCK_LIST
 	// paranoid check
@@ -284,7 +289,7 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 					}
 
 					// If END_BUCKET is reached BTR_find_leaf will return NULL
-					while (!(nextPointer = BTR_find_leaf(page, nextLower, nullptr, nullptr,
+					while (!(nextPointer = BTR_find_leaf(&window, page, nextLower, nullptr, nullptr,
 						(idx->idx_flags & idx_descending),
 						(retrieval->irb_generic & (irb_starting | irb_partial)))))
 					{
@@ -347,7 +352,9 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 							rpb->rpb_number.getValue());
 
 					rpb->rpb_number.setValid(true);
-					return true;
+
+					if (checkRuntimeFilter(tdbb))
+						return true;
 				}
 			}
 
@@ -673,7 +680,7 @@ UCHAR* IndexTableScan::openStream(thread_db* tdbb, Impure* impure, win* window)
 	{
 		UCHAR* pointer = NULL;
 		// If END_BUCKET is reached BTR_find_leaf will return NULL
-		while (!(pointer = BTR_find_leaf(page, limit_ptr, impure->irsb_nav_data, NULL,
+		while (!(pointer = BTR_find_leaf(window, page, limit_ptr, impure->irsb_nav_data, NULL,
 							(idx->idx_flags & idx_descending),
 							(retrieval->irb_generic & (irb_starting | irb_partial)))))
 		{
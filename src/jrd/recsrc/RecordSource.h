@@ -55,6 +55,17 @@ namespace Jrd
 
 	enum class JoinType { INNER, OUTER, SEMI, ANTI };
 
+	// Filter built by a join at runtime and checked by a table scan of its
+	// probe side, to reject the records having no chance to be matched
+	// before they're passed upwards.
+	class RuntimeFilter
+	{
+	public:
+		virtual ~RuntimeFilter() = default;
+
+		virtual bool checkRecord(thread_db* tdbb) const = 0;
+	};
+
 	// Common base for record sources, sub-queries and cursors.
 	class AccessPath
 	{
@@ -154,6 +165,12 @@ namespace Jrd
 			fb_assert(false);
 		}
 
+		// Returns true if the filter is accepted by the table scan of the given stream
+		virtual bool pushRuntimeFilter(StreamType /*stream*/, const RuntimeFilter* /*filter*/)
+		{
+			return false;
+		}
+
 		static bool rejectDuplicate(const UCHAR* /*data1*/, const UCHAR* /*data2*/, void* /*userArg*/)
 		{
 			return true;
@@ -222,8 +239,23 @@ namespace Jrd
 		}
 
 	protected:
+		bool setRuntimeFilter(StreamType stream, const RuntimeFilter* filter)
+		{
+			if (stream != m_stream || m_runtimeFilter)
+				return false;
+
+			m_runtimeFilter = filter;
+			return true;
+		}
+
+		bool checkRuntimeFilter(thread_db* tdbb) const
+		{
+			return !m_runtimeFilter || m_runtimeFilter->checkRecord(tdbb);
+		}
+
 		const StreamType m_stream;
 		mutable const Format* m_format;
+		const RuntimeFilter* m_runtimeFilter = nullptr;
 	};
 
 
@@ -246,6 +278,11 @@ namespace Jrd
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushRuntimeFilter(StreamType stream, const RuntimeFilter* filter) override
+		{
+			return setRuntimeFilter(stream, filter);
+		}
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -273,6 +310,11 @@ namespace Jrd
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushRuntimeFilter(StreamType stream, const RuntimeFilter* filter) override
+		{
+			return setRuntimeFilter(stream, filter);
+		}
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -315,6 +357,11 @@ namespace Jrd
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool pushRuntimeFilter(StreamType stream, const RuntimeFilter* filter) override
+		{
+			return setRuntimeFilter(stream, filter);
+		}
+
 		void setInversion(InversionNode* inversion, BoolExprNode* condition)
 		{
 			fb_assert(!m_inversion && !m_condition);
@@ -610,6 +657,11 @@ namespace Jrd
 			m_ansiNot = ansiNot;
 		}
 
+		bool pushRuntimeFilter(StreamType stream, const RuntimeFilter* filter) override
+		{
+			return m_next->pushRuntimeFilter(stream, filter);
+		}
+
 	protected:
 		FilteredStream(CompilerScratch* csb, RecordSource* next, BoolExprNode* boolean);
 
@@ -735,6 +787,12 @@ namespace Jrd
 			return m_map->keyLength;
 		}
 
+		void setLimit(ValueExprNode* first, ValueExprNode* skip)
+		{
+			m_first = first;
+			m_skip = skip;
+		}
+
 		bool compareKeys(const UCHAR* p, const UCHAR* q) const;
 
 		UCHAR* getData(thread_db* tdbb) const;
@@ -760,9 +818,12 @@ namespace Jrd
 
 	private:
 		Sort* init(thread_db* tdbb) const;
+		FB_UINT64 getLimit(thread_db* tdbb, Request* request) const;
 
 		NestConst<RecordSource> m_next;
 		const SortMap* const m_map;
+		NestConst<ValueExprNode> m_first;
+		NestConst<ValueExprNode> m_skip;
 	};
 
 	// Make moves in a window without going out of partition boundaries.
@@ -1341,7 +1402,7 @@ namespace Jrd
 		const StreamList m_checkStreams;
 	};
 
-	class HashJoin final : public Join<RecordSource>
+	class HashJoin final : public Join<RecordSource>, public RuntimeFilter
 	{
 		class HashTable;
 
@@ -1363,6 +1424,9 @@ namespace Jrd
 			HashTable* irsb_hash_table;
 			UCHAR* irsb_leader_buffer;
 			ULONG irsb_leader_hash;
+			bool irsb_leader_hashed;		// hash is already computed by checkRecord()
+			FB_UINT64* irsb_bloom_filter;	// bloom filter per inner stream
+			ULONG irsb_bloom_mask;			// bloom filter size in bits minus one
 		};
 
 	public:
@@ -1379,6 +1443,8 @@ namespace Jrd
 
 		static unsigned maxCapacity() noexcept;
 
+		bool checkRecord(thread_db* tdbb) const override;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -1388,12 +1454,14 @@ namespace Jrd
 		void init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 				  RecordSource* const* args, NestValueArray* const* keys,
 				  double selectivity);
+		void buildHashTable(thread_db* tdbb, Request* request, Impure* impure) const;
 		ULONG computeHash(thread_db* tdbb, Request* request,
 						  const SubStream& sub, UCHAR* buffer) const;
 		bool fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const;
 
 		SubStream m_leader;
 		Firebird::Array<SubStream> m_subs;
+		bool m_runtimeFilter = false;
 	};
 
 	class MergeJoin : public Join<SortedStream>
@@ -46,7 +46,9 @@ using namespace Jrd;
 SortedStream::SortedStream(CompilerScratch* csb, RecordSource* next, SortMap* map)
 	: RecordSource(csb),
 	  m_next(next),
-	  m_map(map)
+	  m_map(map),
+	  m_first(nullptr),
+	  m_skip(nullptr)
 {
 	fb_assert(m_next && m_map);
 
@@ -185,10 +187,40 @@ void SortedStream::nullRecords(thread_db* tdbb) const
 	m_next->nullRecords(tdbb);
 }
 
+FB_UINT64 SortedStream::getLimit(thread_db* tdbb, Request* request) const
+{
+	// Return the number of records that can be fetched by the outer FIRST/SKIP,
+	// zero means no limit. Invalid values are reported by the outer streams.
+
+	if (!m_first)
+		return 0;
+
+	const dsc* desc = EVL_expr(tdbb, request, m_first);
+	const SINT64 first = desc ? MOV_get_int64(tdbb, desc, 0) : 0;
+
+	if (first <= 0)
+		return 0;
+
+	SINT64 skip = 0;
+
+	if (m_skip)
+	{
+		desc = EVL_expr(tdbb, request, m_skip);
+		skip = desc ? MOV_get_int64(tdbb, desc, 0) : 0;
+
+		if (skip < 0 || skip > MAX_SINT64 - first)
+			return 0;
+	}
+
+	return (FB_UINT64) (first + skip);
+}
+
 Sort* SortedStream::init(thread_db* tdbb) const
 {
 	Request* const request = tdbb->getRequest();
 
+	const FB_UINT64 limit = getLimit(tdbb, request);
+
 	m_next->open(tdbb);
 
 	// Initialize for sort. If this is really a project operation,
@@ -198,7 +230,7 @@ Sort* SortedStream::init(thread_db* tdbb) const
 		Sort(tdbb->getDatabase(), &request->req_sorts,
 			 m_map->length, m_map->keyItems.getCount(), m_map->keyItems.getCount(),
 			 m_map->keyItems.begin(),
-			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0));
+			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0, limit));
 
 	// Pump the input stream dry while pushing records into sort. For
 	// each record, map all fields into the sort record. The reverse
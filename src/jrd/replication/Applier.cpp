@@ -41,6 +41,7 @@
 #include "../jrd/rlck_proto.h"
 #include "../jrd/tra_proto.h"
 #include "../jrd/vio_proto.h"
+#include "../jrd/sqz.h"
 #include "../dsql/dsql_proto.h"
 #include "firebird/impl/sqlda_pub.h"
 
@@ -333,12 +334,23 @@ void Applier::process(thread_db* tdbb, ULONG length, const UCHAR* data)
 
 	tdbb->tdbb_flags |= TDBB_replicator;
 
+	// Compressed blocks are unpacked before being parsed
+
+	UCharBuffer unpacked;
+
+	if (((const Block*) data)->flags & BLOCK_COMPRESSED)
+	{
+		unpackBlock(length, data, unpacked);
+		length = unpacked.getCount();
+		data = unpacked.begin();
+	}
+
 	BlockReader reader(length, data);
 
 	const auto traNum = reader.getTransactionId();
 	const auto protocol = reader.getProtocolVersion();
 
-	if (protocol != PROTOCOL_CURRENT_VERSION)
+	if (protocol < PROTOCOL_VERSION_2 || protocol > PROTOCOL_CURRENT_VERSION)
 		raiseError("Unsupported replication protocol version %u", protocol);
 
 	while (!reader.isEof())
@@ -404,6 +416,35 @@ void Applier::process(thread_db* tdbb, ULONG length, const UCHAR* data)
 				}
 				break;
 
+			case opUpdateRecordDiff:
+				{
+					const auto& relName = reader.getAtomQualifiedName();
+					const ULONG orgLength = reader.getInt32();
+					const auto orgRecord = reader.getBinary(orgLength);
+					const ULONG newLength = reader.getInt32();
+					const ULONG diffLength = reader.getInt32();
+					const auto diff = reader.getBinary(diffLength);
+
+					// Rebuild the new record image from the original one
+
+					Difference difference;
+
+					if (diffLength > difference.getCapacity() || newLength != orgLength)
+						raiseError("Replication block is malformed");
+
+					memcpy(difference.getData(), diff, diffLength);
+
+					UCharBuffer newBuffer;
+					const auto newRecord = newBuffer.getBuffer(newLength);
+					memcpy(newRecord, orgRecord, orgLength);
+
+					if (difference.apply(diffLength, newLength, newRecord) != newLength)
+						raiseError("Replication block is malformed");
+
+					updateRecord(tdbb, traNum, relName, orgLength, orgRecord, newLength, newRecord);
+				}
+				break;
+
 			case opDeleteRecord:
 				{
 					const auto& relName = reader.getAtomQualifiedName();
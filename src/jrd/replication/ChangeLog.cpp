@@ -32,6 +32,7 @@
 #include "Config.h"
 #include "ChangeLog.h"
 #include "Replicator.h"
+#include "Streamer.h"
 #include "Utils.h"
 
 #include <sys/types.h>
@@ -383,10 +384,15 @@ ChangeLog::ChangeLog(MemoryPool& pool,
 	Thread::start(archiver_thread, this, THREAD_medium);
 	m_startupSemaphore.enter();
 	m_workingSemaphore.release();
+
+	if (m_config->streamAddress.hasData())
+		m_streamer = FB_NEW_POOL(pool) LogStreamer(pool, m_config, m_guid, this);
 }
 
 ChangeLog::~ChangeLog()
 {
+	m_streamer.reset();
+
 	m_shutdown = true;
 
 	m_workingSemaphore.release();
@@ -585,6 +591,21 @@ void ChangeLog::mutexBug(int osErrorCode, const char* /*text*/)
 	raiseError("Shared memory locking failed (error %d)", osErrorCode);
 }
 
+FB_UINT64 ChangeLog::getSequence()
+{
+	LockGuard guard(this);
+
+	return m_sharedMemory->getHeader()->sequence;
+}
+
+PathName ChangeLog::getSegmentName(FB_UINT64 sequence) const
+{
+	PathName filename;
+	filename.printf(FILENAME_PATTERN, m_config->filePrefix.c_str(), m_guid.toString(false).c_str(), sequence);
+
+	return m_config->journalDirectory + filename;
+}
+
 void ChangeLog::forceSwitch()
 {
 	LockGuard guard(this);
@@ -963,9 +984,7 @@ ChangeLog::Segment* ChangeLog::createSegment()
 	const auto state = m_sharedMemory->getHeader();
 	const auto sequence = state->sequence + 1;
 
-	PathName filename;
-	filename.printf(FILENAME_PATTERN, m_config->filePrefix.c_str(), m_guid.toString(false).c_str(), sequence);
-	filename = m_config->journalDirectory + filename;
+	const PathName filename = getSegmentName(sequence);
 
 	const auto fd = os_utils::openCreateSharedFile(filename.c_str(), O_EXCL | O_BINARY);
 
@@ -1013,9 +1032,7 @@ ChangeLog::Segment* ChangeLog::reuseSegment(ChangeLog::Segment* segment)
 
 	// Attempt to rename the backing file
 
-	PathName newname;
-	newname.printf(FILENAME_PATTERN, m_config->filePrefix.c_str(), m_guid.toString(false).c_str(), sequence);
-	newname = m_config->journalDirectory + newname;
+	const PathName newname = getSegmentName(sequence);
 
 	// If renaming fails, then we just create a new file.
 	// The old segment will be reused later in this case.
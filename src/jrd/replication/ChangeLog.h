@@ -26,6 +26,7 @@
 
 #include "../common/classes/alloc.h"
 #include "../common/classes/array.h"
+#include "../common/classes/auto.h"
 #include "../common/classes/semaphore.h"
 #include "../common/classes/fb_string.h"
 #include "../common/os/guid.h"
@@ -36,6 +37,7 @@
 namespace Replication
 {
 	struct Config;
+	class LogStreamer;
 
 	enum SegmentState : USHORT
 	{
@@ -215,6 +217,9 @@ namespace Replication
 		void bgArchiver();
 		void cleanup();
 
+		FB_UINT64 getSequence();
+		Firebird::PathName getSegmentName(FB_UINT64 sequence) const;
+
 	private:
 		void initSharedFile();
 
@@ -261,6 +266,8 @@ namespace Replication
 		Firebird::Semaphore m_cleanupSemaphore;
 		Firebird::Semaphore m_workingSemaphore;
 
+		Firebird::AutoPtr<LogStreamer> m_streamer;
+
 		volatile bool m_shutdown;
 	};
 
@@ -62,6 +62,8 @@ namespace
 	constexpr ULONG DEFAULT_GROUP_FLUSH_DELAY = 0;
 	constexpr ULONG DEFAULT_APPLY_IDLE_TIMEOUT = 10;			// seconds
 	constexpr ULONG DEFAULT_APPLY_ERROR_TIMEOUT = 60;			// seconds
+	constexpr ULONG DEFAULT_APPLY_PARALLELISM = 1;
+	constexpr ULONG MAX_APPLY_PARALLELISM = 64;
 	constexpr bool DEFAULT_REPORT_ERRORS = false;
 
 	void parseLong(const string& input, ULONG& output)
@@ -218,6 +220,7 @@ namespace
 Config::Config()
 	: dbName(getPool()),
 	  bufferSize(DEFAULT_BUFFER_SIZE),
+	  compression(false),
 	  includeSchemaFilter(getPool()),
 	  excludeSchemaFilter(getPool()),
 	  includeFilter(getPool()),
@@ -230,11 +233,15 @@ Config::Config()
 	  archiveDirectory(getPool()),
 	  archiveCommand(getPool()),
 	  archiveTimeout(DEFAULT_ARCHIVE_TIMEOUT),
+	  streamAddress(getPool()),
+	  streamPassword(getPool()),
 	  syncReplicas(getPool()),
 	  sourceDirectory(getPool()),
+	  sourceStream(getPool()),
 	  verboseLogging(false),
 	  applyIdleTimeout(DEFAULT_APPLY_IDLE_TIMEOUT),
 	  applyErrorTimeout(DEFAULT_APPLY_ERROR_TIMEOUT),
+	  applyParallelism(DEFAULT_APPLY_PARALLELISM),
 	  schemaSearchPath(getPool()),
 	  pluginName(getPool()),
 	  logErrors(true),
@@ -247,6 +254,7 @@ Config::Config()
 Config::Config(const Config& other)
 	: dbName(getPool(), other.dbName),
 	  bufferSize(other.bufferSize),
+	  compression(other.compression),
 	  includeSchemaFilter(getPool(), other.includeSchemaFilter),
 	  excludeSchemaFilter(getPool(), other.excludeSchemaFilter),
 	  includeFilter(getPool(), other.includeFilter),
@@ -259,11 +267,15 @@ Config::Config(const Config& other)
 	  archiveDirectory(getPool(), other.archiveDirectory),
 	  archiveCommand(getPool(), other.archiveCommand),
 	  archiveTimeout(other.archiveTimeout),
+	  streamAddress(getPool(), other.streamAddress),
+	  streamPassword(getPool(), other.streamPassword),
 	  syncReplicas(getPool(), other.syncReplicas),
 	  sourceDirectory(getPool(), other.sourceDirectory),
+	  sourceStream(getPool(), other.sourceStream),
 	  verboseLogging(other.verboseLogging),
 	  applyIdleTimeout(other.applyIdleTimeout),
 	  applyErrorTimeout(other.applyErrorTimeout),
+	  applyParallelism(other.applyParallelism),
 	  schemaSearchPath(getPool(), other.schemaSearchPath),
 	  pluginName(getPool(), other.pluginName),
 	  logErrors(other.logErrors),
@@ -359,6 +371,10 @@ Config* Config::get(const PathName& lookupName)
 				{
 					parseLong(value, config->bufferSize);
 				}
+				else if (key == "compression")
+				{
+					parseBoolean(value, config->compression);
+				}
 				else if (key == "include_schema_filter")
 				{
 					ISC_systemToUtf8(value);
@@ -424,6 +440,14 @@ Config* Config::get(const PathName& lookupName)
 				{
 					parseLong(value, config->archiveTimeout);
 				}
+				else if (key == "journal_stream_address")
+				{
+					config->streamAddress = value;
+				}
+				else if (key == "journal_stream_password")
+				{
+					config->streamPassword = value;
+				}
 				else if (key == "plugin")
 				{
 					config->pluginName = value;
@@ -446,10 +470,12 @@ Config* Config::get(const PathName& lookupName)
 					parseBoolean(value, config->cascadeReplication);
 				}
 				else if ((key != "journal_source_directory") &&
+						(key != "journal_source_stream") &&
 						(key != "source_guid") &&
 						(key != "verbose_logging") &&
 						(key != "apply_idle_timeout") &&
-						(key != "apply_error_timeout"))
+						(key != "apply_error_timeout") &&
+						(key != "apply_parallelism"))
 				{
 					configError(&localStatus, "unknown key",
 					                          exactMatch ? lookupName.c_str() : section.name.c_str(),
@@ -571,6 +597,14 @@ void Config::enumerate(ReplicaList& replicas)
 						continue;
 					}
 				}
+				else if (key == "journal_source_stream")
+				{
+					config->sourceStream = value;
+				}
+				else if (key == "journal_stream_password")
+				{
+					config->streamPassword = value;
+				}
 				else if (key == "source_guid")
 				{
 					config->sourceGuid = Guid::fromString(value);
@@ -592,6 +626,11 @@ void Config::enumerate(ReplicaList& replicas)
 				{
 					parseLong(value, config->applyErrorTimeout);
 				}
+				else if (key == "apply_parallelism")
+				{
+					parseLong(value, config->applyParallelism);
+					config->applyParallelism = MIN(config->applyParallelism, MAX_APPLY_PARALLELISM);
+				}
 				else if (key == "schema_search_path")
 					config->schemaSearchPath = value;
 			}
@@ -62,6 +62,7 @@ namespace Replication
 
 		Firebird::PathName dbName;
 		ULONG bufferSize;
+		bool compression;
 		Firebird::string includeSchemaFilter;
 		Firebird::string excludeSchemaFilter;
 		Firebird::string includeFilter;
@@ -74,12 +75,16 @@ namespace Replication
 		Firebird::PathName archiveDirectory;
 		Firebird::string archiveCommand;
 		ULONG archiveTimeout;
+		Firebird::string streamAddress;
+		Firebird::string streamPassword;
 		Firebird::ObjectsArray<SyncReplica> syncReplicas;
 		Firebird::PathName sourceDirectory;
+		Firebird::string sourceStream;
 		std::optional<Firebird::Guid> sourceGuid;
 		bool verboseLogging;
 		ULONG applyIdleTimeout;
 		ULONG applyErrorTimeout;
+		ULONG applyParallelism;
 		Firebird::string schemaSearchPath;
 		Firebird::string pluginName;
 		bool logErrors;
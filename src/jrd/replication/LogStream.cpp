@@ -0,0 +1,497 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../common/classes/init.h"
+#include "../common/os/guid.h"
+#include "../common/sha2/sha2.h"
+#include "../yvalve/gds_proto.h"
+#include "../include/memory_routines.h"
+
+#include "LogStream.h"
+
+#ifdef WIN_NT
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+using namespace Firebird;
+using namespace Replication;
+
+namespace
+{
+#ifdef WIN_NT
+	typedef SOCKET SocketHandle;
+
+	class WinsockInit
+	{
+	public:
+		explicit WinsockInit(MemoryPool&)
+		{
+			WSADATA wsadata;
+			m_success = (WSAStartup(MAKEWORD(2, 2), &wsadata) == 0);
+		}
+
+		~WinsockInit()
+		{
+			if (m_success)
+				WSACleanup();
+		}
+
+	private:
+		bool m_success;
+	};
+
+	InitInstance<WinsockInit> winsock;
+#else
+	typedef int SocketHandle;
+#endif
+
+	void closeSocket(SocketHandle handle)
+	{
+#ifdef WIN_NT
+		closesocket(handle);
+#else
+		::close(handle);
+#endif
+	}
+
+	SocketHandle openSocket(const addrinfo* info)
+	{
+#ifdef WIN_NT
+		winsock();
+#endif
+		const auto handle = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+
+#ifndef WIN_NT
+		if (handle >= 0)
+			fcntl(handle, F_SETFD, FD_CLOEXEC);
+#endif
+
+		return handle;
+	}
+
+	bool isValid(SocketHandle handle)
+	{
+#ifdef WIN_NT
+		return (handle != INVALID_SOCKET);
+#else
+		return (handle >= 0);
+#endif
+	}
+
+	// Resolve the address in the [<host>:]<port> form, local host is used by default
+
+	addrinfo* resolve(const string& address, bool passive)
+	{
+		string host, port;
+
+		const auto pos = address.rfind(':');
+		if (pos == string::npos)
+			port = address;
+		else
+		{
+			host = address.substr(0, pos);
+			port = address.substr(pos + 1);
+		}
+
+		if (host.length() > 2 && host[0] == '[' && host[host.length() - 1] == ']')
+			host = host.substr(1, host.length() - 2);
+
+		if (host.isEmpty())
+			host = "localhost";
+
+		addrinfo hints;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_protocol = IPPROTO_TCP;
+		hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+#ifdef WIN_NT
+		winsock();
+#endif
+
+		addrinfo* result = nullptr;
+		if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0)
+			return nullptr;
+
+		return result;
+	}
+
+	bool isLoopback(const addrinfo* info)
+	{
+		switch (info->ai_family)
+		{
+		case AF_INET:
+			{
+				const auto addr = reinterpret_cast<const sockaddr_in*>(info->ai_addr);
+				return ((ntohl(addr->sin_addr.s_addr) >> 24) == 127);
+			}
+
+		case AF_INET6:
+			{
+				const auto addr = reinterpret_cast<const sockaddr_in6*>(info->ai_addr);
+				return IN6_IS_ADDR_LOOPBACK(&addr->sin6_addr);
+			}
+		}
+
+		return false;
+	}
+}
+
+
+namespace Replication
+{
+	// Frame and request encoding
+
+	void StreamRequest::encode(UCHAR* buffer) const
+	{
+		UCHAR* ptr = buffer;
+
+		memcpy(ptr, STREAM_SIGNATURE, sizeof(STREAM_SIGNATURE));
+		ptr += sizeof(STREAM_SIGNATURE);
+
+		ptr += put_vax_short(ptr, (SSHORT) version);
+		ptr += put_vax_int64(ptr, (SINT64) sequence);
+		ptr += put_vax_long(ptr, (SLONG) offset);
+
+		memcpy(ptr, proof, STREAM_PROOF_SIZE);
+		ptr += STREAM_PROOF_SIZE;
+
+		fb_assert(ptr == buffer + SIZE);
+	}
+
+	bool StreamRequest::decode(const UCHAR* buffer)
+	{
+		const UCHAR* ptr = buffer;
+
+		if (memcmp(ptr, STREAM_SIGNATURE, sizeof(STREAM_SIGNATURE)))
+			return false;
+
+		ptr += sizeof(STREAM_SIGNATURE);
+
+		version = (USHORT) gds__vax_integer(ptr, 2);
+		ptr += 2;
+		sequence = (FB_UINT64) isc_portable_integer(ptr, 8);
+		ptr += 8;
+		offset = (ULONG) gds__vax_integer(ptr, 4);
+		ptr += 4;
+
+		memcpy(proof, ptr, STREAM_PROOF_SIZE);
+		ptr += STREAM_PROOF_SIZE;
+
+		fb_assert(ptr == buffer + SIZE);
+		return true;
+	}
+
+	void StreamFrame::encode(UCHAR* buffer) const
+	{
+		UCHAR* ptr = buffer;
+
+		ptr += put_vax_short(ptr, (SSHORT) type);
+		ptr += put_vax_int64(ptr, (SINT64) sequence);
+		ptr += put_vax_long(ptr, (SLONG) offset);
+		ptr += put_vax_long(ptr, (SLONG) length);
+
+		fb_assert(ptr == buffer + SIZE);
+	}
+
+	void StreamFrame::decode(const UCHAR* buffer)
+	{
+		const UCHAR* ptr = buffer;
+
+		type = (USHORT) gds__vax_integer(ptr, 2);
+		ptr += 2;
+		sequence = (FB_UINT64) isc_portable_integer(ptr, 8);
+		ptr += 8;
+		offset = (ULONG) gds__vax_integer(ptr, 4);
+		ptr += 4;
+		length = (ULONG) gds__vax_integer(ptr, 4);
+		ptr += 4;
+
+		fb_assert(ptr == buffer + SIZE);
+	}
+
+	// HMAC-SHA256 (RFC 2104) of the challenge and GUID keyed with the password
+
+	void makeStreamProof(const string& password, const UCHAR* challenge,
+						 const UCHAR* guid, UCHAR* proof)
+	{
+		static_assert(STREAM_PROOF_SIZE == SHA256_DIGEST_SIZE, "wrong proof size");
+
+		UCHAR key[SHA256_BLOCK_SIZE];
+		memset(key, 0, sizeof(key));
+
+		if (password.length() > SHA256_BLOCK_SIZE)
+			get_digest<sha256>((const UCHAR*) password.c_str(), password.length(), key);
+		else
+			memcpy(key, password.c_str(), password.length());
+
+		UCHAR pad[SHA256_BLOCK_SIZE];
+		UCHAR digest[SHA256_DIGEST_SIZE];
+
+		sha256 hash;
+
+		for (unsigned i = 0; i < SHA256_BLOCK_SIZE; i++)
+			pad[i] = key[i] ^ 0x36;
+
+		hash.process(sizeof(pad), pad);
+		hash.process(STREAM_CHALLENGE_SIZE, challenge);
+		hash.process(Guid::SIZE, guid);
+		hash.getHash(digest);
+
+		for (unsigned i = 0; i < SHA256_BLOCK_SIZE; i++)
+			pad[i] = key[i] ^ 0x5C;
+
+		hash.process(sizeof(pad), pad);
+		hash.process(sizeof(digest), digest);
+		hash.getHash(proof);
+	}
+}
+
+
+// StreamSocket class implementation
+
+bool StreamSocket::listen(const string& address, bool localOnly, bool& busy)
+{
+	fb_assert(!isOpen());
+
+	busy = false;
+
+	const auto info = resolve(address, true);
+	if (!info)
+		return false;
+
+	for (auto ptr = info; ptr; ptr = ptr->ai_next)
+	{
+		if (localOnly && !isLoopback(ptr))
+			continue;
+
+		const auto handle = openSocket(ptr);
+		if (!isValid(handle))
+			continue;
+
+#ifndef WIN_NT
+		int optval = 1;
+		setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, (const char*) &optval, sizeof(optval));
+#endif
+
+		if (!bind(handle, ptr->ai_addr, (int) ptr->ai_addrlen) && !::listen(handle, SOMAXCONN))
+		{
+			m_handle = (U_IPTR) handle;
+			break;
+		}
+
+#ifdef WIN_NT
+		busy = (INET_ERRNO == WSAEADDRINUSE);
+#else
+		busy = (INET_ERRNO == EADDRINUSE);
+#endif
+		closeSocket(handle);
+	}
+
+	freeaddrinfo(info);
+
+	return isOpen();
+}
+
+bool StreamSocket::accept(StreamSocket& client, ULONG timeout)
+{
+	fb_assert(isOpen() && !client.isOpen());
+
+	if (wait(timeout) <= 0)
+		return false;
+
+	const auto handle = ::accept((SocketHandle) m_handle, nullptr, nullptr);
+	if (!isValid(handle))
+		return false;
+
+#ifndef WIN_NT
+	fcntl(handle, F_SETFD, FD_CLOEXEC);
+#endif
+
+	int optval = 1;
+	setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, (const char*) &optval, sizeof(optval));
+
+	client.m_handle = (U_IPTR) handle;
+	return true;
+}
+
+bool StreamSocket::connect(const string& address)
+{
+	fb_assert(!isOpen());
+
+	const auto info = resolve(address, false);
+	if (!info)
+		return false;
+
+	for (auto ptr = info; ptr; ptr = ptr->ai_next)
+	{
+		const auto handle = openSocket(ptr);
+		if (!isValid(handle))
+			continue;
+
+		if (!::connect(handle, ptr->ai_addr, (int) ptr->ai_addrlen))
+		{
+			int optval = 1;
+			setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, (const char*) &optval, sizeof(optval));
+
+			m_handle = (U_IPTR) handle;
+			break;
+		}
+
+		closeSocket(handle);
+	}
+
+	freeaddrinfo(info);
+
+	return isOpen();
+}
+
+// Wait for the incoming data (or connection), returns zero on timeout and negative value on error
+
+int StreamSocket::wait(ULONG timeout)
+{
+	fb_assert(isOpen());
+
+#ifdef WIN_NT
+	fd_set fds;
+	FD_ZERO(&fds);
+	FD_SET((SocketHandle) m_handle, &fds);
+
+	timeval tv;
+	tv.tv_sec = timeout / 1000;
+	tv.tv_usec = (timeout % 1000) * 1000;
+
+	return select(0, &fds, nullptr, nullptr, &tv);
+#else
+	pollfd fds;
+	fds.fd = (SocketHandle) m_handle;
+	fds.events = POLLIN;
+	fds.revents = 0;
+
+	while (true)
+	{
+		const int ret = poll(&fds, 1, (int) timeout);
+
+		if (ret < 0 && INET_ERRNO == EINTR)
+			continue;
+
+		return ret;
+	}
+#endif
+}
+
+bool StreamSocket::send(const void* data, ULONG length)
+{
+	fb_assert(isOpen());
+
+	auto ptr = static_cast<const char*>(data);
+
+	while (length)
+	{
+#ifdef MSG_NOSIGNAL
+		const int n = ::send((SocketHandle) m_handle, ptr, length, MSG_NOSIGNAL);
+#else
+		const int n = ::send((SocketHandle) m_handle, ptr, length, 0);
+#endif
+
+		if (n <= 0)
+		{
+#ifndef WIN_NT
+			if (n < 0 && INET_ERRNO == EINTR)
+				continue;
+#endif
+			return false;
+		}
+
+		ptr += n;
+		length -= n;
+	}
+
+	return true;
+}
+
+bool StreamSocket::receive(void* data, ULONG length, ULONG timeout)
+{
+	fb_assert(isOpen());
+
+	auto ptr = static_cast<char*>(data);
+
+	while (length)
+	{
+		if (wait(timeout) <= 0)
+			return false;
+
+		const int n = ::recv((SocketHandle) m_handle, ptr, length, 0);
+
+		if (n <= 0)
+		{
+#ifndef WIN_NT
+			if (n < 0 && INET_ERRNO == EINTR)
+				continue;
+#endif
+			return false;
+		}
+
+		ptr += n;
+		length -= n;
+	}
+
+	return true;
+}
+
+bool StreamSocket::sendFrame(const StreamFrame& frame)
+{
+	UCHAR buffer[StreamFrame::SIZE];
+	frame.encode(buffer);
+
+	return send(buffer, sizeof(buffer));
+}
+
+bool StreamSocket::receiveFrame(StreamFrame& frame, ULONG timeout)
+{
+	UCHAR buffer[StreamFrame::SIZE];
+
+	if (!receive(buffer, sizeof(buffer), timeout))
+		return false;
+
+	frame.decode(buffer);
+	return true;
+}
+
+void StreamSocket::close()
+{
+	if (isOpen())
+	{
+		closeSocket((SocketHandle) m_handle);
+		m_handle = INVALID_HANDLE;
+	}
+}
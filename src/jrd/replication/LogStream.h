@@ -0,0 +1,129 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+
+#ifndef JRD_REPLICATION_LOGSTREAM_H
+#define JRD_REPLICATION_LOGSTREAM_H
+
+#include "../common/classes/fb_string.h"
+
+namespace Replication
+{
+	// Journal streaming protocol.
+	//
+	// The primary sends FRAME_HELLO with its journal GUID and a random challenge, the replica
+	// answers with StreamRequest asking for the journal starting at the given segment and offset
+	// and proving it knows the journal_stream_password (HMAC-SHA256 of the challenge and GUID).
+	// Then the primary sends the blocks of the segments as soon as they're written,
+	// every block being preceded by the frame describing its position in the journal.
+	// FRAME_NO_SEGMENT means that the requested segment is not in the journal anymore,
+	// so the replica has to use the archived segments instead.
+	//
+	// Frames and requests are encoded with the fixed size and little-endian integers,
+	// the blocks are sent as they're stored in the journal segments.
+
+	inline constexpr char STREAM_SIGNATURE[] = "FBJOURNAL";
+
+	inline constexpr USHORT STREAM_VERSION_1 = 1;
+	inline constexpr USHORT STREAM_VERSION_2 = 2;	// portable encoding, authentication
+	inline constexpr USHORT STREAM_CURRENT_VERSION = STREAM_VERSION_2;
+
+	inline constexpr ULONG STREAM_HEARTBEAT_INTERVAL = 1000;	// milliseconds
+	inline constexpr ULONG STREAM_TIMEOUT = 10000;				// milliseconds
+
+	inline constexpr ULONG STREAM_CHALLENGE_SIZE = 16;
+	inline constexpr ULONG STREAM_PROOF_SIZE = 32;
+
+	enum StreamFrameType : USHORT
+	{
+		FRAME_HELLO = 1,		// journal GUID and challenge follow
+		FRAME_BLOCK = 2,		// block of the segment follows
+		FRAME_SEGMENT_END = 3,	// segment is complete
+		FRAME_NO_SEGMENT = 4,	// segment is not available
+		FRAME_HEARTBEAT = 5		// nothing new
+	};
+
+	struct StreamRequest
+	{
+		static inline constexpr ULONG SIZE = sizeof(STREAM_SIGNATURE) + 2 + 8 + 4 + STREAM_PROOF_SIZE;
+
+		USHORT version;
+		FB_UINT64 sequence;
+		ULONG offset;
+		UCHAR proof[STREAM_PROOF_SIZE];
+
+		void encode(UCHAR* buffer) const;
+		bool decode(const UCHAR* buffer);
+	};
+
+	struct StreamFrame
+	{
+		static inline constexpr ULONG SIZE = 2 + 8 + 4 + 4;
+
+		USHORT type;
+		FB_UINT64 sequence;
+		ULONG offset;
+		ULONG length;
+
+		void encode(UCHAR* buffer) const;
+		void decode(const UCHAR* buffer);
+	};
+
+	// Proof of the password knowledge sent by the replica
+	void makeStreamProof(const Firebird::string& password, const UCHAR* challenge,
+						 const UCHAR* guid, UCHAR* proof);
+
+	// TCP connection used to stream the journal
+
+	class StreamSocket
+	{
+	public:
+		StreamSocket() = default;
+
+		~StreamSocket()
+		{
+			close();
+		}
+
+		StreamSocket(const StreamSocket&) = delete;
+		StreamSocket& operator=(const StreamSocket&) = delete;
+
+		bool isOpen() const noexcept
+		{
+			return (m_handle != INVALID_HANDLE);
+		}
+
+		bool listen(const Firebird::string& address, bool localOnly, bool& busy);
+		bool accept(StreamSocket& client, ULONG timeout);
+		bool connect(const Firebird::string& address);
+
+		int wait(ULONG timeout);
+		bool send(const void* data, ULONG length);
+		bool receive(void* data, ULONG length, ULONG timeout);
+
+		bool sendFrame(const StreamFrame& frame);
+		bool receiveFrame(StreamFrame& frame, ULONG timeout);
+
+		void close();
+
+	private:
+		static inline constexpr U_IPTR INVALID_HANDLE = ~((U_IPTR) 0);
+
+		U_IPTR m_handle = INVALID_HANDLE;
+	};
+}
+
+#endif // JRD_REPLICATION_LOGSTREAM_H
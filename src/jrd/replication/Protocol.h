@@ -29,11 +29,13 @@ namespace Replication
 	// Supported protocol versions
 	inline constexpr USHORT PROTOCOL_VERSION_1 = 1;
 	inline constexpr USHORT PROTOCOL_VERSION_2 = 2;	// support for schemas
-	inline constexpr USHORT PROTOCOL_CURRENT_VERSION = PROTOCOL_VERSION_2;
+	inline constexpr USHORT PROTOCOL_VERSION_3 = 3;	// compressed blocks, update differences
+	inline constexpr USHORT PROTOCOL_CURRENT_VERSION = PROTOCOL_VERSION_3;
 
 	// Global (protocol neutral) flags
 	inline constexpr USHORT BLOCK_BEGIN_TRANS	= 0x0001;
 	inline constexpr USHORT BLOCK_END_TRANS		= 0x0002;
+	inline constexpr USHORT BLOCK_COMPRESSED	= 0x0004;	// zlib packed, preceded by ULONG raw length
 
 	struct Block
 	{
@@ -69,7 +71,9 @@ namespace Replication
 		opSetSequence = 14,
 		opExecuteSqlIntl = 15,
 
-		opDefineAtom = 16
+		opDefineAtom = 16,
+
+		opUpdateRecordDiff = 17
 	};
 
 } // namespace
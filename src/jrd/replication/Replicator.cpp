@@ -23,6 +23,7 @@
 #include "firebird.h"
 #include "../jrd/jrd.h"
 #include "../../common/classes/BlobWrapper.h"
+#include "../sqz.h"
 
 #include "Config.h"
 #include "Replicator.h"
@@ -53,7 +54,10 @@ void Replicator::flush(BatchBlock& block, FlushReason reason, ULONG flags)
 	const auto length = (ULONG) (block.buffer->getCount() - sizeof(Block));
 	fb_assert(length);
 
-	block.header.protocol = PROTOCOL_CURRENT_VERSION;
+	// Compressed blocks are not understood by the older replicas,
+	// so stick to the previous protocol version unless requested
+
+	block.header.protocol = m_config->compression ? PROTOCOL_VERSION_3 : PROTOCOL_VERSION_2;
 	block.header.flags |= flags;
 	block.header.length = length;
 
@@ -61,6 +65,9 @@ void Replicator::flush(BatchBlock& block, FlushReason reason, ULONG flags)
 
 	memcpy(block.buffer->begin(), &block.header, sizeof(Block));
 
+	if (m_config->compression)
+		packBlock(*block.buffer);
+
 	// Pass the buffer to the replication manager and setup the new one
 
 	const auto sync = (reason == FLUSH_SYNC);
@@ -372,13 +379,40 @@ void Replicator::updateRecord(CheckStatusWrapper* status,
 
 		const auto [schemaAtom, objectAtom] = txnData.defineQualifiedAtom(QualifiedMetaString(tableName, schemaName));
 
-		txnData.putTag(opUpdateRecord);
-		txnData.putInt32(schemaAtom);
-		txnData.putInt32(objectAtom);
-		txnData.putInt32(orgLength);
-		txnData.putBinary(orgLength, orgData);
-		txnData.putInt32(newLength);
-		txnData.putBinary(newLength, newData);
+		// Send only the differences for the new record image, if possible
+
+		ULONG diffLength = 0;
+		Difference difference;
+
+		if (m_config->compression && orgLength == newLength)
+		{
+			diffLength = difference.make(orgLength, orgData, newLength, newData);
+
+			if (diffLength >= newLength)
+				diffLength = 0;
+		}
+
+		if (diffLength)
+		{
+			txnData.putTag(opUpdateRecordDiff);
+			txnData.putInt32(schemaAtom);
+			txnData.putInt32(objectAtom);
+			txnData.putInt32(orgLength);
+			txnData.putBinary(orgLength, orgData);
+			txnData.putInt32(newLength);
+			txnData.putInt32(diffLength);
+			txnData.putBinary(diffLength, difference.getData());
+		}
+		else
+		{
+			txnData.putTag(opUpdateRecord);
+			txnData.putInt32(schemaAtom);
+			txnData.putInt32(objectAtom);
+			txnData.putInt32(orgLength);
+			txnData.putBinary(orgLength, orgData);
+			txnData.putInt32(newLength);
+			txnData.putBinary(newLength, newData);
+		}
 
 		if (txnData.getSize() > m_config->bufferSize)
 			flush(txnData, FLUSH_OVERFLOW);
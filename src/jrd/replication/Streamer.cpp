@@ -0,0 +1,357 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../common/isc_proto.h"
+#include "../common/os/os_utils.h"
+
+#include "ChangeLog.h"
+#include "Config.h"
+#include "Protocol.h"
+#include "Streamer.h"
+#include "Utils.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifdef WIN_NT
+#include <io.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY	0
+#endif
+
+using namespace Firebird;
+using namespace Replication;
+
+namespace
+{
+	inline constexpr ULONG ACCEPT_TIMEOUT = 100;	// milliseconds
+	inline constexpr ULONG POLL_INTERVAL = 10;		// milliseconds
+	inline constexpr FB_SIZE_T MAX_SESSIONS = 16;	// concurrently served replicas
+
+	bool readAt(int handle, SINT64 offset, void* buffer, ULONG length)
+	{
+		if (os_utils::lseek(handle, offset, SEEK_SET) != offset)
+			return false;
+
+		return (::read(handle, buffer, length) == (int) length);
+	}
+}
+
+
+// LogStreamer class implementation
+
+LogStreamer::LogStreamer(MemoryPool& pool, const Config* config, const Guid& guid, ChangeLog* log)
+	: PermanentStorage(pool),
+	  m_config(config), m_guid(guid), m_log(log),
+	  m_sessions(pool), m_shutdown(false)
+{
+	bool busy = false;
+
+	// Without password anyone who can connect would get the whole journal,
+	// so only the loopback addresses are listened at
+
+	const bool localOnly = m_config->streamPassword.isEmpty();
+
+	if (!m_socket.listen(m_config->streamAddress, localOnly, busy))
+	{
+		// Another process may serve the journal already
+
+		if (!busy)
+		{
+			string warningMsg;
+			warningMsg.printf("Journal cannot be streamed to %s%s", m_config->streamAddress.c_str(),
+				localOnly ? " (only local addresses are allowed without journal_stream_password)" : "");
+			logPrimaryWarning(m_config->dbName, warningMsg);
+		}
+
+		return;
+	}
+
+	Thread::start(listenerThread, this, THREAD_medium, &m_thread);
+}
+
+LogStreamer::~LogStreamer()
+{
+	m_shutdown = true;
+
+	if (m_socket.isOpen())
+		m_thread.waitForCompletion();
+}
+
+THREAD_ENTRY_DECLARE LogStreamer::listenerThread(THREAD_ENTRY_PARAM arg)
+{
+	try
+	{
+		static_cast<LogStreamer*>(arg)->listen();
+	}
+	catch (const Exception& ex)
+	{
+		iscLogException("Error in journal streaming thread", ex);
+	}
+
+	return 0;
+}
+
+THREAD_ENTRY_DECLARE LogStreamer::sessionThread(THREAD_ENTRY_PARAM arg)
+{
+	const auto session = static_cast<Session*>(arg);
+
+	try
+	{
+		session->streamer->serve(session->socket);
+	}
+	catch (const Exception& ex)
+	{
+		iscLogException("Error in journal streaming thread", ex);
+	}
+
+	session->socket.close();
+
+	MutexLockGuard guard(session->streamer->m_mutex, FB_FUNCTION);
+	session->finished = true;
+
+	return 0;
+}
+
+void LogStreamer::listen()
+{
+	AutoPtr<Session> session;
+
+	while (!m_shutdown)
+	{
+		if (!session)
+		{
+			session = FB_NEW_POOL(getPool()) Session;
+			session->streamer = this;
+		}
+
+		if (m_socket.accept(session->socket, ACCEPT_TIMEOUT))
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (m_sessions.getCount() < MAX_SESSIONS)
+			{
+				Thread::start(sessionThread, session, THREAD_medium, &session->thread);
+				m_sessions.add(session.release());
+			}
+			else
+				session->socket.close();	// the replica will retry later
+		}
+
+		reapSessions(false);
+	}
+
+	m_socket.close();
+
+	reapSessions(true);
+}
+
+void LogStreamer::reapSessions(bool all)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	for (FB_SIZE_T i = 0; i < m_sessions.getCount();)
+	{
+		const auto session = m_sessions[i];
+
+		if (all || session->finished)
+		{
+			{	// scope
+				MutexUnlockGuard cout(m_mutex, FB_FUNCTION);
+				session->thread.waitForCompletion();
+			}
+
+			m_sessions.remove(i);
+			delete session;
+		}
+		else
+			i++;
+	}
+}
+
+void LogStreamer::serve(StreamSocket& socket)
+{
+	// Introduce ourselves and wait for the replica to tell where to start from
+
+	UCHAR hello[Guid::SIZE + STREAM_CHALLENGE_SIZE];
+	memcpy(hello, m_guid.getData(), Guid::SIZE);
+	GenerateRandomBytes(hello + Guid::SIZE, STREAM_CHALLENGE_SIZE);
+
+	if (!sendFrame(socket, FRAME_HELLO, 0, 0, sizeof(hello), hello))
+		return;
+
+	UCHAR requestBuffer[StreamRequest::SIZE];
+	StreamRequest request;
+
+	if (!socket.receive(requestBuffer, sizeof(requestBuffer), STREAM_TIMEOUT) ||
+		!request.decode(requestBuffer) ||
+		request.version != STREAM_CURRENT_VERSION)
+	{
+		return;
+	}
+
+	if (m_config->streamPassword.hasData())
+	{
+		UCHAR proof[STREAM_PROOF_SIZE];
+		makeStreamProof(m_config->streamPassword, hello + Guid::SIZE, hello, proof);
+
+		// Compare in constant time
+		UCHAR diff = 0;
+		for (ULONG i = 0; i < STREAM_PROOF_SIZE; i++)
+			diff |= (proof[i] ^ request.proof[i]);
+
+		if (diff)
+		{
+			logPrimaryWarning(m_config->dbName, "Journal stream: replica authentication failed");
+			return;
+		}
+	}
+
+	FB_UINT64 sequence = request.sequence;
+	ULONG offset = MAX(request.offset, (ULONG) sizeof(SegmentHeader));
+	ULONG idleTime = 0;
+
+	Array<UCHAR> buffer(getPool());
+
+	while (!m_shutdown)
+	{
+		const PathName filename = m_log->getSegmentName(sequence);
+
+		const int fd = os_utils::open(filename.c_str(), O_RDONLY | O_BINARY);
+		if (fd < 0)
+		{
+			// Either the segment is not created yet or it's already archived and reused
+
+			if (sequence <= m_log->getSequence())
+			{
+				sendFrame(socket, FRAME_NO_SEGMENT, sequence);
+				return;
+			}
+
+			if (!idle(socket, idleTime))
+				return;
+
+			continue;
+		}
+
+		AutoFile file(fd);
+
+		while (!m_shutdown)
+		{
+			SegmentHeader header;
+			if (!readAt(file, 0, &header, sizeof(SegmentHeader)))
+				return;
+
+			// The segment being created or reused may have the header not initialized yet
+
+			if (strcmp(header.hdr_signature, CHANGELOG_SIGNATURE) || header.hdr_sequence < sequence)
+			{
+				if (!idle(socket, idleTime))
+					return;
+
+				continue;
+			}
+
+			if (header.hdr_sequence != sequence || Guid(header.hdr_guid) != m_guid)
+			{
+				sendFrame(socket, FRAME_NO_SEGMENT, sequence);
+				return;
+			}
+
+			// The header is re-read after every portion of blocks, as the segment
+			// gets its final state only after all its blocks are written
+
+			if (offset < header.hdr_length)
+			{
+				while (offset < header.hdr_length)
+				{
+					Block block;
+					if (!readAt(file, offset, &block, sizeof(Block)))
+						return;
+
+					const ULONG length = sizeof(Block) + block.length;
+
+					if (offset + length > header.hdr_length)
+						raiseError("Journal file %s appears corrupted", filename.c_str());
+
+					UCHAR* const data = buffer.getBuffer(length);
+					memcpy(data, &block, sizeof(Block));
+
+					if (!readAt(file, offset + sizeof(Block), data + sizeof(Block), block.length))
+						return;
+
+					if (!sendFrame(socket, FRAME_BLOCK, sequence, offset, length, data))
+						return;
+
+					offset += length;
+				}
+
+				idleTime = 0;
+				continue;
+			}
+
+			if (header.hdr_state != SEGMENT_STATE_USED)
+			{
+				if (!sendFrame(socket, FRAME_SEGMENT_END, sequence, offset))
+					return;
+
+				sequence++;
+				offset = sizeof(SegmentHeader);
+				break;
+			}
+
+			if (!idle(socket, idleTime))
+				return;
+		}
+	}
+}
+
+// Wait a bit for the new blocks, let the replica know we're alive from time to time
+
+bool LogStreamer::idle(StreamSocket& socket, ULONG& idleTime)
+{
+	Thread::sleep(POLL_INTERVAL);
+	idleTime += POLL_INTERVAL;
+
+	if (idleTime < STREAM_HEARTBEAT_INTERVAL)
+		return true;
+
+	idleTime = 0;
+	return sendFrame(socket, FRAME_HEARTBEAT, 0);
+}
+
+bool LogStreamer::sendFrame(StreamSocket& socket, StreamFrameType type, FB_UINT64 sequence,
+							ULONG offset, ULONG length, const void* data)
+{
+	StreamFrame frame;
+	frame.type = type;
+	frame.sequence = sequence;
+	frame.offset = offset;
+	frame.length = length;
+
+	if (!socket.sendFrame(frame))
+		return false;
+
+	return (!length || socket.send(data, length));
+}
@@ -0,0 +1,75 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+
+#ifndef JRD_REPLICATION_STREAMER_H
+#define JRD_REPLICATION_STREAMER_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/locks.h"
+#include "../common/os/guid.h"
+#include "../common/ThreadStart.h"
+
+#include "LogStream.h"
+
+namespace Replication
+{
+	struct Config;
+	class ChangeLog;
+
+	// Serves the journal to the replicas connected to journal_stream_address.
+	// Segments are read from the journal directory, so the changes written
+	// by any process working with the database are streamed.
+
+	class LogStreamer : protected Firebird::PermanentStorage
+	{
+		struct Session
+		{
+			LogStreamer* streamer = nullptr;
+			StreamSocket socket;
+			Thread thread;
+			bool finished = false;
+		};
+
+	public:
+		LogStreamer(Firebird::MemoryPool& pool, const Config* config,
+					const Firebird::Guid& guid, ChangeLog* log);
+		~LogStreamer();
+
+	private:
+		static THREAD_ENTRY_DECLARE listenerThread(THREAD_ENTRY_PARAM arg);
+		static THREAD_ENTRY_DECLARE sessionThread(THREAD_ENTRY_PARAM arg);
+
+		void listen();
+		void serve(StreamSocket& socket);
+		bool idle(StreamSocket& socket, ULONG& idleTime);
+		bool sendFrame(StreamSocket& socket, StreamFrameType type, FB_UINT64 sequence,
+					   ULONG offset = 0, ULONG length = 0, const void* data = nullptr);
+		void reapSessions(bool all);
+
+		const Config* const m_config;
+		const Firebird::Guid& m_guid;
+		ChangeLog* const m_log;
+		StreamSocket m_socket;
+		Thread m_thread;
+		Firebird::Mutex m_mutex;
+		Firebird::Array<Session*> m_sessions;
+		volatile bool m_shutdown;
+	};
+};
+
+#endif // JRD_REPLICATION_STREAMER_H
@@ -22,6 +22,8 @@
 
 #include "firebird.h"
 #include "../common/classes/GenericMap.h"
+#include "../common/classes/init.h"
+#include "../common/classes/zip.h"
 #include "../common/config/config_file.h"
 #include "../common/isc_proto.h"
 #include "../common/isc_f_proto.h"
@@ -31,6 +33,7 @@
 #include "../common/os/path_utils.h"
 #include "../jrd/constants.h"
 
+#include "Protocol.h"
 #include "Utils.h"
 
 #ifdef HAVE_UNISTD_H
@@ -71,6 +74,13 @@ namespace
 
 	const char* REPLICATION_LOGFILE = "replication.log";
 
+	// Blocks shorter than this are not worth compressing
+	constexpr ULONG MIN_PACKED_LENGTH = 256;
+
+#ifdef HAVE_ZLIB_H
+	InitInstance<ZLib> zlib;
+#endif
+
 	class LogWriter : private GlobalStorage
 	{
 	public:
@@ -291,4 +301,103 @@ namespace Replication
 		logMessage(REPLICA_SIDE, VERBOSE_MSG, database, message);
 	}
 
+
+	bool packBlock(UCharBuffer& buffer)
+	{
+		// Compress the block payload in place, return false if it's not worth it
+
+#ifdef HAVE_ZLIB_H
+		const ULONG length = buffer.getCount() - sizeof(Block);
+
+		if (length < MIN_PACKED_LENGTH || !zlib())
+			return false;
+
+		z_stream strm;
+		strm.zalloc = ZLib::allocFunc;
+		strm.zfree = ZLib::freeFunc;
+		strm.opaque = Z_NULL;
+
+		if (zlib().deflateInit_(&strm, Z_BEST_SPEED, ZLIB_VERSION, sizeof(z_stream)) != Z_OK)
+			return false;
+
+		// Don't allow the packed block to be longer than the original one
+
+		UCharBuffer packed;
+		UCHAR* const output = packed.getBuffer(sizeof(Block) + length);
+
+		strm.next_in = buffer.begin() + sizeof(Block);
+		strm.avail_in = length;
+		strm.next_out = output + sizeof(Block) + sizeof(ULONG);
+		strm.avail_out = length - sizeof(ULONG);
+
+		const int ret = zlib().deflate(&strm, Z_FINISH);
+		const ULONG packedLength = (ULONG) strm.total_out;
+		zlib().deflateEnd(&strm);
+
+		if (ret != Z_STREAM_END)
+			return false;
+
+		Block header;
+		memcpy(&header, buffer.begin(), sizeof(Block));
+		header.flags |= BLOCK_COMPRESSED;
+		header.length = sizeof(ULONG) + packedLength;
+
+		memcpy(output, &header, sizeof(Block));
+		memcpy(output + sizeof(Block), &length, sizeof(ULONG));
+
+		buffer.assign(output, sizeof(Block) + header.length);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void unpackBlock(ULONG length, const UCHAR* data, UCharBuffer& output)
+	{
+		// Decompress the block into the output buffer, including its header
+
+		Block header;
+		memcpy(&header, data, sizeof(Block));
+		fb_assert(header.flags & BLOCK_COMPRESSED);
+
+		if (length != sizeof(Block) + header.length || header.length < sizeof(ULONG))
+			raiseError("Replication block is malformed");
+
+		ULONG rawLength;
+		memcpy(&rawLength, data + sizeof(Block), sizeof(ULONG));
+
+#ifdef HAVE_ZLIB_H
+		if (!zlib())
+			raiseError("Replication block is compressed but zlib library is not available");
+
+		z_stream strm;
+		strm.zalloc = ZLib::allocFunc;
+		strm.zfree = ZLib::freeFunc;
+		strm.opaque = Z_NULL;
+
+		if (zlib().inflateInit_(&strm, ZLIB_VERSION, sizeof(z_stream)) != Z_OK)
+			raiseError("Replication block decompression failed");
+
+		UCHAR* const buffer = output.getBuffer(sizeof(Block) + rawLength);
+
+		strm.next_in = const_cast<UCHAR*>(data) + sizeof(Block) + sizeof(ULONG);
+		strm.avail_in = header.length - sizeof(ULONG);
+		strm.next_out = buffer + sizeof(Block);
+		strm.avail_out = rawLength;
+
+		const int ret = zlib().inflate(&strm, Z_FINISH);
+		const ULONG unpackedLength = (ULONG) strm.total_out;
+		zlib().inflateEnd(&strm);
+
+		if (ret != Z_STREAM_END || unpackedLength != rawLength)
+			raiseError("Replication block decompression failed (error %d)", ret);
+
+		header.flags &= ~BLOCK_COMPRESSED;
+		header.length = rawLength;
+		memcpy(buffer, &header, sizeof(Block));
+#else
+		raiseError("Replication block is compressed but compression is not supported");
+#endif
+	}
+
 } // namespace
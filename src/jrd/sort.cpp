@@ -38,6 +38,7 @@
 #include "../common/TimeZoneUtil.h"
 #include "../common/gdsassert.h"
 #include "../jrd/req.h"
+#include "../jrd/sqz.h"
 #include "../jrd/val.h"
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
@@ -79,6 +80,10 @@ using namespace Firebird;
 constexpr ULONG MAX_SORT_BUFFER_SIZE = 1024 * 128;	// 128KB
 constexpr ULONG MIN_RECORDS_TO_ALLOC = 8;
 
+// Compressed runs are written as a sequence of independently packed frames,
+// this is the maximum length of unpacked frame data
+constexpr ULONG PACK_FRAME_SIZE = 1024 * 64;	// 64KB
+
 // the size of sr_bckptr (everything before sort_record) in bytes
 #define SIZEOF_SR_BCKPTR offsetof(sr, sr_sort_record)
 // the size of sr_bckptr in # of 32 bit longwords
@@ -125,6 +130,15 @@ namespace
 {
 	static constexpr const char* SCRATCH = "fb_sort_";
 
+	// Header of compressed run frame. If compression can't make the frame
+	// shorter, its data is stored as is and both lengths are equal.
+
+	struct pack_frame
+	{
+		ULONG pf_length;	// length of frame data in scratch file
+		ULONG pf_raw;		// length of unpacked frame data
+	};
+
 	class RunSort
 	{
 	public:
@@ -163,7 +177,9 @@ Sort::Sort(Database* dbb,
 	  m_last_record(NULL), m_next_pointer(NULL), m_records(0),
 	  m_runs(NULL), m_merge(NULL), m_free_runs(NULL),
 	  m_flags(0), m_merge_pool(NULL),
-	  m_description(m_owner->getPool(), keys)
+	  m_compress(dbb->dbb_config->getSortCompression()),
+	  m_description(m_owner->getPool(), keys),
+	  m_pack_buffer(m_owner->getPool())
 {
 /**************************************
  *
@@ -225,6 +241,16 @@ Sort::Sort(Database* dbb,
 		m_end_memory = m_memory + m_size_memory;
 		m_first_pointer = (sort_record**) m_memory;
 
+		// If only a few first records are going to be fetched, keep just them
+		// in a heap instead of sorting the whole input. This is possible only
+		// if the heap (and a spare record) fits into the sort buffer.
+
+		if (m_max_records && !m_dup_callback &&
+			m_max_records + 2 < m_size_memory / (record_size + sizeof(sort_record*)))
+		{
+			m_flags |= scb_top_records;
+		}
+
 		// Set up the temp space
 
 		try
@@ -279,6 +305,7 @@ Sort::~Sort()
 		m_runs = run->run_next;
 		if (run->run_buff_alloc)
 			delete[] run->run_buffer;
+		releasePackBuffer(run);
 		delete run;
 	}
 
@@ -289,6 +316,7 @@ Sort::~Sort()
 		m_free_runs = run->run_next;
 		if (run->run_buff_alloc)
 			delete[] run->run_buffer;
+		releasePackBuffer(run);
 		delete run;
 	}
 
@@ -355,6 +383,14 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 			diddleKey((UCHAR*) (record->sr_sort_record.sort_record_key), true, false);
 		}
 
+		// If the top records are kept, the spare record may be reused
+
+		if ((m_flags & scb_top_records) && putTop())
+		{
+			*record_address = (ULONG*) m_last_record->sr_sort_record.sort_record_key;
+			return;
+		}
+
 		// If there isn't room for the record, sort and write the run.
 		// Check that we are not at the beginning of the buffer in addition
 		// to checking for space for the record. This avoids the pointer
@@ -426,6 +462,16 @@ void Sort::sort(thread_db* tdbb)
 			diddleKey((UCHAR*) KEYOF(m_last_record), true, false);
 		}
 
+		// Check the last record against the top ones and drop the spare record
+
+		if ((m_flags & scb_top_records) &&
+			(FB_UINT64) (m_next_pointer - m_first_pointer - 1) > m_max_records)
+		{
+			replaceTop();
+			--m_next_pointer;
+			--m_records;
+		}
+
 		// If there aren't any runs, things fit nicely in memory. Just sort the mess
 		// and we're ready for output.
 		if (!m_runs)
@@ -1225,7 +1271,7 @@ sort_record* Sort::getMerge(merge_control* merge)
 			l = (ULONG) (run->run_end_buffer - run->run_buffer);
 			n = run->run_records * m_longs * sizeof(ULONG);
 			l = MIN(l, n);
-			run->run_seek = readBlock(m_space, run->run_seek, run->run_buffer, l);
+			readRun(run, run->run_buffer, l);
 
 			record = reinterpret_cast<sort_record*>(run->run_buffer);
 			run->run_record =
@@ -1461,7 +1507,9 @@ ULONG Sort::allocate(ULONG n, ULONG chunkSize, bool useFreeSpace)
 	{
 		run->run_buffer = NULL;
 
-		UCHAR* const mem = m_space->inMemory(run->run_seek, run->run_size);
+		// compressed run can't be used in place
+		UCHAR* const mem = run->run_packed ? NULL :
+			m_space->inMemory(run->run_seek, run->run_size);
 
 		if (mem)
 		{
@@ -1557,6 +1605,7 @@ void Sort::mergeRuns(USHORT n)
 	const USHORT buffers = m_size_memory / rec_size;
 	USHORT count;
 	ULONG size = 0;
+	FB_UINT64 records = 0;
 
 	if (n > allocated)
 		size = rec_size * (buffers / (USHORT) (2 * (n - allocated)));
@@ -1590,11 +1639,21 @@ void Sort::mergeRuns(USHORT n)
 			}
 		}
 		temp_run.run_size += run->run_size;
+		records += run->run_records;
 	}
 	temp_run.run_record = reinterpret_cast<sort_record*>(buffer);
 	temp_run.run_buffer = reinterpret_cast<UCHAR*>(temp_run.run_record);
 	temp_run.run_buff_cache = false;
 
+	// Compressed input runs tell nothing about the size of merged data,
+	// reserve space enough to write all the records as incompressible frames
+
+	if (m_compress)
+	{
+		temp_run.run_size = packedSize(records * rec_size,
+			(ULONG) (temp_run.run_end_buffer - temp_run.run_buffer));
+	}
+
 	// Build merge tree bottom up.
 	//
 	// See also kissing cousin of this loop in SORT_sort()
@@ -1639,6 +1698,8 @@ void Sort::mergeRuns(USHORT n)
 	sort_record* q = reinterpret_cast<sort_record*>(temp_run.run_buffer);
 	FB_UINT64 seek = temp_run.run_seek = m_space->allocateSpace(temp_run.run_size);
 	temp_run.run_records = 0;
+	temp_run.run_packed = m_compress &&
+		m_space->inFile(temp_run.run_seek, temp_run.run_size);
 
 	CHECK_FILE(&temp_run);
 
@@ -1648,7 +1709,7 @@ void Sort::mergeRuns(USHORT n)
 		if (q >= (sort_record*) temp_run.run_end_buffer)
 		{
 			size = (UCHAR*) q - temp_run.run_buffer;
-			seek = writeBlock(m_space, seek, temp_run.run_buffer, size);
+			seek = writeRun(&temp_run, seek, temp_run.run_buffer, size);
 			q = reinterpret_cast<sort_record*>(temp_run.run_buffer);
 		}
 		ULONG longs_count = m_longs;
@@ -1661,7 +1722,7 @@ void Sort::mergeRuns(USHORT n)
 	// Write the tail of the new run and return any unused space
 
 	if ( (size = (UCHAR*) q - temp_run.run_buffer) )
-		seek = writeBlock(m_space, seek, temp_run.run_buffer, size);
+		seek = writeRun(&temp_run, seek, temp_run.run_buffer, size);
 
 	// If the records did not fill the allocated run (such as when duplicates are
 	// rejected), then free the remainder and diminish the size of the run accordingly
@@ -1698,6 +1759,7 @@ void Sort::mergeRuns(USHORT n)
 			run->run_buff_alloc = false;
 		}
 		run->run_buffer = NULL;
+		releasePackBuffer(run);
 
 		// Add run descriptor to list of unused run descriptor blocks
 
@@ -1974,10 +2036,15 @@ void Sort::orderAndSave(thread_db* tdbb)
 	}
 
 	const ULONG key_length = (m_longs - SIZEOF_SR_BCKPTR_IN_LONGS) * sizeof(ULONG);
-	run->run_size = run->run_records * key_length;
+	const ULONG size = run->run_records * key_length;
+	run->run_size = m_compress ? packedSize(size, size) : size;
 	run->run_seek = m_space->allocateSpace(run->run_size);
 
-	UCHAR* mem = m_space->inMemory(run->run_seek, run->run_size);
+	// Runs residing in the temporary file (even if it's mapped into memory)
+	// are compressed, otherwise the keys are copied into memory as is
+	const bool packed = m_compress && m_space->inFile(run->run_seek, run->run_size);
+	UCHAR* mem = packed ? NULL : m_space->inMemory(run->run_seek, run->run_size);
+	FB_UINT64 seek = run->run_seek + size;
 
 	if (mem)
 	{
@@ -2000,7 +2067,251 @@ void Sort::orderAndSave(thread_db* tdbb)
 	else
 	{
 		order();
-		writeBlock(m_space, run->run_seek, (UCHAR*) m_last_record, run->run_size);
+		run->run_packed = packed;
+		seek = writeRun(run, run->run_seek, (UCHAR*) m_last_record, size);
+	}
+
+	// Return space reserved for compressed frames but left unused
+
+	if (seek - run->run_seek < run->run_size)
+	{
+		m_space->releaseSpace(seek, run->run_seek + run->run_size - seek);
+		run->run_size = seek - run->run_seek;
+	}
+}
+
+
+FB_UINT64 Sort::packedSize(FB_UINT64 size, ULONG chunk) noexcept
+{
+/**************************************
+ *
+ * Return the worst case length of compressed run of given raw size
+ * which is written by chunks of given size.
+ *
+ **************************************/
+	if (!size)
+		return 0;
+
+	if (!chunk || chunk > size)
+		chunk = (ULONG) MIN(size, MAX_ULONG);
+
+	const FB_UINT64 frames = ((size + chunk - 1) / chunk) *
+		((chunk + PACK_FRAME_SIZE - 1) / PACK_FRAME_SIZE);
+
+	return size + frames * sizeof(pack_frame);
+}
+
+
+void Sort::readRun(run_control* run, UCHAR* address, ULONG length)
+{
+/**************************************
+ *
+ * Read next part of run from the scratch file. Frames of compressed
+ * run are unpacked one by one into the run's own frame buffer.
+ *
+ **************************************/
+	if (!run->run_packed)
+	{
+		run->run_seek = readBlock(m_space, run->run_seek, address, length);
+		return;
+	}
+
+	if (!run->run_pack_buffer)
+		run->run_pack_buffer = FB_NEW_POOL(m_owner->getPool()) UCHAR[PACK_FRAME_SIZE];
+
+	while (length)
+	{
+		if (run->run_pack_offset == run->run_pack_length)
+		{
+			pack_frame frame;
+			run->run_seek = readBlock(m_space, run->run_seek, (UCHAR*) &frame, sizeof(frame));
+			fb_assert(frame.pf_raw && frame.pf_raw <= PACK_FRAME_SIZE);
+			fb_assert(frame.pf_length <= frame.pf_raw);
+
+			if (frame.pf_length == frame.pf_raw)
+			{
+				run->run_seek = readBlock(m_space, run->run_seek,
+					run->run_pack_buffer, frame.pf_length);
+			}
+			else
+			{
+				UCHAR* const packed = m_pack_buffer.getBuffer(frame.pf_length);
+				run->run_seek = readBlock(m_space, run->run_seek, packed, frame.pf_length);
+
+				const UCHAR* const end = Compressor::unpack(frame.pf_length, packed,
+					frame.pf_raw, run->run_pack_buffer);
+
+				if (end != run->run_pack_buffer + frame.pf_raw)
+					BUGCHECK(179);	// msg 179 decompression overran buffer
+			}
+
+			run->run_pack_offset = 0;
+			run->run_pack_length = frame.pf_raw;
+		}
+
+		const ULONG n = MIN(length, run->run_pack_length - run->run_pack_offset);
+		memcpy(address, run->run_pack_buffer + run->run_pack_offset, n);
+		run->run_pack_offset += n;
+		address += n;
+		length -= n;
+	}
+}
+
+
+FB_UINT64 Sort::writeRun(const run_control* run, FB_UINT64 seek, const UCHAR* address, ULONG length)
+{
+/**************************************
+ *
+ * Write a part of run into the scratch file. Compressed run is cut
+ * into frames, each frame is packed by the record compressor and
+ * written together with its header.
+ *
+ **************************************/
+	if (!run->run_packed)
+		return writeBlock(m_space, seek, address, length);
+
+	while (length)
+	{
+		pack_frame frame;
+		frame.pf_raw = MIN(length, PACK_FRAME_SIZE);
+
+		const Compressor dcc(m_owner->getPool(), true, true, frame.pf_raw, address);
+		frame.pf_length = dcc.getPackedLength();
+
+		UCHAR* const buffer = m_pack_buffer.getBuffer(sizeof(frame) + frame.pf_raw);
+
+		if (frame.pf_length < frame.pf_raw)
+			dcc.pack(address, buffer + sizeof(frame));
+		else
+		{
+			frame.pf_length = frame.pf_raw;
+			memcpy(buffer + sizeof(frame), address, frame.pf_raw);
+		}
+
+		memcpy(buffer, &frame, sizeof(frame));
+		seek = writeBlock(m_space, seek, buffer, sizeof(frame) + frame.pf_length);
+
+		address += frame.pf_raw;
+		length -= frame.pf_raw;
+	}
+
+	return seek;
+}
+
+
+void Sort::releasePackBuffer(run_control* run) noexcept
+{
+/**************************************
+ *
+ * Release frame buffer of compressed run.
+ *
+ **************************************/
+	delete[] run->run_pack_buffer;
+	run->run_pack_buffer = NULL;
+	run->run_pack_offset = run->run_pack_length = 0;
+}
+
+
+bool Sort::putTop()
+{
+/**************************************
+ *
+ * Maintain the max-heap of the lowest m_max_records records.
+ * When the heap becomes full, one more record is allocated as
+ * a spare one. Every next record is put into the spare record
+ * and then exchanged with the heap top if it's lower than that.
+ * Return true if the spare record is to be reused.
+ *
+ **************************************/
+	const FB_UINT64 count = m_next_pointer - m_first_pointer - 1;
+
+	if (count < m_max_records)
+		return false;
+
+	if (count == m_max_records)
+	{
+		// Heap is full, build it and allocate the spare record
+
+		for (ULONG i = (ULONG) (m_max_records / 2); i > 0; i--)
+			siftDown(i - 1);
+
+		return false;
+	}
+
+	replaceTop();
+
+	// Now the spare record slot points to either the rejected record or the
+	// former heap top, make it the last record to be filled by the caller
+
+	m_last_record = (SR*) (((SORTP*) m_next_pointer[-1]) - SIZEOF_SR_BCKPTR_IN_LONGS);
+
+	return true;
+}
+
+
+bool Sort::greaterKey(const SORTP* p, const SORTP* q) const noexcept
+{
+/**************************************
+ *
+ * Compare the keys of two diddled records.
+ *
+ **************************************/
+	for (ULONG l = m_key_length; l; l--, p++, q++)
+	{
+		if (*p != *q)
+			return (*p > *q);
+	}
+
+	return false;
+}
+
+
+void Sort::replaceTop() noexcept
+{
+/**************************************
+ *
+ * Exchange the spare record (the last one) with the heap top
+ * if it's lower, then restore the heap order.
+ *
+ **************************************/
+	SORTP** const top = (SORTP**) (m_first_pointer + 1);
+	SORTP** const spare = (SORTP**) (m_next_pointer - 1);
+
+	if (greaterKey(*top, *spare))
+	{
+		swap(top, spare);
+		siftDown(0);
+	}
+}
+
+
+void Sort::siftDown(ULONG i) noexcept
+{
+/**************************************
+ *
+ * Move the heap item down until it's not lower than its children.
+ *
+ **************************************/
+	SORTP** const heap = (SORTP**) (m_first_pointer + 1);
+	const ULONG count = (ULONG) m_max_records;
+
+	while (true)
+	{
+		const ULONG left = 2 * i + 1;
+		const ULONG right = left + 1;
+		ULONG largest = i;
+
+		if (left < count && greaterKey(heap[left], heap[largest]))
+			largest = left;
+
+		if (right < count && greaterKey(heap[right], heap[largest]))
+			largest = right;
+
+		if (largest == i)
+			break;
+
+		swap(heap + i, heap + largest);
+		i = largest;
 	}
 }
 
@@ -242,6 +242,10 @@ struct run_control
 	bool			run_buff_cache;		// run buffer is already in cache
 	FB_UINT64		run_mem_seek;		// position of run's buffer in in-memory part of sort file
 	ULONG			run_mem_size;		// size of run's buffer in in-memory part of sort file
+	bool			run_packed;			// run is written as compressed frames
+	UCHAR*			run_pack_buffer;	// ALLOC: unpacked frame of compressed run
+	ULONG			run_pack_offset;	// offset of next byte in unpacked frame
+	ULONG			run_pack_length;	// length of unpacked frame
 };
 
 // Merge control block
@@ -272,6 +276,7 @@ typedef bool (*FPTR_REJECT_DUP_CALLBACK)(const UCHAR*, const UCHAR*, void*);
 
 inline constexpr int scb_sorted			= 1;	// stream has been sorted
 inline constexpr int scb_reuse_buffer	= 2;	// reuse buffer if possible
+inline constexpr int scb_top_records	= 4;	// keep only m_max_records lowest records
 
 class Sort
 {
@@ -317,15 +322,23 @@ private:
 	void mergeRuns(USHORT);
 	ULONG order();
 	void orderAndSave(Jrd::thread_db*);
+	bool putTop();
 	void putRun(Jrd::thread_db*);
+	void readRun(run_control*, UCHAR*, ULONG);
+	FB_UINT64 writeRun(const run_control*, FB_UINT64, const UCHAR*, ULONG);
 	void sortBuffer(Jrd::thread_db*);
 	void sortRunsBySeek(int);
+	bool greaterKey(const SORTP*, const SORTP*) const noexcept;
+	void replaceTop() noexcept;
+	void siftDown(ULONG) noexcept;
 
 #ifdef DEV_BUILD
 	void checkFile(const run_control*);
 #endif
 
 	static void quick(SLONG, SORTP**, ULONG) noexcept;
+	static FB_UINT64 packedSize(FB_UINT64, ULONG) noexcept;
+	static void releasePackBuffer(run_control*) noexcept;
 
 	Database* m_dbb;							// Database
 	SortOwner* m_owner;							// Sort owner
@@ -339,7 +352,7 @@ private:
 	ULONG m_key_length;							// Key length
 	ULONG m_unique_length;						// Unique key length, used when duplicates eliminated
 	FB_UINT64 m_records;						// Number of records
-	FB_UINT64 m_max_records;					// Maximum number of records to store, assigned but unused.
+	FB_UINT64 m_max_records;					// Maximum number of records to return, zero if unlimited
 	TempSpace* m_space;							// temporary space for scratch file
 	run_control* m_runs;						// ALLOC: Run on scratch file, if any
 	merge_control* m_merge;						// Top level merge block
@@ -351,8 +364,10 @@ private:
 
 	ULONG m_min_alloc_size;						// MIN and MAX values
 	ULONG m_max_alloc_size;						// for the run buffer size
+	bool m_compress;							// compress runs written to scratch file
 
 	Firebird::Array<sort_key_def> m_description;
+	Firebird::Array<UCHAR> m_pack_buffer;		// compressed frame being read or written
 };
 
 
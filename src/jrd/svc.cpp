@@ -2702,6 +2702,14 @@ bool Service::process_switches(ClumpletReader& spb, string& switches)
 				get_action_svc_string(spb, switches);
 				break;
 
+			case isc_spb_nbk_parallel_workers:
+				if (!get_action_svc_parameter(spb.getClumpTag(), nbackup_in_sw_table, switches))
+				{
+					return false;
+				}
+				get_action_svc_data(spb, switches, false);
+				break;
+
 			case isc_spb_nbk_clean_history:
 				if (cleanHistory)
 				{
@@ -0,0 +1,273 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "firebird/Interface.h"
+#include "firebird/Message.h"
+#include "../common/classes/auto.h"
+#include "../common/classes/fb_string.h"
+#include "../common/classes/RefCounted.h"
+#include "../common/classes/TempFile.h"
+#include "../common/utils_proto.h"
+#include <stdio.h>
+
+using namespace Firebird;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(IndexCreateSuite)
+
+
+namespace
+{
+	const int RECORDS = 60000;
+	const int WORKERS = 4;
+
+	// Embedded database with small pages, so the index has a lot of leaf pages
+	// and every worker loads a few of them
+	class TestDatabase
+	{
+	public:
+		TestDatabase()
+			: master(fb_get_master_interface()),
+			  status(master->getStatus()),
+			  provider(master->getDispatcher())
+		{
+			fileName = TempFile::create("fb_index_");
+			remove(fileName.c_str());
+
+			AutoDispose<IXpbBuilder> dpb(getDpb(1));
+			dpb->insertInt(&status, isc_dpb_page_size, 4096);
+
+			IAttachment* const attachment = provider->createDatabase(&status, fileName.c_str(),
+				dpb->getBufferLength(&status), dpb->getBuffer(&status));
+
+			attachment->detach(&status);
+		}
+
+		~TestDatabase()
+		{
+			try
+			{
+				AutoDispose<IXpbBuilder> dpb(getDpb(1));
+
+				IAttachment* const attachment = provider->attachDatabase(&status, fileName.c_str(),
+					dpb->getBufferLength(&status), dpb->getBuffer(&status));
+
+				attachment->dropDatabase(&status);
+			}
+			catch (const FbException&)
+			{
+				remove(fileName.c_str());
+			}
+
+			provider->release();
+			status.dispose();
+		}
+
+		IAttachment* attach(int workers)
+		{
+			AutoDispose<IXpbBuilder> dpb(getDpb(workers));
+
+			return provider->attachDatabase(&status, fileName.c_str(),
+				dpb->getBufferLength(&status), dpb->getBuffer(&status));
+		}
+
+		// Run every statement in its own transaction as DDL is done at commit
+		void execute(IAttachment* attachment, const char* sql)
+		{
+			ITransaction* const transaction = attachment->startTransaction(&status, 0, NULL);
+
+			try
+			{
+				attachment->execute(&status, transaction, 0, sql, SQL_DIALECT_CURRENT,
+					NULL, NULL, NULL, NULL);
+				transaction->commit(&status);
+			}
+			catch (const FbException&)
+			{
+				transaction->rollback(&status);
+				throw;
+			}
+		}
+
+		bool fails(IAttachment* attachment, const char* sql, ISC_STATUS code)
+		{
+			try
+			{
+				execute(attachment, sql);
+			}
+			catch (const FbException& ex)
+			{
+				return fb_utils::containsErrorCode(ex.getStatus()->getErrors(), code);
+			}
+
+			return false;
+		}
+
+		ISC_INT64 count(IAttachment* attachment, const char* sql)
+		{
+			FB_MESSAGE(Output, ThrowStatusWrapper,
+				(FB_BIGINT, value)
+			) output(&status, master);
+
+			RefPtr<ITransaction> transaction(REF_NO_INCR, attachment->startTransaction(&status, 0, NULL));
+
+			attachment->execute(&status, transaction, 0, sql, SQL_DIALECT_CURRENT,
+				NULL, NULL, output.getMetadata(), output.getData());
+
+			return output->value;
+		}
+
+		string validate()
+		{
+			AutoDispose<IXpbBuilder> attachSpb(master->getUtilInterface()->getXpbBuilder(&status,
+				IXpbBuilder::SPB_ATTACH, NULL, 0));
+			attachSpb->insertString(&status, isc_spb_user_name, "SYSDBA");
+
+			RefPtr<IService> service(REF_NO_INCR, provider->attachServiceManager(&status, "service_mgr",
+				attachSpb->getBufferLength(&status), attachSpb->getBuffer(&status)));
+
+			AutoDispose<IXpbBuilder> startSpb(master->getUtilInterface()->getXpbBuilder(&status,
+				IXpbBuilder::SPB_START, NULL, 0));
+			startSpb->insertTag(&status, isc_action_svc_validate);
+			startSpb->insertString(&status, isc_spb_dbname, fileName.c_str());
+
+			service->start(&status, startSpb->getBufferLength(&status), startSpb->getBuffer(&status));
+
+			const UCHAR items[] = {isc_info_svc_line};
+			UCHAR buffer[4096];
+			string output;
+
+			for (bool more = true; more;)
+			{
+				service->query(&status, 0, NULL, sizeof(items), items, sizeof(buffer), buffer);
+
+				more = false;
+				const UCHAR* p = buffer;
+				while (p < buffer + sizeof(buffer) && *p != isc_info_end)
+				{
+					if (*p++ != isc_info_svc_line)
+						continue;
+
+					const USHORT length = p[0] | (p[1] << 8);
+					p += 2;
+					output.append(reinterpret_cast<const char*>(p), length);
+					p += length;
+
+					more = (length > 0);
+				}
+			}
+
+			return output;
+		}
+
+	private:
+		IXpbBuilder* getDpb(int workers)
+		{
+			IXpbBuilder* const dpb = master->getUtilInterface()->getXpbBuilder(&status,
+				IXpbBuilder::DPB, NULL, 0);
+			dpb->insertString(&status, isc_dpb_user_name, "SYSDBA");
+			dpb->insertInt(&status, isc_dpb_parallel_workers, workers);
+
+			return dpb;
+		}
+
+	public:
+		IMaster* const master;
+		ThrowStatusWrapper status;
+
+	private:
+		IProvider* const provider;
+		PathName fileName;
+	};
+}
+
+
+BOOST_AUTO_TEST_CASE(ParallelCreateTest)
+{
+	// Build the same indexes in parallel and by a single worker. Statistics must be
+	// the same and the indexes valid. Few distinct values of the leading segment
+	// make its equal keys span the key ranges loaded by different workers, long
+	// common prefix of the string keys makes separators of the ranges truncated.
+
+	TestDatabase db;
+
+	IAttachment* const parallel = db.attach(WORKERS);
+	IAttachment* const serial = db.attach(1);
+
+	BOOST_WARN_MESSAGE(db.count(parallel,
+			"select cast(rdb$get_context('SYSTEM', 'PARALLEL_WORKERS') as bigint) from rdb$database") > 1,
+		"MaxParallelWorkers is 1, indexes are created sequentially");
+
+	db.execute(parallel, "create table t (id integer not null, a integer, b varchar(60), c integer)");
+
+	string sql;
+	sql.printf(
+		"execute block as\n"
+		"  declare i integer = 0;\n"
+		"begin\n"
+		"  while (i < %d) do\n"
+		"  begin\n"
+		"    insert into t values (:i, mod(:i, 7), 'common prefix of the keys ' || lpad(mod(:i * 7919, 5000), 20, '0'),\n"
+		"      iif(:i = %d, 0, :i));\n"
+		"    i = i + 1;\n"
+		"  end\n"
+		"end", RECORDS, RECORDS - 1);
+
+	db.execute(parallel, sql.c_str());
+
+	const char* const indexes[] =
+	{
+		"create unique index t_id_%s on t (id)",
+		"create index t_ab_%s on t (a, b)",
+		"create descending index t_ba_%s on t (b, a)",
+		"create unique index t_ai_%s on t (a, id)"
+	};
+
+	for (const char* const index : indexes)
+	{
+		sql.printf(index, "par");
+		db.execute(parallel, sql.c_str());
+
+		sql.printf(index, "seq");
+		db.execute(serial, sql.c_str());
+	}
+
+	// Duplicates are the first and the last records
+	BOOST_TEST(db.fails(parallel, "create unique index t_c_par on t (c)", isc_no_dup));
+	BOOST_TEST(db.fails(serial, "create unique index t_c_seq on t (c)", isc_no_dup));
+
+	BOOST_TEST(db.count(parallel,
+		"select count(*) from rdb$indices i1 join rdb$indices i2 on\n"
+		"  i2.rdb$index_name = replace(i1.rdb$index_name, '_PAR', '_SEQ') and\n"
+		"  i2.rdb$statistics = i1.rdb$statistics\n"
+		"  where i1.rdb$relation_name = 'T' and i1.rdb$index_name like '%\\_PAR' escape '\\'") == 4);
+
+	BOOST_TEST(db.count(parallel,
+		"select count(*) from rdb$index_segments s1 join rdb$index_segments s2 on\n"
+		"  s2.rdb$index_name = replace(s1.rdb$index_name, '_PAR', '_SEQ') and\n"
+		"  s2.rdb$field_position = s1.rdb$field_position and\n"
+		"  s2.rdb$statistics = s1.rdb$statistics\n"
+		"  where s1.rdb$index_name starting with 'T_' and s1.rdb$index_name like '%\\_PAR' escape '\\'") == 7);
+
+	BOOST_TEST(db.count(parallel,
+		"select count(*) from t where id >= 0 plan (t index (t_id_par))") == RECORDS);
+	BOOST_TEST(db.count(parallel,
+		"select count(*) from t where a >= 0 plan (t index (t_ab_par))") == RECORDS);
+	BOOST_TEST(db.count(parallel,
+		"select count(*) from t where b > '' plan (t index (t_ba_par))") == RECORDS);
+	BOOST_TEST(db.count(parallel,
+		"select count(*) from t where a = 3 and id >= 0 plan (t index (t_ai_par))") ==
+		db.count(parallel, "select count(*) from t where a + 0 = 3"));
+
+	parallel->detach(&db.status);
+	serial->detach(&db.status);
+
+	const string output = db.validate();
+
+	BOOST_TEST(output.find("Validation finished") != string::npos);
+	BOOST_TEST_INFO(output.c_str());
+	BOOST_TEST(output.find("ERRORS found") == string::npos);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// IndexCreateSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
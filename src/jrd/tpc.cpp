@@ -225,6 +225,39 @@ CommitNumber TipCache::cacheState(TraNumber number)
 	return state;
 }
 
+CommitNumber TipCache::cachedState(thread_db* tdbb, TraNumber number)
+{
+	fb_assert(m_tpcHeader);
+	const GlobalTpcHeader* header = m_tpcHeader->getHeader();
+
+	const TraNumber oldest = header->oldest_transaction.load(std::memory_order_relaxed);
+
+	if (number < oldest)
+		return CN_PREHISTORIC;
+
+	Attachment* const attachment = tdbb->getAttachment();
+	TipStateCache* stateCache = attachment ? attachment->att_tip_state_cache : nullptr;
+
+	CommitNumber stateCn;
+	if (stateCache && stateCache->get(number, stateCn))
+		return stateCn;
+
+	stateCn = cacheState(number);
+
+	if (attachment && (stateCn == CN_DEAD || (stateCn > CN_PREHISTORIC && stateCn <= CN_MAX_NUMBER)))
+	{
+		if (!stateCache)
+		{
+			stateCache = attachment->att_tip_state_cache =
+				FB_NEW_POOL(*attachment->att_pool) TipStateCache;
+		}
+
+		stateCache->put(number, stateCn);
+	}
+
+	return stateCn;
+}
+
 void TipCache::initializeTpc(thread_db *tdbb)
 {
 	Database* dbb = tdbb->getDatabase();
@@ -672,7 +705,7 @@ CommitNumber TipCache::snapshotState(thread_db* tdbb, TraNumber number)
 	fb_assert(m_tpcHeader);
 
 	// Get data from cache
-	CommitNumber stateCn = cacheState(number);
+	CommitNumber stateCn = cachedState(tdbb, number);
 
 	// Transaction is committed or dead?
 	if (stateCn == CN_DEAD || (stateCn >= CN_PREHISTORIC && stateCn <= CN_MAX_NUMBER))
@@ -1146,6 +1179,48 @@ void TipCache::updateActiveSnapshots(thread_db* tdbb, ActiveSnapshots* activeSna
 	}
 }
 
+bool TipCache::hasOtherSnapshots(thread_db* tdbb, AttNumber attachmentId, SnapshotHandle ownHandle)
+{
+	// Can only be called on initialized TipCache
+	fb_assert(m_tpcHeader);
+
+	// Remap snapshot list if it has been grown by someone else
+	remapSnapshots(true);
+
+	const SnapshotList* snapshots = m_snapshots->getHeader();
+	const ULONG slots_used = snapshots->slots_used.load(std::memory_order_acquire);
+
+	for (SnapshotHandle slotNumber = 0; slotNumber < slots_used; slotNumber++)
+	{
+		if (slotNumber == ownHandle)
+			continue;
+
+		const AttNumber slot_attachment_id =
+			snapshots->slots[slotNumber].attachment_id.load(std::memory_order_acquire);
+
+		if (!slot_attachment_id)
+			continue;
+
+		if (slot_attachment_id != attachmentId)
+		{
+			// Slots of dead attachments are not released yet, see updateActiveSnapshots()
+			ThreadStatusGuard temp_status(tdbb);
+			Lock temp_lock(tdbb, sizeof(AttNumber), LCK_attachment);
+			temp_lock.setKey(slot_attachment_id);
+
+			if (LCK_lock(tdbb, &temp_lock, LCK_EX, LCK_NO_WAIT))
+			{
+				LCK_release(tdbb, &temp_lock);
+				continue;
+			}
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
 TraNumber TipCache::generateTransactionId()
 {
 	// Can only be called on initialized TipCache
@@ -51,6 +51,63 @@ inline constexpr CommitNumber
 	CN_DEAD = static_cast<CommitNumber>(-2),
 	CN_MAX_NUMBER = static_cast<CommitNumber>(-3); // Assume CommitNumber is unsigned integer
 
+// Per-attachment direct mapped cache of final (committed or dead) transaction states.
+// Final states never change, so entries don't need any synchronization with other
+// attachments. The cache is owned by its attachment and is not shared between threads,
+// thus lookups are just a couple of plain loads. Entries for transactions older than
+// the Oldest marker are never returned, as TPC itself reports them as prehistoric.
+
+class TipStateCache
+{
+	static constexpr ULONG CACHE_SIZE = 1024;	// must be power of 2
+
+public:
+	bool get(TraNumber number, CommitNumber& stateCn)
+	{
+		const Entry& entry = m_entries[number & (CACHE_SIZE - 1)];
+
+		if (entry.number == number && entry.stateCn != CN_ACTIVE)
+		{
+			stateCn = entry.stateCn;
+			m_hits++;
+			return true;
+		}
+
+		m_misses++;
+		return false;
+	}
+
+	void put(TraNumber number, CommitNumber stateCn)
+	{
+		fb_assert(stateCn == CN_DEAD || (stateCn > CN_PREHISTORIC && stateCn <= CN_MAX_NUMBER));
+
+		Entry& entry = m_entries[number & (CACHE_SIZE - 1)];
+		entry.number = number;
+		entry.stateCn = stateCn;
+	}
+
+	FB_UINT64 getHits() const
+	{
+		return m_hits;
+	}
+
+	FB_UINT64 getMisses() const
+	{
+		return m_misses;
+	}
+
+private:
+	struct Entry
+	{
+		TraNumber number = 0;
+		CommitNumber stateCn = CN_ACTIVE;
+	};
+
+	Entry m_entries[CACHE_SIZE];
+	FB_UINT64 m_hits = 0;
+	FB_UINT64 m_misses = 0;
+};
+
 class TipCache
 {
 public:
@@ -72,6 +129,9 @@ public:
 	// Get the current state of a transaction in the cache
 	CommitNumber cacheState(TraNumber number);
 
+	// The same as above but look into the attachment's cache of final states first
+	CommitNumber cachedState(thread_db* tdbb, TraNumber number);
+
 	// Return the oldest transaction in the given state.
 	// Lookup in the [min_number, max_number) bounds.
 	// If not found, return zero.
@@ -136,6 +196,11 @@ public:
 	// there is no contention.
 	void updateActiveSnapshots(thread_db* tdbb, ActiveSnapshots* activeSnapshots);
 
+	// Check if there are snapshots other than ownHandle (pass MAX_ULONG if the caller
+	// has no snapshot). Slots of dead attachments are ignored. Note that new snapshots
+	// may be taken right after the check.
+	bool hasOtherSnapshots(thread_db* tdbb, AttNumber attachmentId, SnapshotHandle ownHandle);
+
 	// Transactions, attachments, statements ID management.
 	TraNumber generateTransactionId();
 	AttNumber generateAttachmentId();
@@ -166,7 +231,7 @@ public:
 		if (!tipCache)
 			return tra_unknown;
 
-		CommitNumber stateCn = tipCache->cacheState(number);
+		CommitNumber stateCn = tipCache->cachedState(tdbb, number);
 
 		switch (stateCn)
 		{
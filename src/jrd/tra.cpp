@@ -4238,20 +4238,24 @@ BulkInsert* jrd_tra::getBulkInsert(thread_db* tdbb, jrd_rel* relation, bool crea
 	}
 	else if (create)
 	{
-		tra_bulkInsert = FB_NEW_POOL(*tra_pool) BulkInsert(*tra_pool, tdbb, relation);
+		tra_bulkInsert = FB_NEW_POOL(*tra_pool) BulkInsert(*tra_pool, tdbb, this, relation);
 	}
 
 	return tra_bulkInsert;
 }
 
-void jrd_tra::finiBulkInsert(thread_db* tdbb, bool /*commit*/)
+void jrd_tra::finiBulkInsert(thread_db* tdbb, bool commit)
 {
 	if (tra_bulkInsert)
 	{
-		// Currently, there is no way to explicitly undo bulk insert actions, while it
-		// might be implemented later if needed. Thus "commit" arg is not used for now.
+		// Currently, there is no way to explicitly undo bulk insert actions. Stored
+		// records are left unindexed, thus the transaction must not be committed
+		// and its rollback must not be turned into commit after undo.
 
-		tra_bulkInsert->flush(tdbb);
+		if (!commit && tra_bulkInsert->hasRecords())
+			tra_flags |= TRA_invalidated;
+
+		tra_bulkInsert->flush(tdbb, commit);
 
 		delete tra_bulkInsert;
 		tra_bulkInsert = nullptr;
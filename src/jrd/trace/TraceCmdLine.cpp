@@ -109,11 +109,15 @@ namespace
 
 		// If the items aren't contiguous, a scheme like in nbackup.cpp will have to be used.
 		// ASF: This is message codes!
-		const MessageSet MAIN_USAGE{{3, 21}, {41}};
-		const MessageSet EXAMPLES{{22, 27}, {42}};
+		const MessageSet ACTIONS{{3, 11}, {43}};
+		const MessageSet PARAMETERS{{12, 15}, {41, 44, 45}};
+		const MessageSet CONNECTION{{16, 21}, {}};
+		const MessageSet EXAMPLES{{22, 27}, {42, 46}};
 		constexpr int NOTES[] = {28, 29};
 
-		MAIN_USAGE.print();
+		ACTIONS.print();
+		PARAMETERS.print();
+		CONNECTION.print();
 
 		printf("\n");
 		EXAMPLES.print();
@@ -188,6 +192,8 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 	const Switches optSwitches(trace_option_in_sw_table, FB_NELEM(trace_option_in_sw_table),
 								false, true);
 	TraceSession session(*getDefaultMemoryPool());
+	PathName input;
+	bool json = false;
 	for (int itr = 1; itr < argc; ++itr)
 	{
 		if (!argv[itr])
@@ -208,6 +214,7 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 				case IN_SW_TRACE_SUSPEND:
 				case IN_SW_TRACE_RESUME:
 				case IN_SW_TRACE_LIST:
+				case IN_SW_TRACE_DECODE:
 					usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
 					break;
 			}
@@ -229,6 +236,7 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 				case IN_SW_TRACE_SUSPEND:
 				case IN_SW_TRACE_RESUME:
 				case IN_SW_TRACE_LIST:
+				case IN_SW_TRACE_DECODE:
 					usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
 					break;
 			}
@@ -248,6 +256,7 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 			{
 				case IN_SW_TRACE_START:
 				case IN_SW_TRACE_LIST:
+				case IN_SW_TRACE_DECODE:
 					usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
 					break;
 			}
@@ -273,6 +282,7 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 				case IN_SW_TRACE_SUSPEND:
 				case IN_SW_TRACE_RESUME:
 				case IN_SW_TRACE_LIST:
+				case IN_SW_TRACE_DECODE:
 					usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
 					break;
 			}
@@ -287,6 +297,30 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 				usage(uSvc, isc_trace_param_val_miss, sw->in_sw_name);
 			break;
 
+		case IN_SW_TRACE_INPUT:
+			if (action_sw->in_sw != IN_SW_TRACE_DECODE)
+				usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
+
+			if (input.hasData())
+				usage(uSvc, isc_trace_switch_once, sw->in_sw_name);
+
+			itr++;
+			if (itr < argc && argv[itr])
+				input = argv[itr];
+			else
+				usage(uSvc, isc_trace_param_val_miss, sw->in_sw_name);
+			break;
+
+		case IN_SW_TRACE_JSON:
+			if (action_sw->in_sw != IN_SW_TRACE_DECODE)
+				usage(uSvc, isc_trace_param_act_notcompat, sw->in_sw_name, action_sw->in_sw_name);
+
+			if (json)
+				usage(uSvc, isc_trace_switch_once, sw->in_sw_name);
+
+			json = true;
+			break;
+
 		default:
 			fb_assert(false);
 		}
@@ -406,6 +440,19 @@ void fbtrace(UtilSvc* uSvc, TraceSvcIntf* traceSvc)
 		}
 	}
 
+	// binary log is decoded locally, no service is needed
+	if (action_sw->in_sw == IN_SW_TRACE_DECODE)
+	{
+		if (uSvc->isService())
+			usage(uSvc, isc_trace_switch_user_only, action_sw->in_sw_name);
+
+		if (input.isEmpty())
+			usage(uSvc, isc_trace_switch_param_miss, "INPUT", action_sw->in_sw_name);
+
+		traceSvc->decodeLog(input, json);
+		return;
+	}
+
 	// validate missed action's parameters and perform action
 	if (!uSvc->isService() && svc_name.isEmpty()) {
 		usage(uSvc, isc_trace_mandatory_switch_miss, "SERVICE");
@@ -679,6 +679,7 @@ TraceRuntimeStats::TraceRuntimeStats(Attachment* attachment,
 		};
 
 		m_tableCounters.reset(&baseline->getTableCounters(), getTableName);
+		m_waitCounters.reset(baseline);
 
 		m_legacyCounts.resize(m_tableCounters.getObjectCount());
 		m_info.pin_tables = m_legacyCounts.begin();
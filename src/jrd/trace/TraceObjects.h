@@ -152,6 +152,56 @@ class TraceRuntimeStats :
 	typedef GenericCounters<RuntimeStatistics::PageCounters> PageCounters;
 	typedef GenericCounters<RuntimeStatistics::TableCounters> TableCounters;
 
+	// Wait counters are not grouped, so they're reported as the single unnamed object
+
+	class WaitCounters :
+		public Firebird::AutoIface<Firebird::IPerformanceCountersImpl<WaitCounters, Firebird::CheckStatusWrapper> >
+	{
+	public:
+		static constexpr unsigned COUNT = static_cast<unsigned>(WaitStatType::TOTAL_ITEMS);
+
+		void reset(const RuntimeStatistics* stats)
+		{
+			m_valid = false;
+
+			for (unsigned i = 0; i < COUNT; i++)
+			{
+				if ( (m_counters[i] = stats ? (*stats)[static_cast<WaitStatType>(i)] : 0) )
+					m_valid = true;
+			}
+		}
+
+		// PerformanceCounts implementation
+		unsigned getObjectCount()
+		{
+			return m_valid ? 1 : 0;
+		}
+
+		unsigned getMaxCounterIndex()
+		{
+			return COUNT - 1;
+		}
+
+		unsigned getObjectId(unsigned index)
+		{
+			return 0;
+		}
+
+		const char* getObjectName(unsigned index)
+		{
+			return (m_valid && index == 0) ? "" : nullptr;
+		}
+
+		const SINT64* getObjectCounters(unsigned index)
+		{
+			return (m_valid && index == 0) ? m_counters : nullptr;
+		}
+
+	private:
+		SINT64 m_counters[COUNT] = {};
+		bool m_valid = false;
+	};
+
 public:
 	TraceRuntimeStats(Attachment* att, RuntimeStatistics* baseline, RuntimeStatistics* stats,
 		SINT64 clock, SINT64 recordsFetched);
@@ -181,6 +231,10 @@ public:
 				counters = &m_tableCounters;
 				break;
 
+			case IPerformanceStats::COUNTER_GROUP_WAITS:
+				counters = &m_waitCounters;
+				break;
+
 			default:
 				fb_assert(false);
 		}
@@ -197,6 +251,7 @@ private:
 	Firebird::PerformanceInfo m_info;
 	PageCounters m_pageCounters;
 	TableCounters m_tableCounters;
+	WaitCounters m_waitCounters;
 	SINT64 m_globalCounters[GLOBAL_COUNTERS];
 	Firebird::HalfStaticArray<Firebird::TraceCounts, 16> m_legacyCounts;
 };
@@ -65,6 +65,7 @@ public:
 	virtual void stopSession(ULONG id);
 	virtual void setActive(ULONG id, bool active);
 	virtual void listSessions();
+	virtual void decodeLog(const PathName& fileName, bool json);
 
 private:
 	void readSession(const TraceSession& session);
@@ -278,6 +279,12 @@ void TraceSvcJrd::listSessions()
 	}
 }
 
+void TraceSvcJrd::decodeLog(const PathName& /*fileName*/, bool /*json*/)
+{
+	// Binary logs are decoded by fbtracemgr locally, the switch is rejected for services
+	fb_assert(false);
+}
+
 void TraceSvcJrd::readSession(const TraceSession& session)
 {
 	if (session.ses_logfile.empty())
@@ -42,6 +42,9 @@ inline constexpr int IN_SW_TRACE_TRUSTED_AUTH	= 13;
 inline constexpr int IN_SW_TRACE_VERSION		= 14;
 inline constexpr int IN_SW_TRACE_ROLE			= 15;
 inline constexpr int IN_SW_TRACE_PLUGINS		= 16;
+inline constexpr int IN_SW_TRACE_DECODE			= 17;
+inline constexpr int IN_SW_TRACE_INPUT			= 18;
+inline constexpr int IN_SW_TRACE_JSON			= 19;
 
 
 // list of possible actions (services) for use with trace services
@@ -53,6 +56,7 @@ static inline constexpr struct Switches::in_sw_tab_t trace_action_in_sw_table []
 	{IN_SW_TRACE_START,		isc_action_svc_trace_start,		"START",	0, 0, 0, false,	false,	0,	3, NULL},
 	{IN_SW_TRACE_SUSPEND,	isc_action_svc_trace_suspend,	"SUSPEND",	0, 0, 0, false,	false,	0,	2, NULL},
 	{IN_SW_TRACE_VERSION,	0,								"Z",		0, 0, 0, false,	false, 0,	1, NULL},
+	{IN_SW_TRACE_DECODE,	0,								"DECODE",	0, 0, 0, false,	false,	0,	1, NULL},
 	{0,						0,								NULL,		0, 0, 0, false,	false, 0,	0, NULL}	// End of List
 };
 
@@ -64,6 +68,8 @@ static inline constexpr struct Switches::in_sw_tab_t trace_option_in_sw_table []
 	{IN_SW_TRACE_ID,		isc_spb_trc_id,		"ID",		0, 0, 0, false,	false,	0,	1, NULL},
 	{IN_SW_TRACE_NAME,		isc_spb_trc_name,	"NAME", 	0, 0, 0, false,	false,	0,	1, NULL},
 	{IN_SW_TRACE_PLUGINS,	isc_spb_trc_plugins,"PLUGINS", 	0, 0, 0, false,	false,	0,	2, NULL},
+	{IN_SW_TRACE_INPUT,		0,					"INPUT",	0, 0, 0, false,	false,	0,	3, NULL},
+	{IN_SW_TRACE_JSON,		0,					"JSON",		0, 0, 0, false,	false,	0,	1, NULL},
 	{0,						0,					NULL,		0, 0, 0, false,	false, 0,	0, NULL}	// End of List
 };
 
@@ -95,6 +95,7 @@
 #include "../common/Task.h"
 #include "../jrd/WorkerAttachment.h"
 #include "../jrd/Package.h"
+#include "../jrd/BackVersionCache.h"
 
 using namespace Jrd;
 using namespace Firebird;
@@ -157,6 +158,7 @@ inline constexpr int LS_ACTIVE_RPB	= 0x01;
 inline constexpr int LS_NO_RESTART	= 0x02;
 
 static void list_staying(thread_db*, record_param*, RecordStack&, int flags = 0);
+static bool long_delta_chain(thread_db*, const jrd_tra*, const record_param*);
 static void list_staying_fast(thread_db*, record_param*, RecordStack&, record_param* = NULL, int flags = 0);
 static void notify_garbage_collector(thread_db* tdbb, record_param* rpb,
 	TraNumber tranid = MAX_TRA_NUMBER);
@@ -1826,6 +1828,26 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 	// Primary record version not uses prior version
 	Record* prior = (rpb->rpb_flags & rpb_chained) ? rpb->rpb_prior : nullptr;
 
+	// Delta versions already rebuilt by this attachment are taken from the cache
+
+	Attachment* const attachment = tdbb->getAttachment();
+	BackVersionCache* cache = attachment ? attachment->att_back_version_cache : nullptr;
+
+	if (prior && cache && cache->get(rpb, relation->getId(), record))
+	{
+		rpb->rpb_prior = (rpb->rpb_b_page && (rpb->rpb_flags & rpb_delta)) ? record : NULL;
+
+		CCH_RELEASE(tdbb, &rpb->getWindow(tdbb));
+
+		rpb->rpb_address = record->getData();
+		rpb->rpb_length = format->fmt_length;
+		return;
+	}
+
+	// Remember the version location, fragments fetch below overwrites it
+	const ULONG version_page = rpb->rpb_page;
+	const USHORT version_line = rpb->rpb_line;
+
 	if (prior)
 	{
 		tail = difference.getData();
@@ -1904,6 +1926,19 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 
 	rpb->rpb_address = record->getData();
 	rpb->rpb_length = format->fmt_length;
+
+	// Data of committed versions never changes, so it's safe to reuse it later
+
+	if (prior && attachment && TipCache::cacheState(tdbb, rpb->rpb_transaction_nr) == tra_committed)
+	{
+		if (!cache)
+		{
+			cache = attachment->att_back_version_cache =
+				FB_NEW_POOL(*attachment->att_pool) BackVersionCache(*attachment->att_pool);
+		}
+
+		cache->put(rpb, version_page, version_line, relation->getId(), record);
+	}
 }
 
 
@@ -6481,6 +6516,63 @@ static void list_staying(thread_db* tdbb, record_param* rpb, RecordStack& stayin
 }
 
 
+static bool long_delta_chain(thread_db* tdbb, const jrd_tra* transaction, const record_param* rpb)
+{
+/**************************************
+ *
+ *	l o n g _ d e l t a _ c h a i n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether the version going to be stored as differences
+ *	record continues a long run of delta back versions. Readers
+ *	rebuild such versions applying every delta of the run, so a
+ *	full version is stored as a checkpoint every MAX_DELTA_CHAIN
+ *	versions to bound the cost of chasing old versions.
+ *
+ *	No snapshot reads below the first version committed before
+ *	the oldest snapshot, deeper versions are garbage. So there is
+ *	nothing to walk if the version itself is seen by every snapshot,
+ *	and the walk never goes below that version. Only record headers
+ *	are fetched while walking the chain.
+ *
+ **************************************/
+	const unsigned MAX_DELTA_CHAIN = 16;
+
+	if (!(rpb->rpb_flags & rpb_delta))
+		return false;
+
+	const TraNumber oldest_snapshot = rpb->rpb_relation->isTemporary() ?
+		tdbb->getAttachment()->att_oldest_snapshot : transaction->tra_oldest_active;
+
+	if (rpb->rpb_transaction_nr < oldest_snapshot)
+		return false;
+
+	record_param temp = *rpb;
+	unsigned count = 1;
+
+	while ((temp.rpb_flags & rpb_delta) && temp.rpb_b_page)
+	{
+		if (++count >= MAX_DELTA_CHAIN)
+			return true;
+
+		temp.rpb_page = temp.rpb_b_page;
+		temp.rpb_line = temp.rpb_b_line;
+
+		if (!DPM_fetch(tdbb, &temp, LCK_read))
+			return false;
+
+		CCH_RELEASE(tdbb, &temp.getWindow(tdbb));
+
+		if (temp.rpb_transaction_nr < oldest_snapshot)
+			break;
+	}
+
+	return false;
+}
+
+
 static void notify_garbage_collector(thread_db* tdbb, record_param* rpb, TraNumber tranid)
 {
 /**************************************
@@ -6639,7 +6731,7 @@ static PrepareResult prepare_update(thread_db* tdbb, jrd_tra* transaction, TraNu
 				new_rpb->rpb_flags |= rpb_delta;
 			}
 		}
-		else
+		else if (!long_delta_chain(tdbb, transaction, temp))
 		{
 			const ULONG diffLength =
 				difference.make(new_rpb->rpb_length, new_rpb->rpb_address,
@@ -48,6 +48,7 @@
 #include "../common/isc_proto.h"
 #include "../common/os/isc_i_proto.h"
 #include "../common/isc_s_proto.h"
+#include "../common/utils_proto.h"
 #include "../common/config/config.h"
 #include "../common/classes/array.h"
 #include "../common/classes/Hash.h"
@@ -161,6 +162,12 @@ static constexpr bool compatibility[LCK_max][LCK_max] =
 /* EX */	{true,	true,	false,	false,	false,	false,	false}
 };
 
+static void accountWait(const Jrd::LockManager::Callbacks& callbacks, SINT64 start)
+{
+	const SINT64 ticks = fb_utils::query_performance_counter() - start;
+	callbacks.accountWait(fb_utils::ticks_to_microseconds(ticks));
+}
+
 
 namespace Jrd {
 
@@ -2242,7 +2249,9 @@ bool LockManager::grant_or_que(const Callbacks& callbacks, lrq* request, lbl* lo
 	{
 		const SRQ_PTR request_offset = SRQ_REL_PTR(request);
 
+		const SINT64 waitStart = fb_utils::query_performance_counter();
 		wait_for_request(callbacks, request, lck_wait);
+		accountWait(callbacks, waitStart);
 
 		request = (lrq*) SRQ_ABS_PTR(request_offset);
 
@@ -2556,7 +2565,9 @@ bool LockManager::internal_convert(const Callbacks& callbacks,
 		else
 			new_ast = false;
 
+		const SINT64 waitStart = fb_utils::query_performance_counter();
 		wait_for_request(callbacks, request, lck_wait);
+		accountWait(callbacks, waitStart);
 
 		request = (lrq*) SRQ_ABS_PTR(request_offset);
 		lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
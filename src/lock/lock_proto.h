@@ -301,6 +301,9 @@ public:
 		virtual ISC_STATUS getCancelState() const = 0;
 		virtual ULONG adjustWait(ULONG wait) const = 0;
 		virtual void checkoutRun(std::function<void()> func) const = 0;
+
+		// Called after the request had to wait, the wait time is in microseconds
+		virtual void accountWait(SINT64 /*time*/) const {}
 	};
 
 private:
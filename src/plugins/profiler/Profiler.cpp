@@ -175,7 +175,7 @@ public:
 
 	unsigned getFlags() override
 	{
-		return FLAG_AFTER_EVENTS;
+		return FLAG_AFTER_EVENTS | (sampling ? FLAG_SAMPLING : 0);
 	}
 
 	void cancel(ThrowStatusExceptionWrapper* status) override;
@@ -242,6 +242,7 @@ public:
 	std::optional<ISC_TIMESTAMP_TZ> finishTimestamp;
 	string description{defaultPool()};
 	bool detailedRequests = false;
+	bool sampling = false;
 	bool dirty = true;
 };
 
@@ -394,14 +395,27 @@ IProfilerSession* ProfilerPlugin::startSession(ThrowStatusExceptionWrapper* stat
 	if (options && options[0])
 	{
 		string optionsStr = options;
-		optionsStr.alltrim();
+		optionsStr.upper();
 
-		if (optionsStr.hasData())
+		// Options are separated by spaces or commas
+
+		for (FB_SIZE_T pos = 0; pos < optionsStr.length();)
 		{
-			optionsStr.upper();
+			const auto start = optionsStr.find_first_not_of(" \t,", pos);
+			if (start == string::npos)
+				break;
+
+			auto end = optionsStr.find_first_of(" \t,", start);
+			if (end == string::npos)
+				end = optionsStr.length();
+
+			const string option = optionsStr.substr(start, end - start);
+			pos = end;
 
-			if (optionsStr == "DETAILED_REQUESTS")
+			if (option == "DETAILED_REQUESTS")
 				session->detailedRequests = true;
+			else if (option == "SAMPLING")
+				session->sampling = true;
 			else
 			{
 				static const ISC_STATUS statusVector[] = {
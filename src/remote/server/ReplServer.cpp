@@ -23,6 +23,7 @@
 #include "firebird.h"
 #include "firebird/Message.h"
 #include "../common/common.h"
+#include "../common/dsc.h"
 #include "../jrd/constants.h"
 #include "ibase.h"
 #include "../jrd/license.h"
@@ -32,6 +33,10 @@
 #include "../common/os/path_utils.h"
 #include "../common/isc_proto.h"
 #include "../common/classes/ClumpletWriter.h"
+#include "../common/classes/condition.h"
+#include "../common/classes/GenericMap.h"
+#include "../common/classes/locks.h"
+#include "../common/classes/objects_array.h"
 #include "../common/ThreadStart.h"
 #include "../common/utils_proto.h"
 #include "../common/classes/ParsedList.h"
@@ -39,6 +44,7 @@
 
 #include "../jrd/replication/ChangeLog.h"
 #include "../jrd/replication/Config.h"
+#include "../jrd/replication/LogStream.h"
 #include "../jrd/replication/Protocol.h"
 #include "../jrd/replication/Utils.h"
 
@@ -224,6 +230,11 @@ namespace
 #endif
 		}
 
+		static bool exists(const PathName& directory, const Guid& guid)
+		{
+			return PathUtils::canAccess(directory + guid.toPathName(), 0);
+		}
+
 		FB_UINT64 getSequence() const noexcept
 		{
 			return m_data.sequence;
@@ -336,6 +347,1055 @@ namespace
 #endif
 	};
 
+	// Write set of the replicated transaction. Changed records are identified by their
+	// table and the values of the unique keys, records referenced by the foreign keys
+	// are identified by the values of the referenced keys. Objects (tables and sequences)
+	// whose records can't be identified are tracked as a whole.
+
+	class WriteSet
+	{
+		// Huge transactions are tracked by the changed tables only
+		static constexpr FB_SIZE_T MAX_KEYS = 65536;
+
+	public:
+		explicit WriteSet(MemoryPool& pool)
+			: m_keys(pool), m_objects(pool), m_keyObjects(pool)
+		{}
+
+		void addObject(const string& object)
+		{
+			add(m_objects, object);
+		}
+
+		// The key value starts with the object name followed by the zero byte
+		void addKey(const string& key)
+		{
+			const string object(key.c_str());
+
+			if (m_objects.exist(object))
+				return;
+
+			if (m_keys.getCount() >= MAX_KEYS)
+			{
+				for (const auto& name : m_keyObjects)
+					add(m_objects, name);
+
+				m_keys.clear();
+				m_keyObjects.clear();
+
+				add(m_objects, object);
+				return;
+			}
+
+			add(m_keys, key);
+			add(m_keyObjects, object);
+		}
+
+		bool conflicts(const WriteSet& other) const
+		{
+			for (const auto& key : other.m_keys)
+			{
+				if (m_keys.exist(key))
+					return true;
+			}
+
+			for (const auto& object : other.m_objects)
+			{
+				if (m_objects.exist(object) || m_keyObjects.exist(object))
+					return true;
+			}
+
+			for (const auto& object : m_objects)
+			{
+				if (other.m_keyObjects.exist(object))
+					return true;
+			}
+
+			return false;
+		}
+
+		void merge(const WriteSet& other)
+		{
+			for (const auto& object : other.m_objects)
+				addObject(object);
+
+			for (const auto& key : other.m_keys)
+				addKey(key);
+		}
+
+	private:
+		typedef SortedObjectsArray<string> NameList;
+
+		static void add(NameList& list, const string& name)
+		{
+			if (!list.exist(name))
+				list.add(name);
+		}
+
+		NameList m_keys;		// values of the keys
+		NameList m_objects;		// objects changed as a whole
+		NameList m_keyObjects;	// objects the keys belong to
+	};
+
+	// Unique keys of the replicated tables and their foreign keys, as defined in the
+	// replica. They're used to identify the records changed by the replicated blocks.
+
+	class KeyMetadata
+	{
+		struct Format
+		{
+			explicit Format(MemoryPool& pool)
+				: descs(pool)
+			{}
+
+			ULONG length = 0;
+			Array<Ods::Descriptor> descs;
+		};
+
+		struct Key
+		{
+			explicit Key(MemoryPool& pool)
+				: object(pool), prefix(pool), fields(pool)
+			{}
+
+			string object;			// table the key belongs to
+			string prefix;			// start of the key values: table and index names
+			Array<USHORT> fields;	// field ids of the segments
+		};
+
+		struct Table
+		{
+			explicit Table(MemoryPool& pool)
+				: object(pool), formats(pool), keys(pool)
+			{}
+
+			string object;			// qualified table name
+			bool known = false;		// metadata is read successfully
+			bool unique = false;	// records have a unique key
+			ObjectsArray<Format> formats;	// newer first
+			ObjectsArray<Key> keys;
+		};
+
+		enum KeyState { KEY_VALUE, KEY_NULL, KEY_UNKNOWN };
+
+	public:
+		explicit KeyMetadata(MemoryPool& pool)
+			: m_pool(pool), m_tables(pool)
+		{}
+
+		~KeyMetadata()
+		{
+			clear();
+		}
+
+		void setAttachment(IAttachment* attachment)
+		{
+			m_attachment = attachment;
+		}
+
+		void clear()
+		{
+			LeftPooledMap<string, Table*>::Accessor accessor(&m_tables);
+
+			for (bool found = accessor.getFirst(); found; found = accessor.getNext())
+				delete accessor.current()->second;
+
+			m_tables.clear();
+		}
+
+		// Add the keys of the record to the write set, return false if the table is not known
+		bool addRecord(WriteSet& writes, const string& schema, const string& name,
+					   ULONG length, const UCHAR* record)
+		{
+			const auto table = getTable(schema, name);
+
+			if (!table->known)
+				return false;
+
+			// Formats are matched by the record length, as Applier::findFormat() does
+
+			const Format* format = nullptr;
+
+			for (const auto& item : table->formats)
+			{
+				if (item.length == length)
+				{
+					format = &item;
+					break;
+				}
+			}
+
+			if (!format)
+				return false;
+
+			if (!table->unique)
+				writes.addObject(table->object);
+
+			for (const auto& key : table->keys)
+			{
+				string value(key.prefix);
+
+				switch (getKey(value, key, *format, length, record))
+				{
+				case KEY_VALUE:
+					writes.addKey(value);
+					break;
+
+				case KEY_UNKNOWN:
+					writes.addObject(key.object);
+					break;
+
+				case KEY_NULL:
+					// NULLs are never equal in the unique keys and don't reference anything
+					break;
+				}
+			}
+
+			return true;
+		}
+
+	private:
+		Table* getTable(const string& schema, const string& name)
+		{
+			string id(schema);
+			id.append("", 1);
+			id += name;
+
+			Table* table = nullptr;
+
+			if (!m_tables.get(id, table))
+			{
+				table = FB_NEW_POOL(m_pool) Table(m_pool);
+				m_tables.put(id, table);
+
+				try
+				{
+					load(table, schema, name);
+				}
+				catch (const Exception&)
+				{
+					// Changes of the table will be waited for by all the transactions
+					table->known = false;
+				}
+			}
+
+			return table;
+		}
+
+		void load(Table* table, const string& schema, const string& name)
+		{
+			if (!m_attachment)
+				return;
+
+			FbLocalStatus localStatus;
+
+			RefPtr<ITransaction> transaction(REF_NO_INCR,
+				m_attachment->startTransaction(&localStatus, 0, NULL));
+			localStatus.check();
+
+			FB_MESSAGE(Input, CheckStatusWrapper,
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), schema)
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), name)
+			) input(&localStatus, fb_get_master_interface());
+
+			input.clear();
+			input->name.set(name.c_str(), name.length());
+
+			if (schema.hasData())
+				input->schema.set(schema.c_str(), schema.length());
+			else
+			{
+				// The primary has no schemas, the table name must be unique in the replica
+
+				const char* sql =
+					"select rdb$schema_name from system.rdb$relations where rdb$relation_name = ?";
+
+				FB_MESSAGE(NameInput, CheckStatusWrapper,
+					(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), name)
+				) nameInput(&localStatus, fb_get_master_interface());
+
+				nameInput.clear();
+				nameInput->name = input->name;
+
+				FB_MESSAGE(Result, CheckStatusWrapper,
+					(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), schema)
+				) result(&localStatus, fb_get_master_interface());
+
+				RefPtr<IResultSet> cursor(REF_NO_INCR,
+					m_attachment->openCursor(&localStatus, transaction, 0, sql, SQL_DIALECT_V6,
+											 nameInput.getMetadata(), nameInput.getData(),
+											 result.getMetadata(), NULL, 0));
+				localStatus.check();
+
+				unsigned count = 0;
+				while (cursor->fetchNext(&localStatus, result.getData()) == IStatus::RESULT_OK)
+				{
+					input->schema = result->schema;
+					count++;
+				}
+				localStatus.check();
+
+				if (count != 1)
+					return;
+			}
+
+			table->object = getString(input->schema) + "." + name;
+
+			loadFormats(table, transaction, input.getMetadata(), input.getData());
+			loadKeys(table, transaction, input.getMetadata(), input.getData());
+
+			table->known = true;
+		}
+
+		void loadFormats(Table* table, ITransaction* transaction, IMessageMetadata* inputMetadata,
+						 void* inputData)
+		{
+			const char* sql =
+				"select f.rdb$descriptor from system.rdb$formats f "
+				"join system.rdb$relations r on r.rdb$relation_id = f.rdb$relation_id "
+				"where r.rdb$schema_name = ? and r.rdb$relation_name = ? "
+				"order by f.rdb$format desc";
+
+			FbLocalStatus localStatus;
+
+			FB_MESSAGE(Result, CheckStatusWrapper,
+				(FB_BLOB, descriptor)
+			) result(&localStatus, fb_get_master_interface());
+
+			RefPtr<IResultSet> cursor(REF_NO_INCR,
+				m_attachment->openCursor(&localStatus, transaction, 0, sql, SQL_DIALECT_V6,
+										 inputMetadata, inputData, result.getMetadata(), NULL, 0));
+			localStatus.check();
+
+			UCharBuffer buffer;
+
+			while (cursor->fetchNext(&localStatus, result.getData()) == IStatus::RESULT_OK)
+			{
+				buffer.clear();
+
+				RefPtr<IBlob> blob(REF_NO_INCR,
+					m_attachment->openBlob(&localStatus, transaction, &result->descriptor, 0, NULL));
+				localStatus.check();
+
+				UCHAR segment[BUFFER_MEDIUM];
+				unsigned segmentLength = 0;
+				int ret;
+
+				while ((ret = blob->getSegment(&localStatus, sizeof(segment), segment, &segmentLength)) ==
+					IStatus::RESULT_OK || ret == IStatus::RESULT_SEGMENT)
+				{
+					buffer.add(segment, segmentLength);
+				}
+				localStatus.check();
+
+				// See RelationPermanent::getFormat() for the layout of the format descriptor
+
+				if (buffer.getCount() < sizeof(USHORT))
+					raiseError("Record format is malformed");
+
+				const USHORT count = buffer[0] | (buffer[1] << 8);
+
+				if (buffer.getCount() < sizeof(USHORT) + count * sizeof(Ods::Descriptor))
+					raiseError("Record format is malformed");
+
+				auto& format = table->formats.add();
+				memcpy(format.descs.getBuffer(count), buffer.begin() + sizeof(USHORT),
+					   count * sizeof(Ods::Descriptor));
+
+				for (const auto& desc : format.descs)
+				{
+					if (desc.dsc_offset)
+						format.length = desc.dsc_offset + desc.dsc_length;
+				}
+			}
+			localStatus.check();
+		}
+
+		void loadKeys(Table* table, ITransaction* transaction, IMessageMetadata* inputMetadata,
+					  void* inputData)
+		{
+			// Expression indices have no segments, their keys are not known
+
+			const char* sql =
+				"select i.rdb$index_name, p.rdb$schema_name, p.rdb$relation_name, p.rdb$index_name, "
+				"rf.rdb$field_id, i.rdb$foreign_key "
+				"from system.rdb$indices i "
+				"left join system.rdb$indices p "
+				"on p.rdb$schema_name = i.rdb$foreign_key_schema_name and "
+				"p.rdb$index_name = i.rdb$foreign_key "
+				"left join system.rdb$index_segments s "
+				"on s.rdb$schema_name = i.rdb$schema_name and s.rdb$index_name = i.rdb$index_name "
+				"left join system.rdb$relation_fields rf "
+				"on rf.rdb$schema_name = i.rdb$schema_name and "
+				"rf.rdb$relation_name = i.rdb$relation_name and rf.rdb$field_name = s.rdb$field_name "
+				"where i.rdb$schema_name = ? and i.rdb$relation_name = ? and "
+				"coalesce(i.rdb$index_inactive, 0) = 0 and "
+				"(i.rdb$unique_flag = 1 or i.rdb$foreign_key is not null) "
+				"order by i.rdb$index_name, s.rdb$field_position";
+
+			FbLocalStatus localStatus;
+
+			FB_MESSAGE(Result, CheckStatusWrapper,
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), index)
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), parentSchema)
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), parentTable)
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), parentIndex)
+				(FB_SMALLINT, fieldId)
+				(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), foreignKey)
+			) result(&localStatus, fb_get_master_interface());
+
+			RefPtr<IResultSet> cursor(REF_NO_INCR,
+				m_attachment->openCursor(&localStatus, transaction, 0, sql, SQL_DIALECT_V6,
+										 inputMetadata, inputData, result.getMetadata(), NULL, 0));
+			localStatus.check();
+
+			string lastIndex;
+			Key* key = nullptr;
+
+			while (cursor->fetchNext(&localStatus, result.getData()) == IStatus::RESULT_OK)
+			{
+				if (result->fieldIdNull)
+					raiseError("Index key is an expression");
+
+				const string index = getString(result->index);
+
+				if (!key || index != lastIndex)
+				{
+					key = &table->keys.add();
+					lastIndex = index;
+
+					if (result->foreignKeyNull)
+					{
+						key->object = table->object;
+						key->prefix = table->object;
+						key->prefix.append("", 1);
+						key->prefix += index;
+						table->unique = true;
+					}
+					else
+					{
+						if (result->parentTableNull)
+							raiseError("Foreign key references unknown index");
+
+						key->object = getString(result->parentSchema) + "." +
+							getString(result->parentTable);
+						key->prefix = key->object;
+						key->prefix.append("", 1);
+						key->prefix += getString(result->parentIndex);
+					}
+
+					key->prefix.append("", 1);
+				}
+
+				key->fields.add((USHORT) result->fieldId);
+			}
+			localStatus.check();
+		}
+
+		template <unsigned N>
+		static string getString(const FbVarChar<N>& value)
+		{
+			string str(value.str, value.length);
+			str.rtrim();
+			return str;
+		}
+
+		// Append the values of the key segments, keys of the different tables referencing
+		// the same record should get the same value, so the exact numerics are normalized
+		static KeyState getKey(string& value, const Key& key, const Format& format,
+							   ULONG length, const UCHAR* record)
+		{
+			for (const auto id : key.fields)
+			{
+				if (id >= format.descs.getCount() || (ULONG) (id >> 3) >= length)
+					return KEY_UNKNOWN;
+
+				if (record[id >> 3] & (1 << (id & 7)))
+					return KEY_NULL;
+
+				const dsc desc = format.descs[id];
+				const ULONG offset = format.descs[id].dsc_offset;
+
+				if (offset + desc.dsc_length > length)
+					return KEY_UNKNOWN;
+
+				const UCHAR* const data = record + offset;
+
+				switch (desc.dsc_dtype)
+				{
+				case dtype_text:
+				case dtype_varying:
+					{
+						// Only the binary collations compare the strings byte by byte
+
+						if (desc.getCollation() != COLLATE_NONE || desc.getCharSet() == CS_UTF16)
+							return KEY_UNKNOWN;
+
+						const UCHAR* p = data;
+						ULONG l = desc.dsc_length;
+
+						if (desc.dsc_dtype == dtype_varying)
+						{
+							USHORT varLength;
+							memcpy(&varLength, data, sizeof(USHORT));
+							p += sizeof(USHORT);
+							l = MIN(varLength, l - sizeof(USHORT));
+						}
+
+						// Trailing blanks are ignored
+
+						const UCHAR pad = (desc.getCharSet() == CS_BINARY) ? 0 : ASCII_SPACE;
+
+						while (l && p[l - 1] == pad)
+							l--;
+
+						const USHORT charSet = desc.getCharSet();
+
+						value += 'T';
+						value.append((const char*) &charSet, sizeof(charSet));
+						value.append((const char*) &l, sizeof(l));
+						value.append((const char*) p, l);
+					}
+					break;
+
+				case dtype_short:
+				case dtype_long:
+				case dtype_int64:
+					{
+						SINT64 number = 0;
+
+						if (desc.dsc_dtype == dtype_short)
+						{
+							SSHORT n;
+							memcpy(&n, data, sizeof(n));
+							number = n;
+						}
+						else if (desc.dsc_dtype == dtype_long)
+						{
+							SLONG n;
+							memcpy(&n, data, sizeof(n));
+							number = n;
+						}
+						else
+							memcpy(&number, data, sizeof(number));
+
+						SSHORT scale = number ? desc.dsc_scale : 0;
+
+						while (scale < 0 && number % 10 == 0)
+						{
+							number /= 10;
+							scale++;
+						}
+
+						value += 'N';
+						value.append((const char*) &scale, sizeof(scale));
+						value.append((const char*) &number, sizeof(number));
+					}
+					break;
+
+				case dtype_real:
+				case dtype_double:
+				case dtype_sql_date:
+				case dtype_sql_time:
+				case dtype_timestamp:
+				case dtype_boolean:
+					value += (char) desc.dsc_dtype;
+					value.append((const char*) data, desc.dsc_length);
+					break;
+
+				default:
+					return KEY_UNKNOWN;
+				}
+			}
+
+			return KEY_VALUE;
+		}
+
+		MemoryPool& m_pool;
+		IAttachment* m_attachment = nullptr;
+		LeftPooledMap<string, Table*> m_tables;
+	};
+
+	// Parser collecting the records and objects changed by the replicated block,
+	// see Applier::process() for the block layout
+
+	class BlockScanner
+	{
+	public:
+		BlockScanner(ULONG length, const UCHAR* data, KeyMetadata& metadata)
+			: m_metadata(metadata)
+		{
+			if (((const Block*) data)->flags & BLOCK_COMPRESSED)
+			{
+				unpackBlock(length, data, m_unpacked);
+				length = m_unpacked.getCount();
+				data = m_unpacked.begin();
+			}
+
+			m_protocol = ((const Block*) data)->protocol;
+			m_data = data + sizeof(Block);
+			m_end = data + length;
+		}
+
+		// Returns false if the changes are not known, e.g. SQL (DDL) is executed
+		bool scan(WriteSet& writes)
+		{
+			string schema, name;
+
+			while (m_data < m_end)
+			{
+				const UCHAR op = *m_data++;
+
+				switch (op)
+				{
+				case opStartTransaction:
+				case opPrepareTransaction:
+				case opCommitTransaction:
+				case opRollbackTransaction:
+				case opCleanupTransaction:
+				case opStartSavepoint:
+				case opReleaseSavepoint:
+				case opRollbackSavepoint:
+					break;
+
+				case opInsertRecord:
+				case opDeleteRecord:
+					{
+						getName(schema, name);
+
+						const ULONG length = getLength();
+						const UCHAR* const record = getBinary(length);
+
+						if (!record || !m_metadata.addRecord(writes, schema, name, length, record))
+							return false;
+					}
+					break;
+
+				case opUpdateRecord:
+					{
+						getName(schema, name);
+
+						const ULONG orgLength = getLength();
+						const UCHAR* const orgRecord = getBinary(orgLength);
+						const ULONG newLength = getLength();
+						const UCHAR* const newRecord = getBinary(newLength);
+
+						if (!orgRecord || !newRecord ||
+							!m_metadata.addRecord(writes, schema, name, orgLength, orgRecord) ||
+							!m_metadata.addRecord(writes, schema, name, newLength, newRecord))
+						{
+							return false;
+						}
+					}
+					break;
+
+				case opUpdateRecordDiff:
+					{
+						getName(schema, name);
+
+						const ULONG orgLength = getLength();
+						const UCHAR* const orgRecord = getBinary(orgLength);
+						const ULONG newLength = getLength();
+						const ULONG diffLength = getLength();
+						const UCHAR* const diff = getBinary(diffLength);
+
+						if (!orgRecord || !diff || newLength != orgLength)
+							return false;
+
+						UCharBuffer buffer;
+						UCHAR* const newRecord = buffer.getBuffer(newLength);
+						memcpy(newRecord, orgRecord, orgLength);
+
+						if (!applyDifference(diffLength, diff, newLength, newRecord) ||
+							!m_metadata.addRecord(writes, schema, name, orgLength, orgRecord) ||
+							!m_metadata.addRecord(writes, schema, name, newLength, newRecord))
+						{
+							return false;
+						}
+					}
+					break;
+
+				case opStoreBlob:
+					skip(2 * sizeof(SLONG));
+					while (m_data < m_end)
+					{
+						SSHORT length;
+						getValue(length);
+
+						if (!length)
+							break;
+
+						skip((USHORT) length);
+					}
+					break;
+
+				case opSetSequence:
+					getName(schema, name);
+					writes.addObject("GENERATOR " + (schema.hasData() ? schema + "." + name : name));
+					skip(sizeof(SINT64));
+					break;
+
+				case opDefineAtom:
+					{
+						if (m_data >= m_end)
+							return false;
+
+						const ULONG length = *m_data++;
+						const auto atom = m_data;
+						skip(length);
+
+						if (m_malformed)
+							return false;
+
+						m_atoms.add(string((const char*) atom, length));
+					}
+					break;
+
+				default:
+					return false;
+				}
+
+				if (m_malformed)
+					return false;
+			}
+
+			return true;
+		}
+
+	private:
+		template <typename T>
+		void getValue(T& value)
+		{
+			value = 0;
+
+			if (m_end - m_data >= (SINT64) sizeof(T))
+				memcpy(&value, m_data, sizeof(T));
+
+			skip(sizeof(T));
+		}
+
+		ULONG getLength()
+		{
+			SLONG length;
+			getValue(length);
+			return (ULONG) length;
+		}
+
+		// Returns NULL if the block is malformed
+		const UCHAR* getBinary(ULONG length)
+		{
+			const UCHAR* const data = m_data;
+			skip(length);
+			return m_malformed ? nullptr : data;
+		}
+
+		void skip(ULONG length)
+		{
+			if (m_end - m_data < (SINT64) length)
+			{
+				m_data = m_end;
+				m_malformed = true;
+			}
+			else
+				m_data += length;
+		}
+
+		string getAtom()
+		{
+			SLONG pos;
+			getValue(pos);
+
+			return (pos >= 0 && (ULONG) pos < m_atoms.getCount()) ? m_atoms[pos] : string();
+		}
+
+		void getName(string& schema, string& name)
+		{
+			if (m_protocol < PROTOCOL_VERSION_2)
+				schema.erase();
+			else
+				schema = getAtom();
+
+			name = getAtom();
+		}
+
+		// Rebuild the new record image from the original one, see Difference::apply()
+		static bool applyDifference(ULONG diffLength, const UCHAR* diff, ULONG length, UCHAR* record)
+		{
+			const UCHAR* const diffEnd = diff + diffLength;
+			const UCHAR* const end = record + length;
+			UCHAR* p = record;
+
+			while (diff < diffEnd && p < end)
+			{
+				const int l = (signed char) *diff++;
+
+				if (l > 0)
+				{
+					if (p + l > end || diff + l > diffEnd)
+						return false;
+
+					memcpy(p, diff, l);
+					p += l;
+					diff += l;
+				}
+				else
+					p += -l;
+			}
+
+			while (diff < diffEnd)
+			{
+				if (*diff++)
+					return false;
+			}
+
+			return (p == end);
+		}
+
+		KeyMetadata& m_metadata;
+		UCharBuffer m_unpacked;
+		const UCHAR* m_data = nullptr;
+		const UCHAR* m_end = nullptr;
+		USHORT m_protocol = 0;
+		bool m_malformed = false;
+		ObjectsArray<string> m_atoms;
+	};
+
+	// Worker applying the replicated blocks of the transactions assigned to it.
+	// It runs its own thread and uses its own replicator (and connection).
+
+	class ApplyWorker : public GlobalStorage
+	{
+		static constexpr FB_SIZE_T MAX_QUEUE_LENGTH = 64;	// blocks
+
+	public:
+		// Block queued by another worker which must be applied first
+		struct Dependency
+		{
+			ApplyWorker* worker;
+			FB_UINT64 ticket;
+		};
+
+		typedef HalfStaticArray<Dependency, 8> DependencyList;
+
+	private:
+		struct Item
+		{
+			explicit Item(MemoryPool& pool)
+				: data(pool), dependencies(pool), sequence(0), offset(0)
+			{}
+
+			Array<UCHAR> data;
+			Array<Dependency> dependencies;
+			FB_UINT64 sequence;
+			ULONG offset;
+		};
+
+	public:
+		ApplyWorker(IAttachment* attachment, IReplicator* replicator)
+			: m_attachment(attachment), m_replicator(replicator),
+			  m_queue(getPool())
+		{
+			Thread::start(workerThread, this, THREAD_medium, &m_thread);
+		}
+
+		~ApplyWorker()
+		{
+			stop();
+
+			while (m_queue.hasData())
+				delete m_queue.pop();
+
+			// The borrowed replicator is closed by its owner
+
+			if (m_attachment)
+			{
+				FbLocalStatus localStatus;
+				m_replicator->close(&localStatus);
+				m_attachment->detach(&localStatus);
+			}
+		}
+
+		// Stop the thread, the workers waiting for this one are woken up
+		void stop()
+		{
+			{	// scope
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+				if (m_stop)
+					return;
+
+				m_stop = true;
+				m_workCond.notifyAll();
+				m_doneCond.notifyAll();
+			}
+
+			m_thread.waitForCompletion();
+		}
+
+		// Queue the block and return its ticket
+		FB_UINT64 enqueue(FB_UINT64 sequence, ULONG offset, ULONG length, const UCHAR* data,
+						  const DependencyList& dependencies)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			while (!m_failed && m_queue.getCount() >= MAX_QUEUE_LENGTH)
+				m_doneCond.wait(m_mutex);
+
+			if (m_failed)
+				return m_enqueued;
+
+			const auto item = FB_NEW_POOL(getPool()) Item(getPool());
+			item->data.assign(data, length);
+			item->dependencies.assign(dependencies.begin(), dependencies.getCount());
+			item->sequence = sequence;
+			item->offset = offset;
+
+			m_queue.add(item);
+			m_workCond.notifyOne();
+
+			return ++m_enqueued;
+		}
+
+		// Wait until the block with the given ticket is applied, return false on error
+		bool wait(FB_UINT64 ticket)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			while (!m_failed && !m_stop && m_completed < ticket)
+				m_doneCond.wait(m_mutex);
+
+			return !m_failed && m_completed >= ticket;
+		}
+
+		// Check whether the block with the given ticket is applied successfully
+		bool isDone(FB_UINT64 ticket)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			return !m_failed && m_completed >= ticket;
+		}
+
+		bool isFailed()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			return m_failed;
+		}
+
+		// Valid only after the worker has failed. It's empty if the worker has stopped
+		// because the worker it depends on has failed.
+		const FbLocalStatus& getStatus() const
+		{
+			return m_status;
+		}
+
+		FB_UINT64 getErrorSequence() const
+		{
+			return m_errorSequence;
+		}
+
+		ULONG getErrorOffset() const
+		{
+			return m_errorOffset;
+		}
+
+		FB_SIZE_T getQueueLength()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			return m_queue.getCount();
+		}
+
+		SINT64 getBusyTicks()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			return m_busyTicks;
+		}
+
+	private:
+		static THREAD_ENTRY_DECLARE workerThread(THREAD_ENTRY_PARAM arg)
+		{
+			static_cast<ApplyWorker*>(arg)->run();
+			return 0;
+		}
+
+		void run()
+		{
+			AutoMemoryPool workingPool(MemoryPool::createPool());
+			ContextPoolHolder threadContext(workingPool);
+
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			while (true)
+			{
+				while (!m_stop && (m_failed || m_queue.isEmpty()))
+					m_workCond.wait(m_mutex);
+
+				if (m_stop)
+					break;
+
+				const auto item = m_queue.front();
+				SINT64 ticks = 0;
+				bool ready = true;
+
+				{	// scope
+					MutexUnlockGuard cout(m_mutex, FB_FUNCTION);
+
+					for (const auto& dependency : item->dependencies)
+					{
+						if (!dependency.worker->wait(dependency.ticket))
+						{
+							ready = false;
+							break;
+						}
+					}
+
+					if (ready)
+					{
+						const SINT64 start = fb_utils::query_performance_counter();
+						m_replicator->process(&m_status, item->data.getCount(), item->data.begin());
+						ticks = fb_utils::query_performance_counter() - start;
+					}
+				}
+
+				m_queue.remove((FB_SIZE_T) 0);
+
+				if (ready)
+				{
+					m_busyTicks += ticks;
+					m_completed++;
+				}
+
+				if (!ready || !m_status.isSuccess())
+				{
+					// Stop applying, the dispatcher will report the error
+					m_errorSequence = item->sequence;
+					m_errorOffset = item->offset;
+					m_failed = true;
+
+					while (m_queue.hasData())
+						delete m_queue.pop();
+				}
+
+				delete item;
+				m_doneCond.notifyAll();
+			}
+		}
+
+		IAttachment* const m_attachment;
+		IReplicator* const m_replicator;
+		Thread m_thread;
+		Mutex m_mutex;
+		Condition m_workCond;
+		Condition m_doneCond;
+		Array<Item*> m_queue;
+		FB_UINT64 m_enqueued = 0;
+		FB_UINT64 m_completed = 0;
+		SINT64 m_busyTicks = 0;
+		bool m_stop = false;
+		bool m_failed = false;
+		FbLocalStatus m_status;
+		FB_UINT64 m_errorSequence = 0;
+		ULONG m_errorOffset = 0;
+	};
+
 	class Target : public GlobalStorage
 	{
 	public:
@@ -343,7 +1403,9 @@ namespace
 			: m_config(config),
 			  m_attachment(nullptr), m_replicator(nullptr),
 			  m_sequence(0), m_connected(false),
-			  m_lastError(getPool()), m_errorSequence(0), m_errorOffset(0)
+			  m_lastError(getPool()), m_errorSequence(0), m_errorOffset(0),
+			  m_workers(getPool()), m_transactions(getPool()),
+			  m_finished(getPool()), m_applied(getPool()), m_metadata(getPool())
 		{
 		}
 
@@ -365,30 +1427,12 @@ namespace
 		FB_UINT64 initReplica()
 		{
 			if (m_connected)
-				return m_sequence;
-
-			ClumpletWriter dpb(ClumpletReader::dpbList, MAX_DPB_SIZE);
-
-			dpb.insertByte(isc_dpb_no_db_triggers, 1);
-			dpb.insertString(isc_dpb_user_name, DBA_USER_NAME);
-			dpb.insertString(isc_dpb_config, ParsedList::getNonLoopbackProviders(m_config->dbName));
-
-			if (m_config->schemaSearchPath.hasData())
-				dpb.insertString(isc_dpb_search_path, m_config->schemaSearchPath.c_str());
-
-#ifndef NO_DATABASE
-			DispatcherPtr provider;
-			FbLocalStatus localStatus;
-
-			const auto att =
-				provider->attachDatabase(&localStatus, m_config->dbName.c_str(),
-										 dpb.getBufferLength(), dpb.getBuffer());
-			localStatus.check();
-			m_attachment = att;
+				return m_sequence;
 
-			const auto repl = m_attachment->createReplicator(&localStatus);
-			localStatus.check();
-			m_replicator = repl;
+#ifndef NO_DATABASE
+			FbLocalStatus localStatus;
+
+			m_attachment = attach(&m_replicator);
 
 			fb_assert(!m_sequence);
 
@@ -408,6 +1452,25 @@ namespace
 			localStatus.check();
 
 			m_sequence = result->sequence;
+
+			// The first worker borrows the main replicator,
+			// the others connect to the replica on their own
+
+			if (m_config->applyParallelism > 1)
+			{
+				m_workers.add(FB_NEW_POOL(getPool()) ApplyWorker(nullptr, m_replicator));
+
+				while (m_workers.getCount() < m_config->applyParallelism)
+				{
+					IReplicator* replicator = nullptr;
+					IAttachment* const attachment = attach(&replicator);
+					m_workers.add(FB_NEW_POOL(getPool()) ApplyWorker(attachment, replicator));
+				}
+
+				m_metadata.setAttachment(m_attachment);
+
+				verbose("Using %u parallel workers", (unsigned) m_workers.getCount());
+			}
 #endif
 			m_connected = true;
 
@@ -416,6 +1479,19 @@ namespace
 
 		void shutdown()
 		{
+			// Workers may wait for each other, stop all of them before deleting
+
+			for (const auto worker : m_workers)
+				worker->stop();
+
+			while (m_workers.hasData())
+				delete m_workers.pop();
+
+			clearTransactions();
+
+			m_metadata.clear();
+			m_metadata.setAttachment(nullptr);
+
 			FbLocalStatus localStatus;
 			if (m_replicator)
 			{
@@ -438,12 +1514,34 @@ namespace
 #else
 			fb_assert(m_replicator);
 
+			if (m_workers.hasData())
+			{
+				dispatch(sequence, offset, length, data);
+				return;
+			}
+
 			FbLocalStatus localStatus;
 			m_replicator->process(&localStatus, length, data);
 			checkCompletion(localStatus, sequence, offset);
 #endif
 		}
 
+		// Total time spent by workers applying the blocks, in performance counter ticks
+		SINT64 getBusyTicks()
+		{
+			SINT64 ticks = 0;
+
+			for (const auto worker : m_workers)
+				ticks += worker->getBusyTicks();
+
+			return ticks;
+		}
+
+		unsigned getParallelism() const
+		{
+			return MAX(m_workers.getCount(), 1);
+		}
+
 		bool isShutdown() const
 		{
 			return (m_attachment == nullptr);
@@ -502,7 +1600,271 @@ namespace
 			}
 		}
 
+		// Transaction ended but its end is not applied yet by the parallel worker
+		bool isEnding(TraNumber traNumber) const
+		{
+			for (const auto state : m_finished)
+			{
+				if (state->traNumber == traNumber)
+					return true;
+			}
+
+			return false;
+		}
+
+		// Remove the transactions with the applied ends from the list of active ones
+		void forgetApplied(TransactionList& transactions)
+		{
+			if (m_finished.hasData())
+				pruneFinished();
+
+			for (const auto traNumber : m_applied)
+			{
+				FB_SIZE_T pos;
+				if (transactions.find(traNumber, pos))
+					transactions.remove(pos);
+			}
+
+			m_applied.clear();
+		}
+
 	private:
+		struct TxnState
+		{
+			TxnState(MemoryPool& pool, TraNumber number, ApplyWorker* applyWorker)
+				: traNumber(number), worker(applyWorker), writes(pool)
+			{}
+
+			const TraNumber traNumber;
+			ApplyWorker* const worker;
+			WriteSet writes;			// changed records and objects
+			bool barrier = false;		// changes are not known
+			FB_UINT64 ticket = 0;		// end of transaction in the worker queue
+		};
+
+		IAttachment* attach(IReplicator** replicator)
+		{
+			ClumpletWriter dpb(ClumpletReader::dpbList, MAX_DPB_SIZE);
+
+			dpb.insertByte(isc_dpb_no_db_triggers, 1);
+			dpb.insertString(isc_dpb_user_name, DBA_USER_NAME);
+			dpb.insertString(isc_dpb_config, ParsedList::getNonLoopbackProviders(m_config->dbName));
+
+			if (m_config->schemaSearchPath.hasData())
+				dpb.insertString(isc_dpb_search_path, m_config->schemaSearchPath.c_str());
+
+			DispatcherPtr provider;
+			FbLocalStatus localStatus;
+
+			const auto att =
+				provider->attachDatabase(&localStatus, m_config->dbName.c_str(),
+										 dpb.getBufferLength(), dpb.getBuffer());
+			localStatus.check();
+
+			const auto repl = att->createReplicator(&localStatus);
+			if (!localStatus.isSuccess())
+			{
+				FbLocalStatus detachStatus;
+				att->detach(&detachStatus);
+				localStatus.raise();
+			}
+
+			*replicator = repl;
+			return att;
+		}
+
+		void dispatch(FB_UINT64 sequence, ULONG offset, ULONG length, const UCHAR* data)
+		{
+			// Transactions are spread between workers and applied concurrently.
+			// A change made on the primary after the end of another transaction may
+			// depend on its results, so the block is applied after the ends of the
+			// finished transactions that changed the same records, or the records
+			// referenced by the same foreign keys, see WriteSet. The transaction ends
+			// are applied strictly in their original order. Workers wait for these
+			// dependencies themselves, so the independent changes are applied
+			// concurrently and the dispatcher doesn't wait.
+
+			checkWorkers();
+
+			const Block* const header = (Block*) data;
+			const auto traNumber = header->traNumber;
+
+			if (!traNumber)
+			{
+				// Blocks outside transactions (e.g. cleanup after restart of the primary)
+				// affect transactions of all workers, so all of them apply such a block
+
+				HalfStaticArray<FB_UINT64, 16> tickets;
+				const ApplyWorker::DependencyList noDependencies;
+
+				for (const auto worker : m_workers)
+					tickets.add(worker->enqueue(sequence, offset, length, data, noDependencies));
+
+				for (FB_SIZE_T i = 0; i < m_workers.getCount(); i++)
+					m_workers[i]->wait(tickets[i]);
+
+				checkWorkers();
+				pruneFinished();
+
+				if (header->flags & BLOCK_END_TRANS)
+					clearTransactions();
+
+				return;
+			}
+
+			if (m_finishedBarriers)
+			{
+				// Keys are looked up in the replica metadata, so wait until the metadata
+				// changes (DDL) of the finished transactions are committed
+
+				for (const auto finished : m_finished)
+				{
+					if (finished->barrier && !finished->worker->wait(finished->ticket))
+						checkWorkers();
+				}
+
+				pruneFinished();
+			}
+
+			TxnState* state = nullptr;
+
+			if (!m_transactions.get(traNumber, state))
+			{
+				// Pick the least loaded worker for the new transaction
+
+				ApplyWorker* worker = nullptr;
+				FB_SIZE_T minLength = MAX_ULONG;
+
+				for (const auto item : m_workers)
+				{
+					const FB_SIZE_T length = item->getQueueLength();
+
+					if (length < minLength)
+					{
+						worker = item;
+						minLength = length;
+					}
+				}
+
+				state = FB_NEW_POOL(getPool()) TxnState(getPool(), traNumber, worker);
+				m_transactions.put(traNumber, state);
+			}
+
+			WriteSet writes(getPool());
+			const bool known = BlockScanner(length, data, m_metadata).scan(writes);
+
+			if (!known)
+				state->barrier = true;
+
+			pruneFinished();
+
+			ApplyWorker::DependencyList dependencies;
+
+			for (const auto finished : m_finished)
+			{
+				if (!known || finished->barrier || finished->writes.conflicts(writes))
+					addDependency(dependencies, state->worker, finished->worker, finished->ticket);
+			}
+
+			const bool end = (header->flags & BLOCK_END_TRANS);
+
+			if (end && m_lastEnd.worker)
+				addDependency(dependencies, state->worker, m_lastEnd.worker, m_lastEnd.ticket);
+
+			state->writes.merge(writes);
+
+			const FB_UINT64 ticket =
+				state->worker->enqueue(sequence, offset, length, data, dependencies);
+
+			if (end)
+			{
+				m_transactions.remove(traNumber);
+				state->ticket = ticket;
+				m_finished.add(state);
+
+				if (state->barrier)
+					m_finishedBarriers++;
+
+				m_lastEnd.worker = state->worker;
+				m_lastEnd.ticket = ticket;
+			}
+		}
+
+		static void addDependency(ApplyWorker::DependencyList& dependencies, const ApplyWorker* worker,
+								  ApplyWorker* dependency, FB_UINT64 ticket)
+		{
+			// Blocks of the same worker are applied in order anyway
+
+			if (dependency == worker)
+				return;
+
+			for (auto& item : dependencies)
+			{
+				if (item.worker == dependency)
+				{
+					item.ticket = MAX(item.ticket, ticket);
+					return;
+				}
+			}
+
+			dependencies.add({dependency, ticket});
+		}
+
+		// Forget the finished transactions those ends are applied
+		void pruneFinished()
+		{
+			for (FB_SIZE_T i = 0; i < m_finished.getCount();)
+			{
+				const auto state = m_finished[i];
+
+				if (state->worker->isDone(state->ticket))
+				{
+					if (state->barrier)
+					{
+						// Metadata could be changed
+						m_metadata.clear();
+						m_finishedBarriers--;
+					}
+
+					m_applied.add(state->traNumber);
+					m_finished.remove(i);
+					delete state;
+				}
+				else
+					i++;
+			}
+		}
+
+		void clearTransactions()
+		{
+			NonPooledMap<TraNumber, TxnState*>::Accessor accessor(&m_transactions);
+
+			for (bool found = accessor.getFirst(); found; found = accessor.getNext())
+				delete accessor.current()->second;
+
+			m_transactions.clear();
+
+			while (m_finished.hasData())
+				delete m_finished.pop();
+
+			m_finishedBarriers = 0;
+			m_lastEnd.worker = nullptr;
+			m_lastEnd.ticket = 0;
+			m_metadata.clear();
+		}
+
+		void checkWorkers()
+		{
+			// A worker which has stopped because of the failure of another one
+			// has no error, the failed worker reports it
+
+			for (const auto worker : m_workers)
+			{
+				if (worker->isFailed() && !worker->getStatus().isSuccess())
+					checkCompletion(worker->getStatus(), worker->getErrorSequence(), worker->getErrorOffset());
+			}
+		}
+
 		AutoPtr<const Replication::Config> m_config;
 		IAttachment* m_attachment;
 		IReplicator* m_replicator;
@@ -511,14 +1873,21 @@ namespace
 		string m_lastError;
 		FB_UINT64 m_errorSequence;
 		ULONG m_errorOffset;
+		Array<ApplyWorker*> m_workers;
+		NonPooledMap<TraNumber, TxnState*> m_transactions;	// being dispatched
+		Array<TxnState*> m_finished;						// ended, maybe not applied yet
+		Array<TraNumber> m_applied;							// ended and applied
+		ApplyWorker::Dependency m_lastEnd = {nullptr, 0};	// the latest transaction end
+		unsigned m_finishedBarriers = 0;					// finished transactions with DDL
+		KeyMetadata m_metadata;
 	};
 
 	typedef Array<Target*> TargetList;
 
 	struct Segment
 	{
-		explicit Segment(MemoryPool& pool, const PathName& fname, const SegmentHeader& hdr)
-			: filename(pool, fname)
+		explicit Segment(MemoryPool& pool, const PathName& fname, const SegmentHeader& hdr, time_t mtime)
+			: filename(pool, fname), timestamp(mtime)
 		{
 			memcpy(&header, &hdr, sizeof(SegmentHeader));
 		}
@@ -545,6 +1914,7 @@ namespace
 
 		const PathName filename;
 		SegmentHeader header;
+		const time_t timestamp;		// last modification of the segment file
 	};
 
 	typedef SortedArray<Segment*, EmptyStorage<Segment*>, FB_UINT64, Segment> ProcessQueue;
@@ -604,12 +1974,24 @@ namespace
 			target->replicate(sequence, offset, length, data);
 		}
 
+		// The transaction is still considered active until its end is applied by the
+		// parallel worker, so it's replayed if the replication is interrupted before
+
+		target->forgetApplied(transactions);
+
 		if (header->flags & BLOCK_END_TRANS)
 		{
 			if (traNumber)
 			{
 				FB_SIZE_T pos;
-				if (transactions.find(traNumber, pos))
+				const bool found = transactions.find(traNumber, pos);
+
+				if (target->isEnding(traNumber))
+				{
+					if (!found)
+						transactions.add(ActiveTransaction(traNumber, sequence));
+				}
+				else if (found)
 					transactions.remove(pos);
 			}
 			else if (action != REPLAY)
@@ -628,6 +2010,28 @@ namespace
 
 	enum ProcessStatus { PROCESS_SUSPEND, PROCESS_CONTINUE, PROCESS_ERROR, PROCESS_SHUTDOWN };
 
+	void reportError(Target* target, const Exception& ex)
+	{
+		FbLocalStatus localStatus;
+		ex.stuffException(&localStatus);
+
+		string message;
+
+		char temp[BUFFER_LARGE];
+		const ISC_STATUS* statusPtr = localStatus->getErrors();
+		while (fb_interpret(temp, sizeof(temp), &statusPtr))
+		{
+			if (!message.isEmpty())
+				message += "\n\t";
+
+			message += temp;
+		}
+
+		target->logError(message);
+
+		target->verbose("Disconnecting and suspending");
+	}
+
 	ProcessStatus process_archive(MemoryPool& pool, Target* target)
 	{
 		ProcessQueue queue(pool);
@@ -733,7 +2137,7 @@ namespace
 				if (header.hdr_state != SEGMENT_STATE_ARCH)
 					continue;
 */
-				queue.add(FB_NEW_POOL(pool) Segment(pool, filename, header));
+				queue.add(FB_NEW_POOL(pool) Segment(pool, filename, header, stats.st_mtime));
 			}
 
 			if (queue.isEmpty())
@@ -875,6 +2279,8 @@ namespace
 				}
 
 				const TimeStamp startTime(TimeStamp::getCurrentTimeStamp());
+				const SINT64 startTicks = fb_utils::query_performance_counter();
+				const SINT64 startBusyTicks = target->getBusyTicks();
 
 				AutoFile file(fd);
 
@@ -927,6 +2333,16 @@ namespace
 				const TimeStamp finishTime(TimeStamp::getCurrentTimeStamp());
 				const string interval = formatInterval(startTime, finishTime);
 
+				// Replica lag is the time passed since the segment was written to,
+				// parallelism is the average number of workers applying it at once
+
+				const time_t now = time(NULL);
+				const SINT64 lag = (now > segment->timestamp) ? (SINT64) (now - segment->timestamp) : 0;
+
+				const SINT64 elapsedTicks = fb_utils::query_performance_counter() - startTicks;
+				const double parallelism = (target->getParallelism() > 1 && elapsedTicks > 0) ?
+					(double) (target->getBusyTicks() - startBusyTicks) / elapsedTicks : 1.0;
+
 				oldest = findOldest(transactions);
 				oldest_sequence = oldest ? oldest->sequence : 0;
 				next_sequence = sequence + 1;
@@ -946,8 +2362,10 @@ namespace
 					extra = "deleting";
 				}
 
-				target->verbose("Segment %" UQUADFORMAT " (%u bytes) is %s in %s, %s",
-								sequence, totalLength, actionName.c_str(), interval.c_str(), extra.c_str());
+				target->verbose("Segment %" UQUADFORMAT " (%u bytes) is %s in %s "
+								"(lag: %" SQUADFORMAT "s, parallelism: %.2lf of %u), %s",
+								sequence, totalLength, actionName.c_str(), interval.c_str(),
+								lag, parallelism, target->getParallelism(), extra.c_str());
 
 				if (!oldest_sequence)
 					segment->remove();
@@ -980,32 +2398,177 @@ namespace
 		}
 		catch (const Exception& ex)
 		{
-			FbLocalStatus localStatus;
-			ex.stuffException(&localStatus);
+			reportError(target, ex);
+			ret = PROCESS_ERROR;
+		}
+
+		while (queue.hasData())
+			delete queue.pop();
+
+		return ret;
+	}
+
+	ProcessStatus process_stream(MemoryPool& pool, Target* target)
+	{
+		// Apply the blocks streamed by the primary directly from its journal.
+		// The replication state is tracked the same way as for the archived segments,
+		// so the latter can be used any time the stream is not available.
+
+		const auto config = target->getConfig();
+
+		try
+		{
+			StreamSocket socket;
 
-			string message;
+			if (!socket.connect(config->sourceStream))
+			{
+				target->verbose("Journal stream %s is not available", config->sourceStream.c_str());
+				return PROCESS_SUSPEND;
+			}
 
-			char temp[BUFFER_LARGE];
-			const ISC_STATUS* statusPtr = localStatus->getErrors();
-			while (fb_interpret(temp, sizeof(temp), &statusPtr))
+			StreamFrame frame;
+			UCHAR hello[Guid::SIZE + STREAM_CHALLENGE_SIZE];
+			const UCHAR* const guidBuffer = hello;
+
+			if (!socket.receiveFrame(frame, STREAM_TIMEOUT) ||
+				frame.type != FRAME_HELLO || frame.length != sizeof(hello) ||
+				!socket.receive(hello, sizeof(hello), STREAM_TIMEOUT))
 			{
-				if (!message.isEmpty())
-					message += "\n\t";
+				target->verbose("Journal stream %s handshake failed", config->sourceStream.c_str());
+				return PROCESS_SUSPEND;
+			}
 
-				message += temp;
+			const Guid guid(guidBuffer);
+
+			if (!target->checkGuid(guid))
+			{
+				target->verbose("Skipping journal stream %s due to GUID mismatch (found %s)",
+								config->sourceStream.c_str(), guid.toString().c_str());
+				return PROCESS_SUSPEND;
 			}
 
-			target->logError(message);
+			// Replication must be initialized by the archived segments
 
-			target->verbose("Disconnecting and suspending");
+			if (!ControlFile::exists(target->getDirectory(), guid))
+				return PROCESS_SUSPEND;
 
-			ret = PROCESS_ERROR;
-		}
+			TransactionList transactions(pool);
+			ControlFile control(target->getDirectory(), guid, 0, transactions);
 
-		while (queue.hasData())
-			delete queue.pop();
+			const bool restart = target->isShutdown();
+			const FB_UINT64 db_sequence = target->initReplica();
 
-		return ret;
+			if (db_sequence != control.getDbSequence())
+				return PROCESS_SUSPEND;
+
+			const FB_UINT64 last_sequence = control.getSequence();
+			const ULONG last_offset = control.getOffset();
+
+			// After reconnect, the active transactions are replayed starting with the oldest one
+
+			const ActiveTransaction* const oldest = findOldest(transactions);
+
+			FB_UINT64 sequence = last_offset ? last_sequence : last_sequence + 1;
+			ULONG offset = last_offset;
+
+			if (restart)
+			{
+				sequence = oldest ? oldest->sequence : sequence;
+				offset = 0;
+			}
+
+			StreamRequest request;
+			memset(&request, 0, sizeof(StreamRequest));
+			request.version = STREAM_CURRENT_VERSION;
+			request.sequence = sequence;
+			request.offset = offset;
+
+			if (config->streamPassword.hasData())
+				makeStreamProof(config->streamPassword, hello + Guid::SIZE, guidBuffer, request.proof);
+
+			UCHAR requestBuffer[StreamRequest::SIZE];
+			request.encode(requestBuffer);
+
+			if (!socket.send(requestBuffer, sizeof(requestBuffer)))
+				return PROCESS_SUSPEND;
+
+			target->verbose("Streaming journal from %s starting with segment %" UQUADFORMAT,
+							config->sourceStream.c_str(), sequence);
+
+			Array<UCHAR> buffer(pool);
+
+			while (!shutdownFlag)
+			{
+				if (!socket.receiveFrame(frame, STREAM_TIMEOUT))
+				{
+					target->verbose("Journal stream %s is interrupted", config->sourceStream.c_str());
+					return PROCESS_SUSPEND;
+				}
+
+				switch (frame.type)
+				{
+				case FRAME_BLOCK:
+					{
+						if (frame.length < sizeof(Block))
+							raiseError("Journal stream %s appears corrupted", config->sourceStream.c_str());
+
+						UCHAR* const data = buffer.getBuffer(frame.length);
+
+						if (!socket.receive(data, frame.length, STREAM_TIMEOUT))
+						{
+							target->verbose("Journal stream %s is interrupted", config->sourceStream.c_str());
+							return PROCESS_SUSPEND;
+						}
+
+						const Block* const header = (Block*) data;
+
+						if (sizeof(Block) + header->length != frame.length)
+							raiseError("Journal stream %s appears corrupted", config->sourceStream.c_str());
+
+						if (header->length)
+						{
+							const bool replay = (frame.sequence < last_sequence ||
+								(frame.sequence == last_sequence && (!last_offset || frame.offset < last_offset)));
+
+							replicate(target, transactions, frame.sequence, frame.offset,
+									  frame.length, data, replay ? REPLAY : REPLICATE);
+						}
+
+						control.savePartial(frame.sequence, frame.offset + frame.length, transactions);
+					}
+					break;
+
+				case FRAME_SEGMENT_END:
+					control.saveComplete(frame.sequence, transactions);
+
+					target->verbose("Segment %" UQUADFORMAT " (%u bytes) is streamed",
+									frame.sequence, frame.offset);
+
+					// Let the archived segments be processed (and cleaned up) in between
+
+					return PROCESS_CONTINUE;
+
+				case FRAME_NO_SEGMENT:
+					target->verbose("Segment %" UQUADFORMAT " is not in the journal anymore, "
+									"waiting for it to be archived", frame.sequence);
+					return PROCESS_SUSPEND;
+
+				case FRAME_HEARTBEAT:
+					break;
+
+				default:
+					raiseError("Journal stream %s appears corrupted", config->sourceStream.c_str());
+				}
+			}
+
+			return PROCESS_SHUTDOWN;
+		}
+		catch (const Exception& ex)
+		{
+			reportError(target, ex);
+		}
+
+		return PROCESS_ERROR;
 	}
 
 	THREAD_ENTRY_DECLARE process_thread(THREAD_ENTRY_PARAM arg)
@@ -1021,7 +2584,12 @@ namespace
 
 		while (!shutdownFlag)
 		{
-			const ProcessStatus ret = process_archive(*workingPool, target);
+			ProcessStatus ret = process_archive(*workingPool, target);
+
+			// Follow the journal of the primary while no archived segments are pending
+
+			if (ret == PROCESS_SUSPEND && config->sourceStream.hasData())
+				ret = process_stream(*workingPool, target);
 
 			if (ret == PROCESS_CONTINUE)
 				continue;
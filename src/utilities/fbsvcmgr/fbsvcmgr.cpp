@@ -427,6 +427,7 @@ constexpr SvcSwitches backupOptions[] =
 	{"bkp_zip", putOption, 0, isc_spb_bkp_zip, 0 },
 	{"bkp_parallel_workers", putIntArgument, 0, isc_spb_bkp_parallel_workers, 0},
 	{"bkp_direct_io", putOption, 0, isc_spb_bkp_direct_io, 0},
+	{"bkp_columnar", putOption, 0, isc_spb_bkp_columnar, 0},
 	{0, 0, 0, 0, 0}
 };
 
@@ -568,6 +569,8 @@ constexpr SvcSwitches nbackOptions[] =
 	{"nbk_clean_history", putSingleTag, 0, isc_spb_nbk_clean_history, 0},
 	{"nbk_keep_days", putIntArgument, 0, isc_spb_nbk_keep_days, 0},
 	{"nbk_keep_rows", putIntArgument, 0, isc_spb_nbk_keep_rows, 0},
+	{"nbk_parallel_workers", putIntArgument, 0, isc_spb_nbk_parallel_workers, 0},
+	{"nbk_compress", putOption, 0, isc_spb_nbk_compress, 0},
 	{0, 0, 0, 0, 0}
 };
 
@@ -577,6 +580,7 @@ constexpr SvcSwitches nrestOptions[] =
 	{"nbk_file", putStringArgument, 0, isc_spb_nbk_file, 0},
 	{"nbk_inplace", putOption, 0, isc_spb_nbk_inplace, 0},
 	{"nbk_sequence", putOption, 0, isc_spb_nbk_sequence, 0},
+	{"nbk_parallel_workers", putIntArgument, 0, isc_spb_nbk_parallel_workers, 0},
 	{0, 0, 0, 0, 0}
 };
 
@@ -0,0 +1,475 @@
+/*
+ *	PROGRAM:		Firebird utilities
+ *	MODULE:			TraceLogDecoder.cpp
+ *	DESCRIPTION:	Binary trace log decoder
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "firebird/Interface.h"
+#include "iberror.h"
+
+#include "../../common/StatusArg.h"
+#include "../../common/classes/array.h"
+#include "../../common/classes/GenericMap.h"
+#include "../../common/classes/timestamp.h"
+#include "../../common/os/os_utils.h"
+#include "../ntrace/TraceLogFormat.h"
+#include "TraceLogDecoder.h"
+
+using namespace Firebird;
+
+namespace
+{
+	// Objects are described by the plugin instance that refers them
+
+	struct ObjectKey
+	{
+		SINT64 process;
+		FB_UINT64 instance;
+		USHORT type;
+		SINT64 id;
+
+		bool operator>(const ObjectKey& other) const
+		{
+			if (process != other.process)
+				return (process > other.process);
+
+			if (instance != other.instance)
+				return (instance > other.instance);
+
+			if (type != other.type)
+				return (type > other.type);
+
+			return (id > other.id);
+		}
+	};
+
+	class LogDecoder
+	{
+	public:
+		LogDecoder(MemoryPool& pool, const PathName& fileName, bool json)
+			: m_fileName(pool, fileName), m_json(json), m_objects(pool)
+		{}
+
+		void decode(const TraceChunk& chunk, const UCHAR* data, ULONG length);
+
+	private:
+		[[noreturn]] void corrupted();
+
+		void describe(const TraceChunk& chunk, const TraceRecord& record, const char* text, ULONG length);
+		void printText(const TraceChunk& chunk, const TraceRecord& record, const char* text, ULONG length);
+		void printEvent(const TraceChunk& chunk, const TraceEventRecord& event);
+
+		void printHeader(const TraceChunk& chunk, const TraceRecord& record, const char* action);
+		void printObject(const TraceChunk& chunk, TraceRecordType type, SINT64 id, const char* unknown);
+		void printJson(const char* name, const char* value, ULONG length);
+
+		const PathName m_fileName;
+		const bool m_json;
+		RightPooledMap<ObjectKey, string> m_objects;
+	};
+
+	const char* getAction(const TraceEventRecord& event, string& buffer)
+	{
+		const bool commit = (event.flags & TRACE_FLAG_COMMIT);
+		const bool retaining = (event.flags & TRACE_FLAG_RETAINING);
+
+		const char* action;
+
+		switch (event.type)
+		{
+			case TRACE_REC_TRANSACTION_START:
+				action = "START_TRANSACTION";
+				break;
+			case TRACE_REC_TRANSACTION_END:
+				action = commit ?
+					(retaining ? "COMMIT_RETAINING" : "COMMIT_TRANSACTION") :
+					(retaining ? "ROLLBACK_RETAINING" : "ROLLBACK_TRANSACTION");
+				break;
+			case TRACE_REC_STATEMENT_START:
+				action = event.restarts ? "EXECUTE_STATEMENT_RESTART" : "EXECUTE_STATEMENT_START";
+				break;
+			case TRACE_REC_STATEMENT_FINISH:
+				action = "EXECUTE_STATEMENT_FINISH";
+				break;
+			case TRACE_REC_PROCEDURE_START:
+				action = "EXECUTE_PROCEDURE_START";
+				break;
+			case TRACE_REC_PROCEDURE_FINISH:
+				action = "EXECUTE_PROCEDURE_FINISH";
+				break;
+			case TRACE_REC_FUNCTION_START:
+				action = "EXECUTE_FUNCTION_START";
+				break;
+			case TRACE_REC_FUNCTION_FINISH:
+				action = "EXECUTE_FUNCTION_FINISH";
+				break;
+			case TRACE_REC_TRIGGER_START:
+				action = "EXECUTE_TRIGGER_START";
+				break;
+			case TRACE_REC_TRIGGER_FINISH:
+				action = "EXECUTE_TRIGGER_FINISH";
+				break;
+			default:
+				fb_assert(false);
+				action = "<unknown event>";
+		}
+
+		switch (event.result)
+		{
+			case ITracePlugin::RESULT_SUCCESS:
+				return action;
+			case ITracePlugin::RESULT_FAILED:
+				buffer.printf("FAILED %s", action);
+				break;
+			case ITracePlugin::RESULT_UNAUTHORIZED:
+				buffer.printf("UNAUTHORIZED %s", action);
+				break;
+			default:
+				buffer.printf("Unknown result of %s", action);
+				break;
+		}
+
+		return buffer.c_str();
+	}
+}
+
+
+void LogDecoder::corrupted()
+{
+	(Arg::Gds(isc_trace_param_invalid) << m_fileName << "INPUT").raise();
+}
+
+void LogDecoder::decode(const TraceChunk& chunk, const UCHAR* data, ULONG length)
+{
+	const UCHAR* const end = data + length;
+
+	while (data < end)
+	{
+		TraceRecord record;
+
+		if (end - data < (ptrdiff_t) sizeof(TraceRecord))
+			corrupted();
+
+		memcpy(&record, data, sizeof(TraceRecord));
+
+		if (record.length < sizeof(TraceRecord) || record.length > (ULONG) (end - data))
+			corrupted();
+
+		const char* const text = reinterpret_cast<const char*>(data + sizeof(TraceRecord));
+		const ULONG textLength = record.length - sizeof(TraceRecord);
+
+		switch (record.type)
+		{
+			case TRACE_REC_TEXT:
+				printText(chunk, record, text, textLength);
+				break;
+
+			case TRACE_REC_CONNECTION:
+			case TRACE_REC_TRANSACTION:
+			case TRACE_REC_STATEMENT:
+			case TRACE_REC_ROUTINE:
+				describe(chunk, record, text, textLength);
+				break;
+
+			case TRACE_REC_TRANSACTION_START:
+			case TRACE_REC_TRANSACTION_END:
+			case TRACE_REC_STATEMENT_START:
+			case TRACE_REC_STATEMENT_FINISH:
+			case TRACE_REC_PROCEDURE_START:
+			case TRACE_REC_PROCEDURE_FINISH:
+			case TRACE_REC_FUNCTION_START:
+			case TRACE_REC_FUNCTION_FINISH:
+			case TRACE_REC_TRIGGER_START:
+			case TRACE_REC_TRIGGER_FINISH:
+				{
+					if (record.length < sizeof(TraceEventRecord))
+						corrupted();
+
+					TraceEventRecord event;
+					memcpy(&event, data, sizeof(TraceEventRecord));
+					printEvent(chunk, event);
+				}
+				break;
+
+			default:
+				// Skip the records unknown to us
+				break;
+		}
+
+		data += record.length;
+	}
+}
+
+void LogDecoder::describe(const TraceChunk& chunk, const TraceRecord& record, const char* text, ULONG length)
+{
+	const ObjectKey key = {chunk.process, chunk.instance, record.type, record.id};
+	m_objects.put(key)->assign(text, length);
+
+	if (m_json)
+	{
+		const char* object =
+			(record.type == TRACE_REC_CONNECTION) ? "connection" :
+			(record.type == TRACE_REC_TRANSACTION) ? "transaction" :
+			(record.type == TRACE_REC_STATEMENT) ? "statement" : "routine";
+
+		printHeader(chunk, record, nullptr);
+		printf(", \"object\": \"%s\", \"id\": %" SQUADFORMAT, object, record.id);
+		printJson("text", text, length);
+		printf("}\n");
+	}
+}
+
+void LogDecoder::printText(const TraceChunk& chunk, const TraceRecord& record, const char* text, ULONG length)
+{
+	const char* const action = text;
+	const ULONG actionLength = static_cast<ULONG>(strnlen(action, length));
+
+	if (actionLength == length)
+		corrupted();
+
+	text += actionLength + 1;
+	length -= actionLength + 1;
+
+	printHeader(chunk, record, action);
+
+	if (m_json)
+	{
+		printJson("text", text, length);
+		printf("}\n");
+	}
+	else
+		printf("%.*s\n", (int) length, text);
+}
+
+void LogDecoder::printEvent(const TraceChunk& chunk, const TraceEventRecord& event)
+{
+	string buffer;
+	const char* const action = getAction(event, buffer);
+
+	const bool transactionEvent =
+		(event.type == TRACE_REC_TRANSACTION_START || event.type == TRACE_REC_TRANSACTION_END);
+	const bool statementEvent =
+		(event.type == TRACE_REC_STATEMENT_START || event.type == TRACE_REC_STATEMENT_FINISH);
+	const bool stats = (event.flags & TRACE_FLAG_STATS);
+
+	printHeader(chunk, event, action);
+
+	if (m_json)
+	{
+		printf(", \"attachment\": %" SQUADFORMAT, event.attachment);
+
+		if (event.transaction)
+			printf(", \"transaction\": %" SQUADFORMAT, event.transaction);
+
+		if (transactionEvent)
+		{
+			if (event.statement)
+				printf(", \"new_transaction\": %" SQUADFORMAT, event.statement);
+		}
+		else
+			printf(", \"%s\": %" SQUADFORMAT, statementEvent ? "statement" : "routine", event.statement);
+
+		if (event.restarts)
+			printf(", \"restarts\": %u", event.restarts);
+
+		if (stats)
+		{
+			printf(", \"elapsed\": %" SQUADFORMAT ", \"fetched\": %" SQUADFORMAT
+				", \"reads\": %" SQUADFORMAT ", \"writes\": %" SQUADFORMAT
+				", \"fetches\": %" SQUADFORMAT ", \"marks\": %" SQUADFORMAT,
+				event.elapsed, event.fetchedRecords, event.pageReads, event.pageWrites,
+				event.pageFetches, event.pageMarks);
+		}
+
+		printf("}\n");
+		return;
+	}
+
+	printObject(chunk, TRACE_REC_CONNECTION, event.attachment, "\t(ATT_%" SQUADFORMAT ", <unknown>)\n");
+
+	if (event.transaction)
+		printObject(chunk, TRACE_REC_TRANSACTION, event.transaction, "\t\t(TRA_%" SQUADFORMAT ", <unknown>)\n");
+
+	if (transactionEvent)
+	{
+		if (event.statement)
+			printf("\tNew number %" SQUADFORMAT "\n", event.statement);
+	}
+	else if (statementEvent)
+		printObject(chunk, TRACE_REC_STATEMENT, event.statement, "\nStatement %" SQUADFORMAT ", <unknown>:\n");
+	else
+		printObject(chunk, TRACE_REC_ROUTINE, event.statement, "\nRoutine %" SQUADFORMAT ", <unknown>:\n");
+
+	if (event.restarts)
+		printf("Restarted %u time(s)\n", event.restarts);
+
+	if (stats)
+	{
+		if (statementEvent || event.fetchedRecords)
+			printf("%" SQUADFORMAT " records fetched\n", event.fetchedRecords);
+
+		printf("%7" SQUADFORMAT " ms", event.elapsed);
+
+		if (event.pageReads)
+			printf(", %" SQUADFORMAT " read(s)", event.pageReads);
+
+		if (event.pageWrites)
+			printf(", %" SQUADFORMAT " write(s)", event.pageWrites);
+
+		if (event.pageFetches)
+			printf(", %" SQUADFORMAT " fetch(es)", event.pageFetches);
+
+		if (event.pageMarks)
+			printf(", %" SQUADFORMAT " mark(s)", event.pageMarks);
+
+		printf("\n");
+	}
+
+	printf("\n");
+}
+
+// Print the timestamp, origin and action of the record, opens the object in JSON mode
+
+void LogDecoder::printHeader(const TraceChunk& chunk, const TraceRecord& record, const char* action)
+{
+	const TimeStamp stamp(record.timestamp);
+	struct tm times;
+	stamp.decode(&times);
+
+	char timestamp[32];
+	snprintf(timestamp, sizeof(timestamp), "%04d-%02d-%02dT%02d:%02d:%02d.%04d",
+		times.tm_year + 1900, times.tm_mon + 1, times.tm_mday, times.tm_hour,
+		times.tm_min, times.tm_sec, (int) (record.timestamp.timestamp_time % ISC_TIME_SECONDS_PRECISION));
+
+	if (m_json)
+	{
+		printf("{\"timestamp\": \"%s\", \"process\": %" SQUADFORMAT ", \"instance\": \"0x%" QUADFORMAT "x\", "
+			"\"session\": %d", timestamp, chunk.process, chunk.instance, chunk.session);
+
+		if (action)
+			printJson("action", action, static_cast<ULONG>(strlen(action)));
+	}
+	else
+		printf("%s (%" SQUADFORMAT ":0x%" QUADFORMAT "x) %s\n", timestamp, chunk.process, chunk.instance, action);
+}
+
+void LogDecoder::printObject(const TraceChunk& chunk, TraceRecordType type, SINT64 id, const char* unknown)
+{
+	const ObjectKey key = {chunk.process, chunk.instance, type, id};
+
+	if (const auto description = m_objects.get(key))
+		printf("%s", description->c_str());
+	else
+		printf(unknown, id);
+}
+
+void LogDecoder::printJson(const char* name, const char* value, ULONG length)
+{
+	printf(", \"%s\": \"", name);
+
+	for (const char* const end = value + length; value < end; value++)
+	{
+		const UCHAR c = *value;
+
+		switch (c)
+		{
+			case '"':
+				printf("\\\"");
+				break;
+			case '\\':
+				printf("\\\\");
+				break;
+			case '\n':
+				printf("\\n");
+				break;
+			case '\r':
+				printf("\\r");
+				break;
+			case '\t':
+				printf("\\t");
+				break;
+			default:
+				if (c < 0x20)
+					printf("\\u%04x", c);
+				else
+					putchar(c);
+		}
+	}
+
+	putchar('"');
+}
+
+
+namespace Firebird {
+
+void decodeTraceLog(const PathName& fileName, bool json)
+{
+	FILE* const file = os_utils::fopen(fileName.c_str(), "rb");
+	if (!file)
+	{
+		(Arg::Gds(isc_io_error) << Arg::Str("fopen") << Arg::Str(fileName) <<
+			Arg::Gds(isc_io_open_err) << Arg::OsError()).raise();
+	}
+
+	try
+	{
+		LogDecoder decoder(*getDefaultMemoryPool(), fileName, json);
+		Array<UCHAR> buffer;
+
+		while (true)
+		{
+			TraceChunk chunk;
+			const size_t n = fread(&chunk, 1, sizeof(TraceChunk), file);
+
+			// The last chunk may be incomplete if the log is still being written
+
+			if (n < sizeof(TraceChunk))
+				break;
+
+			if (memcmp(chunk.signature, TRACE_LOG_SIGNATURE, sizeof(TRACE_LOG_SIGNATURE)) ||
+				chunk.version != TRACE_LOG_CURRENT_VERSION)
+			{
+				(Arg::Gds(isc_trace_param_invalid) << fileName << "INPUT").raise();
+			}
+
+			UCHAR* const data = buffer.getBuffer(chunk.length);
+
+			if (fread(data, 1, chunk.length, file) != chunk.length)
+				break;
+
+			decoder.decode(chunk, data, chunk.length);
+		}
+
+		if (ferror(file))
+		{
+			(Arg::Gds(isc_io_error) << Arg::Str("fread") << Arg::Str(fileName) <<
+				Arg::Gds(isc_io_read_err) << Arg::OsError()).raise();
+		}
+	}
+	catch (const Exception&)
+	{
+		fclose(file);
+		throw;
+	}
+
+	fclose(file);
+	fflush(stdout);
+}
+
+} // namespace Firebird
@@ -0,0 +1,36 @@
+/*
+ *	PROGRAM:		Firebird utilities
+ *	MODULE:			TraceLogDecoder.h
+ *	DESCRIPTION:	Binary trace log decoder
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef UTILITIES_TRACELOGDECODER_H
+#define UTILITIES_TRACELOGDECODER_H
+
+#include "../../common/classes/fb_string.h"
+
+namespace Firebird {
+
+// Print the binary log written by the trace plugin as text (the same way
+// as the text log is written) or as JSON, one object per line
+
+void decodeTraceLog(const PathName& fileName, bool json);
+
+} // namespace Firebird
+
+#endif // UTILITIES_TRACELOGDECODER_H
@@ -35,6 +35,7 @@
 #include "../../common/os/os_utils.h"
 #include "../../jrd/trace/TraceService.h"
 #include "../ibase.h"
+#include "TraceLogDecoder.h"
 
 #ifdef HAVE_LOCALE_H
 #include <locale.h>
@@ -60,6 +61,7 @@ public:
 	void stopSession(ULONG id) override;
 	void setActive(ULONG id, bool active) override;
 	void listSessions() override;
+	void decodeLog(const PathName& fileName, bool json) override;
 
 	os_utils::CtrlCHandler ctrlCHandler;
 
@@ -203,6 +205,11 @@ void TraceSvcUtil::listSessions()
 	runService(spb.getBufferLength(), spb.getBuffer());
 }
 
+void TraceSvcUtil::decodeLog(const PathName& fileName, bool json)
+{
+	decodeTraceLog(fileName, json);
+}
+
 void TraceSvcUtil::runService(size_t spbSize, const UCHAR* spb)
 {
 	ISC_STATUS_ARRAY status;
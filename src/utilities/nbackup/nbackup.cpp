@@ -57,6 +57,12 @@
 #include "../common/StatusArg.h"
 #include "../common/classes/objects_array.h"
 #include "../common/os/os_utils.h"
+#include "../common/status.h"
+#include "../common/Task.h"
+#include "../common/classes/condition.h"
+#include "../common/classes/Hash.h"
+#include "../common/classes/init.h"
+#include "../common/classes/zip.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -141,7 +147,7 @@ namespace
 		}
 
 		const int mainUsage[] = { 2, 3, 4, 5, 6, 0 };
-		const int notes[] = { 19, 20, 21, 22, 26, 27, 28, 79, 0 };
+		const int notes[] = { 19, 20, 21, 22, 94, 26, 27, 28, 79, 0 };
 		const Switches::in_sw_tab_t* const base = nbackup_action_in_sw_table;
 
 		for (int i = 0; mainUsage[i]; ++i)
@@ -250,6 +256,7 @@ constexpr char localhost[] = "localhost";
 
 constexpr char backup_signature[4] = {'N','B','A','K'};
 constexpr SSHORT BACKUP_VERSION = 2;
+constexpr SSHORT BACKUP_VERSION_CHUNKED = 3;
 
 struct inc_header
 {
@@ -265,6 +272,34 @@ struct inc_header
 	ULONG prev_scn;			// SCN of previous level backup
 };
 
+// Chunked backup (BACKUP_VERSION_CHUNKED) is written when compression is asked for.
+// The header page is followed by the chunks. Raw data of the chunk is the array
+// of page numbers followed by the page images, it's deflated if that makes it
+// shorter. Level 0 backup has the same layout with empty prev_guid.
+// The backup is written and read strictly sequentially, so it may be streamed
+// through pipes. The last chunk has CHUNK_END flag and no data, it holds the
+// totals, thus the truncated stream is detected.
+
+struct chunk_header
+{
+	ULONG sequence;			// Number of the chunk, for the last one number of chunks before it
+	ULONG flags;			// CHUNK_PACKED, CHUNK_END
+	ULONG start_page;		// Range of pages the chunk was collected from
+	ULONG end_page;			// (exclusive), ranges of the chunks never overlap
+	ULONG max_scn;			// Highest SCN of pages in the chunk
+	ULONG page_count;		// Number of pages in the chunk, for the last one in the backup
+	ULONG raw_length;		// Length of page numbers and page images
+	ULONG data_length;		// Length of data following the chunk header
+	ULONG checksum;			// CRC32C of data and then of the header with zero checksum
+};
+
+constexpr ULONG CHUNK_PACKED = 0x1;
+constexpr ULONG CHUNK_END = 0x2;
+constexpr ULONG CHUNK_CHECKSUM_SEED = ~0u;
+
+// Size of page range processed by a parallel worker, it's also the chunk size
+constexpr ULONG BACKUP_RANGE_SIZE = 1024 * 1024;
+
 class NBackup
 {
 public:
@@ -272,12 +307,13 @@ public:
 
 	NBackup(UtilSvc* _uSvc, const PathName& _database, const string& _username, const string& _role,
 			const string& _password, bool _run_db_triggers, bool _direct_io, const string& _deco,
-			CLEAN_HISTORY_KIND cleanHistKind, int keepHistValue)
+			CLEAN_HISTORY_KIND cleanHistKind, int keepHistValue, int parallel, bool compress)
 	  : uSvc(_uSvc), newdb(0), trans(0), database(_database),
 		username(_username), role(_role), password(_password),
 		run_db_triggers(_run_db_triggers), direct_io(_direct_io),
 		dbase(INVALID_HANDLE_VALUE), backup(INVALID_HANDLE_VALUE),
 		decompress(_deco), m_cleanHistKind(cleanHistKind), m_keepHistValue(keepHistValue),
+		m_parallel(parallel), m_compress(compress),
 		childId(0), db_size_pages(0),
 		m_odsNumber(0), m_silent(false), m_printed(false), m_flash_map(false)
 	{
@@ -315,6 +351,7 @@ public:
 	void unlock_database();
 	void backup_database(int level, const string& guidStr, const PathName& fname);
 	void restore_database(const BackupFiles& files, bool repl_seq, bool inc_rest);
+	void verify_backup(const BackupFiles& files);
 
 	bool printed() const noexcept
 	{
@@ -339,6 +376,8 @@ private:
 	string decompress;
 	const CLEAN_HISTORY_KIND m_cleanHistKind;
 	const int m_keepHistValue;
+	const int m_parallel;	// number of parallel workers
+	const bool m_compress;	// write chunked compressed backup
 #ifdef WIN_NT
 	HANDLE childId;
 	HANDLE childStdErr;
@@ -355,6 +394,9 @@ private:
 	FB_SIZE_T read_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize);
 	void write_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize);
 	void seek_file(FILE_HANDLE &file, SINT64 pos);
+	// Positional IO, may be used by parallel workers sharing the handle
+	FB_SIZE_T read_at(FILE_HANDLE &file, SINT64 pos, void *buffer, FB_SIZE_T bufsize);
+	void write_at(FILE_HANDLE &file, SINT64 pos, const void *buffer, FB_SIZE_T bufsize);
 
 	void pr_error(const ISC_STATUS* status, const char* operation);
 	void print_child_stderr();
@@ -378,6 +420,17 @@ private:
 	void open_backup_decompress();
 	void create_backup();
 	void close_backup();
+
+	// Parallel and chunked backup/restore
+	class BackupTask;
+	class RestoreTask;
+
+	void backup_pages(int level, ULONG page_size, ULONG backup_scn, ULONG prev_scn,
+		ULONG& page_reads, ULONG& page_writes);
+	ULONG restore_pages(const inc_header& bakheader, bool verify);
+
+	void check_backup_header(const inc_header& bakheader, int curLevel, const std::optional<Guid>& prev_guid);
+	ULONG verify_image(const void* prefix, FB_SIZE_T prefixLength, std::optional<Guid>& guid);
 };
 
 FB_SIZE_T NBackup::read_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize)
@@ -412,6 +465,8 @@ FB_SIZE_T NBackup::read_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize)
 		if (res < 0)
 		{
 			const int err = errno;
+			if (SYSCALL_INTERRUPTED(err))
+				continue;
 #endif
 			status_exception::raise(Arg::Gds(isc_nbackup_err_read) <<
 				(&file == &dbase ? dbname.c_str() :
@@ -435,14 +490,26 @@ FB_SIZE_T NBackup::read_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize)
 
 void NBackup::write_file(FILE_HANDLE &file, void *buffer, FB_SIZE_T bufsize)
 {
+	// Pipe may accept the data partially
+	while (bufsize)
+	{
 #ifdef WIN_NT
-	DWORD bytesDone;
-	if (WriteFile(file, buffer, bufsize, &bytesDone, NULL) && bytesDone == bufsize)
-		return;
+		DWORD bytesDone;
+		if (!WriteFile(file, buffer, bufsize, &bytesDone, NULL) || !bytesDone)
+			break;
 #else
-	if (write(file, buffer, bufsize) == (ssize_t) bufsize)
-		return;
+		const ssize_t bytesDone = write(file, buffer, bufsize);
+		if (bytesDone < 0 && SYSCALL_INTERRUPTED(errno))
+			continue;
+		if (bytesDone <= 0)
+			break;
 #endif
+		bufsize -= bytesDone;
+		buffer = &((UCHAR*) buffer)[bytesDone];
+	}
+
+	if (!bufsize)
+		return;
 
 	status_exception::raise(Arg::Gds(isc_nbackup_err_write) <<
 		(&file == &dbase ? dbname.c_str() :
@@ -472,6 +539,71 @@ void NBackup::seek_file(FILE_HANDLE &file, SINT64 pos)
 		Arg::OsError());
 }
 
+FB_SIZE_T NBackup::read_at(FILE_HANDLE &file, SINT64 pos, void *buffer, FB_SIZE_T bufsize)
+{
+	FB_SIZE_T rc = 0;
+	while (bufsize)
+	{
+#ifdef WIN_NT
+		OVERLAPPED overlapped;
+		memset(&overlapped, 0, sizeof(OVERLAPPED));
+		overlapped.Offset = (DWORD) pos;
+		overlapped.OffsetHigh = (DWORD) (pos >> 32);
+
+		DWORD res;
+		if (!ReadFile(file, buffer, bufsize, &res, &overlapped))
+		{
+			const DWORD err = GetLastError();
+			if (err == ERROR_HANDLE_EOF)
+				break;
+#else
+		const ssize_t res = os_utils::pread(file, buffer, bufsize, pos);
+		if (res < 0)
+		{
+			const int err = errno;
+			if (SYSCALL_INTERRUPTED(err))
+				continue;
+#endif
+			status_exception::raise(Arg::Gds(isc_nbackup_err_read) <<
+				(&file == &dbase ? dbname.c_str() :
+					&file == &backup ? bakname.c_str() : "unknown") <<
+				Arg::OsError(err));
+		}
+
+		if (!res)
+			break;
+
+		rc += res;
+		pos += res;
+		bufsize -= res;
+		buffer = &((UCHAR*) buffer)[res];
+	}
+
+	return rc;
+}
+
+void NBackup::write_at(FILE_HANDLE &file, SINT64 pos, const void *buffer, FB_SIZE_T bufsize)
+{
+#ifdef WIN_NT
+	OVERLAPPED overlapped;
+	memset(&overlapped, 0, sizeof(OVERLAPPED));
+	overlapped.Offset = (DWORD) pos;
+	overlapped.OffsetHigh = (DWORD) (pos >> 32);
+
+	DWORD bytesDone;
+	if (WriteFile(file, buffer, bufsize, &bytesDone, &overlapped) && bytesDone == bufsize)
+		return;
+#else
+	if (os_utils::pwrite(file, buffer, bufsize, pos) == (ssize_t) bufsize)
+		return;
+#endif
+
+	status_exception::raise(Arg::Gds(isc_nbackup_err_write) <<
+		(&file == &dbase ? dbname.c_str() :
+			&file == &backup ? bakname.c_str() : "unknown") <<
+		Arg::OsError());
+}
+
 void NBackup::open_database_write(bool exclusive)
 {
 #ifdef WIN_NT
@@ -608,6 +740,16 @@ void NBackup::open_backup_scan()
 		return;
 	}
 
+	if (bakname == "stdin")
+	{
+#ifdef WIN_NT
+		backup = GetStdHandle(STD_INPUT_HANDLE);
+#else
+		backup = 0; // Posix file handle for stdin
+#endif
+		return;
+	}
+
 #ifdef WIN_NT
 	backup = CreateFile(bakname.c_str(), GENERIC_READ, 0,
 		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
@@ -797,7 +939,7 @@ void NBackup::create_backup()
 
 void NBackup::close_backup()
 {
-	if (bakname == "stdout")
+	if (bakname == "stdout" || (bakname == "stdin" && decompress.isEmpty()))
 		return;
 
 	if (backup == INVALID_HANDLE_VALUE)
@@ -1394,14 +1536,14 @@ void NBackup::backup_database(int level, const string& guidStr, const PathName&
 
 		// Write data to backup file
 		ULONG backup_scn = header->hdr_header.pag_scn - 1;
-		if (level)
+		if (level || m_compress)
 		{
 			inc_header bh;
 			memcpy(bh.signature, backup_signature, sizeof(backup_signature));
-			bh.version = BACKUP_VERSION;
+			bh.version = m_compress ? BACKUP_VERSION_CHUNKED : BACKUP_VERSION;
 			bh.level = level > 0 ? level : 0;
 			backup_guid.value().copyTo(bh.backup_guid);
-			prev_guid.value().copyTo(bh.prev_guid);
+			prev_guid.value_or(Guid::empty()).copyTo(bh.prev_guid);
 			bh.page_size = header->hdr_page_size;
 			bh.backup_scn = backup_scn;
 			bh.prev_scn = prev_scn;
@@ -1416,116 +1558,124 @@ void NBackup::backup_database(int level, const string& guidStr, const PathName&
 				status_exception::raise(Arg::Gds(isc_nbackup_err_eofhdrdb) << dbname.c_str() << Arg::Num(2));
 		}
 
-		ULONG curPage = 0;
-		ULONG lastPage = FIRST_PIP_PAGE;
-		const ULONG pagesPerPIP = Ods::pagesPerPIP(header->hdr_page_size);
+		if (m_parallel > 1 || m_compress)
+		{
+			backup_pages(level, header->hdr_page_size, backup_scn, prev_scn, page_reads, page_writes);
+		}
+		else
+		{
+			ULONG curPage = 0;
+			ULONG lastPage = FIRST_PIP_PAGE;
+			const ULONG pagesPerPIP = Ods::pagesPerPIP(header->hdr_page_size);
 
-		ULONG scnsSlot = 0;
-		const ULONG pagesPerSCN = Ods::pagesPerSCN(header->hdr_page_size);
+			ULONG scnsSlot = 0;
+			const ULONG pagesPerSCN = Ods::pagesPerSCN(header->hdr_page_size);
 
-		Array<UCHAR> scns_buffer;
-		Ods::scns_page* scns = NULL;
-		Ods::scns_page* scns_buf = reinterpret_cast<Ods::scns_page*>
-			(scns_buffer.getAlignedBuffer(header->hdr_page_size, ioBlockSize));
+			Array<UCHAR> scns_buffer;
+			Ods::scns_page* scns = NULL;
+			Ods::scns_page* scns_buf = reinterpret_cast<Ods::scns_page*>
+				(scns_buffer.getAlignedBuffer(header->hdr_page_size, ioBlockSize));
 
-		while (true)
-		{
-			if (curPage && page_buff->pag_scn > backup_scn)
+			while (true)
 			{
-				status_exception::raise(Arg::Gds(isc_nbackup_page_changed) << Arg::Num(curPage) <<
-										Arg::Num(page_buff->pag_scn) << Arg::Num(backup_scn));
-			}
+				if (curPage && page_buff->pag_scn > backup_scn)
+				{
+					status_exception::raise(Arg::Gds(isc_nbackup_page_changed) << Arg::Num(curPage) <<
+											Arg::Num(page_buff->pag_scn) << Arg::Num(backup_scn));
+				}
 
-			if (!level || page_buff->pag_scn > prev_scn)
-			{
-				write_file(backup, page_buff, header->hdr_page_size);
-				page_writes++;
-			}
+				if (!level || page_buff->pag_scn > prev_scn)
+				{
+					write_file(backup, page_buff, header->hdr_page_size);
+					page_writes++;
+				}
 
-			checkCtrlC(uSvc);
+				checkCtrlC(uSvc);
 
-			if ((db_size_pages != 0) && (db_size == 0))
-				break;
+				if ((db_size_pages != 0) && (db_size == 0))
+					break;
 
-			if (level)
-			{
-				fb_assert(scnsSlot < pagesPerSCN);
-				fb_assert(scns && scns->scn_sequence * pagesPerSCN + scnsSlot == curPage ||
-						 !scns && curPage % pagesPerSCN == scnsSlot);
+				if (level)
+				{
+					fb_assert(scnsSlot < pagesPerSCN);
+					fb_assert(scns && scns->scn_sequence * pagesPerSCN + scnsSlot == curPage ||
+							 !scns && curPage % pagesPerSCN == scnsSlot);
 
-				const ULONG nextSCN = scns ? (scns->scn_sequence + 1) * pagesPerSCN : FIRST_SCN_PAGE;
+					const ULONG nextSCN = scns ? (scns->scn_sequence + 1) * pagesPerSCN : FIRST_SCN_PAGE;
 
-				while (true)
-				{
-					curPage++;
-					scnsSlot++;
-					if (!scns || scns->scn_pages[scnsSlot] > prev_scn ||
-						scnsSlot == pagesPerSCN ||
-						curPage == nextSCN ||
-						curPage == lastPage)
+					while (true)
 					{
-						seek_file(dbase, (SINT64) curPage * header->hdr_page_size);
-						break;
+						curPage++;
+						scnsSlot++;
+						if (!scns || scns->scn_pages[scnsSlot] > prev_scn ||
+							scnsSlot == pagesPerSCN ||
+							curPage == nextSCN ||
+							curPage == lastPage)
+						{
+							seek_file(dbase, (SINT64) curPage * header->hdr_page_size);
+							break;
+						}
 					}
-				}
 
-				if (scnsSlot == pagesPerSCN)
-				{
-					scnsSlot = 0;
-					scns = NULL;
-				}
+					if (scnsSlot == pagesPerSCN)
+					{
+						scnsSlot = 0;
+						scns = NULL;
+					}
 
-				fb_assert(scnsSlot < pagesPerSCN);
-				fb_assert(scns && scns->scn_sequence * pagesPerSCN + scnsSlot == curPage ||
-						 !scns && curPage % pagesPerSCN == scnsSlot);
-			}
-			else
-				curPage++;
+					fb_assert(scnsSlot < pagesPerSCN);
+					fb_assert(scns && scns->scn_sequence * pagesPerSCN + scnsSlot == curPage ||
+							 !scns && curPage % pagesPerSCN == scnsSlot);
+				}
+				else
+					curPage++;
 
 
-			const FB_SIZE_T bytesDone = read_file(dbase, page_buff, header->hdr_page_size);
-			--db_size;
-			page_reads++;
-			if (bytesDone == 0)
-				break;
-			if (bytesDone != header->hdr_page_size)
-				status_exception::raise(Arg::Gds(isc_nbackup_dbsize_inconsistent));
+				const FB_SIZE_T bytesDone = read_file(dbase, page_buff, header->hdr_page_size);
+				--db_size;
+				page_reads++;
+				if (bytesDone == 0)
+					break;
+				if (bytesDone != header->hdr_page_size)
+					status_exception::raise(Arg::Gds(isc_nbackup_dbsize_inconsistent));
 
-			if (level && page_buff->pag_type == pag_scns)
-			{
-				fb_assert(scnsSlot == 0 || scnsSlot == FIRST_SCN_PAGE);
+				if (level && page_buff->pag_type == pag_scns)
+				{
+					fb_assert(scnsSlot == 0 || scnsSlot == FIRST_SCN_PAGE);
 
-				// pick up next SCN's page
-				memcpy(scns_buf, page_buff, header->hdr_page_size);
-				scns = scns_buf;
-			}
+					// pick up next SCN's page
+					memcpy(scns_buf, page_buff, header->hdr_page_size);
+					scns = scns_buf;
+				}
 
 
-			if (curPage == lastPage)
-			{
-				// Starting from ODS 11.1 we can expand file but never use some last
-				// pages in it. There are no need to backup this empty pages. More,
-				// we can't be sure its not used pages have right SCN assigned.
-				// How many pages are really used we know from page_inv_page::pip_used
-				// where stored number of pages allocated from this pointer page.
-				if (page_buff->pag_type == pag_pages)
+				if (curPage == lastPage)
 				{
-					Ods::page_inv_page* pip = (Ods::page_inv_page*) page_buff;
-					if (lastPage == FIRST_PIP_PAGE)
-						lastPage = pip->pip_used - 1;
+					// Starting from ODS 11.1 we can expand file but never use some last
+					// pages in it. There are no need to backup this empty pages. More,
+					// we can't be sure its not used pages have right SCN assigned.
+					// How many pages are really used we know from page_inv_page::pip_used
+					// where stored number of pages allocated from this pointer page.
+					if (page_buff->pag_type == pag_pages)
+					{
+						Ods::page_inv_page* pip = (Ods::page_inv_page*) page_buff;
+						if (lastPage == FIRST_PIP_PAGE)
+							lastPage = pip->pip_used - 1;
+						else
+							lastPage += pip->pip_used;
+
+						if (pip->pip_used < pagesPerPIP)
+							lastPage++;
+					}
 					else
-						lastPage += pip->pip_used;
-
-					if (pip->pip_used < pagesPerPIP)
-						lastPage++;
-				}
-				else
-				{
-					fb_assert(page_buff->pag_type == pag_undefined);
-					break;
+					{
+						fb_assert(page_buff->pag_type == pag_undefined);
+						break;
+					}
 				}
 			}
 		}
+
 		close_database();
 		close_backup();
 
@@ -1740,48 +1890,31 @@ void NBackup::restore_database(const BackupFiles& files, bool repl_seq, bool inc
 					status_exception::raise(Arg::Gds(isc_nbackup_err_eofhdrbk) << bakname.c_str());
 				if (memcmp(bakheader.signature, backup_signature, sizeof(backup_signature)) != 0)
 					status_exception::raise(Arg::Gds(isc_nbackup_invalid_incbk) << bakname.c_str());
-				if (bakheader.version != BACKUP_VERSION)
-				{
-					status_exception::raise(Arg::Gds(isc_nbackup_unsupvers_incbk) <<
-										Arg::Num(bakheader.version) << bakname.c_str());
-				}
-				if (bakheader.level && bakheader.level != curLevel)
-				{
-					status_exception::raise(Arg::Gds(isc_nbackup_invlevel_incbk) <<
-						Arg::Num(bakheader.level) << bakname.c_str() << Arg::Num(curLevel));
-				}
-				// We may also add SCN check, but GUID check covers this case too
-				if (Guid(bakheader.prev_guid) != prev_guid.value())
-					status_exception::raise(Arg::Gds(isc_nbackup_wrong_orderbk) << bakname.c_str());
-
-				// Emulate seek_file(backup, bakheader.page_size)
-				// Backup is stream-oriented, if -decompress is used pipe can't be seek()'ed
-				FB_SIZE_T left = bakheader.page_size - sizeof(bakheader);
-				while (left)
-				{
-					char char_buf[1024];
-					const FB_SIZE_T step = left > sizeof(char_buf) ? sizeof(char_buf) : left;
-					if (read_file(backup, &char_buf, step) != step)
-						status_exception::raise(Arg::Gds(isc_nbackup_err_eofhdrbk) << bakname.c_str());
-					left -= step;
-				}
+
+				check_backup_header(bakheader, curLevel, prev_guid);
 
 				if (!inc_rest)
 					delete_database = true;
 				prev_guid = bakheader.backup_guid;
-				const auto page_ptr = page_buffer.begin();
-				while (true)
+
+				if (bakheader.version == BACKUP_VERSION_CHUNKED || m_parallel > 1)
+					restore_pages(bakheader, false);
+				else
 				{
-					const FB_SIZE_T bytesDone = read_file(backup, page_ptr, bakheader.page_size);
-					if (bytesDone == 0)
-						break;
-					if (bytesDone != bakheader.page_size) {
-						status_exception::raise(Arg::Gds(isc_nbackup_err_eofbk) << bakname.c_str());
+					const auto page_ptr = page_buffer.getBuffer(bakheader.page_size);
+					while (true)
+					{
+						const FB_SIZE_T bytesDone = read_file(backup, page_ptr, bakheader.page_size);
+						if (bytesDone == 0)
+							break;
+						if (bytesDone != bakheader.page_size) {
+							status_exception::raise(Arg::Gds(isc_nbackup_err_eofbk) << bakname.c_str());
+						}
+						const SINT64 pageNum = reinterpret_cast<Ods::pag*>(page_ptr)->pag_pageno;
+						seek_file(dbase, pageNum * bakheader.page_size);
+						write_file(dbase, page_ptr, bakheader.page_size);
+						checkCtrlC(uSvc);
 					}
-					const SINT64 pageNum = reinterpret_cast<Ods::pag*>(page_ptr)->pag_pageno;
-					seek_file(dbase, pageNum * bakheader.page_size);
-					write_file(dbase, page_ptr, bakheader.page_size);
-					checkCtrlC(uSvc);
 				}
 				delete_database = false;
 			}
@@ -1791,14 +1924,33 @@ void NBackup::restore_database(const BackupFiles& files, bool repl_seq, bool inc
 				{
 					// Use relatively small buffer to make use of prefetch and lazy flush
 					char buffer[65536];
-					while (true)
+
+					// Chunked level 0 backup starts with the incremental backup header,
+					// the plain one is the database image starting with the header page
+
+					inc_header bakheader;
+					FB_SIZE_T bytesRead = read_file(backup, &bakheader, sizeof(bakheader));
+
+					if (bytesRead == sizeof(bakheader) &&
+						memcmp(bakheader.signature, backup_signature, sizeof(backup_signature)) == 0)
 					{
-						const FB_SIZE_T bytesRead = read_file(backup, buffer, sizeof(buffer));
-						if (bytesRead == 0)
-							break;
-						write_file(dbase, buffer, bytesRead);
-						checkCtrlC(uSvc);
+						check_backup_header(bakheader, 0, std::nullopt);
+						restore_pages(bakheader, false);
 					}
+					else
+					{
+						write_file(dbase, &bakheader, bytesRead);
+
+						while (bytesRead)
+						{
+							bytesRead = read_file(backup, buffer, sizeof(buffer));
+							if (bytesRead == 0)
+								break;
+							write_file(dbase, buffer, bytesRead);
+							checkCtrlC(uSvc);
+						}
+					}
+
 					seek_file(dbase, 0);
 				}
 				else
@@ -1852,103 +2004,1118 @@ void NBackup::restore_database(const BackupFiles& files, bool repl_seq, bool inc
 	}
 }
 
-int NBACKUP_main(UtilSvc* uSvc)
+#ifdef HAVE_ZLIB_H
+namespace
 {
-	int exit_code = FB_SUCCESS;
+	InitInstance<ZLib> zlib;
+}
+#endif
 
-	try {
-		nbackup(uSvc);
+// Backup of page ranges by parallel workers. Every worker reads its range and
+// picks up the pages to be backed up, the ranges are written into the backup
+// in their order by the worker that completed the oldest outstanding range.
+// The number of ranges in flight is limited by the number of items.
+
+class NBackup::BackupTask : public Task
+{
+public:
+	BackupTask(NBackup* nbk, int level, ULONG pageSize, ULONG endPage, ULONG backupScn, ULONG prevScn)
+		: m_nbk(nbk), m_level(level), m_pageSize(pageSize), m_endPage(endPage),
+		  m_backupScn(backupScn), m_prevScn(prevScn),
+		  m_rangePages(MAX(1, BACKUP_RANGE_SIZE / pageSize)),
+		  m_pagesPerSCN(Ods::pagesPerSCN(pageSize)),
+		  m_nextPage(0), m_nextSeq(0), m_writeSeq(0),
+		  m_pageReads(0), m_pageWrites(0), m_chunks(0),
+		  m_writing(false), m_stop(false), m_error(false)
+	{
+		for (int i = 0; i < 2 * m_nbk->m_parallel; i++)
+			m_items.add(FB_NEW Item(this));
 	}
-	catch (const status_exception& e)
+
+	~BackupTask()
 	{
-		if (!uSvc->isService())
-		{
-			const ISC_STATUS* s = e.value();
-			isc_print_status(s);
-		}
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			delete *p;
+	}
 
- 		StaticStatusVector status;
- 		e.stuffException(status);
+	bool handler(WorkItem& wi) override;
+	bool getWorkItem(WorkItem** pItem) override;
+	bool getResult(IStatus* status) override;
 
-		UtilSvc::StatusAccessor sa = uSvc->getStatusAccessor();
-		sa.init();
- 		sa.setServiceStatus(status.begin());
+	int getMaxWorkers() override
+	{
+		return m_nbk->m_parallel;
+	}
 
-		exit_code = FB_FAILURE;
+	ULONG getPageReads() const
+	{
+		return m_pageReads;
 	}
-	catch (const Exception& e)
+
+	ULONG getPageWrites() const
 	{
-		if (!uSvc->isService())
-			fprintf(stderr, "%s\n", e.what());
+		return m_pageWrites;
+	}
 
- 		StaticStatusVector status;
- 		e.stuffException(status);
+	void writeEnd();
 
-		UtilSvc::StatusAccessor sa = uSvc->getStatusAccessor();
-		sa.init();
- 		sa.setServiceStatus(status.begin());
+private:
+	class Item : public WorkItem
+	{
+	public:
+		enum State { FREE, BUSY, READY };
+
+		explicit Item(BackupTask* task)
+			: WorkItem(task),
+			  m_state(FREE), m_seq(0), m_startPage(0), m_endPage(0),
+			  m_count(0), m_reads(0), m_maxScn(0), m_checksum(0),
+			  m_packedLength(0), m_packed(false), m_pages(NULL)
+		{}
+
+		State m_state;
+		ULONG m_seq;			// order of the range in the backup
+		ULONG m_startPage;
+		ULONG m_endPage;
+		ULONG m_count;			// number of pages to be written
+		ULONG m_reads;
+		ULONG m_maxScn;
+		ULONG m_checksum;		// checksum of chunk data
+		ULONG m_packedLength;
+		bool m_packed;
+		UCHAR* m_pages;			// images of pages to be written
+		Array<UCHAR> m_pageBuffer;
+		Array<UCHAR> m_scnBuffer;
+		Array<ULONG> m_numbers;
+		Array<UCHAR> m_packBuffer;
+	};
+
+	bool mustRead(const Ods::scns_page* scns, ULONG scnPage, ULONG page) const
+	{
+		return !scns || page <= scnPage || scns->scn_pages[page % m_pagesPerSCN] > m_prevScn;
+	}
+
+	void readRange(Item& item);
+	bool pack(Item& item);
+	ULONG checksum(const Item& item) const;
+	void writeItem(Item& item);
+	void writeChunk(chunk_header& chunk);
+
+	NBackup* const m_nbk;
+	const int m_level;
+	const ULONG m_pageSize;
+	const ULONG m_endPage;
+	const ULONG m_backupScn;
+	const ULONG m_prevScn;
+	const ULONG m_rangePages;
+	const ULONG m_pagesPerSCN;
+
+	Mutex m_mutex;
+	Condition m_cond;
+	HalfStaticArray<Item*, 8> m_items;
+	ULONG m_nextPage;
+	ULONG m_nextSeq;
+	ULONG m_writeSeq;
+	ULONG m_pageReads;
+	ULONG m_pageWrites;
+	ULONG m_chunks;
+	FbLocalStatus m_status;
+	bool m_writing;
+	bool m_stop;
+	bool m_error;
+};
 
-		exit_code = FB_FAILURE;
+bool NBackup::BackupTask::getWorkItem(WorkItem** pItem)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	// Wait until the item to be used for the next range is written
+
+	Item* item;
+	while (true)
+	{
+		if (m_stop || m_nextPage >= m_endPage)
+			return false;
+
+		item = m_items[m_nextSeq % m_items.getCount()];
+		if (item->m_state == Item::FREE)
+			break;
+
+		m_cond.wait(m_mutex);
 	}
 
-	return exit_code;
-}
+	// Ranges never cross the boundary of the pages described by the same SCN page
 
-enum NbOperation {nbNone, nbLock, nbUnlock, nbFixup, nbBackup, nbRestore};
+	const ULONG groupEnd = (m_nextPage / m_pagesPerSCN + 1) * m_pagesPerSCN;
 
-void nbackup(UtilSvc* uSvc)
-{
-	UtilSvc::ArgvType& argv = uSvc->argv;
-	const int argc = argv.getCount();
+	item->m_state = Item::BUSY;
+	item->m_seq = m_nextSeq++;
+	item->m_startPage = m_nextPage;
+	item->m_endPage = MIN(MIN(m_nextPage + m_rangePages, groupEnd), m_endPage);
+	m_nextPage = item->m_endPage;
 
-	NbOperation op = nbNone;
-	string username, role, password;
-	PathName database, filename;
-	string decompress;
-	bool run_db_triggers = true;
-	bool direct_io =
-#ifdef WIN_NT
-		true;
-#else
-		false;
-#endif
-	NBackup::BackupFiles backup_files;
-	int level = -1;
-	std::optional<Guid> guid;
-	bool print_size = false, version = false, inc_rest = false, repl_seq = false;
-	string onOff;
-	bool cleanHistory = false;
-	NBackup::CLEAN_HISTORY_KIND cleanHistKind = NBackup::CLEAN_HISTORY_KIND::NONE;
-	int keepHistValue = 0;
+	*pItem = item;
+	return true;
+}
 
-	const Switches switches(nbackup_action_in_sw_table, FB_NELEM(nbackup_action_in_sw_table),
-							false, true);
+bool NBackup::BackupTask::handler(WorkItem& wi)
+{
+	Item& item = static_cast<Item&>(wi);
 
-	// Read global command line parameters
-	for (int itr = 1; itr < argc; ++itr)
+	try
 	{
-		// We must recognize all parameters here
-		if (argv[itr][0] != '-') {
-			usage(uSvc, isc_nbackup_unknown_param, argv[itr]);
-		}
+		readRange(item);
 
-		const Switches::in_sw_tab_t* rc = switches.findSwitch(argv[itr]);
-		if (!rc)
+		if (m_nbk->m_compress && item.m_count)
 		{
-			usage(uSvc, isc_nbackup_unknown_switch, argv[itr]);
-			break;
+			item.m_packed = pack(item);
+			item.m_checksum = checksum(item);
 		}
 
-		switch (rc->in_sw)
-		{
-		case IN_SW_NBK_USER_NAME:
-			if (++itr >= argc)
-				missingParameterForSwitch(uSvc, argv[itr - 1]);
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
 
-			username = argv[itr];
-			break;
+		item.m_state = Item::READY;
+		m_pageReads += item.m_reads;
 
-		case IN_SW_NBK_ROLE:
+		if (!m_writing)
+		{
+			m_writing = true;
+
+			while (!m_stop)
+			{
+				Item* const next = m_items[m_writeSeq % m_items.getCount()];
+				if (next->m_state != Item::READY)
+					break;
+
+				fb_assert(next->m_seq == m_writeSeq);
+
+				{ // scope
+					MutexUnlockGuard unlock(m_mutex, FB_FUNCTION);
+					writeItem(*next);
+				}
+
+				m_pageWrites += next->m_count;
+				next->m_state = Item::FREE;
+				m_writeSeq++;
+				m_cond.notifyAll();
+			}
+
+			m_writing = false;
+		}
+	}
+	catch (const Exception& ex)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (!m_error)
+		{
+			ex.stuffException(&m_status);
+			m_error = true;
+		}
+
+		m_stop = true;
+		m_cond.notifyAll();
+	}
+
+	return !m_stop;
+}
+
+bool NBackup::BackupTask::getResult(IStatus* status)
+{
+	if (m_error && status)
+		status->setErrors(m_status->getErrors());
+
+	return !m_error;
+}
+
+void NBackup::BackupTask::readRange(Item& item)
+{
+	const ULONG ioBlockSize = m_nbk->direct_io ? DIRECT_IO_BLOCK_SIZE : PAGE_ALIGNMENT;
+
+	item.m_count = 0;
+	item.m_reads = 0;
+	item.m_maxScn = 0;
+	item.m_numbers.clear();
+	item.m_pages = item.m_pageBuffer.getAlignedBuffer(m_rangePages * m_pageSize, ioBlockSize);
+
+	// Incremental backup reads only pages marked by SCN page as changed after
+	// the previous backup. Pages preceding the first SCN page are always read.
+
+	const Ods::scns_page* scns = NULL;
+	ULONG scnPage = 0;
+
+	if (m_level)
+	{
+		const ULONG group = item.m_startPage / m_pagesPerSCN;
+		scnPage = group ? group * m_pagesPerSCN : FIRST_SCN_PAGE;
+
+		Ods::scns_page* const scns_buf = reinterpret_cast<Ods::scns_page*>
+			(item.m_scnBuffer.getAlignedBuffer(m_pageSize, ioBlockSize));
+
+		if (m_nbk->read_at(m_nbk->dbase, (SINT64) scnPage * m_pageSize, scns_buf, m_pageSize) == m_pageSize)
+		{
+			item.m_reads++;
+
+			if (scns_buf->scn_header.pag_type == pag_scns)
+				scns = scns_buf;
+		}
+	}
+
+	ULONG curPage = item.m_startPage;
+	while (curPage < item.m_endPage)
+	{
+		if (!mustRead(scns, scnPage, curPage))
+		{
+			curPage++;
+			continue;
+		}
+
+		// Read the run of adjacent pages at once
+
+		ULONG lastPage = curPage + 1;
+		while (lastPage < item.m_endPage && mustRead(scns, scnPage, lastPage))
+			lastPage++;
+
+		UCHAR* const buffer = item.m_pages + item.m_count * m_pageSize;
+		const FB_SIZE_T bytesDone = m_nbk->read_at(m_nbk->dbase, (SINT64) curPage * m_pageSize,
+			buffer, (lastPage - curPage) * m_pageSize);
+
+		if (bytesDone % m_pageSize)
+			status_exception::raise(Arg::Gds(isc_nbackup_dbsize_inconsistent));
+
+		const ULONG pagesDone = bytesDone / m_pageSize;
+		item.m_reads += pagesDone;
+
+		for (ULONG i = 0; i < pagesDone; i++, curPage++)
+		{
+			Ods::pag* const page = reinterpret_cast<Ods::pag*>(buffer + i * m_pageSize);
+
+			if (curPage && page->pag_scn > m_backupScn)
+			{
+				status_exception::raise(Arg::Gds(isc_nbackup_page_changed) << Arg::Num(curPage) <<
+										Arg::Num(page->pag_scn) << Arg::Num(m_backupScn));
+			}
+
+			if (!m_level || page->pag_scn > m_prevScn)
+			{
+				UCHAR* const target = item.m_pages + item.m_count * m_pageSize;
+				if (target != reinterpret_cast<UCHAR*>(page))
+					memmove(target, page, m_pageSize);
+
+				item.m_numbers.add(curPage);
+				item.m_count++;
+
+				if (page->pag_scn > item.m_maxScn)
+					item.m_maxScn = page->pag_scn;
+			}
+		}
+
+		checkCtrlC(m_nbk->uSvc);
+
+		if (curPage < lastPage)
+			break;	// end of file
+	}
+}
+
+bool NBackup::BackupTask::pack(Item& item)
+{
+	// Deflate page numbers and page images, return false if it's not worth it
+
+#ifdef HAVE_ZLIB_H
+	if (!zlib())
+		return false;
+
+	z_stream strm;
+	strm.zalloc = ZLib::allocFunc;
+	strm.zfree = ZLib::freeFunc;
+	strm.opaque = Z_NULL;
+
+	if (zlib().deflateInit_(&strm, Z_BEST_SPEED, ZLIB_VERSION, sizeof(z_stream)) != Z_OK)
+		return false;
+
+	// Don't allow the packed chunk to be longer than the raw one
+
+	const ULONG numbersLength = item.m_count * sizeof(ULONG);
+	const ULONG rawLength = numbersLength + item.m_count * m_pageSize;
+
+	strm.next_in = reinterpret_cast<Bytef*>(item.m_numbers.begin());
+	strm.avail_in = numbersLength;
+	strm.next_out = item.m_packBuffer.getBuffer(rawLength);
+	strm.avail_out = rawLength;
+
+	int ret = zlib().deflate(&strm, Z_NO_FLUSH);
+
+	if (ret == Z_OK)
+	{
+		strm.next_in = item.m_pages;
+		strm.avail_in = item.m_count * m_pageSize;
+
+		ret = zlib().deflate(&strm, Z_FINISH);
+	}
+
+	item.m_packedLength = (ULONG) strm.total_out;
+	zlib().deflateEnd(&strm);
+
+	return (ret == Z_STREAM_END);
+#else
+	return false;
+#endif
+}
+
+ULONG NBackup::BackupTask::checksum(const Item& item) const
+{
+	if (item.m_packed)
+		return Crc32C::update(CHUNK_CHECKSUM_SEED, item.m_packedLength, item.m_packBuffer.begin());
+
+	const ULONG crc = Crc32C::update(CHUNK_CHECKSUM_SEED, item.m_count * sizeof(ULONG),
+		reinterpret_cast<const UCHAR*>(item.m_numbers.begin()));
+
+	return Crc32C::update(crc, item.m_count * m_pageSize, item.m_pages);
+}
+
+void NBackup::BackupTask::writeChunk(chunk_header& chunk)
+{
+	// Checksum of the data is already in the header, finish it with the header itself
+
+	const ULONG crc = chunk.checksum;
+	chunk.checksum = 0;
+	chunk.checksum = Crc32C::update(crc, sizeof(chunk), reinterpret_cast<const UCHAR*>(&chunk));
+
+	m_nbk->write_file(m_nbk->backup, &chunk, sizeof(chunk));
+}
+
+void NBackup::BackupTask::writeEnd()
+{
+	chunk_header chunk;
+	memset(&chunk, 0, sizeof(chunk));
+	chunk.sequence = m_chunks;
+	chunk.flags = CHUNK_END;
+	chunk.end_page = m_endPage;
+	chunk.max_scn = m_backupScn;
+	chunk.page_count = m_pageWrites;
+	chunk.checksum = CHUNK_CHECKSUM_SEED;
+
+	writeChunk(chunk);
+}
+
+void NBackup::BackupTask::writeItem(Item& item)
+{
+	if (!item.m_count)
+		return;
+
+	if (!m_nbk->m_compress)
+	{
+		// Plain incremental backup stores page images only
+		m_nbk->write_file(m_nbk->backup, item.m_pages, item.m_count * m_pageSize);
+		return;
+	}
+
+	const ULONG numbersLength = item.m_count * sizeof(ULONG);
+
+	chunk_header chunk;
+	chunk.sequence = m_chunks++;
+	chunk.flags = item.m_packed ? CHUNK_PACKED : 0;
+	chunk.start_page = item.m_startPage;
+	chunk.end_page = item.m_endPage;
+	chunk.max_scn = item.m_maxScn;
+	chunk.page_count = item.m_count;
+	chunk.raw_length = numbersLength + item.m_count * m_pageSize;
+	chunk.data_length = item.m_packed ? item.m_packedLength : chunk.raw_length;
+	chunk.checksum = item.m_checksum;
+
+	writeChunk(chunk);
+
+	if (item.m_packed)
+		m_nbk->write_file(m_nbk->backup, item.m_packBuffer.begin(), item.m_packedLength);
+	else
+	{
+		m_nbk->write_file(m_nbk->backup, item.m_numbers.begin(), numbersLength);
+		m_nbk->write_file(m_nbk->backup, item.m_pages, item.m_count * m_pageSize);
+	}
+}
+
+// Restore of pages by parallel workers. Units of the backup (chunks or runs of
+// page images) are read serially, then workers check, unpack and write them
+// into the database. Every page is present in the backup file once, so the
+// order of writes doesn't matter. Verification does the same except writing.
+
+class NBackup::RestoreTask : public Task
+{
+public:
+	RestoreTask(NBackup* nbk, const inc_header& header, bool verify)
+		: m_nbk(nbk), m_pageSize(header.page_size),
+		  m_backupScn(header.backup_scn), m_prevScn(header.prev_scn),
+		  m_maxPages(MAX(1, BACKUP_RANGE_SIZE / header.page_size)),
+		  m_chunked(header.version == BACKUP_VERSION_CHUNKED),
+		  m_incremental(Guid(header.prev_guid) != Guid::empty()),
+		  m_verify(verify),
+		  m_chunks(0), m_pages(0), m_lastPage(0),
+		  m_stop(false), m_error(false)
+	{}
+
+	~RestoreTask()
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			delete *p;
+	}
+
+	bool handler(WorkItem& wi) override;
+	bool getWorkItem(WorkItem** pItem) override;
+	bool getResult(IStatus* status) override;
+
+	int getMaxWorkers() override
+	{
+		return m_nbk->m_parallel;
+	}
+
+	ULONG getPages() const
+	{
+		return m_pages;
+	}
+
+private:
+	class Item : public WorkItem
+	{
+	public:
+		explicit Item(RestoreTask* task)
+			: WorkItem(task), m_count(0)
+		{
+			memset(&m_chunk, 0, sizeof(m_chunk));
+		}
+
+		ULONG m_count;			// number of pages
+		chunk_header m_chunk;	// header of the chunk
+		Array<UCHAR> m_data;	// data as read from the backup
+		Array<UCHAR> m_raw;		// unpacked data
+	};
+
+	bool readItem(Item& item);
+	void checkEnd(chunk_header& chunk);
+	void checkChecksum(chunk_header& chunk, const UCHAR* data);
+	void checkPages(const Item& item, const ULONG* numbers, const UCHAR* pages);
+	const UCHAR* unpack(Item& item);
+
+	ULONG pageNumber(const ULONG* numbers, const UCHAR* pages, ULONG n) const
+	{
+		return numbers ? numbers[n] :
+			reinterpret_cast<const Ods::pag*>(pages + n * m_pageSize)->pag_pageno;
+	}
+
+	NBackup* const m_nbk;
+	const ULONG m_pageSize;
+	const ULONG m_backupScn;
+	const ULONG m_prevScn;
+	const ULONG m_maxPages;
+	const bool m_chunked;
+	const bool m_incremental;
+	const bool m_verify;
+
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	ULONG m_chunks;			// chunks read
+	ULONG m_pages;			// pages read
+	ULONG m_lastPage;		// end of range of the last chunk read
+	FbLocalStatus m_status;
+	bool m_stop;
+	bool m_error;
+};
+
+bool NBackup::RestoreTask::getWorkItem(WorkItem** pItem)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (m_stop)
+		return false;
+
+	Item* item = static_cast<Item*>(*pItem);
+	if (!item)
+	{
+		item = FB_NEW Item(this);
+		m_items.add(item);
+		*pItem = item;
+	}
+
+	try
+	{
+		if (readItem(*item))
+			return true;
+	}
+	catch (const Exception& ex)
+	{
+		if (!m_error)
+		{
+			ex.stuffException(&m_status);
+			m_error = true;
+		}
+	}
+
+	m_stop = true;
+	return false;
+}
+
+bool NBackup::RestoreTask::readItem(Item& item)
+{
+	// Read the next unit of the backup, return false at the end of backup
+
+	const char* const fileName = m_nbk->bakname.c_str();
+
+	if (!m_chunked)
+	{
+		const FB_SIZE_T bytesDone = m_nbk->read_file(m_nbk->backup,
+			item.m_data.getBuffer(m_maxPages * m_pageSize), m_maxPages * m_pageSize);
+
+		if (bytesDone % m_pageSize)
+			status_exception::raise(Arg::Gds(isc_nbackup_err_eofbk) << fileName);
+
+		item.m_count = bytesDone / m_pageSize;
+		m_pages += item.m_count;
+		return (item.m_count != 0);
+	}
+
+	// The stream of chunks must be finished with the end chunk
+
+	chunk_header& chunk = item.m_chunk;
+
+	if (m_nbk->read_file(m_nbk->backup, &chunk, sizeof(chunk)) != sizeof(chunk))
+		status_exception::raise(Arg::Gds(isc_nbackup_err_eofbk) << fileName);
+
+	if (chunk.flags & CHUNK_END)
+	{
+		checkEnd(chunk);
+		return false;
+	}
+
+	const bool packed = (chunk.flags & CHUNK_PACKED);
+
+	if (!chunk.page_count || chunk.page_count > m_maxPages || (chunk.flags & ~CHUNK_PACKED) ||
+		chunk.sequence != m_chunks ||
+		chunk.start_page < m_lastPage || chunk.end_page <= chunk.start_page ||
+		chunk.page_count > chunk.end_page - chunk.start_page ||
+		chunk.raw_length != chunk.page_count * (sizeof(ULONG) + m_pageSize) ||
+		(packed ? chunk.data_length > chunk.raw_length : chunk.data_length != chunk.raw_length))
+	{
+		status_exception::raise(Arg::Gds(isc_nbackup_err_chunk) << fileName);
+	}
+
+	if (m_nbk->read_file(m_nbk->backup, item.m_data.getBuffer(chunk.data_length),
+			chunk.data_length) != chunk.data_length)
+	{
+		status_exception::raise(Arg::Gds(isc_nbackup_err_eofbk) << fileName);
+	}
+
+	item.m_count = chunk.page_count;
+
+	m_chunks++;
+	m_pages += chunk.page_count;
+	m_lastPage = chunk.end_page;
+	return true;
+}
+
+void NBackup::RestoreTask::checkEnd(chunk_header& chunk)
+{
+	const char* const fileName = m_nbk->bakname.c_str();
+
+	checkChecksum(chunk, NULL);
+
+	if (chunk.flags != CHUNK_END || chunk.sequence != m_chunks || chunk.page_count != m_pages ||
+		chunk.raw_length || chunk.data_length || chunk.end_page < m_lastPage)
+	{
+		status_exception::raise(Arg::Gds(isc_nbackup_err_chunk) << fileName);
+	}
+
+	// Nothing is expected after the end chunk
+
+	UCHAR dummy;
+	if (m_nbk->read_file(m_nbk->backup, &dummy, sizeof(dummy)))
+		status_exception::raise(Arg::Gds(isc_nbackup_err_chunk) << fileName);
+}
+
+void NBackup::RestoreTask::checkChecksum(chunk_header& chunk, const UCHAR* data)
+{
+	const ULONG stored = chunk.checksum;
+	chunk.checksum = 0;
+
+	ULONG crc = Crc32C::update(CHUNK_CHECKSUM_SEED, data ? chunk.data_length : 0, data);
+	crc = Crc32C::update(crc, sizeof(chunk), reinterpret_cast<const UCHAR*>(&chunk));
+
+	chunk.checksum = stored;
+
+	if (crc != stored)
+	{
+		status_exception::raise(Arg::Gds(isc_nbackup_err_checksum) <<
+			Arg::Num(chunk.sequence) << m_nbk->bakname.c_str());
+	}
+}
+
+void NBackup::RestoreTask::checkPages(const Item& item, const ULONG* numbers, const UCHAR* pages)
+{
+	// Pages must be within the range of the chunk in ascending order, page images
+	// must correspond to the page numbers and SCNs of the backup
+
+	const chunk_header& chunk = item.m_chunk;
+	ULONG maxScn = 0;
+
+	for (ULONG i = 0; i < item.m_count; i++)
+	{
+		const ULONG pageNum = pageNumber(numbers, pages, i);
+		const Ods::pag* const page = reinterpret_cast<const Ods::pag*>(pages + i * m_pageSize);
+
+		const bool valid = (!numbers ||
+				(pageNum >= chunk.start_page && pageNum < chunk.end_page &&
+				 (!i || pageNum > numbers[i - 1]) &&
+				 (page->pag_type == pag_undefined || page->pag_pageno == pageNum))) &&
+			page->pag_type <= pag_max &&
+			(!pageNum || page->pag_scn <= m_backupScn) &&
+			(!m_incremental || page->pag_scn > m_prevScn);
+
+		if (!valid)
+		{
+			status_exception::raise(Arg::Gds(isc_nbackup_page_corrupt) <<
+				Arg::Num(pageNum) << m_nbk->bakname.c_str());
+		}
+
+		if (page->pag_scn > maxScn)
+			maxScn = page->pag_scn;
+	}
+
+	if (numbers && maxScn != chunk.max_scn)
+		status_exception::raise(Arg::Gds(isc_nbackup_err_chunk) << m_nbk->bakname.c_str());
+}
+
+const UCHAR* NBackup::RestoreTask::unpack(Item& item)
+{
+	const char* const fileName = m_nbk->bakname.c_str();
+
+#ifdef HAVE_ZLIB_H
+	if (!zlib())
+		status_exception::raise(Arg::Gds(isc_nbackup_nozlib) << fileName);
+
+	z_stream strm;
+	strm.zalloc = ZLib::allocFunc;
+	strm.zfree = ZLib::freeFunc;
+	strm.opaque = Z_NULL;
+
+	if (zlib().inflateInit_(&strm, ZLIB_VERSION, sizeof(z_stream)) != Z_OK)
+		status_exception::raise(Arg::Gds(isc_nbackup_err_chunk) << fileName);
+
+	const ULONG rawLength = item.m_chunk.raw_length;
+	UCHAR* const buffer = item.m_raw.getBuffer(rawLength);
+
+	strm.next_in = item.m_data.begin();
+	strm.avail_in = item.m_chunk.data_length;
+	strm.next_out = buffer;
+	strm.avail_out = rawLength;
+
+	const int ret = zlib().inflate(&strm, Z_FINISH);
+	const ULONG unpackedLength = (ULONG) strm.total_out;
+	zlib().inflateEnd(&strm);
+
+	if (ret != Z_STREAM_END || unpackedLength != rawLength)
+		status_exception::raise(Arg::Gds(isc_nbackup_err_chunk) << fileName);
+
+	return buffer;
+#else
+	status_exception::raise(Arg::Gds(isc_nbackup_nozlib) << fileName);
+#endif
+}
+
+bool NBackup::RestoreTask::handler(WorkItem& wi)
+{
+	Item& item = static_cast<Item&>(wi);
+
+	try
+	{
+		const ULONG* numbers = NULL;
+		const UCHAR* pages = item.m_data.begin();
+
+		if (m_chunked)
+		{
+			checkChecksum(item.m_chunk, item.m_data.begin());
+
+			const UCHAR* const raw = (item.m_chunk.flags & CHUNK_PACKED) ?
+				unpack(item) : item.m_data.begin();
+
+			numbers = reinterpret_cast<const ULONG*>(raw);
+			pages = raw + item.m_count * sizeof(ULONG);
+		}
+
+		// Plain backup written by older versions is checked only when asked for
+
+		if (m_chunked || m_verify)
+			checkPages(item, numbers, pages);
+
+		// Write runs of adjacent pages at once
+
+		for (ULONG i = 0; i < item.m_count && !m_verify; )
+		{
+			const ULONG pageNum = pageNumber(numbers, pages, i);
+
+			ULONG n = 1;
+			while (i + n < item.m_count && pageNumber(numbers, pages, i + n) == pageNum + n)
+				n++;
+
+			m_nbk->write_at(m_nbk->dbase, (SINT64) pageNum * m_pageSize, pages + i * m_pageSize, n * m_pageSize);
+			i += n;
+		}
+
+		checkCtrlC(m_nbk->uSvc);
+	}
+	catch (const Exception& ex)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (!m_error)
+		{
+			ex.stuffException(&m_status);
+			m_error = true;
+		}
+
+		m_stop = true;
+	}
+
+	return !m_stop;
+}
+
+bool NBackup::RestoreTask::getResult(IStatus* status)
+{
+	if (m_error && status)
+		status->setErrors(m_status->getErrors());
+
+	return !m_error;
+}
+
+void NBackup::backup_pages(int level, ULONG page_size, ULONG backup_scn, ULONG prev_scn,
+	ULONG& page_reads, ULONG& page_writes)
+{
+	// Find the last page to be backed up walking the page inventory pages,
+	// the sequential backup does the same on the fly
+
+	const ULONG ioBlockSize = direct_io ? DIRECT_IO_BLOCK_SIZE : PAGE_ALIGNMENT;
+	const ULONG pagesPerPIP = Ods::pagesPerPIP(page_size);
+
+	Array<UCHAR> pip_buffer;
+	Ods::page_inv_page* const pip = reinterpret_cast<Ods::page_inv_page*>
+		(pip_buffer.getAlignedBuffer(page_size, ioBlockSize));
+
+	ULONG lastPage = FIRST_PIP_PAGE;
+	while (read_at(dbase, (SINT64) lastPage * page_size, pip, page_size) == page_size)
+	{
+		page_reads++;
+
+		if (pip->pip_header.pag_type != pag_pages)
+			break;
+
+		if (lastPage == FIRST_PIP_PAGE)
+			lastPage = pip->pip_used - 1;
+		else
+			lastPage += pip->pip_used;
+
+		if (pip->pip_used < pagesPerPIP)
+			lastPage++;
+	}
+
+	// lastPage is already past the last allocated page, see the loop above
+	ULONG endPage = lastPage;
+	if (db_size_pages && endPage > db_size_pages)
+		endPage = db_size_pages;
+
+	BackupTask task(this, level, page_size, endPage, backup_scn, prev_scn);
+
+	Coordinator coord(getDefaultMemoryPool());
+	coord.runSync(&task);
+
+	page_reads += task.getPageReads();
+	page_writes += task.getPageWrites();
+
+	FbLocalStatus st;
+	if (!task.getResult(&st))
+		st.raise();
+
+	if (m_compress)
+		task.writeEnd();
+}
+
+ULONG NBackup::restore_pages(const inc_header& bakheader, bool verify)
+{
+	RestoreTask task(this, bakheader, verify);
+
+	Coordinator coord(getDefaultMemoryPool());
+	coord.runSync(&task);
+
+	FbLocalStatus st;
+	if (!task.getResult(&st))
+		st.raise();
+
+	return task.getPages();
+}
+
+void NBackup::check_backup_header(const inc_header& bakheader, int curLevel,
+	const std::optional<Guid>& prev_guid)
+{
+	// Check the header of the backup file of given level just read from the backup
+	// and skip the rest of the header page
+
+	if (bakheader.version != BACKUP_VERSION && bakheader.version != BACKUP_VERSION_CHUNKED)
+	{
+		status_exception::raise(Arg::Gds(isc_nbackup_unsupvers_incbk) <<
+							Arg::Num(bakheader.version) << bakname.c_str());
+	}
+
+	if (bakheader.page_size < sizeof(bakheader) || bakheader.page_size > MAX_PAGE_SIZE)
+		status_exception::raise(Arg::Gds(isc_nbackup_invalid_incbk) << bakname.c_str());
+
+	if (!curLevel)
+	{
+		// Level 0 backup has the header only when it's chunked
+		if (bakheader.version != BACKUP_VERSION_CHUNKED || bakheader.level ||
+			Guid(bakheader.prev_guid) != Guid::empty())
+		{
+			status_exception::raise(Arg::Gds(isc_nbackup_invalid_incbk) << bakname.c_str());
+		}
+	}
+	else
+	{
+		if (bakheader.level && bakheader.level != curLevel)
+		{
+			status_exception::raise(Arg::Gds(isc_nbackup_invlevel_incbk) <<
+				Arg::Num(bakheader.level) << bakname.c_str() << Arg::Num(curLevel));
+		}
+		// We may also add SCN check, but GUID check covers this case too
+		if (Guid(bakheader.prev_guid) != prev_guid.value())
+			status_exception::raise(Arg::Gds(isc_nbackup_wrong_orderbk) << bakname.c_str());
+	}
+
+	// Emulate seek_file(backup, bakheader.page_size)
+	// Backup is stream-oriented, if -decompress is used pipe can't be seek()'ed
+	FB_SIZE_T left = bakheader.page_size - sizeof(bakheader);
+	while (left)
+	{
+		char char_buf[1024];
+		const FB_SIZE_T step = left > sizeof(char_buf) ? sizeof(char_buf) : left;
+		if (read_file(backup, &char_buf, step) != step)
+			status_exception::raise(Arg::Gds(isc_nbackup_err_eofhdrbk) << bakname.c_str());
+		left -= step;
+	}
+}
+
+ULONG NBackup::verify_image(const void* prefix, FB_SIZE_T prefixLength, std::optional<Guid>& guid)
+{
+	// Plain level 0 backup is the database image, prefix is its part already read.
+	// Every page must be complete and correspond to its position in the file.
+
+	Ods::header_page header;
+	memcpy(&header, prefix, MIN(prefixLength, HDR_SIZE));
+
+	if (prefixLength < HDR_SIZE &&
+		read_file(backup, reinterpret_cast<UCHAR*>(&header) + prefixLength, HDR_SIZE - prefixLength) !=
+			HDR_SIZE - prefixLength)
+	{
+		status_exception::raise(Arg::Gds(isc_nbackup_err_eofhdrbk) << bakname.c_str());
+	}
+
+	if (!Ods::isSupported(&header))
+	{
+		const USHORT ods_version = header.hdr_ods_version & ~ODS_FIREBIRD_FLAG;
+		status_exception::raise(Arg::Gds(isc_wrong_ods) << Arg::Str(bakname.c_str()) <<
+								Arg::Num(ods_version) <<
+								Arg::Num(header.hdr_ods_minor) <<
+								Arg::Num(ODS_VERSION) <<
+								Arg::Num(ODS_CURRENT));
+	}
+
+	const ULONG pageSize = header.hdr_page_size;
+	if (pageSize < HDR_SIZE || pageSize > MAX_PAGE_SIZE)
+		status_exception::raise(Arg::Gds(isc_nbackup_page_corrupt) << Arg::Num(0) << bakname.c_str());
+
+	Array<UCHAR> page_buffer;
+	UCHAR* const page_ptr = page_buffer.getBuffer(pageSize);
+
+	memcpy(page_ptr, &header, HDR_SIZE);
+	if (read_file(backup, page_ptr + HDR_SIZE, pageSize - HDR_SIZE) != pageSize - HDR_SIZE)
+		status_exception::raise(Arg::Gds(isc_nbackup_err_eofhdrbk) << bakname.c_str());
+
+	guid.reset();
+	auto p = reinterpret_cast<Ods::header_page*>(page_ptr)->hdr_data;
+	const auto end = page_ptr + pageSize;
+	while (p < end && *p != Ods::HDR_end)
+	{
+		if (*p == Ods::HDR_backup_guid)
+		{
+			if (p[1] == Guid::SIZE)
+				guid = Guid(p + 2);
+			break;
+		}
+
+		p += p[1] + 2;
+	}
+	if (!guid)
+		status_exception::raise(Arg::Gds(isc_nbackup_lostguid_l0bk));
+
+	ULONG pageNum = 1;
+	while (true)
+	{
+		const FB_SIZE_T bytesDone = read_file(backup, page_ptr, pageSize);
+		if (bytesDone == 0)
+			break;
+		if (bytesDone != pageSize)
+			status_exception::raise(Arg::Gds(isc_nbackup_err_eofbk) << bakname.c_str());
+
+		const Ods::pag* const page = reinterpret_cast<Ods::pag*>(page_ptr);
+		if (page->pag_type > pag_max || (page->pag_type != pag_undefined && page->pag_pageno != pageNum))
+		{
+			status_exception::raise(Arg::Gds(isc_nbackup_page_corrupt) <<
+				Arg::Num(pageNum) << bakname.c_str());
+		}
+
+		pageNum++;
+		checkCtrlC(uSvc);
+	}
+
+	return pageNum;
+}
+
+void NBackup::verify_backup(const BackupFiles& files)
+{
+	// Check backup files of consecutive levels the same way as restore does
+	// it, but without writing the database
+
+	std::optional<Guid> prev_guid;
+
+	try
+	{
+		for (FB_SIZE_T curLevel = 0; curLevel < files.getCount(); curLevel++)
+		{
+			bakname = files[curLevel];
+			toSystem(bakname);
+			open_backup_scan();
+
+			inc_header bakheader;
+			const FB_SIZE_T bytesRead = read_file(backup, &bakheader, sizeof(bakheader));
+
+			ULONG pages;
+			if (bytesRead == sizeof(bakheader) &&
+				memcmp(bakheader.signature, backup_signature, sizeof(backup_signature)) == 0)
+			{
+				check_backup_header(bakheader, curLevel, prev_guid);
+				pages = restore_pages(bakheader, true);
+				prev_guid = bakheader.backup_guid;
+			}
+			else if (!curLevel)
+				pages = verify_image(&bakheader, bytesRead, prev_guid);
+			else
+				status_exception::raise(Arg::Gds(isc_nbackup_invalid_incbk) << bakname.c_str());
+
+			close_backup();
+
+			uSvc->printf(false, "%s: level %u, %u pages verified\n", bakname.c_str(), curLevel, pages);
+		}
+	}
+	catch (const Exception&)
+	{
+		m_silent = true;
+		close_backup();
+		throw;
+	}
+}
+
+int NBACKUP_main(UtilSvc* uSvc)
+{
+	int exit_code = FB_SUCCESS;
+
+	try {
+		nbackup(uSvc);
+	}
+	catch (const status_exception& e)
+	{
+		if (!uSvc->isService())
+		{
+			const ISC_STATUS* s = e.value();
+			isc_print_status(s);
+		}
+
+ 		StaticStatusVector status;
+ 		e.stuffException(status);
+
+		UtilSvc::StatusAccessor sa = uSvc->getStatusAccessor();
+		sa.init();
+ 		sa.setServiceStatus(status.begin());
+
+		exit_code = FB_FAILURE;
+	}
+	catch (const Exception& e)
+	{
+		if (!uSvc->isService())
+			fprintf(stderr, "%s\n", e.what());
+
+ 		StaticStatusVector status;
+ 		e.stuffException(status);
+
+		UtilSvc::StatusAccessor sa = uSvc->getStatusAccessor();
+		sa.init();
+ 		sa.setServiceStatus(status.begin());
+
+		exit_code = FB_FAILURE;
+	}
+
+	return exit_code;
+}
+
+enum NbOperation {nbNone, nbLock, nbUnlock, nbFixup, nbBackup, nbRestore, nbVerify};
+
+void nbackup(UtilSvc* uSvc)
+{
+	UtilSvc::ArgvType& argv = uSvc->argv;
+	const int argc = argv.getCount();
+
+	NbOperation op = nbNone;
+	string username, role, password;
+	PathName database, filename;
+	string decompress;
+	bool run_db_triggers = true;
+	bool direct_io =
+#ifdef WIN_NT
+		true;
+#else
+		false;
+#endif
+	NBackup::BackupFiles backup_files;
+	int level = -1;
+	std::optional<Guid> guid;
+	bool print_size = false, version = false, inc_rest = false, repl_seq = false;
+	string onOff;
+	bool cleanHistory = false;
+	NBackup::CLEAN_HISTORY_KIND cleanHistKind = NBackup::CLEAN_HISTORY_KIND::NONE;
+	int keepHistValue = 0;
+	int parallel = 1;
+	bool compress = false;
+
+	const Switches switches(nbackup_action_in_sw_table, FB_NELEM(nbackup_action_in_sw_table),
+							false, true);
+
+	// Read global command line parameters
+	for (int itr = 1; itr < argc; ++itr)
+	{
+		// We must recognize all parameters here
+		if (argv[itr][0] != '-') {
+			usage(uSvc, isc_nbackup_unknown_param, argv[itr]);
+		}
+
+		const Switches::in_sw_tab_t* rc = switches.findSwitch(argv[itr]);
+		if (!rc)
+		{
+			usage(uSvc, isc_nbackup_unknown_switch, argv[itr]);
+			break;
+		}
+
+		switch (rc->in_sw)
+		{
+		case IN_SW_NBK_USER_NAME:
+			if (++itr >= argc)
+				missingParameterForSwitch(uSvc, argv[itr - 1]);
+
+			username = argv[itr];
+			break;
+
+		case IN_SW_NBK_ROLE:
 			if (++itr >= argc)
 				missingParameterForSwitch(uSvc, argv[itr - 1]);
 
@@ -2076,6 +3243,20 @@ void nbackup(UtilSvc* uSvc)
 			op = nbRestore;
 			break;
 
+		case IN_SW_NBK_VERIFY:
+			if (op != nbNone)
+				singleAction(uSvc);
+
+			if (++itr >= argc)
+				missingParameterForSwitch(uSvc, argv[itr - 1]);
+
+			backup_files.push(argv[itr]);
+			while (++itr < argc)
+				backup_files.push(argv[itr]);
+
+			op = nbVerify;
+			break;
+
 		case IN_SW_NBK_SIZE:
 			print_size = true;
 			break;
@@ -2133,6 +3314,19 @@ void nbackup(UtilSvc* uSvc)
 			}
 			break;
 
+		case IN_SW_NBK_PARALLEL:
+			if (++itr >= argc)
+				missingParameterForSwitch(uSvc, argv[itr - 1]);
+
+			parallel = atoi(argv[itr]);
+			if (parallel < 1)
+				usage(uSvc, isc_nbackup_wrong_param, argv[itr - 1]);
+			break;
+
+		case IN_SW_NBK_COMPRESS:
+			compress = true;
+			break;
+
 		default:
 			usage(uSvc, isc_nbackup_unknown_switch, argv[itr]);
 			break;
@@ -2180,7 +3374,7 @@ void nbackup(UtilSvc* uSvc)
 	const string guidStr = guid ? guid.value().toString() : "";
 
 	NBackup nbk(uSvc, database, username, role, password, run_db_triggers, direct_io,
-				decompress, cleanHistKind, keepHistValue);
+				decompress, cleanHistKind, keepHistValue, parallel, compress);
 	try
 	{
 		switch (op)
@@ -2204,6 +3398,10 @@ void nbackup(UtilSvc* uSvc)
 			case nbRestore:
 				nbk.restore_database(backup_files, repl_seq, inc_rest);
 				break;
+
+			case nbVerify:
+				nbk.verify_backup(backup_files);
+				break;
 		}
 	}
 	catch (const Exception& e)
@@ -51,6 +51,9 @@ inline constexpr int IN_SW_NBK_INPLACE			= 16;
 inline constexpr int IN_SW_NBK_SEQUENCE			= 17;
 inline constexpr int IN_SW_NBK_CLEAN_HISTORY	= 18;
 inline constexpr int IN_SW_NBK_KEEP				= 19;
+inline constexpr int IN_SW_NBK_PARALLEL			= 20;
+inline constexpr int IN_SW_NBK_COMPRESS			= 21;
+inline constexpr int IN_SW_NBK_VERIFY			= 22;
 
 
 static inline constexpr struct Switches::in_sw_tab_t nbackup_in_sw_table [] =
@@ -59,6 +62,8 @@ static inline constexpr struct Switches::in_sw_tab_t nbackup_in_sw_table [] =
 	{IN_SW_NBK_DIRECT,		isc_spb_nbk_direct,			"DIRECT",	0, 0, 0, false, false,	0,	1, NULL},
 	{IN_SW_NBK_INPLACE,		isc_spb_nbk_inplace,		"INPLACE",	0, 0, 0, false, true,	0,	1, NULL},
 	{IN_SW_NBK_SEQUENCE,	isc_spb_nbk_sequence,		"SEQUENCE",	0, 0, 0, false, true,	0,	3, NULL},
+	{IN_SW_NBK_PARALLEL,	isc_spb_nbk_parallel_workers,	"PARALLEL",	0, 0, 0, false, false,	0,	3, NULL},
+	{IN_SW_NBK_COMPRESS,	isc_spb_nbk_compress,		"COMPRESS",	0, 0, 0, false, true,	0,	4, NULL},
 	{IN_SW_NBK_0,			0,							NULL,		0, 0, 0, false, false,	0,	0, NULL}	// End of List
 };
 
@@ -72,6 +77,7 @@ static inline constexpr struct Switches::in_sw_tab_t nbackup_action_in_sw_table
 	{IN_SW_NBK_FIXUP,		isc_action_svc_nfix,	"FIXUP",			0, 0, 0, false, false,	10,	1,	NULL, nboExclusive},
 	{IN_SW_NBK_BACKUP,		isc_action_svc_nbak,	"BACKUP",			0, 0, 0, false, false,	11,	1,	NULL, nboExclusive},
 	{IN_SW_NBK_RESTORE,		isc_action_svc_nrest,	"RESTORE",			0, 0, 0, false, false,	12,	1,	NULL, nboExclusive},
+	{IN_SW_NBK_VERIFY,		0,						"VERIFY",			0, 0, 0, false, false,	93,	3,	NULL, nboExclusive},
 	{IN_SW_NBK_DIRECT,		0,						"DIRECT",			0, 0, 0, false, false,	70,	1,	NULL, nboSpecial},
 	{IN_SW_NBK_INPLACE,		0,						"INPLACE",			0, 0, 0, false, false,	78, 1,	NULL, nboSpecial},
 	{IN_SW_NBK_SIZE,		0,						"SIZE",				0, 0, 0, false, false,	17,	1,	NULL, nboSpecial},
@@ -79,6 +85,8 @@ static inline constexpr struct Switches::in_sw_tab_t nbackup_action_in_sw_table
 	{IN_SW_NBK_SEQUENCE,	0,						"SEQUENCE",			0, 0, 0, false, false,	80, 3,	NULL, nboSpecial},
 	{IN_SW_NBK_CLEAN_HISTORY, isc_spb_nbk_clean_history, "CLEAN_HISTORY",	0, 0, 0, false, false,	82, 10,	NULL, nboSpecial},
 	{IN_SW_NBK_KEEP,		0,						"KEEP",				0, 0, 0, false, false,	83, 1,	NULL, nboSpecial},
+	{IN_SW_NBK_PARALLEL,	0,						"PARALLEL",			0, 0, 0, false, false,	89, 3,	NULL, nboSpecial},
+	{IN_SW_NBK_COMPRESS,	0,						"COMPRESS",			0, 0, 0, false, false,	90, 4,	NULL, nboSpecial},
 	{IN_SW_NBK_NODBTRIG,	0,						"T",				0, 0, 0, false, false,	0,	1,	NULL, nboGeneral},
 	{IN_SW_NBK_NODBTRIG,	0,						"NODBTRIGGERS",		0, 0, 0, false, false,	16,	3,	NULL, nboGeneral},
 	{IN_SW_NBK_USER_NAME,	0,						"USER",				0, 0, 0, false, false,	13,	1,	NULL, nboGeneral},
@@ -0,0 +1,264 @@
+/*
+ *	PROGRAM:	SQL Trace plugin
+ *	MODULE:		BinaryLogWriter.cpp
+ *	DESCRIPTION:	Binary trace log writer
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#include "BinaryLogWriter.h"
+#include "os/platform.h"
+#include "../../common/isc_proto.h"
+#include "../../common/StatusHolder.h"
+#include "../../common/ThreadStart.h"
+#include "../../common/classes/ImplementHelper.h"
+#include "../../common/classes/init.h"
+#include "../../common/classes/semaphore.h"
+#include "../../common/classes/timestamp.h"
+
+using namespace Firebird;
+
+namespace
+{
+	constexpr int FLUSH_INTERVAL = 1000;	// milliseconds
+
+	// Flushes the binary logs of all plugin instances of the process
+
+	class LogFlusher
+	{
+	public:
+		explicit LogFlusher(MemoryPool& pool)
+			: m_writers(pool), m_signaled(false), m_started(false), m_shutdown(false)
+		{}
+
+		~LogFlusher()
+		{
+			if (m_started)
+			{
+				m_shutdown = true;
+				m_wakeup.release();
+				m_thread.waitForCompletion();
+			}
+		}
+
+		void add(BinaryLogWriter* writer)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			m_writers.add(writer);
+
+			if (!m_started)
+			{
+				Thread::start(flushThread, this, THREAD_medium, &m_thread);
+				m_started = true;
+			}
+		}
+
+		void remove(BinaryLogWriter* writer)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			FB_SIZE_T pos;
+			if (m_writers.find(writer, pos))
+				m_writers.remove(pos);
+		}
+
+		void wakeup()
+		{
+			if (!m_signaled.exchange(true))
+				m_wakeup.release();
+		}
+
+	private:
+		static THREAD_ENTRY_DECLARE flushThread(THREAD_ENTRY_PARAM arg)
+		{
+			static_cast<LogFlusher*>(arg)->run();
+			return 0;
+		}
+
+		void run()
+		{
+			while (!m_shutdown)
+			{
+				m_wakeup.tryEnter(0, FLUSH_INTERVAL);
+				m_signaled = false;
+
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+				for (const auto writer : m_writers)
+				{
+					try
+					{
+						writer->flush();
+					}
+					catch (const Exception& ex)
+					{
+						iscLogException("Error writing binary trace log", ex);
+					}
+				}
+			}
+		}
+
+		Mutex m_mutex;
+		SortedArray<BinaryLogWriter*> m_writers;
+		Semaphore m_wakeup;
+		std::atomic<bool> m_signaled;
+		Thread m_thread;
+		bool m_started;
+		volatile bool m_shutdown;
+	};
+
+	GlobalPtr<LogFlusher, InstanceControl::PRIORITY_DELETE_FIRST> flusher;
+}
+
+
+BinaryLogWriter::BinaryLogWriter(ITraceLogWriter* logWriter, int session)
+	: m_logWriter(logWriter), m_session(session),
+	  m_chunk(*getDefaultMemoryPool()),
+	  m_head(0), m_tail(0)
+{
+	m_logWriter->addRef();
+	flusher->add(this);
+}
+
+BinaryLogWriter::~BinaryLogWriter()
+{
+	flusher->remove(this);
+
+	try
+	{
+		flush();
+	}
+	catch (const Exception& ex)
+	{
+		iscLogException("Error writing binary trace log", ex);
+	}
+
+	m_logWriter->release();
+}
+
+void BinaryLogWriter::putText(TraceRecordType type, SINT64 id, const char* action, const string& text)
+{
+	TraceRecord header;
+	memset(&header, 0, sizeof(TraceRecord));
+	header.type = type;
+	header.id = id;
+
+	// Text events are prefixed with the action, descriptions are just the text
+
+	const ULONG actionLength = action ? static_cast<ULONG>(strlen(action) + 1) : 0;
+
+	put(header, sizeof(TraceRecord), action, actionLength, text.c_str(), text.length());
+}
+
+void BinaryLogWriter::putEvent(TraceEventRecord& record)
+{
+	put(record, sizeof(TraceEventRecord));
+}
+
+void BinaryLogWriter::put(TraceRecord& header, ULONG headerLength,
+						  const void* data, ULONG dataLength,
+						  const void* data2, ULONG dataLength2)
+{
+	header.length = headerLength + dataLength + dataLength2;
+	header.timestamp = TimeStamp::getCurrentTimeStamp().value();
+
+	if (header.length > RING_SIZE)
+	{
+		// Too long record (e.g. huge SQL text), write it as a separate chunk
+
+		flush();
+
+		MutexLockGuard guard(m_flushMutex, FB_FUNCTION);
+
+		m_chunk.resize(sizeof(TraceChunk));
+		m_chunk.add(reinterpret_cast<const UCHAR*>(&header), headerLength);
+		m_chunk.add(static_cast<const UCHAR*>(data), dataLength);
+		m_chunk.add(static_cast<const UCHAR*>(data2), dataLength2);
+
+		writeChunk();
+		return;
+	}
+
+	ULONG head = m_head.load(std::memory_order_relaxed);
+
+	if (RING_SIZE - (head - m_tail.load(std::memory_order_acquire)) < header.length)
+		flush();
+
+	copy(head, &header, headerLength);
+	copy(head, data, dataLength);
+	copy(head, data2, dataLength2);
+
+	m_head.store(head, std::memory_order_release);
+
+	if (head - m_tail.load(std::memory_order_acquire) > RING_SIZE / 2)
+		flusher->wakeup();
+}
+
+void BinaryLogWriter::copy(ULONG& position, const void* data, ULONG length)
+{
+	if (!length)
+		return;
+
+	const ULONG offset = position % RING_SIZE;
+	const ULONG part = MIN(length, RING_SIZE - offset);
+
+	memcpy(m_ring + offset, data, part);
+	memcpy(m_ring, static_cast<const UCHAR*>(data) + part, length - part);
+
+	position += length;
+}
+
+void BinaryLogWriter::flush()
+{
+	MutexLockGuard guard(m_flushMutex, FB_FUNCTION);
+
+	const ULONG tail = m_tail.load(std::memory_order_relaxed);
+	const ULONG head = m_head.load(std::memory_order_acquire);
+
+	if (head == tail)
+		return;
+
+	const ULONG length = head - tail;
+	const ULONG offset = tail % RING_SIZE;
+	const ULONG part = MIN(length, RING_SIZE - offset);
+
+	m_chunk.resize(sizeof(TraceChunk));
+	m_chunk.add(m_ring + offset, part);
+	m_chunk.add(m_ring, length - part);
+
+	m_tail.store(head, std::memory_order_release);
+
+	writeChunk();
+}
+
+void BinaryLogWriter::writeChunk()
+{
+	const auto chunk = reinterpret_cast<TraceChunk*>(m_chunk.begin());
+	memset(chunk, 0, sizeof(TraceChunk));
+	memcpy(chunk->signature, TRACE_LOG_SIGNATURE, sizeof(TRACE_LOG_SIGNATURE));
+	chunk->version = TRACE_LOG_CURRENT_VERSION;
+	chunk->length = m_chunk.getCount() - sizeof(TraceChunk);
+	chunk->process = get_process_id();
+	chunk->instance = (FB_UINT64) (U_IPTR) this;
+	chunk->session = m_session;
+
+	LocalStatus ls;
+	CheckStatusWrapper status(&ls);
+
+	m_logWriter->write_s(&status, m_chunk.begin(), m_chunk.getCount());
+	check(&status);
+}
@@ -0,0 +1,70 @@
+/*
+ *	PROGRAM:	SQL Trace plugin
+ *	MODULE:		BinaryLogWriter.h
+ *	DESCRIPTION:	Binary trace log writer
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef BINARYLOGWRITER_H
+#define BINARYLOGWRITER_H
+
+#include "firebird.h"
+#include "../../jrd/ntrace.h"
+#include "../../common/classes/array.h"
+#include "../../common/classes/fb_string.h"
+#include "../../common/classes/locks.h"
+
+#include "TraceLogFormat.h"
+
+#include <atomic>
+
+// Collects the binary records of the plugin instance in the ring buffer.
+// Events of the instance are delivered by its attachment one at a time,
+// so there's the single producer and putting the record costs a memcpy.
+// The ring is flushed into the log by the background thread, or by the
+// producer itself if the ring is full.
+
+class BinaryLogWriter
+{
+public:
+	BinaryLogWriter(Firebird::ITraceLogWriter* logWriter, int session);
+	~BinaryLogWriter();
+
+	void putText(TraceRecordType type, SINT64 id, const char* action, const Firebird::string& text);
+	void putEvent(TraceEventRecord& record);
+
+	void flush();
+
+private:
+	static constexpr ULONG RING_SIZE = 32768;
+
+	void put(TraceRecord& header, ULONG headerLength,
+			 const void* data = nullptr, ULONG dataLength = 0,
+			 const void* data2 = nullptr, ULONG dataLength2 = 0);
+	void copy(ULONG& position, const void* data, ULONG length);
+	void writeChunk();
+
+	Firebird::ITraceLogWriter* const m_logWriter;
+	const int m_session;
+	Firebird::Array<UCHAR> m_chunk;
+	Firebird::Mutex m_flushMutex;
+	std::atomic<ULONG> m_head;	// advanced by the producer
+	std::atomic<ULONG> m_tail;	// advanced by the flush
+	UCHAR m_ring[RING_SIZE];
+};
+
+#endif // BINARYLOGWRITER_H
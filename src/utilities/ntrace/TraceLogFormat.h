@@ -0,0 +1,104 @@
+/*
+ *	PROGRAM:	SQL Trace plugin
+ *	MODULE:		TraceLogFormat.h
+ *	DESCRIPTION:	Layout of the binary trace log
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef TRACELOGFORMAT_H
+#define TRACELOGFORMAT_H
+
+#include "firebird.h"
+
+// The binary trace log is a sequence of chunks. Every chunk is appended by
+// a single write, so chunks of different plugin instances never intermix.
+// The chunk contains the records of one plugin instance, every record starts
+// with TraceRecord. Objects (connections, transactions, statements, routines)
+// are described once by the text records, the events refer them by ID.
+// All values are stored in the native byte order.
+
+inline constexpr char TRACE_LOG_SIGNATURE[] = "FBTRACE";
+
+inline constexpr USHORT TRACE_LOG_VERSION_1 = 1;
+inline constexpr USHORT TRACE_LOG_CURRENT_VERSION = TRACE_LOG_VERSION_1;
+
+struct TraceChunk
+{
+	char signature[8];
+	USHORT version;
+	USHORT reserved;
+	ULONG length;			// length of the records following the chunk header
+	SINT64 process;			// process ID
+	FB_UINT64 instance;		// plugin instance, unique inside the process
+	SLONG session;			// trace session ID
+	ULONG reserved2;
+};
+
+enum TraceRecordType : USHORT
+{
+	TRACE_REC_TEXT = 1,				// event formatted as text: action and text follow
+	TRACE_REC_CONNECTION = 2,		// connection description follows
+	TRACE_REC_TRANSACTION = 3,		// transaction description follows
+	TRACE_REC_STATEMENT = 4,		// statement description follows
+	TRACE_REC_ROUTINE = 5,			// procedure, function or trigger description follows
+	TRACE_REC_TRANSACTION_START = 6,
+	TRACE_REC_TRANSACTION_END = 7,
+	TRACE_REC_STATEMENT_START = 8,
+	TRACE_REC_STATEMENT_FINISH = 9,
+	TRACE_REC_PROCEDURE_START = 10,
+	TRACE_REC_PROCEDURE_FINISH = 11,
+	TRACE_REC_FUNCTION_START = 12,
+	TRACE_REC_FUNCTION_FINISH = 13,
+	TRACE_REC_TRIGGER_START = 14,
+	TRACE_REC_TRIGGER_FINISH = 15
+};
+
+// Event flags
+inline constexpr USHORT TRACE_FLAG_COMMIT = 0x0001;		// transaction is committed
+inline constexpr USHORT TRACE_FLAG_RETAINING = 0x0002;	// transaction context is retained
+inline constexpr USHORT TRACE_FLAG_STATS = 0x0004;		// performance counters are valid
+
+struct TraceRecord
+{
+	ULONG length;			// whole record length, including this header
+	USHORT type;			// TraceRecordType
+	USHORT result;			// ITracePlugin::RESULT_XXX for events
+	ISC_TIMESTAMP timestamp;
+	SINT64 id;				// described object for the text records
+};
+
+// Fixed layout record of the execution events. IDs refer the described objects:
+// statement is the statement (or routine) ID, for the transaction end it's the
+// new transaction number when the context is retained.
+
+struct TraceEventRecord : public TraceRecord
+{
+	SINT64 attachment;
+	SINT64 transaction;
+	SINT64 statement;
+	USHORT flags;
+	USHORT reserved;
+	ULONG restarts;
+	SINT64 elapsed;			// milliseconds
+	SINT64 fetchedRecords;
+	SINT64 pageReads;
+	SINT64 pageWrites;
+	SINT64 pageFetches;
+	SINT64 pageMarks;
+};
+
+#endif // TRACELOGFORMAT_H
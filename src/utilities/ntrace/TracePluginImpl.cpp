@@ -105,6 +105,14 @@ TracePluginImpl::TracePluginImpl(IPluginBase* plugin,
 	const char* ses_name = initInfo->getTraceSessionName();
 	session_name = ses_name && *ses_name ? ses_name : " ";
 
+	const bool binary = config.log_format.equalsNoCase("binary");
+
+	if (!binary && !config.log_format.equalsNoCase("text"))
+	{
+		fatal_exception::raiseFmt("invalid value \"%s\" of log_format parameter",
+			config.log_format.c_str());
+	}
+
 	if (!logWriter)
 	{
 		PathName logname(configuration.log_filename);
@@ -121,6 +129,10 @@ TracePluginImpl::TracePluginImpl(IPluginBase* plugin,
 
 		logWriter = FB_NEW PluginLogWriter(logname.c_str(), config.max_log_size * 1024 * 1024);
 		logWriter->addRef();
+
+		// Interactive sessions are always logged as text
+		if (binary)
+			binaryLog = FB_NEW BinaryLogWriter(logWriter, session_id);
 	}
 
 	// Compile filtering regular expressions
@@ -255,8 +267,103 @@ string TracePluginImpl::getPlan(C* routine)
 	return NEWLINE;
 }
 
+string TracePluginImpl::getRoutineName(ITraceProcedure* procedure)
+{
+	string temp;
+	temp.printf(NEWLINE "%s %s:", "Procedure", procedure->getProcName());
+	return temp;
+}
+
+string TracePluginImpl::getRoutineName(ITraceFunction* function)
+{
+	string temp;
+	temp.printf(NEWLINE "%s %s:", "Function", function->getFuncName());
+	return temp;
+}
+
+string TracePluginImpl::getRoutineName(ITraceTrigger* trigger)
+{
+	string name = "Trigger";
+
+	if (trigger->getTriggerName())
+	{
+		string trgname;
+		trgname.printf(" %s", trigger->getTriggerName());
+		name += trgname;
+	}
+
+	if ((trigger->getWhich() != ITraceTrigger::TYPE_ALL) && trigger->getRelationName())
+	{
+		string relation;
+		relation.printf(" FOR %s", trigger->getRelationName());
+		name += relation;
+	}
+
+	string extras;
+	switch (trigger->getWhich())
+	{
+		case ITraceTrigger::TYPE_ALL:
+			extras = "ON ";	//// TODO: Why ALL means ON (DATABASE) triggers?
+			break;
+		case ITraceTrigger::TYPE_BEFORE:
+			extras = "BEFORE ";
+			break;
+		case ITraceTrigger::TYPE_AFTER:
+			extras = "AFTER ";
+			break;
+		default:
+			extras = "<unknown> ";
+			break;
+	}
+
+	switch (trigger->getAction())
+	{
+		case TRIGGER_INSERT:
+			extras += "INSERT";
+			break;
+		case TRIGGER_UPDATE:
+			extras += "UPDATE";
+			break;
+		case TRIGGER_DELETE:
+			extras += "DELETE";
+			break;
+		case TRIGGER_CONNECT:
+			extras += "CONNECT";
+			break;
+		case TRIGGER_DISCONNECT:
+			extras += "DISCONNECT";
+			break;
+		case TRIGGER_TRANS_START:
+			extras += "TRANSACTION_START";
+			break;
+		case TRIGGER_TRANS_COMMIT:
+			extras += "TRANSACTION_COMMIT";
+			break;
+		case TRIGGER_TRANS_ROLLBACK:
+			extras += "TRANSACTION_ROLLBACK";
+			break;
+		case TRIGGER_DDL:
+			extras += "DDL";
+			break;
+		default:
+			extras += "Unknown trigger action";
+			break;
+	}
+
+	string temp;
+	temp.printf(NEWLINE "%s (%s):", name.c_str(), extras.c_str());
+	return temp;
+}
+
 void TracePluginImpl::logRecord(const char* action)
 {
+	if (binaryLog)
+	{
+		binaryLog->putText(TRACE_REC_TEXT, 0, action, record);
+		record = "";
+		return;
+	}
+
 	// We use atomic file appends for logging. Do not try to break logging
 	// to multiple separate file operations
 	const Firebird::TimeStamp stamp(Firebird::TimeStamp::getCurrentTimeStamp());
@@ -374,9 +481,7 @@ void TracePluginImpl::logRecordProc(const char* action, ITraceDatabaseConnection
 {
 	const StmtNumber stmt_id = procedure->getStmtID();
 
-	string temp;
-	temp.printf(NEWLINE "%s %s:", "Procedure", procedure->getProcName());
-
+	string temp = getRoutineName(procedure);
 	temp += (stmt_id && !checkRoutine(stmt_id)) ? getPlan(procedure) : NEWLINE;
 
 	record.insert(0, temp);
@@ -394,9 +499,7 @@ void TracePluginImpl::logRecordFunc(const char* action, ITraceDatabaseConnection
 {
 	const StmtNumber stmt_id = function->getStmtID();
 
-	string temp;
-	temp.printf(NEWLINE "%s %s:", "Function", function->getFuncName());
-
+	string temp = getRoutineName(function);
 	temp += (stmt_id && !checkRoutine(stmt_id)) ? getPlan(function) : NEWLINE;
 
 	record.insert(0, temp);
@@ -414,76 +517,7 @@ void TracePluginImpl::logRecordTrig(const char* action, ITraceDatabaseConnection
 {
 	const StmtNumber stmt_id = trigger->getStmtID();
 
-	string name = "Trigger";
-
-	if (trigger->getTriggerName())
-	{
-		string trgname;
-		trgname.printf(" %s", trigger->getTriggerName());
-		name += trgname;
-	}
-
-	if ((trigger->getWhich() != ITraceTrigger::TYPE_ALL) && trigger->getRelationName())
-	{
-		string relation;
-		relation.printf(" FOR %s", trigger->getRelationName());
-		name += relation;
-	}
-
-	string extras;
-	switch (trigger->getWhich())
-	{
-		case ITraceTrigger::TYPE_ALL:
-			extras = "ON ";	//// TODO: Why ALL means ON (DATABASE) triggers?
-			break;
-		case ITraceTrigger::TYPE_BEFORE:
-			extras = "BEFORE ";
-			break;
-		case ITraceTrigger::TYPE_AFTER:
-			extras = "AFTER ";
-			break;
-		default:
-			extras = "<unknown> ";
-			break;
-	}
-
-	switch (trigger->getAction())
-	{
-		case TRIGGER_INSERT:
-			extras += "INSERT";
-			break;
-		case TRIGGER_UPDATE:
-			extras += "UPDATE";
-			break;
-		case TRIGGER_DELETE:
-			extras += "DELETE";
-			break;
-		case TRIGGER_CONNECT:
-			extras += "CONNECT";
-			break;
-		case TRIGGER_DISCONNECT:
-			extras += "DISCONNECT";
-			break;
-		case TRIGGER_TRANS_START:
-			extras += "TRANSACTION_START";
-			break;
-		case TRIGGER_TRANS_COMMIT:
-			extras += "TRANSACTION_COMMIT";
-			break;
-		case TRIGGER_TRANS_ROLLBACK:
-			extras += "TRANSACTION_ROLLBACK";
-			break;
-		case TRIGGER_DDL:
-			extras += "DDL";
-			break;
-		default:
-			extras += "Unknown trigger action";
-			break;
-	}
-
-	string temp;
-	temp.printf(NEWLINE "%s (%s):", name.c_str(), extras.c_str());
-
+	string temp = getRoutineName(trigger);
 	temp += (stmt_id && !checkRoutine(stmt_id)) ? getPlan(trigger) : NEWLINE;
 
 	record.insert(0, temp);
@@ -629,29 +663,148 @@ void TracePluginImpl::logRecordError(const char* action, ITraceConnection* conne
 		logRecord(action);
 }
 
-void TracePluginImpl::appendGlobalCounts(IPerformanceStats* stats)
-{
-	string temp;
-
-	temp.printf("%7" QUADFORMAT"d ms", stats->getElapsedTime());
-	record.append(temp);
+// Holds counters: IPerformanceCounters::PAGE_{FETCHES|READS|MARKS|WRITES}
+static constexpr unsigned GLOBAL_COUNTERS = 4;
 
+static bool sumPageCounters(IPerformanceStats* stats, SINT64* globalCounters)
+{
 	const auto pageCounters = stats->getCounters(IPerformanceStats::COUNTER_GROUP_PAGES);
 	fb_assert(pageCounters);
 
-	if (const auto count = pageCounters->getObjectCount())
+	memset(globalCounters, 0, GLOBAL_COUNTERS * sizeof(SINT64));
+
+	const auto count = pageCounters->getObjectCount();
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		const auto counters = pageCounters->getObjectCounters(i);
+		for (unsigned j = 0; j < GLOBAL_COUNTERS; j++)
+			globalCounters[j] += counters[j];
+	}
+
+	return (count != 0);
+}
+
+void TracePluginImpl::describeConnection(ITraceDatabaseConnection* connection)
+{
+	{
+		ReadLockGuard lock(connectionsLock, FB_FUNCTION);
+		ConnectionsTree::Accessor accessor(&connections);
+		if (accessor.locate(connection->getConnectionID()))
+			return;
+	}
+
+	register_connection(connection);
+}
+
+TraNumber TracePluginImpl::describeTransaction(ITraceTransaction* transaction)
+{
+	TraNumber tra_id = transaction->getPreviousID();
+	if (!tra_id)
+		tra_id = transaction->getTransactionID();
+
+	{
+		ReadLockGuard lock(transactionsLock, FB_FUNCTION);
+		TransactionsTree::Accessor accessor(&transactions);
+		if (accessor.locate(tra_id))
+			return tra_id;
+	}
+
+	register_transaction(transaction);
+	return tra_id;
+}
+
+// Returns false for the statements which do not fall under filter criteria
+
+bool TracePluginImpl::describeStatement(ITraceSQLStatement* statement)
+{
+	const StmtNumber stmt_id = statement->getStmtID();
+
+	for (bool reg = false; ; reg = true)
+	{
+		{
+			ReadLockGuard lock(statementsLock, FB_FUNCTION);
+			StatementsTree::Accessor accessor(&statements);
+			if (accessor.locate(stmt_id))
+				return (accessor.current().description != NULL);
+		}
+
+		if (reg)
+			return false;
+
+		register_sql_statement(statement);
+	}
+}
+
+void TracePluginImpl::logBinaryEvent(TraceRecordType type, ntrace_result_t result,
+	ITraceDatabaseConnection* connection, ITraceTransaction* transaction,
+	StmtNumber stmt_id, IPerformanceStats* stats, USHORT flags, ULONG restarts)
+{
+	TraceEventRecord event;
+	memset(&event, 0, sizeof(TraceEventRecord));
+	event.type = type;
+	event.result = result;
+
+	describeConnection(connection);
+	event.attachment = connection->getConnectionID();
+
+	if (transaction)
+		event.transaction = describeTransaction(transaction);
+
+	event.statement = stmt_id;
+	event.restarts = restarts;
+
+	if (stats)
 	{
-		// Holds counters: IPerformanceCounters::PAGE_{FETCHES|READS|MARKS|WRITES}
-		static constexpr unsigned GLOBAL_COUNTERS = 4;
-		SINT64 globalCounters[GLOBAL_COUNTERS] = {0};
+		flags |= TRACE_FLAG_STATS;
+		event.elapsed = stats->getElapsedTime();
+		event.fetchedRecords = stats->getFetchedRecords();
 
-		for (unsigned i = 0; i < count; i++)
+		SINT64 globalCounters[GLOBAL_COUNTERS];
+		if (sumPageCounters(stats, globalCounters))
 		{
-			const auto counters = pageCounters->getObjectCounters(i);
-			for (unsigned j = 0; j < GLOBAL_COUNTERS; j++)
-				globalCounters[j] += counters[j];
+			event.pageReads = globalCounters[IPerformanceCounters::PAGE_READS];
+			event.pageWrites = globalCounters[IPerformanceCounters::PAGE_WRITES];
+			event.pageFetches = globalCounters[IPerformanceCounters::PAGE_FETCHES];
+			event.pageMarks = globalCounters[IPerformanceCounters::PAGE_MARKS];
 		}
+	}
+
+	event.flags = flags;
+
+	binaryLog->putEvent(event);
+}
+
+template <class C>
+void TracePluginImpl::logBinaryRoutine(TraceRecordType type, ntrace_result_t result,
+	ITraceDatabaseConnection* connection, ITraceTransaction* transaction,
+	C* routine, IPerformanceStats* stats)
+{
+	const StmtNumber stmt_id = routine->getStmtID();
 
+	// Routines without statement ID are described every time
+
+	if (!stmt_id || !checkRoutine(stmt_id))
+	{
+		string description = getRoutineName(routine);
+		description += stmt_id ? getPlan(routine) : NEWLINE;
+		binaryLog->putText(TRACE_REC_ROUTINE, stmt_id, nullptr, description);
+	}
+
+	logBinaryEvent(type, result, connection, transaction, stmt_id, stats);
+}
+
+void TracePluginImpl::appendGlobalCounts(IPerformanceStats* stats)
+{
+	string temp;
+
+	temp.printf("%7" QUADFORMAT"d ms", stats->getElapsedTime());
+	record.append(temp);
+
+	SINT64 globalCounters[GLOBAL_COUNTERS];
+
+	if (sumPageCounters(stats, globalCounters))
+	{
 		if (const auto cnt = globalCounters[IPerformanceCounters::PAGE_READS])
 		{
 			temp.printf(", %" QUADFORMAT"d read(s)", cnt);
@@ -677,6 +830,42 @@ void TracePluginImpl::appendGlobalCounts(IPerformanceStats* stats)
 		}
 	}
 
+	// Older engines don't provide the wait counters
+
+	const auto waitCounters = stats->getCounters(IPerformanceStats::COUNTER_GROUP_WAITS);
+
+	if (waitCounters && waitCounters->getObjectCount() &&
+		waitCounters->getMaxCounterIndex() >= IPerformanceCounters::WAIT_WRITE_TIME)
+	{
+		const auto counters = waitCounters->getObjectCounters(0);
+
+		if (const auto cnt = counters[IPerformanceCounters::WAIT_LOCK_WAITS])
+		{
+			temp.printf(", %" QUADFORMAT"d lock wait(s) %.3f ms", cnt,
+				counters[IPerformanceCounters::WAIT_LOCK_TIME] / 1000.0);
+			record.append(temp);
+		}
+
+		if (const auto cnt = counters[IPerformanceCounters::WAIT_LATCH_WAITS])
+		{
+			temp.printf(", %" QUADFORMAT"d latch wait(s) %.3f ms", cnt,
+				counters[IPerformanceCounters::WAIT_LATCH_TIME] / 1000.0);
+			record.append(temp);
+		}
+
+		if (const auto time = counters[IPerformanceCounters::WAIT_READ_TIME])
+		{
+			temp.printf(", %.3f ms read time", time / 1000.0);
+			record.append(temp);
+		}
+
+		if (const auto time = counters[IPerformanceCounters::WAIT_WRITE_TIME])
+		{
+			temp.printf(", %.3f ms write time", time / 1000.0);
+			record.append(temp);
+		}
+	}
+
 	record.append(NEWLINE);
 }
 
@@ -1309,6 +1498,8 @@ void TracePluginImpl::log_finalize()
 		logRecord("TRACE_FINI");
 	}
 
+	binaryLog.reset();
+
 	logWriter->release();
 	logWriter = NULL;
 }
@@ -1365,6 +1556,9 @@ void TracePluginImpl::register_connection(ITraceDatabaseConnection* connection)
 	}
 	conn_data.description->append(NEWLINE);
 
+	if (binaryLog)
+		binaryLog->putText(TRACE_REC_CONNECTION, conn_data.id, nullptr, *conn_data.description);
+
 	// Adjust the list of connections
 	{
 		WriteLockGuard lock(connectionsLock, FB_FUNCTION);
@@ -1481,6 +1675,9 @@ void TracePluginImpl::register_transaction(ITraceTransaction* transaction)
 
 	trans_data.description->append(")" NEWLINE);
 
+	if (binaryLog)
+		binaryLog->putText(TRACE_REC_TRANSACTION, trans_data.id, nullptr, *trans_data.description);
+
 	// Remember transaction
 	{
 		WriteLockGuard lock(transactionsLock, FB_FUNCTION);
@@ -1493,7 +1690,11 @@ void TracePluginImpl::log_event_transaction_start(ITraceDatabaseConnection* conn
 		ITraceTransaction* transaction, size_t /*tpb_length*/,
 		const ntrace_byte_t* /*tpb*/, ntrace_result_t tra_result)
 {
-	if (config.log_transactions)
+	if (config.log_transactions && binaryLog)
+	{
+		logBinaryEvent(TRACE_REC_TRANSACTION_START, tra_result, connection, transaction, 0, nullptr);
+	}
+	else if (config.log_transactions)
 	{
 		const char* event_type;
 		switch (tra_result)
@@ -1519,7 +1720,16 @@ void TracePluginImpl::log_event_transaction_end(ITraceDatabaseConnection* connec
 		ITraceTransaction* transaction, FB_BOOLEAN commit,
 		FB_BOOLEAN retain_context, ntrace_result_t tra_result)
 {
-	if (config.log_transactions)
+	if (config.log_transactions && binaryLog)
+	{
+		USHORT flags = commit ? TRACE_FLAG_COMMIT : 0;
+		if (retain_context)
+			flags |= TRACE_FLAG_RETAINING;
+
+		logBinaryEvent(TRACE_REC_TRANSACTION_END, tra_result, connection, transaction,
+			retain_context ? transaction->getTransactionID() : 0, transaction->getPerfStats(), flags);
+	}
+	else if (config.log_transactions)
 	{
 		if (retain_context || transaction->getInitialID() != transaction->getTransactionID())
 		{
@@ -1642,6 +1852,13 @@ void TracePluginImpl::log_event_proc_execute(ITraceDatabaseConnection* connectio
 	if (config.time_threshold && stats && stats->getElapsedTime() < config.time_threshold)
 		return;
 
+	if (binaryLog)
+	{
+		logBinaryRoutine(started ? TRACE_REC_PROCEDURE_START : TRACE_REC_PROCEDURE_FINISH,
+			proc_result, connection, transaction, procedure, stats);
+		return;
+	}
+
 	ITraceParams* params = procedure->getInputs();
 	if (params && params->getCount())
 	{
@@ -1724,6 +1941,13 @@ void TracePluginImpl::log_event_func_execute(ITraceDatabaseConnection* connectio
 	if (config.time_threshold && stats && stats->getElapsedTime() < config.time_threshold)
 		return;
 
+	if (binaryLog)
+	{
+		logBinaryRoutine(started ? TRACE_REC_FUNCTION_START : TRACE_REC_FUNCTION_FINISH,
+			func_result, connection, transaction, function, stats);
+		return;
+	}
+
 	ITraceParams* params = function->getInputs();
 	if (params && params->getCount())
 	{
@@ -1815,6 +2039,13 @@ void TracePluginImpl::log_event_trigger_execute(ITraceDatabaseConnection* connec
 	if (config.time_threshold && stats && stats->getElapsedTime() < config.time_threshold)
 		return;
 
+	if (binaryLog)
+	{
+		logBinaryRoutine(started ? TRACE_REC_TRIGGER_START : TRACE_REC_TRIGGER_FINISH,
+			trig_result, connection, transaction, trigger, stats);
+		return;
+	}
+
 	if (stats)
 	{
 		appendGlobalCounts(stats);
@@ -1891,6 +2122,9 @@ void TracePluginImpl::register_sql_statement(ITraceSQLStatement* statement)
 		*stmt_data.description += temp;
 
 		*stmt_data.description += getPlan(statement);
+
+		if (binaryLog)
+			binaryLog->putText(TRACE_REC_STATEMENT, stmt_data.id, nullptr, *stmt_data.description);
 	}
 	else
 	{
@@ -1968,6 +2202,16 @@ void TracePluginImpl::log_event_dsql_execute(ITraceDatabaseConnection* connectio
 	if (config.time_threshold && stats && stats->getElapsedTime() < config.time_threshold)
 		return;
 
+	if (binaryLog)
+	{
+		if (describeStatement(statement))
+		{
+			logBinaryEvent(started ? TRACE_REC_STATEMENT_START : TRACE_REC_STATEMENT_FINISH,
+				req_result, connection, transaction, statement->getStmtID(), stats, 0, number);
+		}
+		return;
+	}
+
 	if (restart)
 	{
 		string temp;
@@ -32,6 +32,7 @@
 #include "firebird.h"
 #include "../../jrd/ntrace.h"
 #include "TracePluginConfig.h"
+#include "BinaryLogWriter.h"
 #include "../../common/SimilarToRegex.h"
 #include "../../common/classes/rwlock.h"
 #include "../../common/classes/GenericMap.h"
@@ -151,6 +152,7 @@ private:
 	Firebird::ITraceLogWriter* logWriter;
 	TracePluginConfig config;	// Immutable, thus thread-safe
 	Firebird::string record;
+	Firebird::AutoPtr<BinaryLogWriter> binaryLog;	// Set if log_format is binary
 
 	// Data for currently active connections, transactions, statements
 	Firebird::RWLock connectionsLock;
@@ -203,6 +205,10 @@ private:
 	bool checkRoutine(StmtNumber stmt_id);
 	template <class C> Firebird::string getPlan(C* routine);
 
+	Firebird::string getRoutineName(Firebird::ITraceProcedure* procedure);
+	Firebird::string getRoutineName(Firebird::ITraceFunction* function);
+	Firebird::string getRoutineName(Firebird::ITraceTrigger* trigger);
+
 	// Write message to text log file
 	void logRecord(const char* action);
 	void logRecordConn(const char* action, Firebird::ITraceDatabaseConnection* connection);
@@ -220,6 +226,17 @@ private:
 	void logRecordServ(const char* action, Firebird::ITraceServiceConnection* service);
 	void logRecordError(const char* action, Firebird::ITraceConnection* connection, Firebird::ITraceStatusVector* status);
 
+	// Write event to binary log, objects are described when met first time
+	void describeConnection(Firebird::ITraceDatabaseConnection* connection);
+	TraNumber describeTransaction(Firebird::ITraceTransaction* transaction);
+	bool describeStatement(Firebird::ITraceSQLStatement* statement);
+	void logBinaryEvent(TraceRecordType type, unsigned result,
+		Firebird::ITraceDatabaseConnection* connection, Firebird::ITraceTransaction* transaction,
+		StmtNumber stmt_id, Firebird::IPerformanceStats* stats, USHORT flags = 0, ULONG restarts = 0);
+	template <class C> void logBinaryRoutine(TraceRecordType type, unsigned result,
+		Firebird::ITraceDatabaseConnection* connection, Firebird::ITraceTransaction* transaction,
+		C* routine, Firebird::IPerformanceStats* stats);
+
 	/* Methods which do logging of events to file */
 	void log_init();
 	void log_finalize();
@@ -37,6 +37,7 @@ STR_PARAMETER(exclude_schema_filter, "")
 STR_PARAMETER(include_filter, "")
 STR_PARAMETER(exclude_filter, "")
 PATH_PARAMETER(log_filename, "")
+STR_PARAMETER(log_format, "text")
 BOOL_PARAMETER(log_errors, false)
 BOOL_PARAMETER(log_warnings, false)
 STR_PARAMETER(include_gds_codes, "")